@@ -0,0 +1,374 @@
+/* s2texpack.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* s2texpack: convert a TGA image to an S2PLOT texture file (".s2t",
+ * see src/s2texfile.h) holding the image and its mipmaps, optionally
+ * block compressed or reduced to one or two channels.  ss2lt uploads
+ * these files straight from a memory mapping without decoding them.
+ *
+ * usage: s2texpack [-f rgba|lum|luma|bc1|bc3] [-nomip] in.tga out.s2t
+ *
+ *   rgba  uncompressed, 4 bytes per pixel (default)
+ *   lum   grey only, 1 byte per pixel
+ *   luma  grey and alpha, 2 bytes per pixel
+ *   bc1   S3TC/DXT1, 4 bits per pixel, alpha on or off
+ *   bc3   S3TC/DXT5, 8 bits per pixel, smooth alpha
+ *
+ * Usually run via scripts/texpack.csh, which takes any image format
+ * ImageMagick understands.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitmaplib.h"
+#include "s2texfile.h"
+
+static char *fmtnames[S2TF_NFORMATS] = {"rgba", "lum", "luma", "bc1", "bc3"};
+
+/* halve an image with a 2x2 box filter */
+static BITMAP4 *halve(BITMAP4 *in, int w, int h, int *w2, int *h2) {
+  int x, y, i, j, sx, sy;
+  *w2 = (w > 1) ? w / 2 : 1;
+  *h2 = (h > 1) ? h / 2 : 1;
+  BITMAP4 *out = (BITMAP4 *)malloc((long)*w2 * *h2 * sizeof(BITMAP4));
+  if (!out) {
+    return NULL;
+  }
+  for (y = 0; y < *h2; y++) {
+    for (x = 0; x < *w2; x++) {
+      int r = 0, g = 0, b = 0, a = 0, n = 0;
+      for (j = 0; j < 2; j++) {
+	sy = 2 * y + j;
+	if (sy >= h || (j && *h2 == h)) {
+	  continue;
+	}
+	for (i = 0; i < 2; i++) {
+	  sx = 2 * x + i;
+	  if (sx >= w || (i && *w2 == w)) {
+	    continue;
+	  }
+	  BITMAP4 *p = in + (long)sy * w + sx;
+	  r += p->r; g += p->g; b += p->b; a += p->a;
+	  n++;
+	}
+      }
+      out[y * *w2 + x].r = (r + n / 2) / n;
+      out[y * *w2 + x].g = (g + n / 2) / n;
+      out[y * *w2 + x].b = (b + n / 2) / n;
+      out[y * *w2 + x].a = (a + n / 2) / n;
+    }
+  }
+  return out;
+}
+
+static unsigned char grey(BITMAP4 *p) {
+  return (unsigned char)((p->r * 77 + p->g * 150 + p->b * 29 + 128) >> 8);
+}
+
+static unsigned int pack565(int r, int g, int b) {
+  return ((r * 31 + 127) / 255 << 11) | ((g * 63 + 127) / 255 << 5) |
+    ((b * 31 + 127) / 255);
+}
+
+static void unpack565(unsigned int c, int *rgb) {
+  rgb[0] = ((c >> 11) & 31) * 255 / 31;
+  rgb[1] = ((c >> 5) & 63) * 255 / 63;
+  rgb[2] = (c & 31) * 255 / 31;
+}
+
+/* encode the colours of a 4x4 block: endpoints are the corners of the
+ * block's colour bounding box, pulled in a little, and each pixel
+ * takes the nearest of the four palette entries.  With punch set
+ * (BC1 only) pixels with alpha below half become transparent and the
+ * three colour palette is used.
+ */
+static void encodeColours(BITMAP4 *blk, int punch, unsigned char *out) {
+  int lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0}, k, c, i;
+  int anyclear = 0;
+  for (i = 0; i < 16; i++) {
+    if (punch && blk[i].a < 128) {
+      anyclear = 1;
+      continue;
+    }
+    int v[3] = {blk[i].r, blk[i].g, blk[i].b};
+    for (c = 0; c < 3; c++) {
+      if (v[c] < lo[c]) lo[c] = v[c];
+      if (v[c] > hi[c]) hi[c] = v[c];
+    }
+  }
+  if (lo[0] > hi[0]) {
+    /* every pixel transparent */
+    lo[0] = lo[1] = lo[2] = hi[0] = hi[1] = hi[2] = 0;
+  }
+  for (c = 0; c < 3; c++) {
+    int inset = (hi[c] - lo[c]) / 16;
+    lo[c] += inset;
+    hi[c] -= inset;
+  }
+  unsigned int c0 = pack565(hi[0], hi[1], hi[2]);
+  unsigned int c1 = pack565(lo[0], lo[1], lo[2]);
+  /* four colour mode needs c0 > c1, three colour mode c0 <= c1 */
+  if ((anyclear && c0 > c1) || (!anyclear && c0 < c1)) {
+    unsigned int t = c0; c0 = c1; c1 = t;
+  }
+  int pal[4][3];
+  unpack565(c0, pal[0]);
+  unpack565(c1, pal[1]);
+  int npal = 4;
+  for (c = 0; c < 3; c++) {
+    if (c0 > c1) {
+      pal[2][c] = (2 * pal[0][c] + pal[1][c]) / 3;
+      pal[3][c] = (pal[0][c] + 2 * pal[1][c]) / 3;
+    } else {
+      pal[2][c] = (pal[0][c] + pal[1][c]) / 2;
+      npal = 3;
+    }
+  }
+  unsigned int bits = 0;
+  for (i = 0; i < 16; i++) {
+    int best = 0, bestd = 1 << 30;
+    if (anyclear && blk[i].a < 128) {
+      best = 3;
+    } else {
+      for (k = 0; k < npal; k++) {
+	int dr = blk[i].r - pal[k][0], dg = blk[i].g - pal[k][1],
+	  db = blk[i].b - pal[k][2];
+	int d = dr * dr + dg * dg + db * db;
+	if (d < bestd) {
+	  bestd = d;
+	  best = k;
+	}
+      }
+    }
+    bits |= (unsigned int)best << (2 * i);
+  }
+  out[0] = c0 & 255; out[1] = c0 >> 8;
+  out[2] = c1 & 255; out[3] = c1 >> 8;
+  for (k = 0; k < 4; k++) {
+    out[4 + k] = (bits >> (8 * k)) & 255;
+  }
+}
+
+/* encode the alpha of a 4x4 block in the eight value BC3 mode */
+static void encodeAlpha(BITMAP4 *blk, unsigned char *out) {
+  int a0 = 0, a1 = 255, i, k, pal[8];
+  for (i = 0; i < 16; i++) {
+    if (blk[i].a > a0) a0 = blk[i].a;
+    if (blk[i].a < a1) a1 = blk[i].a;
+  }
+  unsigned long long bits = 0;
+  if (a0 > a1) {
+    pal[0] = a0;
+    pal[1] = a1;
+    for (k = 1; k < 7; k++) {
+      pal[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+    }
+    for (i = 0; i < 16; i++) {
+      int best = 0, bestd = 1 << 30;
+      for (k = 0; k < 8; k++) {
+	int d = abs(blk[i].a - pal[k]);
+	if (d < bestd) {
+	  bestd = d;
+	  best = k;
+	}
+      }
+      bits |= (unsigned long long)best << (3 * i);
+    }
+  }
+  out[0] = a0;
+  out[1] = a1;
+  for (k = 0; k < 6; k++) {
+    out[2 + k] = (bits >> (8 * k)) & 255;
+  }
+}
+
+/* convert one level to the file format */
+static void packLevel(BITMAP4 *img, int w, int h, int fmt, unsigned char *out) {
+  long i, n = (long)w * h;
+  int bx, by, x, y;
+  switch (fmt) {
+  case S2TF_RGBA:
+    memcpy(out, img, n * sizeof(BITMAP4));
+    break;
+  case S2TF_LUM:
+    for (i = 0; i < n; i++) {
+      out[i] = grey(img + i);
+    }
+    break;
+  case S2TF_LUMA:
+    for (i = 0; i < n; i++) {
+      out[2 * i] = grey(img + i);
+      out[2 * i + 1] = img[i].a;
+    }
+    break;
+  case S2TF_BC1:
+  case S2TF_BC3:
+    for (by = 0; by < (h + 3) / 4; by++) {
+      for (bx = 0; bx < (w + 3) / 4; bx++) {
+	BITMAP4 blk[16];
+	/* partial blocks repeat their edge pixels */
+	for (i = 0; i < 16; i++) {
+	  x = bx * 4 + (i & 3);
+	  y = by * 4 + (i >> 2);
+	  blk[i] = img[(long)(y < h ? y : h - 1) * w + (x < w ? x : w - 1)];
+	}
+	if (fmt == S2TF_BC3) {
+	  encodeAlpha(blk, out);
+	  encodeColours(blk, 0, out + 8);
+	  out += 16;
+	} else {
+	  encodeColours(blk, 1, out);
+	  out += 8;
+	}
+      }
+    }
+    break;
+  }
+}
+
+static void put32(unsigned char *p, unsigned int v) {
+  p[0] = v & 255;
+  p[1] = (v >> 8) & 255;
+  p[2] = (v >> 16) & 255;
+  p[3] = (v >> 24) & 255;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: s2texpack [-f rgba|lum|luma|bc1|bc3] [-nomip] "
+	  "in.tga out.s2t\n");
+  exit(-1);
+}
+
+int main(int argc, char *argv[]) {
+  int fmt = S2TF_RGBA, mips = 1, i, w, h;
+  char *inname = NULL, *outname = NULL;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      i++;
+      for (fmt = 0; fmt < S2TF_NFORMATS; fmt++) {
+	if (!strcmp(argv[i], fmtnames[fmt])) {
+	  break;
+	}
+      }
+      if (fmt == S2TF_NFORMATS) {
+	usage();
+      }
+    } else if (!strcmp(argv[i], "-nomip")) {
+      mips = 0;
+    } else if (!inname) {
+      inname = argv[i];
+    } else if (!outname) {
+      outname = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!outname) {
+    usage();
+  }
+
+  /* ReadTGATexture would hand back random noise for a bad file */
+  BITMAP4 *img = ReadTGABitmap(inname, &w, &h);
+  if (!img) {
+    fprintf(stderr, "s2texpack: unable to read %s\n", inname);
+    exit(-1);
+  }
+  if ((w > S2TF_MAXSIZE) || (h > S2TF_MAXSIZE)) {
+    fprintf(stderr, "s2texpack: %s is larger than %d pixels across\n",
+	    inname, S2TF_MAXSIZE);
+    exit(-1);
+  }
+
+  /* lay out the file */
+  int nlevels = 1;
+  if (mips) {
+    while (((w >> nlevels) > 0 || (h >> nlevels) > 0) &&
+	   nlevels < S2TF_MAXLEVELS) {
+      nlevels++;
+    }
+  }
+  unsigned int offset[S2TF_MAXLEVELS], size[S2TF_MAXLEVELS];
+  unsigned long total = S2TF_HEADER + nlevels * S2TF_LEVEL;
+  for (i = 0; i < nlevels; i++) {
+    int lw = (w >> i) ? (w >> i) : 1, lh = (h >> i) ? (h >> i) : 1;
+    total = (total + 15) & ~15UL;
+    offset[i] = total;
+    size[i] = S2TF_LEVELSIZE(fmt, lw, lh);
+    total += size[i];
+  }
+  unsigned char *buf = (unsigned char *)calloc(total, 1);
+  if (!buf) {
+    fprintf(stderr, "s2texpack: out of memory\n");
+    exit(-1);
+  }
+  memcpy(buf, S2TF_MAGIC, 8);
+  put32(buf + 8, fmt);
+  put32(buf + 12, w);
+  put32(buf + 16, h);
+  put32(buf + 20, nlevels);
+  put32(buf + 24, 0);
+
+  /* each level from the one before */
+  BITMAP4 *lev = img;
+  int lw = w, lh = h;
+  for (i = 0; i < nlevels; i++) {
+    unsigned char *ent = buf + S2TF_HEADER + i * S2TF_LEVEL;
+    if (i > 0) {
+      BITMAP4 *next = halve(lev, lw, lh, &lw, &lh);
+      if (!next) {
+	fprintf(stderr, "s2texpack: out of memory\n");
+	exit(-1);
+      }
+      free(lev);
+      lev = next;
+    }
+    put32(ent, lw);
+    put32(ent + 4, lh);
+    put32(ent + 8, offset[i]);
+    put32(ent + 12, size[i]);
+    packLevel(lev, lw, lh, fmt, buf + offset[i]);
+  }
+  free(lev);
+
+  FILE *fp = fopen(outname, "wb");
+  if (!fp || fwrite(buf, 1, total, fp) != total) {
+    fprintf(stderr, "s2texpack: unable to write %s\n", outname);
+    exit(-1);
+  }
+  fclose(fp);
+  fprintf(stderr, "%s: %dx%d %s, %d level%s, %lu bytes\n", outname, w, h,
+	  fmtnames[fmt], nlevels, (nlevels > 1) ? "s" : "", total);
+  free(buf);
+  return 0;
+}
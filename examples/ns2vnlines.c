@@ -0,0 +1,67 @@
+/* ns2vnlines.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>. 
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "s2plot.h"
+
+int main(int argc, char *argv[])
+{
+   int N = 1000;				/* Number of line segments */
+   float x[2000], y[2000], z[2000];		/* End points */
+   COLOUR col;					/* Colour */
+   int i;
+
+   srand48((long)time(NULL));			/* Seed random numbers */
+
+   s2opend("/?",argc, argv);			/* Open the display */
+   s2swin(-1.,1., -1.,1., -1.,1.);		/* Set the window coordinates */
+   s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0);	/* Draw coordinate box */
+
+   for (i=0;i<2*N;i+=2) {			/* Short random segments */
+      x[i] = drand48()*1.8 - 0.9;
+      y[i] = drand48()*1.8 - 0.9;
+      z[i] = drand48()*1.8 - 0.9;
+      x[i+1] = x[i] + drand48()*0.2 - 0.1;
+      y[i+1] = y[i] + drand48()*0.2 - 0.1;
+      z[i+1] = z[i] + drand48()*0.2 - 0.1;
+   }
+   col.r = 1.0;					/* Yellow */
+   col.g = 1.0;
+   col.b = 0.0;
+   ns2vnlines(N, x, y, z, NULL, NULL, NULL, col, 2.);	/* Draw segments */
+
+   s2show(1);					/* Open the s2plot window */
+   
+   return 1;
+}
@@ -0,0 +1,89 @@
+/* ss2lta.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>. 
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "s2plot.h"
+
+#define NTEX 3
+unsigned int texids[NTEX];			/* IDs for the textures */
+
+void cb(double *t, int *kc)
+{
+   static int reported = 0;			/* Told the user yet? */
+   static double t0 = -1.0;			/* Time of first callback */
+   int i, nready = 0;				/* Loop variable, count */
+   float aspect;				/* Aspect ratio of texture */
+
+   if (t0 < 0.0) t0 = *t;			/* *t is absolute time */
+   if (reported) return;
+   for (i=0;i<NTEX;i++) {
+      if (ss2qtl(texids[i], &aspect) == 1) {	/* Is this texture ready? */
+         nready++;
+      }
+   }
+   if (nready == NTEX) {
+      fprintf(stderr, "All textures loaded after %.2f seconds\n", 
+	      *t - t0);
+      reported = 1;
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   char *texfn[NTEX] = { "firetile2_pow2_rgb.tga", "checked.tga", 
+			 "halo32.tga" };
+                /* Textures in directory pointed to by S2PLOT_TEXPATH */
+   XYZ P[4];					/* Corners of facet */
+   COLOUR col = { 1.0, 1.0, 1.0 };		/* White */
+   int i;					/* Loop variable */
+
+   s2opend("/?",argc, argv);			/* Open the display */
+   s2swin(-1.,1., -1.,1., -1.,1.);		/* Set the window coordinates */
+
+   for (i=0;i<NTEX;i++) {
+      texids[i] = ss2lta(texfn[i]);		/* Start loading texture */
+   }
+
+   for (i=0;i<NTEX;i++) {			/* Use the textures at once */
+      P[0].x = -0.9 + 0.6*i; P[0].y = -0.3; P[0].z = 0.0;
+      P[1].x = -0.4 + 0.6*i; P[1].y = -0.3; P[1].z = 0.0;
+      P[2].x = -0.4 + 0.6*i; P[2].y =  0.2; P[2].z = 0.0;
+      P[3].x = -0.9 + 0.6*i; P[3].y =  0.2; P[3].z = 0.0;
+      ns2vf4x(P, col, texids[i], 1.0, 'o');
+   }
+
+   cs2scb(cb);					/* Install dynamic callback */
+   s2show(1);					/* Open the s2plot window */
+   
+   return 1;
+}
@@ -0,0 +1,75 @@
+/* ss2ptr.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>. 
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "s2plot.h"
+
+unsigned int texid;				/* ID for this texture */
+int width = 256, height = 256;			/* Dimensions of texture */
+
+void cb(double *t, int *kc)
+{
+   static int row = 0;				/* Row to write next */
+   unsigned char *tex;				/* Array holding texture */
+   int i, idx;					/* Loop variable and index */
+   float v;					/* Value of this pixel */
+   XYZ P[4] = {{-1,-1,0}, {1,-1,0}, {1,1,0}, {-1,1,0}};	/* Corners */
+   COLOUR col = { 1.0, 1.0, 1.0 };		/* White */
+
+   tex = ss2gt(texid, NULL, NULL);		/* Fetch the texture */
+   for (i=0;i<width;i++) {			/* New "spectrum" for one row */
+      v = 0.5 + 0.5*sin(0.05*i + 0.3*(*t)) * drand48();
+      idx = (row*width + i)*4;			/* Stored as (r, g, b, alpha) */
+      tex[idx  ] = 255*v;			/* Red */
+      tex[idx+1] = 255*v*v;			/* Green */
+      tex[idx+2] = 64;				/* Blue */
+   }
+   ss2ptr(texid, 0, width-1, row, row);		/* Send only this row */
+   row = (row + 1) % height;			/* Scroll */
+
+   ns2vf4x(P, col, texid, 1.0, 'o');		/* Draw textured facet */
+}
+
+int main(int argc, char *argv[])
+{
+   s2opend("/?",argc, argv);			/* Open the display */
+   s2swin(-1.,1., -1.,1., -1.,1.);		/* Set the window coordinates */
+
+   texid = ss2ctt(width, height);		/* Create transient texture */
+   cs2scb(cb);					/* Install dynamic callback */
+
+   s2show(1);					/* Open the s2plot window */
+   
+   return 1;
+}
@@ -0,0 +1,92 @@
+/* ss2tbbx.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>. 
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "s2plot.h"
+
+#define NBB 100000				/* Number of billboards */
+XYZ xyz[NBB];					/* Billboard positions */
+COLOUR col[NBB];				/* Billboard colours */
+unsigned int tid;				/* Texture id */
+
+void cb(double *t, int *kc)
+{
+   static int cnt = 0;				/* Keep count between calls */
+   char string[64];				/* Label to draw */
+   XYZ str = { 0.0, 0.0, 0.0 };			/* No stretch */
+   int i;
+
+   if (cnt == 100) {				/* Every few seconds */
+      ss2tbbx(!ss2qbbx());			/* Toggle shader billboards */
+      cnt = 0;					/* Reset count */
+   } else {
+      cnt++;					/* Keep on counting */
+   }
+
+   for (i=0;i<NBB;i++) {
+      ds2vbb(xyz[i], str, 0.01, col[i], tid, 0.5, 't'); /* Draw billboard */
+   }
+
+   sprintf(string, "Billboards expanded on the %s", ss2qbbx() ? "GPU" : "CPU");
+   s2lab("","","",string);			/* Write the label */
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+
+   srand48((long)time(NULL));			/* Seed random numbers */
+
+   s2opend("/?",argc, argv);			/* Open the display */
+   s2swin(-1.,1., -1.,1., -1.,1.);		/* Set the window coordinates */
+   s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0);	/* Draw coordinate box */
+
+   for (i=0;i<NBB;i++) {			/* Random positions, colours */
+      xyz[i].x = drand48()*2.0 - 1.0;
+      xyz[i].y = drand48()*2.0 - 1.0;
+      xyz[i].z = drand48()*2.0 - 1.0;
+      col[i].r = drand48();
+      col[i].g = drand48();
+      col[i].b = drand48();
+   }
+
+   tid = ss2lt("halo32.tga");			/* Load a texture */
+
+   cs2scb(&cb);					/* Install a callback */
+
+   s2show(1);					/* Open the s2plot window */
+   
+   return 1;
+}
@@ -0,0 +1,73 @@
+/* ss2tlod.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>. 
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "s2plot.h"
+
+#define NPT 2000000				/* Number of points */
+
+int main(int argc, char *argv[])
+{
+   float *x, *y, *z;				/* Point positions */
+   float r;					/* Radius of a point */
+   int i;
+
+   srand48((long)time(NULL));			/* Seed random numbers */
+
+   s2opend("/?",argc, argv);			/* Open the display */
+   s2swin(-1.,1., -1.,1., -1.,1.);		/* Set the window coordinates */
+   s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0);	/* Draw coordinate box */
+
+   x = (float *)malloc(NPT * sizeof(float));
+   y = (float *)malloc(NPT * sizeof(float));
+   z = (float *)malloc(NPT * sizeof(float));
+   for (i=0;i<NPT;i++) {			/* A centrally concentrated */
+      r = pow(drand48(), 3.0);			/* cloud of points */
+      x[i] = r * (drand48()*2.0 - 1.0);
+      y[i] = r * (drand48()*2.0 - 1.0);
+      z[i] = r * (drand48()*2.0 - 1.0);
+   }
+
+   ss2tlod(1);					/* Reduce detail while moving */
+
+   s2sci(S2_PG_YELLOW);				/* Set the colour */
+   s2pt(NPT, x, y, z, 1);			/* Draw the points */
+
+   s2lab("","","","Points drawn at reduced detail while the camera moves");
+
+   s2show(1);					/* Open the s2plot window */
+   
+   return 1;
+}
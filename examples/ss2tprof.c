@@ -0,0 +1,74 @@
+/* ss2tprof.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>. 
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "s2plot.h"
+
+void cb(double *t, int *kc)
+{
+   static int last = -1;
+   int count, bytes;
+   float secs;
+
+   if ((int)(*t) != last) {			/* Report once a second */
+      last = (int)(*t);
+      secs = ss2qprs("draw", 1, &count, &bytes);	/* Previous frame */
+      if (secs >= 0.) {
+	 fprintf(stderr, "frame %d drew in %.1f ms\n", ss2qprn(), secs*1000.);
+      }
+   }
+   ns2sphere(0.5*sin(*t), 0.5*cos(*t), 0., 0.1, 1., 1., 0.);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+
+   s2opend("/?",argc, argv);			/* Open the display */
+   s2swin(-1.,1., -1.,1., -1.,1.);		/* Set the window coordinates */
+   s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0);	/* Draw coordinate box */
+
+   for (i=0;i<100000;i++) {			/* Random points */
+      s2sci(i % 15 + 1);
+      s2pt1(drand48()*2.0 - 1.0, drand48()*2.0 - 1.0, 
+	    drand48()*2.0 - 1.0, 1);
+   }
+
+   ss2tprof(1);					/* Profile every frame */
+   cs2scb(cb);					/* Install a callback */
+
+   s2show(1);					/* Open the s2plot window */
+   						/* Press 'T' to save profile */
+   return 1;
+}
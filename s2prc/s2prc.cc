@@ -144,6 +144,7 @@ struct triangleStripe {
 extern "C" {
 #include "s2plot.h"
 #include "geomviewer.h"
+#include "s2types.h"
   void _s2_startDynamicGeometry(int);
   void _s2_endDynamicGeometry(void);
 }
@@ -155,77 +156,6 @@ extern "C" {
 #define FALSE 0
 #endif
 
-/* cached texture structure */
-#if !defined(_S2CACHEDTEXTURE_STRUCT_DEFINED)
-typedef struct {
-  int width, height;    // "user" width and height
-  int width2, height2;  // "internal" width and height (poss. powers of two)
-  float wfrac, hfrac;   // width and height fraction for texture coordinates
-                        // when width2 > width &/ height2 > height
-  BITMAP4 *bitmap;      // the pixels
-  GLuint id;            // OpenGL texture id
-  int depth, depth2;    // "user" and "internal" depth for 3d textures
-} _S2CACHEDTEXTURE;
-#define _S2CACHEDTEXTURE_STRUCT_DEFINED 1
-#endif
-
-/* transparent 3-vertex facet structure */
-#if !defined(_S2FACE3A_STRUCT_DEFINED)
-typedef struct {
-  XYZ p[3];               // vertices
-  XYZ n[3];               // vertex normals
-  COLOUR colour[3];       // vertex colours
-  int trans;              // 'o' = opaque, 't'/'s' = transparent
-  double alpha[3];        // transparency: 1.0 = default = opaque
-  char whichscreen[10];   // for screen geometry, which screen/s?
-  char VRMLname[32];      // which named branch to put in VRML / PRC output
-} _S2FACE3A;
-#define _S2FACE3A_STRUCT_DEFINED 1
-#endif
-
-/* billboard structure - NOT ALL FIELDS SUPPORTED IN PRC EXPORT */
-#if !defined(_S2BBOARD_STRUCT_DEFINED)
-typedef struct {
-  XYZ p;                 // vertex (position)
-  XYZ str;               // stretch (direction + magnitude): 0 = no stretch
-  XYZ offset;            // offset (X and Y only, Z ignored)
-  float aspect;          // aspect ratio: width to height "on the screen"
-  float size;            // size of billboard
-  float pa;              // position angle in radians, clockwise from 12 o'clock
-  COLOUR col;            // colour
-  unsigned int texid;    // OpenGL texture id
-  float alpha;           // transparency: 1.0 = default = opaque
-  double dist;           // distance to camera - used internally for sorting
-  char trans;            // 'o' = opaque, 't'/'s' = transparent
-  char whichscreen[10];  // for screen geometry, which screen/s?
-  char VRMLname[32];     // which named branch to put in VRML / PRC output
-} _S2BBOARD;
-#define _S2BBOARD_STRUCT_DEFINED
-#endif
-
-// textured mesh
-#if !defined(_S2TEXTUREDMESH_STRUCT_DEFINED)
-typedef struct {
-  int nverts; // vertices
-  XYZ *verts;
-  int nnorms; // normals
-  XYZ *norms;
-  int nvtcs;  // vertex texture coordinates
-  XYZ *vtcs; // only XY used (as u,v)
-  int nfacets; // (triangular) facets
-  int *facets; // 3 * int per facet = 3 * vertex INDICES (look-up)
-  int *facets_vtcs; // 3 * int per facet = 3 * texture coordinate INDICES
-  unsigned int texid;
-  int trans; /* 'o' = opaque, 't'/'s' = transparent */
-  double alpha; /* 1.0 = opaque, 0.0 = totally transparent */
-  char whichscreen[10];
-  char VRMLname[32];
-} _S2TEXTUREDMESH;
-#define _S2TEXTUREDMESH_STRUCT_DEFINED
-#endif
-
-
-
 // s2plot global variables
 extern int _s2_nVRMLnames;
 extern char **_s2_VRMLnames;
@@ -328,8 +258,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < ndot; ) {
 	  // get start point
 	  while (i < ndot && 
-		 (strcmp(dot[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(dot[i].whichscreen))) {
+		 ((dot[i].VRMLname != nidx) ||
+		  dot[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == ndot) {
@@ -360,8 +290,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < nline; ) {
 	  // get start point
 	  while (i < nline && 
-		 (strcmp(line[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(line[i].whichscreen))) {
+		 ((line[i].VRMLname != nidx) ||
+		  line[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nline) {
@@ -394,8 +324,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < nface4; ) {
 	  // get start point
 	  while ((i < nface4) && 
-		 (strcmp(face4[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(face4[i].whichscreen))) {
+		 ((face4[i].VRMLname != nidx) ||
+		  face4[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nface4) {
@@ -419,8 +349,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < nface4t; ) {
 	  // get start point
 	  while ((i < nface4t) && 
-		 (strcmp(face4t[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(face4t[i].whichscreen))) {
+		 ((face4t[i].VRMLname != nidx) ||
+		  face4t[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nface4t) {
@@ -453,8 +383,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < nface3; ) {
 	  // get start point
 	  while ((i < nface3) && 
-		 (strcmp(face3[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(face3[i].whichscreen))) {
+		 ((face3[i].VRMLname != nidx) ||
+		  face3[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nface3) {
@@ -496,8 +426,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < nface3a; ) {
 	  // get start point
 	  while ((i < nface3a) && 
-		 (strcmp(face3a[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(face3a[i].whichscreen))) {
+		 ((face3a[i].VRMLname != nidx) ||
+		  face3a[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nface3a) {
@@ -532,8 +462,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < nball; ) {
 	  // get start point
 	  while ((i < nball) && 
-		 (strcmp(ball[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(ball[i].whichscreen))) {
+		 ((ball[i].VRMLname != nidx) ||
+		  ball[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nball) {
@@ -557,8 +487,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < ncone; ){
 	  // get start point
 	  while ((i < ncone) &&
-		 (strcmp(cone[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(cone[i].whichscreen) ||
+		 ((cone[i].VRMLname != nidx) ||
+		  cone[i].whichscreen ||
 		  ((cone[i].r2 > EPS) && (cone[i].r1 > EPS)))) {
 	    i++;
 	  }
@@ -583,8 +513,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < ncone; ){
 	  // get start point
 	  while ((i < ncone) &&
-		 (strcmp(cone[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(cone[i].whichscreen) ||
+		 ((cone[i].VRMLname != nidx) ||
+		  cone[i].whichscreen ||
 		  (fabs(cone[i].r2 - cone[i].r1) > EPS))) {
 	    i++;
 	  }
@@ -609,8 +539,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < nlabel; ) {
 	  // get start point
 	  while ((i < nlabel) && 
-		 (strcmp(label[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(label[i].whichscreen))) {
+		 ((label[i].VRMLname != nidx) ||
+		  label[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nlabel) {
@@ -632,8 +562,8 @@ void cppWritePRC(void) {
 	for (i = 0; i < nbboard; ) {
 	  // get start point
 	  while ((i < nbboard) && 
-		 (strcmp(bboard[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(bboard[i].whichscreen))) {
+		 ((bboard[i].VRMLname != nidx) ||
+		  bboard[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nbboard) {
@@ -651,8 +581,8 @@ void cppWritePRC(void) {
 	file.begingroup(group);
 	for (i = 0; i < ntexmesh; i++) {
 	  while ((i < ntexmesh) &&
-		 (strcmp(texmesh[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(texmesh[i].whichscreen))) {
+		 ((texmesh[i].VRMLname != nidx) ||
+		  texmesh[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == ntexmesh) {
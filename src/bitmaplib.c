@@ -1031,6 +1031,50 @@ BITMAP4 *ReadTGATexture(char *fname,int *w,int *h)
    fclose(fptr);
    return(ptr);
 }
+/*
+   Read a TGA texture file as ReadTGATexture does, but return NULL if
+   the file cannot be opened or read rather than a texture of random
+   noise.  Does not call rand(), so it leaves the application's random
+   number sequence alone and is safe to call from other threads.
+*/
+BITMAP4 *ReadTGABitmap(char *fname,int *w,int *h)
+{
+   int width,height,depth;
+   FILE *fptr;
+   BITMAP4 *ptr;
+
+   if ((fptr = fopen(fname,"rb")) == NULL) {
+      fprintf(stderr,"Failed to open texture file \"%s\"\n",fname);
+      return(NULL);
+   }
+
+   /* Read the header */
+   TGA_Info(fptr,&width,&height,&depth);
+   if (width < 4 || height < 4 || width > 30000 || height > 30000) {
+      fprintf(stderr,"Failed to read TGA header\n");
+      fclose(fptr);
+      return(NULL);
+   }
+
+   /* Allocate memory for the texture */
+   if ((ptr = (BITMAP4 *)calloc(width*height,sizeof(BITMAP4))) == NULL) {
+      fprintf(stderr,"Failed to allocate memory for texture \"%s\"\n",fname);
+      fclose(fptr);
+      return(NULL);
+   }
+
+   /* Actually read the texture */
+   int fl = TGA_Read(fptr,ptr,&width,&height);
+   fclose(fptr);
+   if (fl != 0) {
+      fprintf(stderr,"TGA file read error %d\n", fl);
+      free(ptr);
+      return(NULL);
+   }
+   *w = width;
+   *h = height;
+   return(ptr);
+}
 BITMAP4 YUV_to_Bitmap(int y,int u,int v)
 {  
    int r,g,b; 
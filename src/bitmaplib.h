@@ -83,6 +83,7 @@ extern "C" {
   void WriteTGACompressedRow(FILE *,BITMAP4 *,int,int);
 
   BITMAP4 *ReadTGATexture(char *,int *,int *);
+  BITMAP4 *ReadTGABitmap(char *,int *,int *);
   
 #if defined(__cplusplus) && !defined(S2_CPPBUILD)
 } /* extern "C" { */
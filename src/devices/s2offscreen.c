@@ -0,0 +1,228 @@
+/* s2offscreen.c: S2PLOT offscreen (/s2offscr) driver
+ *
+ * Copyright 2006-2014 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>. 
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Renders into an EGL pbuffer instead of a window, so S2PLOT programs
+ * can produce frames with no window system at all (render farms, CI).
+ * With Mesa's surfaceless platform this needs no GPU and no X server:
+ * the software rasteriser is used.  The driver supplies the window
+ * system (see S2WINSYS in s2win.h) in place of glut; the pbuffer has
+ * the size given by S2PLOT_WIDTH and S2PLOT_HEIGHT.  Every frame drawn
+ * is recorded (0000.tga, 0001.tga, ...; see ss2scap), and s2show
+ * exits after S2PLOT_FRAMES frames (or at S2PLOT_RUNTIME).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "s2opengl.h"
+#include "s2types.h"
+#include "s2win.h"
+#include "s2const.h"
+
+void CleanExit(void);
+void _s2debug(char *fn, char *messg, ...);
+void _s2error(char *fn, char *messg, ...);
+
+OPTIONS *_s2o_options;
+
+#define moptions (*_s2o_options)
+
+static EGLDisplay _s2o_display = EGL_NO_DISPLAY;
+static EGLSurface _s2o_surface = EGL_NO_SURFACE;
+static EGLContext _s2o_context = EGL_NO_CONTEXT;
+static int _s2o_width, _s2o_height;
+
+/* display callback, and the number of frames s2show draws (0: until
+ * S2PLOT_RUNTIME, or forever) */
+static void (*_s2o_displayfn)(void) = NULL;
+static int _s2o_nframes;
+
+/* find a display that needs no window system: Mesa's surfaceless
+ * platform if there is one, else the default display */
+static EGLDisplay _s2o_getDisplay(void) {
+  EGLDisplay dpy = EGL_NO_DISPLAY;
+#if defined(EGL_PLATFORM_SURFACELESS_MESA)
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = 
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+    eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if (getPlatformDisplay) {
+    dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, 
+			     EGL_DEFAULT_DISPLAY, NULL);
+  }
+#endif
+  if (dpy == EGL_NO_DISPLAY) {
+    dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+  return dpy;
+}
+
+static void init_s2offscreen(int *argc, char **argv) {
+  EGLint major, minor;
+  _s2o_display = _s2o_getDisplay();
+  if ((_s2o_display == EGL_NO_DISPLAY) || 
+      !eglInitialize(_s2o_display, &major, &minor)) {
+    _s2error("(internal)", "/S2OFFSCR: cannot initialise EGL");
+  }
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    _s2error("(internal)", "/S2OFFSCR: EGL has no desktop OpenGL");
+  }
+  _s2debug("(internal)", "/S2OFFSCR using EGL %d.%d (%s)", major, minor,
+	   eglQueryString(_s2o_display, EGL_VENDOR));
+}
+
+static void createwindow_s2offscreen(char *title, int w, int h) {
+  EGLint cfgattr[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		      EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, 
+		      EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+		      EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8,
+		      EGL_NONE};
+  EGLint pbattr[] = {EGL_WIDTH, w, EGL_HEIGHT, h, EGL_NONE};
+  EGLConfig config;
+  EGLint nconfig = 0;
+
+  if (!eglChooseConfig(_s2o_display, cfgattr, &config, 1, &nconfig) ||
+      (nconfig < 1)) {
+    _s2error("(internal)", "/S2OFFSCR: no RGBA pbuffer configuration");
+  }
+  _s2o_context = eglCreateContext(_s2o_display, config, EGL_NO_CONTEXT,
+				  NULL);
+  if (_s2o_context == EGL_NO_CONTEXT) {
+    _s2error("(internal)", "/S2OFFSCR: cannot create OpenGL context");
+  }
+  _s2o_surface = eglCreatePbufferSurface(_s2o_display, config, pbattr);
+  if (_s2o_surface == EGL_NO_SURFACE) {
+    _s2error("(internal)", "/S2OFFSCR: cannot create %d x %d pbuffer",
+	     w, h);
+  }
+  if (!eglMakeCurrent(_s2o_display, _s2o_surface, _s2o_surface, 
+		      _s2o_context)) {
+    _s2error("(internal)", "/S2OFFSCR: cannot make context current");
+  }
+  _s2o_width = w;
+  _s2o_height = h;
+  glViewport(0, 0, w, h);
+  _s2debug("(internal)", "/S2OFFSCR rendering %d x %d with %s", w, h,
+	   (char *)glGetString(GL_RENDERER));
+}
+
+static void displayfunc_s2offscreen(void (*func)(void)) {
+  _s2o_displayfn = func;
+}
+
+/* s2show: draw the frames then quit, as though the user had */
+static void mainloop_s2offscreen(void) {
+  int i;
+  for (i = 0; (_s2o_nframes <= 0) || (i < _s2o_nframes); i++) {
+    if (_s2o_displayfn) {
+      _s2o_displayfn();
+    }
+  }
+  CleanExit();
+}
+
+static int get_s2offscreen(int which) {
+  switch(which) {
+  case S2_SCREEN_WIDTH:
+  case S2_WINDOW_WIDTH:
+    return _s2o_width;
+  case S2_SCREEN_HEIGHT:
+  case S2_WINDOW_HEIGHT:
+    return _s2o_height;
+  default:
+    return 0;
+  }
+}
+
+static void swapbuffers_s2offscreen(void) {
+  /* nothing to show: recorded frames are read back by s2capture.c */
+  glFlush();
+}
+
+static void destroywindow_s2offscreen(void) {
+  if (_s2o_display == EGL_NO_DISPLAY) {
+    return;
+  }
+  eglMakeCurrent(_s2o_display, EGL_NO_SURFACE, EGL_NO_SURFACE, 
+		 EGL_NO_CONTEXT);
+  if (_s2o_surface != EGL_NO_SURFACE) {
+    eglDestroySurface(_s2o_display, _s2o_surface);
+  }
+  if (_s2o_context != EGL_NO_CONTEXT) {
+    eglDestroyContext(_s2o_display, _s2o_context);
+  }
+  eglTerminate(_s2o_display);
+  _s2o_display = EGL_NO_DISPLAY;
+}
+
+static S2WINSYS _s2o_winsys = {init_s2offscreen, mainloop_s2offscreen,
+			       createwindow_s2offscreen, 
+			       displayfunc_s2offscreen,
+			       get_s2offscreen, swapbuffers_s2offscreen,
+			       destroywindow_s2offscreen};
+
+void prep_s2offscreen(OPTIONS *ioptions) {
+  _s2o_options = ioptions;
+
+  /* record every frame */
+  moptions.recordimages = TRUE;
+
+  /* how many frames s2show draws: one, unless S2PLOT_RUNTIME is to 
+   * end the program */
+  _s2o_nframes = getenv("S2PLOT_RUNTIME") ? 0 : 1;
+  char *s2frames = getenv("S2PLOT_FRAMES");
+  if (s2frames) {
+    _s2o_nframes = atoi(s2frames);
+  }
+  _s2debug("(internal)", "/S2OFFSCR device support loaded");
+}
+
+S2WINSYS *winsys_s2offscreen(void) {
+  return &_s2o_winsys;
+}
+
+void resize_s2offscreen(void) {
+  // do nothing!
+}
+
+int keybd_s2offscreen(char c) {
+  int consumed = 0;
+  return consumed;
+}
+
+void draw_s2offscreen(CAMERA cam) {
+  /* not called: the offscreen device draws through the ordinary
+   * single-screen mono path in HandleDisplay */
+}
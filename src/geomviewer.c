@@ -51,6 +51,15 @@
 #endif
 #endif
 
+/* stage timers of the frame profile (see s2prof.c), kept by S2PLOT */
+#if defined(BUILDING_S2PLOT)
+#define _S2PROFSTART(t) ((t) = _s2priv_profStart())
+#define _S2PROFSTOP(stage, t, n, b) _s2priv_profStop((stage), (t), (n), (b))
+#else
+#define _S2PROFSTART(t)
+#define _S2PROFSTOP(stage, t, n, b)
+#endif
+
 // not sure if this breaks anything: it shouldn't!
 #define WINWIDTH (options.screenwidth)
 #define WINHEIGHT (options.screenheight)
@@ -72,148 +81,6 @@ int(*_device_keybd)(char);
 #define S2MPI_PORT_OFFSET_SCALE 100
 #endif
 
-#if defined(S2OPENMP) && !defined(BUILDING_VIEWER)
-//#define POINTER_SORT 1
-#include <omp.h>
-// mQsortMT algorithm/code from http://softwarecommunity.intel.com/articles/eng/2422.htm
-// Rajiv Parikh
-#if defined(POINTER_SORT)
-int bbptrcomp(const void *, const void *);
-#define QST _S2BBOARD
-#define QSTcomp bbptrcomp
-void mQsortMTptr(QST **data, int N) {
-  QST **a, **b, **c;
-  int i, amax, bmax, j, k;
-  amax = N/2; 
-  bmax = N-amax; 
-  a = data;
-  b = data+amax;
-
-  // sort two halves
-#pragma omp parallel sections
-  {
-#pragma omp section
-    qsort(a, amax, sizeof(QST *), QSTcomp);
-#pragma omp section
-    qsort(b, bmax, sizeof(QST *), QSTcomp);
-  }
-
-  // merge
-  i = amax - 1;
-  j = N - 1;
-  if (((a[amax-1]))->dist > ((b[0]))->dist) {
-    c = (QST **)malloc((bmax)*sizeof(QST *));
-    for (k = 0; k < bmax; k++) {
-      c[k] = b[k];
-    }
-    k = bmax - 1;
-    while ((i >= 0) && (k >= 0)) {
-      if (((a[i]))->dist>=((c[k]))->dist) {
-	data[j--] = a[i--];
-      } else {
-	data[j--] = c[k--];
-      }
-    }
-    while (k>=0) {
-      data[j--] = c[k--];
-    }
-    free(c);
-  }
-}
-
-#else
-
-int bboardcomp(const void *, const void *);
-#define QST _S2BBOARD
-#define QSTcomp bboardcomp
-void mQsortMT(QST* data, int N) {
-  QST *a,*b,*c;
-  int i, amax, bmax, j, k;
-  amax = N/2; 
-  bmax = N-amax; 
-  a = data;
-  b = data+amax;
-
-  // sort two halves
-#pragma omp parallel sections
-  {
-#pragma omp section
-    //QsortST(a,amax);
-    qsort(a, amax, sizeof(QST), QSTcomp);
-#pragma omp section
-    //QsortST(b,bmax);
-    qsort(b, bmax, sizeof(QST), QSTcomp);
-  }
-
-  // merge
-  i = amax - 1;
-  j = N - 1;
-  if (a[amax-1].dist > b[0].dist) {
-    c = (QST *)malloc((bmax)*sizeof(QST));
-    for (k = 0; k < bmax; k++) {
-      c[k] = b[k];
-    }
-    k = bmax - 1;
-    while ((i >= 0) && (k >= 0)) {
-      if (a[i].dist>=c[k].dist) {
-	data[j--] = a[i--];
-      } else {
-	data[j--] = c[k--];
-      }
-    }
-    while (k>=0) {
-      data[j--] = c[k--];
-    }
-    free(c);
-  }
-}
-
-
-int handlecomp(const void *, const void *);
-#define QSTh _S2HANDLE
-#define QSThcomp handlecomp
-void mQsortMTh(QSTh* data, int N) {
-  QSTh *a,*b,*c;
-  int i, amax, bmax, j, k;
-  amax = N/2; 
-  bmax = N-amax; 
-  a = data;
-  b = data+amax;
-
-  // sort two halves
-#pragma omp parallel sections
-  {
-#pragma omp section
-    qsort(a, amax, sizeof(QSTh), QSThcomp);
-#pragma omp section
-    qsort(b, bmax, sizeof(QSTh), QSThcomp);
-  }
-
-  // merge
-  i = amax - 1;
-  j = N - 1;
-  if (a[amax-1].dist > b[0].dist) {
-    c = (QSTh *)malloc((bmax)*sizeof(QSTh));
-    for (k = 0; k < bmax; k++) {
-      c[k] = b[k];
-    }
-    k = bmax - 1;
-    while ((i >= 0) && (k >= 0)) {
-      if (a[i].dist>=c[k].dist) {
-	data[j--] = a[i--];
-      } else {
-	data[j--] = c[k--];
-      }
-    }
-    while (k>=0) {
-      data[j--] = c[k--];
-    }
-    free(c);
-  }
-}
-#endif
-#endif
-
 #include "hiddenMouseCursor.h"
 
 //#if defined(S2_USE_GLFLOAT)
@@ -509,6 +376,10 @@ int main(int argc,char **argv) {
   }
   _s2_ctext_count = 0;
   _s2_ctext = NULL;
+  _s2_ctext_alloc = 0;
+  _s2_ctext_bytes = 0;
+  _s2_texreg_byid = _s2_texreg_byname = NULL;
+  _s2_texreg_nslot = 0;
 
   
   CreateOpenGL();
@@ -764,6 +635,14 @@ void HandleDisplay(void) {
   if (tbegin < 0.) {
     tbegin = tm; /* GetRunTime(); */
   }
+
+#if defined(BUILDING_S2PLOT)
+  /* start this frame's slot in the frame profile (ss2tprof) */
+  _s2priv_profFrame(tm);
+
+  /* install textures finished by the background loader (ss2lta) */
+  _s2priv_texLoadApply();
+#endif
   
   if (_device_resize) {
     int curwiny = s2winGet(S2_WINDOW_Y);
@@ -950,6 +829,7 @@ void HandleDisplay(void) {
 
     /* update the dynamic geometry lists for this panel */
     if ((_s2_callback || _s2_callbackx) && _s2_animation) {
+      double tprof = _s2priv_profStart();
       _s2_startDynamicGeometry(_s2_dynamic_erase /* TRUE */);
       // erase screen geom:
       _s2_startScreenGeometry(_s2_dynamic_erase /* TRUE */);
@@ -961,15 +841,23 @@ void HandleDisplay(void) {
 	_s2_callback(&tm, &_s2_callbackkey);
       }
       _s2_endDynamicGeometry();
+      _s2priv_profStop(_S2PROF_CALLBACK, tprof, 1, 0);
     }
 
     /* set the camera if there is an explicitly set position */
     if (_s2_cameraset) {
       _s2priv_CameraSet();
     }
+
+    /* note whether the view has moved since the last frame: static
+     * dot clouds are drawn at reduced detail while it does (ss2tlod) */
+    _s2priv_lodMotion(&(_s2_panels[spid]));
     
   }
   xs2cp(waspanel);
+
+  /* the rest of the frame is timed as drawing */
+  double tprofdraw = _s2priv_profStart();
   
 #endif 
   
@@ -1123,12 +1011,24 @@ void HandleDisplay(void) {
     options.windowdump = 0;
   }
   
+#if defined(BUILDING_S2PLOT)
+  /* collect frames read back last time, and start on this one if it
+   * is to be recorded too */
+  double tprofcap = _s2priv_profStart();
+  _s2priv_capHarvest();
+#endif
+
   // Are we recording images? 
   if (options.recordimages || options.windowdump == 1) {
+#if defined(BUILDING_S2PLOT)
+    _s2priv_capFrame("", options.screenwidth, options.screenheight,
+		     options.stereo == ACTIVESTEREO);
+#else
     if (options.stereo == ACTIVESTEREO)
       WindowDump("",options.screenwidth,options.screenheight,TRUE,12);
     else
       WindowDump("",options.screenwidth,options.screenheight,FALSE,12);
+#endif
     options.windowdump = 0;
   }
   
@@ -1213,13 +1113,9 @@ void HandleDisplay(void) {
       
       /* and save the image if desired */
       if (_s2_recstate >= 2) {
-	if (options.stereo == ACTIVESTEREO) {
-	  WindowDump(framestr, options.screenwidth, options.screenheight, 
-		     TRUE, 12);
-	} else {
-	  WindowDump(framestr, options.screenwidth, options.screenheight,
-		     FALSE, 12);
-	}
+	_s2priv_capFrame(framestr, options.screenwidth, 
+			 options.screenheight, 
+			 options.stereo == ACTIVESTEREO);
       }
     
       /* increment frame counter */
@@ -1230,14 +1126,19 @@ void HandleDisplay(void) {
       }
     }
   }
+  _s2priv_profStop(_S2PROF_CAPTURE, tprofcap, 1, 0);
 #endif
   
 #if defined(BUILDING_S2PLOT)
   if (_s2_bufswap) {
+    double tprof = _s2priv_profStart();
 #endif
     s2winSwapBuffers();
 #if defined(BUILDING_S2PLOT)
+    _s2priv_profStop(_S2PROF_SWAP, tprof, 1, 0);
   }
+  _s2priv_profStop(_S2PROF_DRAW, tprofdraw, 1, 0);
+  _s2priv_govFrame(tm);
 #endif
 
   /* 
@@ -1270,20 +1171,24 @@ void HandleDisplay(void) {
       geometry).
    Otherwise draw immediately,
 */
+/* vertex batches for geometry that is not retained (see s2batch.c) */
+static _S2BATCHLIST _s2x_scratchbatch;
+#if defined(BUILDING_S2PLOT)
+/* transparent facets and points, packed for each view */
+static _S2BATCHLIST _s2x_transbatch;
+#endif
+
 void MakeGeometry(int doupdate, int doscreen, int eye) {
 
   int i,j;
-  XYZ linelist[300*MAXLABELLEN];
   XYZ normal;
   COLOUR white = {1,1,1};
-  int nlinelist = 0;
 #if !defined(BUILDING_S2PLOT)
   int objectid = 1;
 #endif
-  int oldsize = 1;
+  _S2BATCHLIST *bl = &_s2x_scratchbatch;
 #if defined(BUILDING_S2PLOT)
-  int oldstipplefactor = 0;
-  unsigned short oldstipplepattern = 0xFFFF;
+  double tprof; /* for the frame profile's stage timers */
 #endif
 #if !defined(BUILDING_S2PLOT)
   static int listindex = -1;
@@ -1374,12 +1279,53 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
   XYZ vt, vtn;
 #endif
   /* end projections needed for screen coordinate drawing */
+
+  /* world and screen geometry is packed into the panel's retained
+   * (static) or streamed (dynamic) vertex buffers and only re-packed
+   * when it changes, so every eye and screen replays the same batches;
+   * static world geometry is packed by place, so that each view only
+   * draws the batches in its frustum (see s2cull.c) */
+#if defined(BUILDING_S2PLOT)
+  if (_s2_dynamicEnabled) {
+    bl = &(_s2_panels[_s2_activepanel].GL_dynamic);
+  } else if (_s2_retain_lists) {
+    bl = &(_s2_panels[_s2_activepanel].GL_static);
+    if (doupdate) {
+      bl->dirty = 1;
+    }
+  }
+  if (bl == &_s2x_scratchbatch) {
+    _S2PROFSTART(tprof);
+    _s2priv_packBatches(bl, 0);
+    _S2PROFSTOP(_S2PROF_PACK, tprof, bl->nvtx, 
+		bl->nvtx * sizeof(_S2BATCHVTX));
+  } else if (bl->dirty) {
+    _S2PROFSTART(tprof);
+    _s2priv_packBatches(bl, !_s2_dynamicEnabled);
+    _s2priv_uploadBatches(bl);
+    _S2PROFSTOP(_S2PROF_PACK, tprof, bl->nvtx, 
+		bl->nvtx * sizeof(_S2BATCHVTX));
+  }
+#else
+  _s2priv_packBatches(bl, 0);
+#endif
   
   // Are the objects transparent? 
   if (transparency < 1)
     glDepthMask(GL_FALSE);
   
-  // Balls 
+  // Balls: instances of the cached unit sphere, scaled by their
+  // radius, so their normals need renormalising.  The frame-time
+  // governor may ask for coarser spheres (and planets) while moving.
+#if defined(BUILDING_S2PLOT)
+  int sphereres = _s2priv_govern(_S2GOV_SPHERE, options.sphereresolution);
+#else
+  int sphereres = options.sphereresolution;
+#endif
+  _S2PROFSTART(tprof);
+  if (nball) {
+    glEnable(GL_NORMALIZE);
+  }
   for (i=0;i<nball;i++) {
 #if !defined(BUILDING_S2PLOT)
     glLoadName(objectid++);
@@ -1388,21 +1334,25 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
 
 #if defined(BUILDING_S2PLOT)
     if (doscreen) {
-      if (strlen(_s2_doingScreen) && 
-	  strstr(ball[i].whichscreen, _s2_doingScreen)) {
+      if (_S2ONSCREEN(ball[i].whichscreen)) {
 	// screen geometry
 	s2UnProject(view[0] + view[2] * ball[i].p.x + 0.5, 
 		     view[1] + view[3] * ball[i].p.y + 0.5, 
 		     ball[i].p.z, 
 		     model, proj, view, &vt.x, &vt.y, &vt.z);
-	CreateASphere(vt, ball[i].r, options.sphereresolution, 1,1);
+	DrawSphereInstance(vt, ball[i].r, sphereres);
       }
-    } else if (!strlen(ball[i].whichscreen))
+    } else if (!ball[i].whichscreen)
 #endif
-    CreateASphere(ball[i].p,ball[i].r,options.sphereresolution,1,1);
+    DrawSphereInstance(ball[i].p,ball[i].r,sphereres);
+  }
+  if (nball) {
+    glDisable(GL_NORMALIZE);
   }
+  _S2PROFSTOP(_S2PROF_BALL, tprof, nball, 0);
   
   // Disks 
+  _S2PROFSTART(tprof);
   for (i=0;i<ndisk;i++) {
 #if !defined(BUILDING_S2PLOT)
     glLoadName(objectid++);
@@ -1411,8 +1361,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
 
 #if defined(BUILDING_S2PLOT)
     if (doscreen) {
-      if (strlen(_s2_doingScreen) &&
-	  strstr(disk[i].whichscreen, _s2_doingScreen)) {
+      if (_S2ONSCREEN(disk[i].whichscreen)) {
 	// screen geometry
 	s2UnProject(view[0] + view[2] * disk[i].p.x + 0.5, 
 		     view[1] + view[3] * disk[i].p.y + 0.5, 
@@ -1440,15 +1389,17 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
 	dor2 = sqrt((vtmp.x - vt.x)*(vtmp.x - vt.x) +
 		    (vtmp.y - vt.y)*(vtmp.y - vt.y));
 
-	CreateDisk(vt, vtn, dor2, dor1, 32, 0.0, TWOPI);
+	DrawDiskInstance(vt, vtn, dor2, dor1, 32);
       }
-    } else if (!strlen(disk[i].whichscreen))
+    } else if (!disk[i].whichscreen)
 #endif
-    CreateDisk(disk[i].p,disk[i].n,disk[i].r2,disk[i].r1,32,0.0,TWOPI);
+    DrawDiskInstance(disk[i].p,disk[i].n,disk[i].r2,disk[i].r1,32);
   }
+  _S2PROFSTOP(_S2PROF_DISK, tprof, ndisk, 0);
   
 
   // Cones 
+  _S2PROFSTART(tprof);
   for (i=0;i<ncone;i++) {
 #if !defined(BUILDING_S2PLOT)
     glLoadName(objectid++);
@@ -1457,8 +1408,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
 
 #if defined(BUILDING_S2PLOT)
     if (doscreen) {
-      if (strlen(_s2_doingScreen) && 
-	  strstr(cone[i].whichscreen, _s2_doingScreen)) {
+      if (_S2ONSCREEN(cone[i].whichscreen)) {
 	// screen geometry
 	s2UnProject(view[0] + view[2] * cone[i].p2.x + 0.5, 
 		     view[1] + view[3] * cone[i].p2.y + 0.5, 
@@ -1468,323 +1418,33 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
 		     view[1] + view[3] * cone[i].p1.y + 0.5, 
 		     cone[i].p1.z, 
 		     model, proj, view, &vtn.x, &vtn.y, &vtn.z);
-	CreateCone(vt, vtn, cone[i].r2, cone[i].r1, 32, 0.0, TWOPI);
+	DrawConeInstance(vt, vtn, cone[i].r2, cone[i].r1, 32);
       }
-    } else if (!strlen(cone[i].whichscreen))
+    } else if (!cone[i].whichscreen)
 #endif
-    CreateCone(cone[i].p2,cone[i].p1,cone[i].r2,cone[i].r1,32,0.0,TWOPI);
+    DrawConeInstance(cone[i].p2,cone[i].p1,cone[i].r2,cone[i].r1,32);
   }
+  _S2PROFSTOP(_S2PROF_CONE, tprof, ncone, 0);
 
-  // 3 vertex faces 
-  if (nface3 > 0) {
-
-#if defined(S2USEARRAYS)
-    
-    GLfloat *_f3_vertices = (GLfloat *)malloc(nface3 * 3 * 3 * sizeof(GLfloat));
-    GLfloat *_f3_normals = (GLfloat *)malloc(nface3 * 3 * 3 * sizeof(GLfloat));
-    GLfloat *_f3_colours = (GLfloat *)malloc(nface3 * 3 * 4 * sizeof(GLfloat));
-
-    int nf3 = 0;
-    for (i=0;i<nface3;i++) {
+  // Facets: packed vertex batches, drawn lit
+  _S2PROFSTART(tprof);
 #if defined(BUILDING_S2PLOT)
-      if (doscreen) {
-	if (strlen(_s2_doingScreen) &&
-	    strstr(face3[i].whichscreen, _s2_doingScreen)) {
-	  // screen geometry
-	  for (j = 0; j < 3; j++) {
-	    s2UnProject(view[0] + view[2] * face3[i].p[j].x + 0.5, 
-			view[1] + view[3] * face3[i].p[j].y + 0.5, 
-			face3[i].p[j].z, 
-			model, proj, view, &vtx, &vty, &vtz);
-	    _f3_colours[nf3 * 3 * 4 + j * 4 + 0] = face3[i].colour[j].r;
-	    _f3_colours[nf3 * 3 * 4 + j * 4 + 1] = face3[i].colour[j].g;
-	    _f3_colours[nf3 * 3 * 4 + j * 4 + 2] = face3[i].colour[j].b;
-	    _f3_colours[nf3 * 3 * 4 + j * 4 + 3] = transparency;
-	    _f3_vertices[nf3 * 3 * 3 + j * 3 + 0] = vtx;
-	    _f3_vertices[nf3 * 3 * 3 + j * 3 + 1] = vty;
-	    _f3_vertices[nf3 * 3 * 3 + j * 3 + 2] = vtz;
-	    _f3_normals[nf3 * 3 * 3 + j * 3 + 0] = 0.;
-	    _f3_normals[nf3 * 3 * 3 + j * 3 + 1] = 0.;
-	    _f3_normals[nf3 * 3 * 3 + j * 3 + 2] = -1.;	    
-	  }
-	  nf3++;
-	}
-      } else if (!strlen(face3[i].whichscreen)) 
-#endif
-	{
-	  for (j=0;j<3;j++) {
-	    //glNormal3f(face3[i].n[j].x,face3[i].n[j].y,face3[i].n[j].z);
-	    _f3_colours[nf3 * 3 * 4 + j * 4 + 0] = face3[i].colour[j].r;
-	    _f3_colours[nf3 * 3 * 4 + j * 4 + 1] = face3[i].colour[j].g;
-	    _f3_colours[nf3 * 3 * 4 + j * 4 + 2] = face3[i].colour[j].b;
-	    _f3_colours[nf3 * 3 * 4 + j * 4 + 3] = transparency;
-	    _f3_vertices[nf3 * 3 * 3 + j * 3 + 0] = face3[i].p[j].x;
-	    _f3_vertices[nf3 * 3 * 3 + j * 3 + 1] = face3[i].p[j].y;
-	    _f3_vertices[nf3 * 3 * 3 + j * 3 + 2] = face3[i].p[j].z;
-	    _f3_normals[nf3 * 3 * 3 + j * 3 + 0] = face3[i].n[j].x;
-	    _f3_normals[nf3 * 3 * 3 + j * 3 + 1] = face3[i].n[j].y;
-	    _f3_normals[nf3 * 3 * 3 + j * 3 + 2] = face3[i].n[j].z;
-	  }
-	  nf3++;
-	}
-    }
-    
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glEnableClientState(GL_NORMAL_ARRAY);
-    glEnableClientState(GL_COLOR_ARRAY);
-    glVertexPointer(3, GL_FLOAT, 0, _f3_vertices);
-    glNormalPointer(GL_FLOAT, 0, _f3_normals);
-    glColorPointer(4, GL_FLOAT, 0, _f3_colours);
-    glDrawArrays(GL_TRIANGLES, 0, nf3*3);
-    glDisableClientState(GL_COLOR_ARRAY);
-    glDisableClientState(GL_NORMAL_ARRAY);
-    glDisableClientState(GL_VERTEX_ARRAY);
-    free(_f3_colours);
-    free(_f3_normals);
-    free(_f3_vertices);
-
-#else  
-
-    glBegin(GL_TRIANGLES);
-    for (i=0;i<nface3;i++) {
-#if defined(BUILDING_S2PLOT)
-      if (doscreen) {
-	if (strlen(_s2_doingScreen) &&
-	    strstr(face3[i].whichscreen, _s2_doingScreen)) {
-	  // screen geometry
-	  for (j = 0; j < 3; j++) {
-	    s2UnProject(view[0] + view[2] * face3[i].p[j].x + 0.5, 
-			 view[1] + view[3] * face3[i].p[j].y + 0.5, 
-			 face3[i].p[j].z, 
-			 model, proj, view, &vtx, &vty, &vtz);
-	    _glColor4f(face3[i].colour[j].r, 
-			      face3[i].colour[j].g,
-			      face3[i].colour[j].b, transparency);
-	    glVertex3f(vtx, vty, vtz);
-	  }
-	}
-      } else if (!strlen(face3[i].whichscreen)) 
-#endif
-	{
-	  for (j=0;j<3;j++) {
-	    glNormal3f(face3[i].n[j].x,face3[i].n[j].y,face3[i].n[j].z);
-	    _glColor4f(face3[i].colour[j].r,face3[i].colour[j].g,face3[i].colour[j].b,transparency);
-	    glVertex3f(face3[i].p[j].x,face3[i].p[j].y,face3[i].p[j].z);
-	  }
-	}
-    }
-    glEnd();
-
-#endif // #if defined(S2USEARRAYS)
-
-  }
-  
-  // 4 vertex faces 
-  if (nface4 > 0) {
-    glBegin(GL_QUADS);
-    for (i=0;i<nface4;i++) {
-#if defined(BUILDING_S2PLOT)
-      if (doscreen) {
-	if (strlen(_s2_doingScreen) && 
-	    strstr(face4[i].whichscreen, _s2_doingScreen)) {
-	  // screen geometry
-	  for (j = 0; j < 4; j++) {
-	    s2UnProject(view[0] + view[2] * face4[i].p[j].x + 0.5, 
-			 view[1] + view[3] * face4[i].p[j].y + 0.5, 
-			 face4[i].p[j].z, 
-			 model, proj, view, &vtx, &vty, &vtz);
-	    _glColor4f(face4[i].colour[j].r, 
-			      face4[i].colour[j].g,
-			      face4[i].colour[j].b, transparency);
-	    glVertex3f(vtx, vty, vtz);
-	  }
-	}
-      } else if (!strlen(face4[i].whichscreen))
+  _s2priv_drawBatches(bl, 1, doscreen ? view : NULL);
+#else
+  _s2priv_drawBatches(bl, 1, NULL);
 #endif
-	{
-	  // normal 3d geometry
-	  for (j=0;j<4;j++) {
-	    glNormal3f(face4[i].n[j].x,face4[i].n[j].y,face4[i].n[j].z);
-	    _glColor4f(face4[i].colour[j].r,face4[i].colour[j].g,face4[i].colour[j].b,transparency);
-	    glVertex3f(face4[i].p[j].x,face4[i].p[j].y,face4[i].p[j].z);
-	  }
-	}
-      
-    }
-    glEnd();
-  }
-  
 
   // Turn of lighting for the points and lines 
   glDisable(GL_LIGHTING);
   
-  // Labels 
-  for (i=0;i<nlabel;i++) {
-    CreateLabelVector(label[i].s,label[i].p,label[i].right,label[i].up,linelist,&nlinelist);
-    _glColor4f(label[i].colour.r,label[i].colour.g,label[i].colour.b,transparency);
-
-#if defined(BUILDING_S2PLOT)
-    if (doscreen) {
-      if (strlen(_s2_doingScreen) && 
-	  strstr(label[i].whichscreen, _s2_doingScreen)) {
-	for (j = 0; j < nlinelist; j += 2) {
-	  glBegin(GL_LINES);
-	  s2UnProject(view[0] + view[2] * linelist[j].x + 0.5, 
-		       view[1] + view[3] * linelist[j].y + 0.5,
-		       linelist[j].z,
-		       model, proj, view, &vtx, &vty, &vtz);
-	  glVertex3f(vtx, vty, vtz);
-	  s2UnProject(view[0] + view[2] * linelist[j+1].x + 0.5, 
-		       view[1] + view[3] * linelist[j+1].y + 0.5,
-		       linelist[j+1].z,
-		       model, proj, view, &vtx, &vty, &vtz);	  
-	  glVertex3f(vtx, vty, vtz);
-	  glEnd();
-	}
-      }
-    } else if (!strlen(label[i].whichscreen)) {
-#endif 
-      for (j=0;j<nlinelist;j+=2) {
-	glBegin(GL_LINES);
-	glVertex3f(linelist[j].x,linelist[j].y,linelist[j].z);
-	glVertex3f(linelist[j+1].x,linelist[j+1].y,linelist[j+1].z);
-	glEnd();
-      }
-#if defined(BUILDING_S2PLOT)
-    }
-#endif
-  }
-  
-  // Points 
-  if (ndot > 0) {
-    oldsize = dot[0].size;
-#if defined(BUILDING_VIEWER)
-    if (options.stereo == INTERSTEREO) {
-      glPointSize(options.pointscale*oldsize<2. ? 2. : options.pointscale*oldsize);
-    } else {
-      glPointSize(options.pointscale*oldsize);
-    }
-#else
-    glPointSize(options.pointscale*oldsize);
-#endif
-    glBegin(GL_POINTS);
-    for (i=0;i<ndot;i++) {
-      if (oldsize != dot[i].size) {
-	glEnd();
-	oldsize = dot[i].size;
-#if defined(BUILDING_VIEWER)
-    if (options.stereo == INTERSTEREO) {
-      glPointSize(options.pointscale*oldsize<2. ? 2. : options.pointscale*oldsize);
-    } else {
-      glPointSize(options.pointscale*oldsize);
-    }
-#else
-    glPointSize(options.pointscale*oldsize);
-#endif
-	glBegin(GL_POINTS);
-      }
-      _glColor4f(dot[i].colour.r,dot[i].colour.g,dot[i].colour.b,transparency);
-
-#if defined(BUILDING_S2PLOT)
-      if (doscreen) {
-	if (strlen(_s2_doingScreen) && 
-	    strstr(dot[i].whichscreen, _s2_doingScreen)) {
-	  s2UnProject(view[0] + view[2] * dot[i].p.x, 
-		       view[1] + view[3] * dot[i].p.y, 
-		       dot[i].p.z, 
-		       model, proj, view, &vtx, &vty, &vtz);
-	  glVertex3f(vtx, vty, vtz);
-	}
-      } else if (!strlen(dot[i].whichscreen))
-#endif
-	{
-	  glVertex3f(dot[i].p.x,dot[i].p.y,dot[i].p.z);
-	}
-    }
-    glEnd();
-    glPointSize(options.pointscale);
-  }
-  
-  // Lines 
-  if (nline > 0) {
-
-    // addition DGB 20140423 to support transparent lines
-    // NB this implementation of transparency is a hack without proper sorting, 
-    // and only additive transparency (= result approaches 1.0)
-#if defined(BUILDING_S2PLOT)
-    // and TURN OFF AS THIS IS BUGGY DGB 20170404
-    //glEnable(GL_BLEND);
-    //glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-#endif
-
-    //oldsize = line[0].width;
-    oldsize = line[0].width - 3; // make it NOT equal line[0].width
-    //glLineWidth(options.linescale*oldsize);
-    glBegin(GL_LINES);
-    for (i=0;i<nline;i++) {
-#if defined(BUILDING_S2PLOT)
-      if (oldsize != line[i].width || 
-	  oldstipplefactor != line[i].stipple_factor ||
-	  oldstipplepattern != line[i].stipple_pattern) {
-#else 
-      if (oldsize != line[i].width) {
-#endif
-	glEnd();
-	oldsize = line[i].width;
-	glLineWidth(options.linescale*oldsize);
+  // Labels, points and lines: packed vertex batches, drawn unlit
 #if defined(BUILDING_S2PLOT)
-	oldstipplefactor = line[i].stipple_factor;
-	oldstipplepattern = line[i].stipple_pattern;
-	if (oldstipplefactor > 0) {
-	  glLineStipple(oldstipplefactor, oldstipplepattern);
-	  glEnable(GL_LINE_STIPPLE);
-	} else {
-	  glDisable(GL_LINE_STIPPLE);
-	}
-#endif
-	glBegin(GL_LINES);
-      }
-#if defined(BUILDING_S2PLOT)
-      if (doscreen) {
-	if (strlen(_s2_doingScreen) && 
-	    strstr(line[i].whichscreen, _s2_doingScreen)) {
-	  for (j = 0; j < 2; j++) {
-	    s2UnProject(view[0] + view[2] * line[i].p[j].x + 0.5, 
-			 view[1] + view[3] * line[i].p[j].y + 0.5, 
-			 line[i].p[j].z, 
-			 model, proj, view, &vtx, &vty, &vtz);
-	    _glColor4f(line[i].colour[j].r, 
-			      line[i].colour[j].g,
-		       line[i].colour[j].b, line[i].alpha /*transparency*/);
-	    glVertex3f(vtx, vty, vtz);
-	  }		
-	} 
-      } else if (!strlen(line[i].whichscreen)) 
-#endif
-	{
-	  for (j=0;j<2;j++) {
-#if defined(BUILDING_S2PLOT) 
-	    if (line[i].alpha < 0.999) {
-	      glEnable(GL_BLEND);
-	    } else {
-	      glDisable(GL_BLEND);
-	    }
-	    _glColor4f(line[i].colour[j].r,line[i].colour[j].g,line[i].colour[j].b,line[i].alpha /*transparency*/);
-
+  _s2priv_drawBatches(bl, 0, doscreen ? view : NULL);
 #else
-	    _glColor4f(line[i].colour[j].r,line[i].colour[j].g,line[i].colour[j].b,transparency);
+  _s2priv_drawBatches(bl, 0, NULL);
 #endif
-	    glVertex3f(line[i].p[j].x,line[i].p[j].y,line[i].p[j].z);
-	  }
-	}
-    }  
-    glEnd();
-    glLineWidth(options.linescale);
+  _S2PROFSTOP(_S2PROF_BATCH, tprof, bl->nbatch, 0);
 
-#if defined(BUILDING_S2PLOT)
-    glDisable(GL_BLEND);
-#endif
-  }
 #if defined(BUILDING_S2PLOT)
   glDisable(GL_LINE_STIPPLE);
 #endif  
@@ -1803,6 +1463,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
     glEnable(GL_LIGHTING);
   
   // Textured balls
+  _S2PROFSTART(tprof);
   for (i=0;i<nballt;i++) {
     if (options.showtextures && (options.rendermode != WIREFRAME)) {
       glEnable(GL_TEXTURE_2D);
@@ -1812,34 +1473,35 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
 
 #if defined(BUILDING_S2PLOT)
     if (doscreen) {
-      if (strlen(_s2_doingScreen) && 
-	  strstr(ballt[i].whichscreen, _s2_doingScreen)) {
+      if (_S2ONSCREEN(ballt[i].whichscreen)) {
 	// screen geometry
 	s2UnProject(view[0] + view[2] * ballt[i].p.x + 0.5,
 		     view[1] + view[3] * ballt[i].p.y + 0.5, 
 		     ballt[i].p.z, 
 		     model, proj, view, &vt.x, &vt.y, &vt.z);
-	CreateAPlanet(vt, ballt[i].r, options.sphereresolution, 1, 1,
+	CreateAPlanet(vt, ballt[i].r, sphereres, 1, 1,
 		      ballt[i].texture_phase, ballt[i].axis,
 		      ballt[i].rotation);
       }
-    } else if (!strlen(ballt[i].whichscreen))
+    } else if (!ballt[i].whichscreen)
 #endif
 #if defined(BUILDING_S2PLOT)
-      CreateAPlanet(ballt[i].p,ballt[i].r,options.sphereresolution,1,1,
+      CreateAPlanet(ballt[i].p,ballt[i].r,sphereres,1,1,
 		    ballt[i].texture_phase, ballt[i].axis,
 		    ballt[i].rotation);
 #elif defined(BUILDING_VIEWER)
     XYZ defaxis = {0., 1., 0.};
-    CreateAPlanet(ballt[i].p, ballt[i].r, options.sphereresolution, 1, 1,
+    CreateAPlanet(ballt[i].p, ballt[i].r, sphereres, 1, 1,
 		  0., defaxis, 0.);
 #endif
     if (options.showtextures && (options.rendermode != WIREFRAME)) {
       glDisable(GL_TEXTURE_2D);
     }
   }
+  _S2PROFSTOP(_S2PROF_BALLT, tprof, nballt, 0);
 
   // Textured faces
+  _S2PROFSTART(tprof);
 #if defined(BUILDING_S2PLOT)
   // turn on blending with a simple addition blend
   glEnable(GL_BLEND);
@@ -1891,8 +1553,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
       glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
     }      
     if (doscreen) {
-      if (strlen(_s2_doingScreen) && 
-	  strstr(face4t[i].whichscreen, _s2_doingScreen)) {
+      if (_S2ONSCREEN(face4t[i].whichscreen)) {
 	
 	glBegin(GL_QUADS);
 	_glColor4f(face4t[i].colour.r,face4t[i].colour.g,
@@ -1922,7 +1583,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
 		
       }
       
-    } else if (!strlen(face4t[i].whichscreen))
+    } else if (!face4t[i].whichscreen)
      
 #endif
       {
@@ -1950,55 +1611,17 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
     glDisable(GL_TEXTURE_2D);
     glDepthMask(GL_TRUE);
   }
+  _S2PROFSTOP(_S2PROF_FACE4T, tprof, nface4t, 0);
 
 
-  // 3 vertex transparent faces 
+  // 3 vertex transparent faces: packed for this view, along with the
+  // transparent points, with the blended ones sorted back to front
 #if defined(BUILDING_S2PLOT)
-  if (nface3a > 0) {
-    for (i=0;i<nface3a;i++) {
-      if (face3a[i].trans == 't') {
-	glDepthMask(GL_FALSE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-      } else if (face3a[i].trans == 's') {
-	glDepthMask(GL_FALSE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-      } else {
-	glDepthMask(GL_TRUE);
-	glDisable(GL_BLEND);
-      }
-      if (doscreen) {
-	if (strlen(_s2_doingScreen) && 
-	    strstr(face3a[i].whichscreen, _s2_doingScreen)) {
-	  glBegin(GL_TRIANGLES);
-	  for (j = 0; j < 3; j++) {
-	    /* screen z coord in glUnProject: 0.0 = near plane,
-	     * 1.0 = far plane (ie. it's a depth buffer
-	     * coordinate */
-	    s2UnProject(view[0] + view[2] * face3a[i].p[j].x, 
-			 view[1] + view[3] * face3a[i].p[j].y, 
-			 face3a[i].p[j].z, 
-			 model, proj, view, &vtx, &vty, &vtz);
-	    _glColor4f(face3a[i].colour[j].r,
-			      face3a[i].colour[j].g,
-			      face3a[i].colour[j].b,face3a[i].alpha[j]);
-	    glVertex3f(vtx, vty, vtz);
-	  }
-	  glEnd();
-	  
-	}
-      } else if (!strlen(face3a[i].whichscreen)) {
-	glBegin(GL_TRIANGLES);
-	for (j=0;j<3;j++) {
-	  glNormal3f(face3a[i].n[j].x,face3a[i].n[j].y,face3a[i].n[j].z);
-	  _glColor4f(face3a[i].colour[j].r,face3a[i].colour[j].g,face3a[i].colour[j].b,face3a[i].alpha[j]);
-	  glVertex3f(face3a[i].p[j].x,face3a[i].p[j].y,face3a[i].p[j].z);
-	}
-	glEnd();
-      }
-    }
-  }
+  _S2PROFSTART(tprof);
+  _s2priv_packTransparent(&_s2x_transbatch, doscreen);
+  _S2PROFSTOP(_S2PROF_TRANS, tprof, _s2x_transbatch.nvtx,
+	      _s2x_transbatch.nvtx * sizeof(_S2BATCHVTX));
+  _s2priv_drawBatches(&_s2x_transbatch, 1, doscreen ? view : NULL);
   glDisable(GL_BLEND);
   glDepthMask(GL_TRUE);
 
@@ -2026,11 +1649,10 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
       glTexParameterf(GL_TEXTURE_3D,GL_TEXTURE_WRAP_R,GL_CLAMP_TO_EDGE);
       
       if (doscreen) {
-	if (strlen(_s2_doingScreen) &&
-	    strstr(texpoly3d[i].whichscreen, _s2_doingScreen)) {
+	if (_S2ONSCREEN(texpoly3d[i].whichscreen)) {
 	  _s2warn("MakeGeometry", "screen-meshed textures not supported");
 	}
-      } else if (!strlen(texpoly3d[i].whichscreen)) {
+      } else if (!texpoly3d[i].whichscreen) {
 
 	glBegin(GL_POLYGON);
 	glColor4f(1., 1., 1., texpoly3d[i].alpha);
@@ -2057,125 +1679,112 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
   }
 #endif
 
-  // textured meshes
+  // textured meshes: ordered as for the transparent facets, whole
+  // meshes at a time, and grouped by texture where order is free
+  _S2PROFSTART(tprof);
   if (ntexmesh > 0) {
+    static _S2SORTKEYS msort;
+    XYZ mc;
+    int mk, mv;
+    unsigned int oldtex = 0;
+    char oldtrans = 0;
+    _s2priv_sortReserve(&msort, ntexmesh);
     for (i = 0; i < ntexmesh; i++) {
-      if (texmesh[i].trans == 't') {
-	glDepthMask(GL_FALSE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-      } else if (texmesh[i].trans == 's') {
-	glDepthMask(GL_FALSE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-      } else {
-	glDepthMask(GL_TRUE);
-	glDisable(GL_BLEND);
-      }
-
-      if (texmesh[i].texid > 0) {
-	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, texmesh[i].texid);
-	glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
-	glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
-	//glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_R,GL_CLAMP_TO_EDGE);
+      mc.x = mc.y = mc.z = 0.;
+      if (texmesh[i].trans == 's' && !doscreen && texmesh[i].nverts > 0) {
+	for (mv = 0; mv < texmesh[i].nverts; mv++) {
+	  mc.x += texmesh[i].verts[mv].x;
+	  mc.y += texmesh[i].verts[mv].y;
+	  mc.z += texmesh[i].verts[mv].z;
+	}
+	mc.x /= texmesh[i].nverts;
+	mc.y /= texmesh[i].nverts;
+	mc.z /= texmesh[i].nverts;
       }
+      msort.key[i] = _s2priv_transKey(texmesh[i].trans, 
+				      _s2priv_transDepth(mc, 0),
+				      (float)texmesh[i].texid);
+    }
+    _s2priv_sortKeys(&msort);
 
-      //fprintf(stderr, "afafafa texmesh %d\n", i);
+    for (mk = 0; mk < ntexmesh; mk++) {
+      i = msort.idx[mk];
 
       if (doscreen) {
-	if (strlen(_s2_doingScreen) &&
-	    strstr(texmesh[i].whichscreen, _s2_doingScreen)) {
+	if (_S2ONSCREEN(texmesh[i].whichscreen)) {
 	  _s2warn("MakeGeometry", "screen-meshed textures not supported");
 	}
-      } else if (!strlen(texmesh[i].whichscreen)) {
-	//fprintf(stderr, "thththth texmesh %d\n", i);
-
-	glBegin(GL_TRIANGLES);
-	glColor4f(1.0, 1.0, 1.0, texmesh[i].alpha);
-	int j,k;
-	//fprintf(stderr, "ikikikik texmesh %d nfacets = %d\n", i, texmesh[i].nfacets);
-	//fprintf(stderr, "nverts = %d, nnorms = %d\n", texmesh[i].nverts, texmesh[i].nnorms);
-
-	for (j = 0; j < texmesh[i].nfacets; j+=1) {
-	  for (k = 0; k < 3; k++) {
-	    int vx = texmesh[i].facets[j*3+k];
-	    //fprintf(stderr, "%d\t", vx);
-
-	    // glNormal3f has to go onto the stack BEFORE glVertex3f !!!
-	    if (texmesh[i].nnorms == texmesh[i].nverts) {
-	      glNormal3f(texmesh[i].norms[vx].x,
-			 texmesh[i].norms[vx].y,
-			 texmesh[i].norms[vx].z);
-	    }
-
-	    if (texmesh[i].texid > 0) {
-	      int tx = texmesh[i].facets_vtcs[j*3+k];
-	      glTexCoord2f(texmesh[i].vtcs[tx].x,
-			   texmesh[i].vtcs[tx].y);
-	    }
+	continue;
+      } else if (texmesh[i].whichscreen) {
+	continue;
+      }
 
+      if (texmesh[i].trans != oldtrans) {
+	_s2priv_transState(texmesh[i].trans);
+	oldtrans = texmesh[i].trans;
+      }
 
-	    glVertex3f(texmesh[i].verts[vx].x, 
-		       texmesh[i].verts[vx].y,
-		       texmesh[i].verts[vx].z);
+      if (texmesh[i].texid != oldtex) {
+	if (texmesh[i].texid > 0) {
+	  glEnable(GL_TEXTURE_2D);
+	  glBindTexture(GL_TEXTURE_2D, texmesh[i].texid);
+	  glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+	  glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
+	  //glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_R,GL_CLAMP_TO_EDGE);
+	} else {
+	  glDisable(GL_TEXTURE_2D);
+	}
+	oldtex = texmesh[i].texid;
+      }
+
+      glBegin(GL_TRIANGLES);
+      glColor4f(texmesh[i].col.r, texmesh[i].col.g, texmesh[i].col.b,
+		texmesh[i].alpha);
+      int j,k;
+      //fprintf(stderr, "ikikikik texmesh %d nfacets = %d\n", i, texmesh[i].nfacets);
+      //fprintf(stderr, "nverts = %d, nnorms = %d\n", texmesh[i].nverts, texmesh[i].nnorms);
+
+      for (j = 0; j < texmesh[i].nfacets; j+=1) {
+	for (k = 0; k < 3; k++) {
+	  int vx = texmesh[i].facets[j*3+k];
+	  //fprintf(stderr, "%d\t", vx);
+
+	  // glNormal3f has to go onto the stack BEFORE glVertex3f !!!
+	  if (texmesh[i].nnorms == texmesh[i].nverts) {
+	    glNormal3f(texmesh[i].norms[vx].x,
+		       texmesh[i].norms[vx].y,
+		       texmesh[i].norms[vx].z);
+	  }
 
+	  if (texmesh[i].texid > 0) {
+	    int tx = texmesh[i].facets_vtcs[j*3+k];
+	    glTexCoord2f(texmesh[i].vtcs[tx].x,
+			 texmesh[i].vtcs[tx].y);
 	  }
-	}
-	glEnd();
-	//fprintf(stderr, "ssgssgssg texmesh %d\n", i);
 
+
+	  glVertex3f(texmesh[i].verts[vx].x, 
+		     texmesh[i].verts[vx].y,
+		     texmesh[i].verts[vx].z);
+
+	}
       }
+      glEnd();
+      //fprintf(stderr, "ssgssgssg texmesh %d\n", i);
+
     }
     glDisable(GL_BLEND);
     glDisable(GL_TEXTURE_2D);
     glDepthMask(GL_TRUE);
   }
+  _S2PROFSTOP(_S2PROF_TEXMESH, tprof, ntexmesh, 0);
 
 #endif
   
 
-  // transparent points
+  // transparent points (packed with the transparent faces above)
 #if defined(BUILDING_S2PLOT)
-
-
-  if (ntrdot > 0) {
-    for (i = 0; i < ntrdot; i++) {
-      if (trdot[i].trans == 't') {
-	glDepthMask(GL_FALSE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-      } else if (trdot[i].trans == 's') {
-	glDepthMask(GL_FALSE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-      } else {
-	glDepthMask(GL_TRUE);
-	glDisable(GL_BLEND);
-      }
-      glPointSize(options.pointscale * trdot[i].size);
-      glBegin(GL_POINTS);
-      _glColor4f(trdot[i].colour.r,trdot[i].colour.g,trdot[i].colour.b,trdot[i].alpha);
-      if (doscreen) {
-	if (strlen(_s2_doingScreen) && 
-	    strstr(trdot[i].whichscreen, _s2_doingScreen)) {
-	  s2UnProject(view[0] + view[2] * trdot[i].p.x, 
-		       view[1] + view[3] * trdot[i].p.y, 
-		       trdot[i].p.z, 
-		       model, proj, view, &vtx, &vty, &vtz);
-	  glVertex3f(vtx, vty, vtz);
-	  
-	}
-      } else if (!strlen(trdot[i].whichscreen)) {
-	glVertex3f(trdot[i].p.x,trdot[i].p.y,trdot[i].p.z);
-      }
-      glEnd();
-    }
-    glPointSize(options.pointscale);
-    glDisable(GL_BLEND);
-    glDepthMask(GL_TRUE);
-  }
-
+  _s2priv_drawBatches(&_s2x_transbatch, 0, doscreen ? view : NULL);
 #endif
   
 #if defined(BUILDING_S2PLOT)
@@ -2225,14 +1834,18 @@ if (_s2_dynamicEnabled) {
   if (nbboard) {
     //fprintf(stderr, "doscreen = %d and nbboard = %d\n", doscreen, nbboard);
     // draw 3d billboards
+    _S2PROFSTART(tprof);
     _s2priv_drawBillboards(doscreen);
+    _S2PROFSTOP(_S2PROF_BBOARD, tprof, nbboard, 0);
     // draw screen billboards 
     // What is a screen billboard? NOT YET IMPLEMENTED
     //_s2priv_drawBillboards(TRUE);
   }
 
   if (nbbset) {
+    _S2PROFSTART(tprof);
     _s2priv_drawBBsets();
+    _S2PROFSTOP(_S2PROF_BBSET, tprof, nbbset, 0);
   }
   
   /* draw the handles if they are visible */
@@ -2261,6 +1874,16 @@ if (_s2_dynamicEnabled && !doscreen) {
 }
 
 #include "s2geomviewer.c"
+#include "s2batch.c"
+#include "s2sort.c"
+#include "s2cull.c"
+#include "s2lod.c"
+#include "s2govern.c"
+#include "s2prof.c"
+#include "s2capture.c"
+#include "s2texreg.c"
+#include "s2texload.c"
+#include "s2texfile.c"
   
 #if defined(BUILDING_VIEWER)
 #include "s2common.c"
@@ -2507,6 +2130,15 @@ void _s2_process_key(unsigned char key,int x, int y, int modifiers)
     /* toggle fullscreen / constrained screen */
     _s2priv_togglefs();
     break;
+  case 'T':
+    /* write the frame profile */
+    if (_s2_profile.on) {
+      _s2priv_profWrite(_s2_profile.filename ? _s2_profile.filename :
+			"s2profile.csv");
+    } else {
+      _s2warnk('T', "frame profile is off (see ss2tprof)");
+    }
+    break;
 #endif
     
   case 'a':									/* Start/stop autospin */
@@ -3665,7 +3297,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-         if ((label = (LABEL *)realloc(label,(nlabel+1)*sizeof(LABEL))) == NULL) {
+         if ((label = (LABEL *)_s2priv_arenaReserve(label, nlabel, 1, sizeof(LABEL))) == NULL) {
 	   _s2error("(internal)", "memory allocatino for label failed");
          }
          label[nlabel].p      = p[0];
@@ -3681,8 +3313,8 @@ int ReadGeometry(char *name)
 			}
 			label[nlabel].s[i] = '\0';
 #if defined(BUILDING_S2PLOT)
-			strcpy(label[nlabel].whichscreen, "");
-			strncpy(label[nlabel].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+			label[nlabel].whichscreen = 0;
+			label[nlabel].VRMLname = _s2_currVRMLidx;
 #endif
 			nlabel++;
 
@@ -3710,15 +3342,15 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-			if ((ball = (BALL *)realloc(ball,(nball+1)*sizeof(BALL))) == NULL) {
+			if ((ball = (BALL *)_s2priv_arenaReserve(ball, nball, 1, sizeof(BALL))) == NULL) {
 			  _s2error("(internal)", "memory allocation for ball failed");
          }
 			ball[nball].p = p[0];
 			ball[nball].r = r;
 			ball[nball].colour = c[0];
 #if defined(BUILDING_S2PLOT)
-			strcpy(ball[nball].whichscreen, "");
-			strncpy(ball[nball].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+			ball[nball].whichscreen = 0;
+			ball[nball].VRMLname = _s2_currVRMLidx;
 #endif
 			nball++;
 
@@ -3736,7 +3368,7 @@ int ReadGeometry(char *name)
 	   fclose(fptr);
 	   continue;
          }
-         if ((ballt = (BALLT *)realloc(ballt,(nballt+1)*sizeof(BALLT))) == NULL) {
+         if ((ballt = (BALLT *)_s2priv_arenaReserve(ballt, nballt, 1, sizeof(BALLT))) == NULL) {
 	   _s2error("(internal)", "memory allocation for textured ball failed");
          }
          ballt[nballt].p = p[0];
@@ -3788,8 +3420,8 @@ int ReadGeometry(char *name)
 	 ballt[nballt].axis.y = 1.;
 	 ballt[nballt].axis.z = 0.;
 	 ballt[nballt].rotation = 0.;
-	 strcpy(ballt[nballt].whichscreen, "");
-	 //strncpy(ballt[nballt].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+	 ballt[nballt].whichscreen = 0;
+	 //ballt[nballt].VRMLname = _s2_currVRMLidx;
 #endif
          nballt++;
 	 
@@ -3803,7 +3435,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-         if ((disk = (DISK *)realloc(disk,(ndisk+1)*sizeof(DISK))) == NULL) {
+         if ((disk = (DISK *)_s2priv_arenaReserve(disk, ndisk, 1, sizeof(DISK))) == NULL) {
 	   _s2error("(internal)", "memory allocation for disk failed");
          }
          disk[ndisk].p = p[0];
@@ -3813,7 +3445,7 @@ int ReadGeometry(char *name)
          disk[ndisk].colour = c[0];
 
 #if defined(BUILDING_S2PLOT)
-	 strcpy(disk[ndisk].whichscreen, "");
+	 disk[ndisk].whichscreen = 0;
 #endif
          ndisk++;
 
@@ -3827,7 +3459,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-         if ((cone = (CONE *)realloc(cone,(ncone+1)*sizeof(CONE))) == NULL) {
+         if ((cone = (CONE *)_s2priv_arenaReserve(cone, ncone, 1, sizeof(CONE))) == NULL) {
 	   _s2error("(internal)", "memory allocation for cone failed");
          }
          cone[ncone].p1 = p[0];
@@ -3836,8 +3468,8 @@ int ReadGeometry(char *name)
          cone[ncone].r2 = r2;
          cone[ncone].colour = c[0];
 #if defined(BUILDING_S2PLOT)
-	 strcpy(cone[ncone].whichscreen, "");
-	 strncpy(cone[ncone].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+	 cone[ncone].whichscreen = 0;
+	 cone[ncone].VRMLname = _s2_currVRMLidx;
 #endif
          ncone++;
 
@@ -3877,15 +3509,15 @@ int ReadGeometry(char *name)
             	continue;
 				}
 			}
-			if ((dot = (DOT *)realloc(dot,(ndot+1)*sizeof(DOT))) == NULL) {
+			if ((dot = (DOT *)_s2priv_arenaReserve(dot, ndot, 1, sizeof(DOT))) == NULL) {
 			  _s2error("(internal)", "memory allocation for dot failed");
          }
 			dot[ndot].p = p[0];
 			dot[ndot].colour = c[0];
 			dot[ndot].size = ABS(size);
 #if defined(BUILDING_S2PLOT)
-			strcpy(dot[ndot].whichscreen, "");
-			strncpy(dot[ndot].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+			dot[ndot].whichscreen = 0;
+			dot[ndot].VRMLname = _s2_currVRMLidx;
 #endif
 			ndot++;
 
@@ -3945,7 +3577,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-         if ((face3 = (FACE3 *)realloc(face3,(nface3+1)*sizeof(FACE3))) == NULL) {
+         if ((face3 = (FACE3 *)_s2priv_arenaReserve(face3, nface3, 1, sizeof(FACE3))) == NULL) {
 	   _s2error("(internal)", "memory allocation for face3n failed");
          }
 	 for (i=0;i<3;i++) {
@@ -3954,8 +3586,8 @@ int ReadGeometry(char *name)
 	   face3[nface3].colour[i] = c[0];
 	 }
 #if defined(BUILDING_S2PLOT)
-	 strcpy(face3[nface3].whichscreen, "");
-	 strncpy(face3[nface3].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+	 face3[nface3].whichscreen = 0;
+	 face3[nface3].VRMLname = _s2_currVRMLidx;
 #endif		
          nface3++;
 
@@ -3971,7 +3603,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-         if ((face3 = (FACE3 *)realloc(face3,(nface3+1)*sizeof(FACE3)))==NULL) {
+         if ((face3 = (FACE3 *)_s2priv_arenaReserve(face3, nface3, 1, sizeof(FACE3)))==NULL) {
 	   _s2error("(internal)", "memory allocation for face3 failed");
          }
          for (i=0;i<3;i++) {
@@ -3980,8 +3612,8 @@ int ReadGeometry(char *name)
             face3[nface3].colour[i] = c[i];
          }
 #if defined(BUILDING_S2PLOT)
-	 strcpy(face3[nface3].whichscreen, "");
-	 strncpy(face3[nface3].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+	 face3[nface3].whichscreen = 0;
+	 face3[nface3].VRMLname = _s2_currVRMLidx;
 #endif		
          nface3++;
 
@@ -4000,7 +3632,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-         if ((face3 = (FACE3 *)realloc(face3,(nface3+1)*sizeof(FACE3)))==NULL) {
+         if ((face3 = (FACE3 *)_s2priv_arenaReserve(face3, nface3, 1, sizeof(FACE3)))==NULL) {
 	   _s2error("(internal)", "memory allocation for face3 failed");
          }
 	 for (i=0;i<3;i++) {
@@ -4009,8 +3641,8 @@ int ReadGeometry(char *name)
 	   face3[nface3].colour[i] = c[i];
 	 }
 #if defined(BUILDING_S2PLOT)
-	 strcpy(face3[nface3].whichscreen, "");
-	 strncpy(face3[nface3].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+	 face3[nface3].whichscreen = 0;
+	 face3[nface3].VRMLname = _s2_currVRMLidx;
 #endif		
          nface3++;
 
@@ -4042,7 +3674,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-	 if ((face4 = (FACE4 *)realloc(face4,(nface4+1)*sizeof(FACE4))) == NULL) {
+	 if ((face4 = (FACE4 *)_s2priv_arenaReserve(face4, nface4, 1, sizeof(FACE4))) == NULL) {
 	   _s2error("(internal)", "memory allocation for face4 failed");
          }
 	 for (i=0;i<4;i++) {
@@ -4051,8 +3683,8 @@ int ReadGeometry(char *name)
 	   face4[nface4].colour[i] = c[0];
 	 }
 #if defined(BUILDING_S2PLOT)
-	   strcpy(face4[nface4].whichscreen, "");
-	   strncpy(face4[nface4].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+	   face4[nface4].whichscreen = 0;
+	   face4[nface4].VRMLname = _s2_currVRMLidx;
 #endif		
 	 nface4++;
 
@@ -4070,7 +3702,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-         if ((face4 = (FACE4 *)realloc(face4,(nface4+1)*sizeof(FACE4)))==NULL) {
+         if ((face4 = (FACE4 *)_s2priv_arenaReserve(face4, nface4, 1, sizeof(FACE4)))==NULL) {
 	   _s2error("(internal)", "memory allocation for face4 failed");
          }
          for (i=0;i<4;i++) {
@@ -4079,8 +3711,8 @@ int ReadGeometry(char *name)
             face4[nface4].colour[i] = c[i];
          }
 #if defined(BUILDING_S2PLOT)
-	 strcpy(face4[nface4].whichscreen, "");
-	 strncpy(face4[nface4].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+	 face4[nface4].whichscreen = 0;
+	 face4[nface4].VRMLname = _s2_currVRMLidx;
 #endif		
          nface4++;
 
@@ -4102,7 +3734,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-	 if ((face4 = (FACE4 *)realloc(face4,(nface4+1)*sizeof(FACE4)))==NULL) {
+	 if ((face4 = (FACE4 *)_s2priv_arenaReserve(face4, nface4, 1, sizeof(FACE4)))==NULL) {
 	   _s2error("(internal)", "memory allocation for face4 failed");
 	 }
 	 for (i=0;i<4;i++) {
@@ -4111,8 +3743,8 @@ int ReadGeometry(char *name)
 	   face4[nface4].colour[i] = c[i];
 	 }
 #if defined(BUILDING_S2PLOT)
-	 strcpy(face4[nface4].whichscreen, "");
-	 strncpy(face4[nface4].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+	 face4[nface4].whichscreen = 0;
+	 face4[nface4].VRMLname = _s2_currVRMLidx;
 #endif		
 	 nface4++;
 
@@ -4142,7 +3774,7 @@ int ReadGeometry(char *name)
             fclose(fptr);
             continue;
          }
-         if ((face4t = (FACE4T *)realloc(face4t,(nface4t+1)*sizeof(FACE4T))) == NULL) {
+         if ((face4t = (FACE4T *)_s2priv_arenaReserve(face4t, nface4t, 1, sizeof(FACE4T))) == NULL) {
 	   _s2error("(internal)", "memory allocation for face4t failed");
          }
 	 for (i=0;i<4;i++)
@@ -4185,8 +3817,8 @@ int ReadGeometry(char *name)
 #endif
 	 }
 #if defined(BUILDING_S2PLOT)
-	 strcpy(face4t[nface4t].whichscreen, "");
-	 strncpy(face4t[nface4t].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
+	 face4t[nface4t].whichscreen = 0;
+	 face4t[nface4t].VRMLname = _s2_currVRMLidx;
 #endif		
 	 nface4t++;
 
@@ -4316,7 +3948,7 @@ int ReadOFF(char *name)
 	for (i=0;i<noffface;i++) {
 		switch (offface[i].nv) {
 		case 1:
-		  if ((dot = (DOT *)realloc(dot,(ndot+1)*sizeof(DOT))) == NULL) {
+		  if ((dot = (DOT *)_s2priv_arenaReserve(dot, ndot, 1, sizeof(DOT))) == NULL) {
 		    _s2error("(internal)", "memory allocation for dot failed");
          }
          dot[ndot].p = offvert[offface[i].p[0]];
@@ -4325,7 +3957,7 @@ int ReadOFF(char *name)
          ndot++;
 			break;
 		case 2:
-		  if ((line = (LINE *)realloc(line,(nline+1)*sizeof(LINE))) == NULL) {
+		  if ((line = (LINE *)_s2priv_arenaReserve(line, nline, 1, sizeof(LINE))) == NULL) {
 		    _s2error("(internal)", "memory allocation for line failed");
          }
          line[nline].p[0]   = offvert[offface[i].p[0]];
@@ -4336,7 +3968,7 @@ int ReadOFF(char *name)
          nline++;
 			break;
 		case 3:
-		  if ((face3 = (FACE3 *)realloc(face3,(nface3+1)*sizeof(FACE3)))==NULL) {
+		  if ((face3 = (FACE3 *)_s2priv_arenaReserve(face3, nface3, 1, sizeof(FACE3)))==NULL) {
 		    _s2error("(internal)", "memory allocation for face3 failed");
          }
 			for (j=0;j<3;j++) {
@@ -4347,7 +3979,7 @@ int ReadOFF(char *name)
          nface3++;
 			break;
 		case 4:
-		  if ((face4 = (FACE4 *)realloc(face4,(nface4+1)*sizeof(FACE4)))==NULL) {
+		  if ((face4 = (FACE4 *)_s2priv_arenaReserve(face4, nface4, 1, sizeof(FACE4)))==NULL) {
 		    _s2error("(internal)", "memory allocation for face4 failed");
          }
 			for (j=0;j<4;j++) {
@@ -4393,7 +4025,7 @@ void CleanGeometry(void)
       for (j=0;j<4;j++) {
          e = VectorLength(face4[i].p[j],face4[i].p[(j+1)%4]);
          if (e < EPSILON) {
-	   if ((face3 = (FACE3 *)realloc(face3,(nface3+1)*sizeof(FACE3))) == NULL) {
+	   if ((face3 = (FACE3 *)_s2priv_arenaReserve(face3, nface3, 1, sizeof(FACE3))) == NULL) {
 	     _s2error("(internal)", "memory allocation for face3 failed");
             }
             face3[nface3].p[0]   = face4[i].p[j];
@@ -4421,7 +4053,7 @@ void CleanGeometry(void)
 		for (j=0;j<3;j++) {
 			e = VectorLength(face3[i].p[j],face3[i].p[(j+1)%3]);
 			if (e < EPSILON) {
-			  if ((line = (LINE *)realloc(line,(nline+1)*sizeof(LINE))) == NULL) {
+			  if ((line = (LINE *)_s2priv_arenaReserve(line, nline, 1, sizeof(LINE))) == NULL) {
 			    _s2error("(internal)", "memory allocation for line failed");
          	}
          	line[nline].width  = 1;
@@ -4444,7 +4076,7 @@ void CleanGeometry(void)
 	for (i=0;i<nline;i++) {
 		e = VectorLength(line[i].p[0],line[i].p[1]);
 		if (e < EPSILON) {
-		  if ((dot = (DOT *)realloc(dot,(ndot+1)*sizeof(DOT))) == NULL) {
+		  if ((dot = (DOT *)_s2priv_arenaReserve(dot, ndot, 1, sizeof(DOT))) == NULL) {
 		    _s2error("(internal)", "memory allocation for dot failed");
          }
          dot[ndot].size   = line[i].width;
@@ -4494,23 +4126,23 @@ void DeleteGeometry(void)
 {
 	int i;
 
-   ndot     = 0; if (dot     != NULL) { free(dot);     dot     = NULL; }
-   nline    = 0; if (line    != NULL) { free(line);    line    = NULL; }
-   nface3   = 0; if (face3   != NULL) { free(face3);   face3   = NULL; }
-   nface4   = 0; if (face4   != NULL) { free(face4);   face4   = NULL; }
-	nball    = 0; if (ball    != NULL) { free(ball);    ball    = NULL; }
-	ndisk    = 0; if (disk    != NULL) { free(disk);    disk    = NULL; }
-	ncone    = 0; if (cone    != NULL) { free(cone);    cone    = NULL; }
-	nlabel   = 0; if (label   != NULL) { free(label);   label   = NULL; }
+   ndot     = 0; if (dot     != NULL) { _s2priv_arenaFree(dot);     dot     = NULL; }
+   nline    = 0; if (line    != NULL) { _s2priv_arenaFree(line);    line    = NULL; }
+   nface3   = 0; if (face3   != NULL) { _s2priv_arenaFree(face3);   face3   = NULL; }
+   nface4   = 0; if (face4   != NULL) { _s2priv_arenaFree(face4);   face4   = NULL; }
+	nball    = 0; if (ball    != NULL) { _s2priv_arenaFree(ball);    ball    = NULL; }
+	ndisk    = 0; if (disk    != NULL) { _s2priv_arenaFree(disk);    disk    = NULL; }
+	ncone    = 0; if (cone    != NULL) { _s2priv_arenaFree(cone);    cone    = NULL; }
+	nlabel   = 0; if (label   != NULL) { _s2priv_arenaFree(label);   label   = NULL; }
 #if defined(BUILDING_S2PLOT)
-	nhandle  = 0; if (handle  != NULL) { free(handle);  handle  = NULL; }
-	nbboard  = 0; if (bboard  != NULL) { free(bboard);  bboard  = NULL; }
-	nbbset   = 0; if (bbset   != NULL) { free(bbset);   bbset   = NULL; }
-	nface3a  = 0; if (face3a  != NULL) { free(face3a);  face3a  = NULL; }
+	nhandle  = 0; if (handle  != NULL) { _s2priv_arenaFree(handle);  handle  = NULL; }
+	nbboard  = 0; if (bboard  != NULL) { _s2priv_arenaFree(bboard);  bboard  = NULL; }
+	nbbset   = 0; if (bbset   != NULL) { _s2priv_arenaFree(bbset);   bbset   = NULL; }
+	nface3a  = 0; if (face3a  != NULL) { _s2priv_arenaFree(face3a);  face3a  = NULL; }
 #if defined(S2_3D_TEXTURES)
-	ntexpoly3d = 0; if (texpoly3d != NULL) { free(texpoly3d); texpoly3d = NULL; }
+	ntexpoly3d = 0; if (texpoly3d != NULL) { _s2priv_arenaFree(texpoly3d); texpoly3d = NULL; }
 #endif
-	ntexmesh = 0; if (texmesh != NULL) { free(texmesh); texmesh = NULL; }
+	ntexmesh = 0; if (texmesh != NULL) { _s2priv_arenaFree(texmesh); texmesh = NULL; }
 #endif
 
 	/* Remove texture facets */
@@ -4523,7 +4155,7 @@ void DeleteGeometry(void)
 	}
 	nface4t = 0; 
 	if (face4t != NULL) { 
-		free(face4t); 
+		_s2priv_arenaFree(face4t); 
 		face4t = NULL; 
 	}
 
@@ -4537,7 +4169,7 @@ void DeleteGeometry(void)
    }
    nballt = 0;
    if (ballt != NULL) {
-      free(ballt);
+      _s2priv_arenaFree(ballt);
       ballt = NULL;
    }
 
@@ -4631,8 +4263,8 @@ void CreateAxes(void)
 {
 	COLOUR red = {1,0,0},green = {0,1,0}, blue = {0,0,1};
 
+	line = (LINE *)_s2priv_arenaReserve(line, 0, 3, sizeof(LINE));
 	nline = 3;
-	line = (LINE *)malloc(nline*sizeof(LINE));
 	line[0].p[0].x   = -1; line[0].p[0].y   = 0;  line[0].p[0].z   = 0;
    line[0].p[1].x   =  1; line[0].p[1].y   = 0;  line[0].p[1].z   = 0;
 	line[0].width = 1;
@@ -5049,6 +4681,14 @@ Shift-q,Shift-ESC   quit\n\
 
 void CleanExit(void)
 {
+#if defined(BUILDING_S2PLOT)
+  /* write the frame profile, if a file was named for it */
+  if (_s2_profile.on && _s2_profile.filename) {
+    _s2priv_profWrite(_s2_profile.filename);
+  }
+  /* finish writing recorded frames */
+  _s2priv_capFlush();
+#endif
   s2winDestroyWindow();
    ClearAllBuffers();
 	exit(0);
@@ -5188,14 +4828,6 @@ void _s2priv_drawActiveFrame(int active) {
 #endif
 #endif
 
-int handlecomp(const void *a, const void *b) {
-  if (((_S2HANDLE *)a)->dist > ((_S2HANDLE *)b)->dist) {
-    return -1;
-  } else {
-    return 1;
-  }
-}
-
 int bboardcomp(const void *a, const void *b) {
   if (((_S2BBOARD *)a)->dist > ((_S2BBOARD *)b)->dist) {
     return 1;
@@ -5206,14 +4838,6 @@ int bboardcomp(const void *a, const void *b) {
   }
 }
 
-int bbptrcomp(const void *a, const void *b) {
-  if ((*((_S2BBOARD **)a))->dist > (*((_S2BBOARD **)b))->dist) {
-    return -1;
-  } else {
-    return 1;
-  }
-}
-
 /* draw the Handles */
 void _s2priv_drawHandles(int doscreen) {
 
@@ -5249,7 +4873,10 @@ void _s2priv_drawHandles(int doscreen) {
   //SetVectorLength(&UP, 7.0);
   //SetVectorLength(&RGT, 7.0);
 
-  int i=0;  
+  static _S2SORTKEYS hsort;
+  _s2priv_sortReserve(&hsort, nhandle);
+
+  int i=0, k;
 #if defined(S2OPENMP)
 #pragma omp parallel shared(handle,CAMP,nhandle) private(i)
   {
@@ -5259,17 +4886,14 @@ void _s2priv_drawHandles(int doscreen) {
       handle[i].dist = (CAMP.x - handle[i].p.x) * (CAMP.x - handle[i].p.x) +
 	(CAMP.y - handle[i].p.y) * (CAMP.y - handle[i].p.y) +
 	(CAMP.z - handle[i].p.z) * (CAMP.z - handle[i].p.z);
+      hsort.key[i] = _s2priv_depthKey(handle[i].dist, 1);
     }
 #if defined(S2OPENMP)
   }
 #endif
   
-  // 2. sort the handles
-#if defined(S2OPENMP)
-  mQsortMTh(handle, nhandle);
-#else
-  qsort(handle, nhandle, sizeof(_S2HANDLE), handlecomp);
-#endif  
+  // 2. sort the handles, farthest first (the handles stay in place)
+  _s2priv_sortKeys(&hsort);
 
   // 3. draw the handles
   static XYZ vertices[4];
@@ -5284,14 +4908,14 @@ void _s2priv_drawHandles(int doscreen) {
 
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-  for (i = 0; i < nhandle; i++) {
+  for (k = 0; k < nhandle; k++) {
+    i = hsort.idx[k];
 
-    if ((doscreen && !strlen(handle[i].whichscreen)) ||
-	(!doscreen && strlen(handle[i].whichscreen))) {
+    if ((doscreen && !handle[i].whichscreen) ||
+	(!doscreen && handle[i].whichscreen)) {
       continue;
     }
-    if (doscreen && !(strlen(_s2_doingScreen) &&
-		      strstr(handle[i].whichscreen, _s2_doingScreen))) {
+    if (doscreen && !_S2ONSCREEN(handle[i].whichscreen)) {
       continue;
     }
     
@@ -5412,7 +5036,46 @@ void _s2priv_drawBBsets(void) {
   // for bboards: no lighting, normal blending
   glDisable(GL_LIGHTING);
   glEnable(GL_TEXTURE_2D);
-  int i, j;
+  int i;
+
+  // Query for the max point size supported by the hardware: this does
+  // not change, so only ask once
+  static float maxSize = -1.0f;
+  if (maxSize < 0.0f) {
+    glGetFloatv( GL_POINT_SIZE_MAX_ARB, &maxSize );
+    // Clamp size to 100.0f or the sprites could get a little too big on some  
+    // of the newer graphic cards. My ATI card at home supports a max point 
+    // size of 1024.0f!
+    if( maxSize > 100.0f )
+      maxSize = 100.0f;
+  }
+
+  // This is how will our point sprite's size will be modified by 
+  // distance from the viewer
+  float quadratic[] =  { 1.0f, 0.0f, 0.01f };
+  glPointParameterfvARB( GL_POINT_DISTANCE_ATTENUATION_ARB, quadratic );
+    
+  // The alpha of a point is calculated to allow the fading of points 
+  // instead of shrinking them past a defined threshold size. The threshold 
+  // is defined by GL_POINT_FADE_THRESHOLD_SIZE_ARB and is not clamped to 
+  // the minimum and maximum point sizes.
+  glPointParameterfARB( GL_POINT_FADE_THRESHOLD_SIZE_ARB, 60.0f );
+    
+  glPointParameterfARB( GL_POINT_SIZE_MIN_ARB, 1.0f );
+  glPointParameterfARB( GL_POINT_SIZE_MAX_ARB, maxSize );
+    
+  // Specify point sprite texture coordinate replacement mode for each 
+  // texture unit
+  glTexEnvf( GL_POINT_SPRITE_ARB, GL_COORD_REPLACE_ARB, GL_TRUE );
+    
+  //
+  // Render point sprites, each set straight from its arrays
+  //
+    
+  glEnable( GL_POINT_SPRITE_ARB );
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+
   for (i = 0; i < nbbset; i++) {
     if (bbset[i].trans=='t') {
       glDepthMask(GL_FALSE);
@@ -5429,67 +5092,20 @@ void _s2priv_drawBBsets(void) {
 
     glBindTexture(GL_TEXTURE_2D, bbset[i].texid);
 
-    // This is how will our point sprite's size will be modified by 
-    // distance from the viewer
-    float quadratic[] =  { 1.0f, 0.0f, 0.01f };
-    glPointParameterfvARB( GL_POINT_DISTANCE_ATTENUATION_ARB, quadratic );
-    
-    // Query for the max point size supported by the hardware
-    float maxSize = 0.0f;
-    glGetFloatv( GL_POINT_SIZE_MAX_ARB, &maxSize );
-    
-    // Clamp size to 100.0f or the sprites could get a little too big on some  
-    // of the newer graphic cards. My ATI card at home supports a max point 
-    // size of 1024.0f!
-    if( maxSize > 100.0f )
-      maxSize = 100.0f;
-
     if (bbset[i].size > maxSize) {
       bbset[i].size = maxSize;
     }
     
     glPointSize(bbset[i].size);
-    
-    // The alpha of a point is calculated to allow the fading of points 
-    // instead of shrinking them past a defined threshold size. The threshold 
-    // is defined by GL_POINT_FADE_THRESHOLD_SIZE_ARB and is not clamped to 
-    // the minimum and maximum point sizes.
-    glPointParameterfARB( GL_POINT_FADE_THRESHOLD_SIZE_ARB, 60.0f );
-    
-    glPointParameterfARB( GL_POINT_SIZE_MIN_ARB, 1.0f );
-    glPointParameterfARB( GL_POINT_SIZE_MAX_ARB, maxSize );
-    
-    // Specify point sprite texture coordinate replacement mode for each 
-    // texture unit
-    glTexEnvf( GL_POINT_SPRITE_ARB, GL_COORD_REPLACE_ARB, GL_TRUE );
-    
-    //
-    // Render point sprites...
-    //
-    
-    glEnable( GL_POINT_SPRITE_ARB );
-    glBegin( GL_POINTS );
-
-    for(j = 0; j < bbset[i].n; j++) {
-      //glPointSize(j % 100);
-      //glPointSize(bbset[i].size * (0.8 + 0.4 * rand() / (float)(RAND_MAX)));
-      //glPointSize(bbset[i].size);
-      //glBegin( GL_POINTS );
-      glColor4f( bbset[i].colarray[j*4+0],
-		 bbset[i].colarray[j*4+1],
-		 bbset[i].colarray[j*4+2],
-		 bbset[i].colarray[j*4+3]);
-      glVertex3f(bbset[i].vertarray[j*3+0],
-		 bbset[i].vertarray[j*3+1],
-		 bbset[i].vertarray[j*3+2]);
-      //glEnd();
-    }
-    glEnd();
-    
-    glDisable( GL_POINT_SPRITE_ARB );
-    
-    
+
+    glVertexPointer(3, GL_FLOAT, 0, bbset[i].vertarray);
+    glColorPointer(4, GL_FLOAT, 0, bbset[i].colarray);
+    glDrawArrays(GL_POINTS, 0, bbset[i].n);
   }
+
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glDisable( GL_POINT_SPRITE_ARB );
   
   glDisable(GL_TEXTURE_2D);
   glDepthMask(GL_TRUE);
@@ -5652,6 +5268,81 @@ void _s2priv_drawBillboards(void) {
 
 #else 
 
+/* GPU billboard expansion (ss2tbbx): each corner of a billboard is
+ * sent with the billboard's centre, and the vertex shader makes the
+ * same quad the CPU loop in _s2priv_drawBillboards would, from the
+ * camera vectors and the billboard's stretch, position angle, size,
+ * aspect and offset.  The fragments go through the fixed pipeline. */
+#define _S2BBSHAPE 6  /* attribute: stretch x, y, z and position angle */
+#define _S2BBEXTENT 7 /* attribute: size, aspect, offset x and y */
+static const char *_s2x_bbvertsrc = 
+  "#version 110\n"
+  "uniform vec3 rgt, up, view;\n"
+  "attribute vec4 shape;\n"
+  "attribute vec4 extent;\n"
+  "vec3 rot(vec3 p, float th) {\n"
+  "  return p * cos(th) + cross(view, p) * sin(th) +\n"
+  "    view * dot(view, p) * (1. - cos(th));\n"
+  "}\n"
+  "void main() {\n"
+  "  vec3 nrgt = normalize(rgt);\n"
+  "  vec3 nup = normalize(up);\n"
+  "  vec3 s = shape.xyz;\n"
+  "  vec3 sn = (dot(s, s) > 0.) ? normalize(s) : vec3(0.);\n"
+  "  vec3 drgt = rot(rgt * extent.y + sn * dot(s, nrgt), shape.w);\n"
+  "  vec3 dup = rot(up + sn * dot(s, nup), shape.w);\n"
+  "  vec2 c = gl_MultiTexCoord0.xy * 2. - 1.;\n"
+  "  vec4 p = vec4(gl_Vertex.xyz + nrgt * extent.z + nup * extent.w +\n"
+  "                extent.x * (c.y * dup + c.x * drgt), 1.);\n"
+  "  gl_Position = gl_ModelViewProjectionMatrix * p;\n"
+  "  gl_ClipVertex = gl_ModelViewMatrix * p;\n"
+  "  gl_FrontColor = gl_Color;\n"
+  "  gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+  "}\n";
+
+/* build the billboard expansion program the first time it is asked
+ * for; returns 0 (and billboards are expanded on the CPU) if it 
+ * cannot be built */
+static GLuint _s2priv_bbProgram(void) {
+  static GLuint prog = 0;
+  static int tried = 0;
+  GLuint vs;
+  GLint ok = 0;
+  if (tried) {
+    return prog;
+  }
+  tried = 1;
+
+  const char *version = (const char *)glGetString(GL_VERSION);
+  if (!version || atoi(version) < 2) {
+    _s2warn("(internal)", "billboard shaders need OpenGL 2.0: expanding billboards on the CPU");
+    return 0;
+  }
+
+  vs = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vs, 1, &_s2x_bbvertsrc, NULL);
+  glCompileShader(vs);
+  glGetShaderiv(vs, GL_COMPILE_STATUS, &ok);
+  if (ok) {
+    prog = glCreateProgram();
+    glAttachShader(prog, vs);
+    glBindAttribLocation(prog, _S2BBSHAPE, "shape");
+    glBindAttribLocation(prog, _S2BBEXTENT, "extent");
+    glLinkProgram(prog);
+    glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+  }
+  // the shader lives on in the program, if there is one
+  glDeleteShader(vs);
+  if (!ok) {
+    if (prog) {
+      glDeleteProgram(prog);
+      prog = 0;
+    }
+    _s2warn("(internal)", "failed to build billboard shader: expanding billboards on the CPU");
+  }
+  return prog;
+}
+
 /* draw the billboards */
 void _s2priv_drawBillboards(int doscreen) {
   /* billboard texture method, correctly sorted  */
@@ -5677,49 +5368,47 @@ void _s2priv_drawBillboards(int doscreen) {
 
   int i = 0;
 
-#if defined(POINTER_SORT)
-  static _S2BBOARD **bbptr = NULL;
-  bbptr = (_S2BBOARD **)realloc(bbptr, nbboard * sizeof(_S2BBOARD *));
-#endif
+  static _S2SORTKEYS bbsort;
+  _s2priv_sortReserve(&bbsort, nbboard);
+
+  // bboards wholly outside the view are given a key that sorts after
+  // every distance, and are not drawn; the bounding radius allows for
+  // the largest stretch, aspect and offset a bboard can have
+  _S2FRUSTUM fr;
+  _s2priv_cullFrustum(&fr);
+  int nvis = 0;
+  float bbrad;
 
 #if defined(S2OPENMP)
   //int tid, nthreads;
-#pragma omp parallel shared(bboard,CAMP,nbboard) private(i)
+#pragma omp parallel shared(bboard,CAMP,nbboard,fr) private(i,bbrad)
   {
-#pragma omp for schedule(dynamic,1000)
+#pragma omp for schedule(dynamic,1000) reduction(+:nvis)
 #endif
     for (i = 0; i < nbboard; i++) {
+      bbrad = fabs(bboard[i].size) * 
+	(7.0 * (1. + fabs(bboard[i].aspect)) + 2. * Modulus(bboard[i].str)) +
+	fabs(bboard[i].offset.x) + fabs(bboard[i].offset.y);
+      if (bboard[i].whichscreen || 
+	  !_s2priv_cullSphere(&fr, bboard[i].p, bbrad)) {
+	bbsort.key[i] = _S2SORTLAST;
+	continue;
+      }
       bboard[i].dist = (CAMP.x - bboard[i].p.x) * (CAMP.x - bboard[i].p.x) +
 	(CAMP.y - bboard[i].p.y) * (CAMP.y - bboard[i].p.y) +
 	(CAMP.z - bboard[i].p.z) * (CAMP.z - bboard[i].p.z);
-#if defined(POINTER_SORT)
-      bbptr[i] = &(bboard[i]);
-#endif
+      bbsort.key[i] = _s2priv_depthKey(bboard[i].dist, 1);
+      nvis++;
     }
 #if defined(S2OPENMP)
   }
 #endif
 
-  // SORT RESULTS IN ORDERED LIST: CLOSEST TO FURTHEST
-
-  // 2. sort the bboards
-#if !defined(POINTER_SORT)
-  // direct method
-#if defined(S2OPENMP)
-  mQsortMT(bboard, nbboard);
-#else
-  qsort(bboard, nbboard, sizeof(_S2BBOARD), bboardcomp);
-#endif  
-
-#else
-  // offset pointer method
-#if defined(S2OPENMP)
-  mQsortMTptr(bbptr, nbboard);
-#else
-  qsort(bbptr, nbboard, sizeof(_S2BBOARD *), bbptrcomp);
-#endif
-
-#endif
+  // 2. sort the bboards: bbsort.idx lists the nvis visible ones 
+  // farthest first, and the bboard array itself is left in place
+  double tprof = _s2priv_profStart();
+  _s2priv_sortKeys(&bbsort);
+  _s2priv_profStop(_S2PROF_BBSORT, tprof, nvis, 0);
 
   // 3. calculate the bboard vertices and normals
   static GLfloat *_bb_vertices = NULL;
@@ -5730,6 +5419,13 @@ void _s2priv_drawBillboards(int doscreen) {
   _bb_colours = (GLfloat *)realloc(_bb_colours, 4 * 4 * nbboard * sizeof(GLfloat));
   static GLfloat *_bb_texcoords = NULL;
   _bb_texcoords = (GLfloat *)realloc(_bb_texcoords, 4 * 2 * nbboard * sizeof(GLfloat));
+  GLuint bbprog = _s2_bbshader ? _s2priv_bbProgram() : 0;
+  static GLfloat *_bb_shape = NULL;
+  static GLfloat *_bb_extent = NULL;
+  if (bbprog) {
+    _bb_shape = (GLfloat *)realloc(_bb_shape, 4 * 4 * nbboard * sizeof(GLfloat));
+    _bb_extent = (GLfloat *)realloc(_bb_extent, 4 * 4 * nbboard * sizeof(GLfloat));
+  }
   static float size;
 
   XYZ nRGT = RGT;
@@ -5774,61 +5470,77 @@ void _s2priv_drawBillboards(int doscreen) {
 
   int j, bi;
 #if defined(S2OPENMP)
-#pragma omp parallel shared(bboard,nRGT,nUP,_bb_vertices,_bb_normal,_bb_colours,_bb_texcoords) private(tmpb,dilRGT,dilUP,size,i,j,bi)
+#pragma omp parallel shared(bboard,nRGT,nUP,_bb_vertices,_bb_normal,_bb_colours,_bb_texcoords,_bb_shape,_bb_extent,bbprog) private(tmpb,dilRGT,dilUP,size,i,j,bi)
   {
 #pragma omp for schedule(dynamic,500)
 #endif
-    for (i = 0; i < nbboard; i++) {
+    for (i = 0; i < nvis; i++) {
 
-      // SORT RESULTS IN ORDERED LIST: CLOSEST TO FURTHEST
-      // SO HERE WE INVERT THE ORDER AS WE WANT TO DRAW FARTHEST FIRST
-      bi = nbboard-1-i;
+      // vertices are laid out in draw order: farthest first
+      bi = bbsort.idx[i];
       
-      // dilate the UP and RIGHT vectors to stretch the texture
-      tmpb = bboard[bi].str;
-      SetVectorLength(&tmpb, DotProduct(bboard[bi].str, nRGT));
-      dilRGT = VectorAdd(VectorMul(RGT, bboard[bi].aspect), tmpb);
+      if (bbprog) {
+	// the corners all start at the centre: the shader expands them
+	for (j = 0; j < 4; j++) {
+	  _bb_vertices[i*3*4+j*3+0] = bboard[bi].p.x;
+	  _bb_vertices[i*3*4+j*3+1] = bboard[bi].p.y;
+	  _bb_vertices[i*3*4+j*3+2] = bboard[bi].p.z;
+	  _bb_shape[i*4*4+j*4+0] = bboard[bi].str.x;
+	  _bb_shape[i*4*4+j*4+1] = bboard[bi].str.y;
+	  _bb_shape[i*4*4+j*4+2] = bboard[bi].str.z;
+	  _bb_shape[i*4*4+j*4+3] = bboard[bi].pa;
+	  _bb_extent[i*4*4+j*4+0] = bboard[bi].size;
+	  _bb_extent[i*4*4+j*4+1] = bboard[bi].aspect;
+	  _bb_extent[i*4*4+j*4+2] = bboard[bi].offset.x;
+	  _bb_extent[i*4*4+j*4+3] = bboard[bi].offset.y;
+	}
+      } else {
+	// dilate the UP and RIGHT vectors to stretch the texture
+	tmpb = bboard[bi].str;
+	SetVectorLength(&tmpb, DotProduct(bboard[bi].str, nRGT));
+	dilRGT = VectorAdd(VectorMul(RGT, bboard[bi].aspect), tmpb);
       
-      tmpb = bboard[bi].str;
-      SetVectorLength(&tmpb, DotProduct(bboard[bi].str, nUP));
-      dilUP = VectorAdd(UP, tmpb);
-
-      //XYZ xoff = nRGT;
-      //SetVectorLength(&xoff, bboard[i].offset.x);
-      //XYZ yoff = nUP;
-      //SetVectorLength(&yoff, bboard[i].offset.y);
-      //XYZ toff = VectorAdd(xoff, yoff);
-      XYZ toff = VectorAdd(VectorMul(nRGT, bboard[bi].offset.x),
-			   VectorMul(nUP, bboard[bi].offset.y));
-
-      // rotate dilRGT and dilUP about the view direction by position angle
-      // "Unit" suffix is the function which requires VIEW already normalised
-      dilRGT = ArbitraryRotateUnit(dilRGT, bboard[bi].pa, VIEW);
-      dilUP = ArbitraryRotateUnit(dilUP, bboard[bi].pa, VIEW);
+	tmpb = bboard[bi].str;
+	SetVectorLength(&tmpb, DotProduct(bboard[bi].str, nUP));
+	dilUP = VectorAdd(UP, tmpb);
+
+	//XYZ xoff = nRGT;
+	//SetVectorLength(&xoff, bboard[i].offset.x);
+	//XYZ yoff = nUP;
+	//SetVectorLength(&yoff, bboard[i].offset.y);
+	//XYZ toff = VectorAdd(xoff, yoff);
+	XYZ toff = VectorAdd(VectorMul(nRGT, bboard[bi].offset.x),
+			     VectorMul(nUP, bboard[bi].offset.y));
+
+	// rotate dilRGT and dilUP about the view direction by position angle
+	// "Unit" suffix is the function which requires VIEW already normalised
+	dilRGT = ArbitraryRotateUnit(dilRGT, bboard[bi].pa, VIEW);
+	dilUP = ArbitraryRotateUnit(dilUP, bboard[bi].pa, VIEW);
       
-      size = bboard[bi].size; // * powf(bboard[bi].dist, 0.3);
+	size = bboard[bi].size; // * powf(bboard[bi].dist, 0.3);
 
-      _bb_vertices[i*3*4+0*3+0] = bboard[bi].p.x + toff.x + size * (dilUP.x - dilRGT.x);
-      _bb_vertices[i*3*4+0*3+1] = bboard[bi].p.y + toff.y + size * (dilUP.y - dilRGT.y);
-      _bb_vertices[i*3*4+0*3+2] = bboard[bi].p.z + toff.z + size * (dilUP.z - dilRGT.z);
+	_bb_vertices[i*3*4+0*3+0] = bboard[bi].p.x + toff.x + size * (dilUP.x - dilRGT.x);
+	_bb_vertices[i*3*4+0*3+1] = bboard[bi].p.y + toff.y + size * (dilUP.y - dilRGT.y);
+	_bb_vertices[i*3*4+0*3+2] = bboard[bi].p.z + toff.z + size * (dilUP.z - dilRGT.z);
       
-      _bb_vertices[i*3*4+1*3+0] = bboard[bi].p.x + toff.x + size * (dilUP.x + dilRGT.x);
-      _bb_vertices[i*3*4+1*3+1] = bboard[bi].p.y + toff.y + size * (dilUP.y + dilRGT.y);
-      _bb_vertices[i*3*4+1*3+2] = bboard[bi].p.z + toff.z + size * (dilUP.z + dilRGT.z);
+	_bb_vertices[i*3*4+1*3+0] = bboard[bi].p.x + toff.x + size * (dilUP.x + dilRGT.x);
+	_bb_vertices[i*3*4+1*3+1] = bboard[bi].p.y + toff.y + size * (dilUP.y + dilRGT.y);
+	_bb_vertices[i*3*4+1*3+2] = bboard[bi].p.z + toff.z + size * (dilUP.z + dilRGT.z);
       
-      _bb_vertices[i*3*4+2*3+0] = bboard[bi].p.x + toff.x + size * (-dilUP.x + dilRGT.x);
-      _bb_vertices[i*3*4+2*3+1] = bboard[bi].p.y + toff.y + size * (-dilUP.y + dilRGT.y);
-      _bb_vertices[i*3*4+2*3+2] = bboard[bi].p.z + toff.z + size * (-dilUP.z + dilRGT.z);
+	_bb_vertices[i*3*4+2*3+0] = bboard[bi].p.x + toff.x + size * (-dilUP.x + dilRGT.x);
+	_bb_vertices[i*3*4+2*3+1] = bboard[bi].p.y + toff.y + size * (-dilUP.y + dilRGT.y);
+	_bb_vertices[i*3*4+2*3+2] = bboard[bi].p.z + toff.z + size * (-dilUP.z + dilRGT.z);
       
-      _bb_vertices[i*3*4+3*3+0] = bboard[bi].p.x + toff.x + size * (-dilUP.x - dilRGT.x);
-      _bb_vertices[i*3*4+3*3+1] = bboard[bi].p.y + toff.y + size * (-dilUP.y - dilRGT.y);
-      _bb_vertices[i*3*4+3*3+2] = bboard[bi].p.z + toff.z + size * (-dilUP.z - dilRGT.z);
+	_bb_vertices[i*3*4+3*3+0] = bboard[bi].p.x + toff.x + size * (-dilUP.x - dilRGT.x);
+	_bb_vertices[i*3*4+3*3+1] = bboard[bi].p.y + toff.y + size * (-dilUP.y - dilRGT.y);
+	_bb_vertices[i*3*4+3*3+2] = bboard[bi].p.z + toff.z + size * (-dilUP.z - dilRGT.z);
       
-      // assign normal
-      for (j = 0; j < 4; j++) {
-	_bb_normal[i*3*4+j*3+0] = -VIEW.x;
-	_bb_normal[i*3*4+j*3+1] = -VIEW.y;
-	_bb_normal[i*3*4+j*3+2] = -VIEW.z;
+	// assign normal
+	for (j = 0; j < 4; j++) {
+	  _bb_normal[i*3*4+j*3+0] = -VIEW.x;
+	  _bb_normal[i*3*4+j*3+1] = -VIEW.y;
+	  _bb_normal[i*3*4+j*3+2] = -VIEW.z;
+	}
       }
 
       // assign colours (desaturating if necessary)
@@ -5868,30 +5580,36 @@ void _s2priv_drawBillboards(int doscreen) {
   glEnable(GL_BLEND);
   glEnable(GL_TEXTURE_2D);
 
-  for (i = 0; i < nbboard; i++) {
+  if (bbprog) {
+    glUseProgram(bbprog);
+    glUniform3f(glGetUniformLocation(bbprog, "rgt"), RGT.x, RGT.y, RGT.z);
+    glUniform3f(glGetUniformLocation(bbprog, "up"), UP.x, UP.y, UP.z);
+    glUniform3f(glGetUniformLocation(bbprog, "view"), VIEW.x, VIEW.y, VIEW.z);
+    glNormal3f(-VIEW.x, -VIEW.y, -VIEW.z);
+    glEnableVertexAttribArray(_S2BBSHAPE);
+    glEnableVertexAttribArray(_S2BBEXTENT);
+  }
+
+  for (i = 0; i < nvis; i++) {
 
     /*
-    if ((doscreen && !strlen(bboard[i].whichscreen)) ||
-	(!doscreen && strlen(bboard[i].whichscreen))) {
+    if ((doscreen && !bboard[i].whichscreen) ||
+	(!doscreen && bboard[i].whichscreen)) {
       continue;
     }
-    if (doscreen && !(strlen(_s2_doingScreen) &&
-		      strstr(bboard[i].whichscreen, _s2_doingScreen))) {
+    if (doscreen && !_S2ONSCREEN(bboard[i].whichscreen)) {
       continue;
     }
     */
     
-    if (strlen(bboard[i].whichscreen)) {
+    // [bi for indexing into bboard[...] array only!]
+    bi = bbsort.idx[i];
+
+    if (bboard[bi].whichscreen) {
       // screen billboards are ignored / meaningless
       continue;
     }
 
-
-    // SORT RESULTS IN ORDERED LIST: CLOSEST TO FURTHEST
-    // SO HERE WE INVERT THE ORDER AS WE WANT TO DRAW FARTHEST FIRST
-    // [for indexing into bboard[...] array only!]
-    bi = nbboard-1-i;
-
     if (bboard[bi].trans == 't') {
       glDepthMask(GL_FALSE);
       glEnable(GL_BLEND);
@@ -5907,14 +5625,12 @@ void _s2priv_drawBillboards(int doscreen) {
     glBindTexture(GL_TEXTURE_2D, bboard[bi].texid);
 
     int j = i+1;
-    int bj = nbboard-1-j;
-    while ((j < nbboard) && 
-	   !(strlen(bboard[i].whichscreen)) && 
+    while ((j < nvis) && 
+	   !bboard[bbsort.idx[j]].whichscreen && 
 	   // (j-i < 5000)) &&
-	   (bboard[bj].trans == bboard[bi].trans) &&
-	   (bboard[bj].texid == bboard[bi].texid)) {
+	   (bboard[bbsort.idx[j]].trans == bboard[bi].trans) &&
+	   (bboard[bbsort.idx[j]].texid == bboard[bi].texid)) {
       j++;
-      bj--;
     }
     j--;
     // j = i;
@@ -5925,8 +5641,15 @@ void _s2priv_drawBillboards(int doscreen) {
     glEnableClientState(GL_TEXTURE_COORD_ARRAY);
     glTexCoordPointer(2, GL_FLOAT, 0, _bb_texcoords+(i*2*4));
 
-    glEnableClientState(GL_NORMAL_ARRAY);
-    glNormalPointer(GL_FLOAT, 0, _bb_normal+(i*3*4));
+    if (bbprog) {
+      glVertexAttribPointer(_S2BBSHAPE, 4, GL_FLOAT, GL_FALSE, 0, 
+			    _bb_shape+(i*4*4));
+      glVertexAttribPointer(_S2BBEXTENT, 4, GL_FLOAT, GL_FALSE, 0, 
+			    _bb_extent+(i*4*4));
+    } else {
+      glEnableClientState(GL_NORMAL_ARRAY);
+      glNormalPointer(GL_FLOAT, 0, _bb_normal+(i*3*4));
+    }
 
     glEnableClientState(GL_COLOR_ARRAY);
     glColorPointer(4, GL_FLOAT, 0, _bb_colours+(i*4*4));
@@ -5943,6 +5666,11 @@ void _s2priv_drawBillboards(int doscreen) {
   glDisableClientState(GL_NORMAL_ARRAY);
   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
   glDisableClientState(GL_VERTEX_ARRAY);
+  if (bbprog) {
+    glDisableVertexAttribArray(_S2BBSHAPE);
+    glDisableVertexAttribArray(_S2BBEXTENT);
+    glUseProgram(0);
+  }
 
   // texturing off, disable blending, lighting on
   glDisable(GL_TEXTURE_2D);
@@ -6372,6 +6100,17 @@ int s2open(int ifullscreen, int istereo, int iargc, char **iargv) {
     /* null device */
     options.stereo = NULLSTEREO;
     _s2_devcap = 0;
+  } else if (istereo == -2) {
+    /* offscreen rendering with no window system: the driver stands in
+     * for glut, so it is loaded now rather than after s2winInit */
+    options.stereo = NOSTEREO;
+    _s2_devcap = 0;
+    _s2_driver = (char *)calloc(strlen("s2offscreen")+1, sizeof(char));
+    strcpy(_s2_driver, "s2offscreen");
+    _device_draw = NULL;
+    _device_resize = NULL;
+    _device_keybd = NULL;
+    loadDevices(_s2_driver);
   } else if (istereo) {
     /* unknown stereo mode */
     _s2warn("s2open*", "unsupported stereo mode");
@@ -6534,6 +6273,10 @@ int s2open(int ifullscreen, int istereo, int iargc, char **iargv) {
    /* no pre-loaded cached textures */
    _s2_ctext_count = 0;
    _s2_ctext = NULL;
+   _s2_ctext_alloc = 0;
+   _s2_ctext_bytes = 0;
+   _s2_texreg_byid = _s2_texreg_byname = NULL;
+   _s2_texreg_nslot = 0;
    //_s2_ctext_width = _s2_ctext_height = NULL;
    //_s2_ctext_bitmap = NULL;
    //_s2_ctext_id = NULL;
@@ -6624,14 +6367,44 @@ int s2open(int ifullscreen, int istereo, int iargc, char **iargv) {
    _s2_vralphascaling = 0;  // no scaling by default
    _s2_evas_x = _s2_evas_y = _s2_evas_z = -1.0;
 
+   /* billboards are expanded on the CPU by default */
+   _s2_bbshader = 0;
+
+   /* static dot clouds are always drawn in full by default */
+   _s2_lodpoints = 0;
+
+   /* no frame budget: always draw at full quality */
+   memset(&_s2_governor, 0, sizeof(_S2GOVERNOR));
+
+   /* frame profile: on from the start if S2PLOT_PROFILE names a file
+    * for it to be written to */
+   memset(&_s2_profile, 0, sizeof(_S2PROFILE));
+   {
+     char *s2profile = getenv("S2PLOT_PROFILE");
+     if (s2profile) {
+       _s2_profile.filename = strdup(s2profile);
+       _s2_profile.on = 1;
+     }
+   }
+
+   /* format of recorded frames */
+   {
+     char *s2capture = getenv("S2PLOT_CAPTURE");
+     if (s2capture) {
+       _s2priv_capFormat(s2capture);
+     }
+   }
+
    /* isosurfaces */
    _s2_nisosurf = 0;
    _s2_isosurfs = NULL;
    _s2_fastsurfaces = 1;
 
-   _device_draw = NULL;
-   if (_s2_driver) {
-     loadDevices(_s2_driver);
+   if (!s2winSystem()) {
+     _device_draw = NULL;
+     if (_s2_driver) {
+       loadDevices(_s2_driver);
+     }
    }
    
    /* fade-in */
@@ -6643,6 +6416,10 @@ int s2open(int ifullscreen, int istereo, int iargc, char **iargv) {
      char *s2fadetime = getenv("S2PLOT_FADETIME");
      if (s2fadetime) {
        _s2_fadetime = atof(s2fadetime);
+     } else if (s2winSystem()) {
+       /* offscreen frames are not faded unless asked for */
+       _s2_fadetime = 0.;
+       _s2_fadestatus = 2;
      }
    }
 
@@ -6668,8 +6445,10 @@ int s2open(int ifullscreen, int istereo, int iargc, char **iargv) {
    /* normal (3d) coordinates */
    //_s2_screenco = 0;
    strcpy(_s2_whichscreen, "");
+   _s2_currscreentag = _s2priv_screenTag(_s2_whichscreen);
    _s2_screenEnabled = 0;
    strcpy(_s2_doingScreen, "");
+   _s2_doingScreenBit = 0;
 
    /* command prompt */
    _s2prompt_length = -1; // not prompting
@@ -7982,6 +7761,20 @@ void s2chromacpts(int inp, float *ix, float *iy, float *iz,
 
 /* create a texture with LaTeX commands. */
 unsigned int s2latexture(char *latexcmd, float *aspect) {
+  int width, height;
+  BITMAP4 *bitmap = _s2priv_latexBitmap(latexcmd, aspect, &width, &height);
+  if (!bitmap) {
+    return s2loadtexture("<latex-failed>");
+  }
+  return _s2priv_setupTexture(width, height, bitmap, 1);
+}
+
+/* run LaTeX and read the resulting image, returning NULL (with aspect
+ * set to 1) if any step fails.  Each call works in its own temporary
+ * directory, so this may run in the background loader (s2texload.c).
+ */
+BITMAP4 *_s2priv_latexBitmap(char *latexcmd, float *aspect, 
+			     int *width, int *height) {
 
   char latexbin[200], dvipngbin[200];
   if (getenv("S2PLOT_LATEXBIN")) {
@@ -8043,7 +7836,7 @@ unsigned int s2latexture(char *latexcmd, float *aspect) {
     if (aspect) {
       *aspect = 1.;
     }
-    return s2loadtexture("<latex-failed>");
+    return NULL;
   }
 
   /* generate temporary directory */
@@ -8086,7 +7879,7 @@ unsigned int s2latexture(char *latexcmd, float *aspect) {
     if (aspect) {
       *aspect = 1.;
     }
-    return s2loadtexture("<latex-failed>");
+    return NULL;
   }
   sprintf(command, 
 	  "cd %s && %s -D 300 -T tight s2plot.dvi 2>&1 > /dev/null", 
@@ -8096,7 +7889,7 @@ unsigned int s2latexture(char *latexcmd, float *aspect) {
     if (aspect) {
       *aspect = 1.;
     }
-    return s2loadtexture("<dvipng-failed>");
+    return NULL;
   }
   sprintf(command, 
 	  "cd %s && %s/texturise1.csh -scale+ s2plot1.png s2plot1.tga 2>&1 > texres.txt",
@@ -8106,31 +7899,35 @@ unsigned int s2latexture(char *latexcmd, float *aspect) {
     if (aspect) {
       *aspect = 1.;
     }
-    return s2loadtexture("<texturise1-failed>");
+    return NULL;
   }
   sprintf(command, "%s/texres.txt", tempbase);
   FILE *tmp = fopen(command, "r");
   int texx = 0, texy = 0;
-  if (fgets(command, 255, tmp)) {
+  if (tmp && fgets(command, 255, tmp)) {
     sscanf(command, "%d %d", &texx, &texy);
+    fclose(tmp);
   } else {
+    if (tmp) {
+      fclose(tmp);
+    }
     _s2warn("s2latexture", "cannot obtain texture information");
     if (aspect) {
       *aspect = 1.;
     }
-    return s2loadtexture("<dvipng-failed>");
+    return NULL;
   }
   if (aspect) {
     *aspect = (float)texx / (float)texy;
   }
 
   sprintf(command, "%s/s2plot1.tga", tempbase);
-  unsigned int texnum = ss2lt(command);
+  BITMAP4 *bitmap = _s2priv_readTexture(command, width, height);
 
   sprintf(command, "rm -rf %s", tempbase);
   system(command);
   
-  return texnum;
+  return bitmap;
 }
 
 
@@ -9573,6 +9370,7 @@ void drawView(char *projinfo, double camsca) {
 #if (1)
     // draw the screen geometry
     strcpy(_s2_doingScreen, projinfo);
+    _s2_doingScreenBit = _s2priv_screenBits(_s2_doingScreen);
     glDisable(GL_LIGHTING);
     int tmp = options.rendermode;
     options.rendermode = SHADE_FLAT;
@@ -9580,6 +9378,7 @@ void drawView(char *projinfo, double camsca) {
     glEnable(GL_LIGHTING);
     options.rendermode = tmp;
     strcpy(_s2_doingScreen, "");
+    _s2_doingScreenBit = 0;
 #endif
 
     // draw the panel surround
@@ -9721,7 +9520,7 @@ void handleView(int msx, int msy) {
 	
 	_s2_dragpanel = spid;
 
-	if (strlen(_s2_draghandle->whichscreen)) {
+	if (_s2_draghandle->whichscreen) {
 	  _s2_draghandle_screen = 1;
 	  _s2_draghandle_id = _s2_draghandle->id;
 	  _s2_draghandle_basex = _s2_draghandle->p.x;
@@ -9778,6 +9577,11 @@ void pushVRMLname(char *iname) {
     _s2_currVRMLidx = i;
     return;
   }
+  // primitives store the name index in 16 bits
+  if (_s2_nVRMLnames > USHRT_MAX) {
+    _s2warn("pushVRMLname", "too many distinct VRML names");
+    return;
+  }
 
   _s2_VRMLnames = (char **)realloc(_s2_VRMLnames, 
 				   (_s2_nVRMLnames+1)*sizeof(char *));
@@ -9800,7 +9604,7 @@ int _s2_face3a_compare_colour(const void *va, const void *vb) {
   _S2FACE3A *a = (_S2FACE3A *)va;
   _S2FACE3A *b = (_S2FACE3A *)vb;
   static float cmpstring;
-  cmpstring = strcmp(a->VRMLname, b->VRMLname);
+  cmpstring = (int)a->VRMLname - (int)b->VRMLname;
   if (cmpstring < 0) {
     return -1;
   } else if (cmpstring > 0) {
@@ -9824,7 +9628,7 @@ int _s2_face3_compare_colour(const void *va, const void *vb) {
   FACE3 *a = (FACE3 *)va;
   FACE3 *b = (FACE3 *)vb;
   static float cmpstring;
-  cmpstring = strcmp(a->VRMLname, b->VRMLname);
+  cmpstring = (int)a->VRMLname - (int)b->VRMLname;
   if (cmpstring < 0) {
     return -1;
   } else if (cmpstring > 0) {
@@ -9923,8 +9727,8 @@ void writeVRML20(void) {
 	for (i = 0; i < ndot; ) {
 	  // get start point
 	  while (i < ndot && 
-		 (strcmp(dot[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(dot[i].whichscreen))) {
+		 ((dot[i].VRMLname != nidx) ||
+		  dot[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == ndot) {
@@ -9933,8 +9737,8 @@ void writeVRML20(void) {
 	  // get end point
 	  j = i;
 	  while ((j < ndot) && (dot[i].size == dot[j].size) &&
-		 !strcmp(dot[i].VRMLname, dot[j].VRMLname) &&
-		 !strlen(dot[i].whichscreen) && 
+		 (dot[i].VRMLname == dot[j].VRMLname) &&
+		 !dot[i].whichscreen && 
 		 SAMECOLOUR(dot[i].colour, dot[j].colour)) {
 	    j++;
 	  }
@@ -9953,8 +9757,8 @@ void writeVRML20(void) {
 	for (i = 0; i < nline; ) {
 	  // get start point
 	  while (i < nline && 
-		 (strcmp(line[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(line[i].whichscreen))) {
+		 ((line[i].VRMLname != nidx) ||
+		  line[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nline) {
@@ -9963,8 +9767,8 @@ void writeVRML20(void) {
 	  // get end point
 	  j = i;
 	  while ((j < nline) && (line[i].width == line[j].width) &&
-		 !strcmp(line[i].VRMLname, line[j].VRMLname) && 
-		 !strlen(line[i].whichscreen) && 
+		 (line[i].VRMLname == line[j].VRMLname) && 
+		 !line[i].whichscreen && 
 		 SAMECOLOUR(line[i].colour[0], line[j].colour[0])) {
 	    j++;
 	  }
@@ -9984,8 +9788,8 @@ void writeVRML20(void) {
 	for (i = 0; i < nface4; ) {
 	  // get start point
 	  while ((i < nface4) && 
-		 (strcmp(face4[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(face4[i].whichscreen))) {
+		 ((face4[i].VRMLname != nidx) ||
+		  face4[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nface4) {
@@ -10007,8 +9811,8 @@ void writeVRML20(void) {
 	for (i = 0; i < nface4t; ) {
 	  // get start point
 	  while ((i < nface4t) && 
-		 (strcmp(face4t[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(face4t[i].whichscreen))) {
+		 ((face4t[i].VRMLname != nidx) ||
+		  face4t[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nface4t) {
@@ -10038,8 +9842,8 @@ void writeVRML20(void) {
 	for (i = 0; i < nface3; ) {
 	  // get start point
 	  while ((i < nface3) && 
-		 (strcmp(face3[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(face3[i].whichscreen))) {
+		 ((face3[i].VRMLname != nidx) ||
+		  face3[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nface3) {
@@ -10054,8 +9858,8 @@ void writeVRML20(void) {
 	    // coloured vertices to draw in one set
 	  } else {
 	    while ((j < nface3) &&
-		   !(strcmp(face3[j].VRMLname, _s2_VRMLnames[nidx]) ||
-		     strlen(face3[j].whichscreen)) &&
+		   !((face3[j].VRMLname != nidx) ||
+		     face3[j].whichscreen) &&
 		   S2_COLOURWITHIN(face3[i].colour[0],face3[j].colour[0],0.01) &&
 		   S2_COLOURWITHIN(face3[i].colour[0],face3[j].colour[1],0.01) &&
 		   S2_COLOURWITHIN(face3[i].colour[0],face3[j].colour[2],0.01)) {
@@ -10088,8 +9892,8 @@ void writeVRML20(void) {
 	for (i = 0; i < nface3a; ) {
 	  // get start point
 	  while ((i < nface3a) &&
-		 (strcmp(face3a[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(face3a[i].whichscreen))) {
+		 ((face3a[i].VRMLname != nidx) ||
+		  face3a[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nface3a) {
@@ -10104,8 +9908,8 @@ void writeVRML20(void) {
 	    // coloured vertices to draw in one set
 	  } else {
 	    while ((j < nface3a) &&
-		   !(strcmp(face3a[j].VRMLname, _s2_VRMLnames[nidx]) ||
-		     strlen(face3a[j].whichscreen)) &&
+		   !((face3a[j].VRMLname != nidx) ||
+		     face3a[j].whichscreen) &&
 		   S2_COLOURWITHIN(face3a[i].colour[0],face3a[j].colour[0],0.01) &&
 		   S2_COLOURWITHIN(face3a[i].colour[0],face3a[j].colour[1],0.01) &&
 		   S2_COLOURWITHIN(face3a[i].colour[0],face3a[j].colour[2],0.01)) {
@@ -10131,8 +9935,8 @@ void writeVRML20(void) {
 	for (i = 0; i < nball; ){
 	  // get start point
 	  while ((i < nball) &&
-		 (strcmp(ball[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(ball[i].whichscreen))) {
+		 ((ball[i].VRMLname != nidx) ||
+		  ball[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nball) {
@@ -10155,8 +9959,8 @@ void writeVRML20(void) {
 	for (i = 0; i < ncone; ){
 	  // get start point
 	  while ((i < ncone) &&
-		 (strcmp(cone[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(cone[i].whichscreen) ||
+		 ((cone[i].VRMLname != nidx) ||
+		  cone[i].whichscreen ||
 		  ((cone[i].r2 > EPS) && (cone[i].r1 > EPS)))) {
 	    i++;
 	  }
@@ -10179,8 +9983,8 @@ void writeVRML20(void) {
 	for (i = 0; i < ncone; ){
 	  // get start point
 	  while ((i < ncone) &&
-		 (strcmp(cone[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(cone[i].whichscreen) ||
+		 ((cone[i].VRMLname != nidx) ||
+		  cone[i].whichscreen ||
 		  (fabs(cone[i].r2 - cone[i].r1) > EPS))) {
 	    i++;
 	  }
@@ -10202,8 +10006,8 @@ void writeVRML20(void) {
 	for (i = 0; i < nlabel; ){
 	  // get start point
 	  while ((i < nlabel) &&
-		 (strcmp(label[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(label[i].whichscreen))) {
+		 ((label[i].VRMLname != nidx) ||
+		  label[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nlabel) {
@@ -10224,8 +10028,8 @@ void writeVRML20(void) {
 	for (i = 0; i < nbboard; ) {
 	  // get start point
 	  while ((i < nbboard) && 
-		 (strcmp(bboard[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(bboard[i].whichscreen))) {
+		 ((bboard[i].VRMLname != nidx) ||
+		  bboard[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nbboard) {
@@ -10248,8 +10052,8 @@ void writeVRML20(void) {
 	for (i = 0; i < nhandle; ) {
 	  // get start point
 	  while ((i < nhandle) && 
-		 (strcmp(handle[i].VRMLname, _s2_VRMLnames[nidx]) ||
-		  strlen(handle[i].whichscreen))) {
+		 ((handle[i].VRMLname != nidx) ||
+		  handle[i].whichscreen)) {
 	    i++;
 	  }
 	  if (i == nhandle) {
@@ -11215,6 +11019,10 @@ void ss2wtga(char *fname) {
   }
 }
 
+void ss2scap(char *format) {
+  _s2priv_capFormat(format);
+}
+
 unsigned char *ss2gpix(unsigned int *width, unsigned int *height) {
   *width = options.screenwidth;
   *height = options.screenheight;
@@ -11508,6 +11316,14 @@ void loadDevices(char *drivername) {
     } else {
       _device_keybd = (int (*)(char))initializer;
     }
+
+    sprintf(method_name, "winsys_%s", drivername);
+    initializer = dlsym(sdl_library, method_name);
+    if (initializer != NULL) {
+      // the driver replaces the window system (eg. offscreen rendering)
+      S2WINSYS *(*winsysfn)(void) = (S2WINSYS *(*)(void))initializer;
+      s2winSetSystem((*winsysfn)());
+    }
   }  
 }
 
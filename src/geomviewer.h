@@ -125,6 +125,9 @@ void CleanExit(void);
 
 // misc.c
 void CreateASphere(XYZ,double,int,int,int);
+void DrawSphereInstance(XYZ,double,int);
+void DrawDiskInstance(XYZ,XYZ,double,double,int);
+void DrawConeInstance(XYZ,XYZ,double,double,int);
 void CreateAPlanet(XYZ,double,int,int,int,float,XYZ,float);
 void GiveUsage(char *);
 int  ReadVector(FILE *,XYZ *);
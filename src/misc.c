@@ -93,6 +93,301 @@ void CreateASphere(XYZ c,double r,int n,int twidth,int theight)
    }
 }
 
+/*
+   Cached unit meshes for balls, disks and cones.
+	Rather than recomputing cos/sin for every vertex of every object,
+	one unit sphere is built per resolution and each ball is drawn as
+	an instance of it: a translate and scale on the modelview matrix
+	and a call of the mesh's display list.  Disks and cones can not be
+	scaled from a single unit mesh (their two radii vary per object),
+	so their vertices are filled from a cached table of ring
+	directions and drawn from an array.
+*/
+#define UNITMESHCACHE 8
+
+typedef struct {
+   int n;            /* resolution, 0 if the slot is unused */
+   int nvtx;
+   GLfloat *vtx;     /* interleaved GL_T2F_N3F_V3F */
+   GLuint list;      /* display list of the mesh, 0 if not compiled */
+} UNITMESH;
+
+static UNITMESH unitsphere[UNITMESHCACHE];
+static UNITMESH unitring[UNITMESHCACHE];
+static int nextsphere = 0, nextring = 0;
+
+/*
+   Take a cache slot for a new mesh of resolution n and nvtx vertices,
+	recycling the oldest slot when the cache is full
+*/
+static UNITMESH *UnitMeshSlot(UNITMESH *cache,int *next,int n,int nvtx)
+{
+   UNITMESH *m;
+   GLfloat *v;
+
+   m = &(cache[*next]);
+   *next = (*next + 1) % UNITMESHCACHE;
+   if (m->list != 0) {
+      glDeleteLists(m->list,1);
+      m->list = 0;
+   }
+   m->n = 0;
+   if ((v = (GLfloat *)realloc(m->vtx,nvtx * 8 * sizeof(GLfloat))) == NULL)
+      return(NULL);
+   m->vtx = v;
+   m->n = n;
+   m->nvtx = nvtx;
+   return(m);
+}
+
+/*
+   The unit sphere of (even) resolution n, as quads with the same
+	vertices, normals and texture coordinates as CreateASphere
+*/
+static UNITMESH *UnitSphere(int n)
+{
+   int i,j,k,nn;
+   double theta1,theta2,theta3;
+   GLfloat *v;
+   UNITMESH *m;
+
+   nn = n/2;
+   for (i=0;i<UNITMESHCACHE;i++) {
+      if (unitsphere[i].n == n)
+         return(&(unitsphere[i]));
+   }
+   if ((m = UnitMeshSlot(unitsphere,&nextsphere,n,4*n*nn)) == NULL)
+      return(NULL);
+
+   v = m->vtx;
+   for (j=0;j<nn;j++) {
+      theta1 = j * TWOPI / n - PID2;
+      theta2 = (j + 1) * TWOPI / n - PID2;
+      for (i=0;i<n;i++) {
+         for (k=0;k<4;k++) {
+            /* quad corners in the strip's winding, starting on the
+               lower ring so each quad is split as the strip's is */
+            int ii = i + (k == 1 || k == 2);
+            double theta = (k == 2 || k == 3) ? theta2 : theta1;
+            theta3 = ii * TWOPI / n;
+            v[0] = ii / (double)n;
+            v[1] = 2 * (j + (k == 2 || k == 3)) / (double)n;
+            v[2] = v[5] = cos(theta) * cos(theta3);
+            v[3] = v[6] = sin(theta);
+            v[4] = v[7] = cos(theta) * sin(theta3);
+            v += 8;
+         }
+      }
+   }
+   return(m);
+}
+
+/*
+   Draw a ball of radius r centred at c as an instance of the cached
+	unit sphere of resolution n.  The caller enables GL_NORMALIZE
+	(or equivalent) so the scaled normals stay unit length.
+*/
+void DrawSphereInstance(XYZ c,double r,int n)
+{
+   GLint compiling;
+   UNITMESH *m;
+
+   if (r < 0)
+      r = -r;
+   if (n < 0)
+      n = -n;
+   if (n < 4 || r <= 0) {
+      glBegin(GL_POINTS);
+      glVertex3f(c.x,c.y,c.z);
+      glEnd();
+      return;
+   }
+   n /= 2;
+   n *= 2;
+   if ((m = UnitSphere(n)) == NULL) {
+      CreateASphere(c,r,n,1,1);
+      return;
+   }
+
+   glPushMatrix();
+   glTranslatef(c.x,c.y,c.z);
+   glScalef(r,r,r);
+   if (m->list == 0) {
+      /* lists can not be created while another is being compiled */
+      glGetIntegerv(GL_LIST_INDEX,&compiling);
+      if (compiling == 0 && (m->list = glGenLists(1)) != 0) {
+         glNewList(m->list,GL_COMPILE);
+         glInterleavedArrays(GL_T2F_N3F_V3F,0,m->vtx);
+         glDrawArrays(GL_QUADS,0,m->nvtx);
+         glEndList();
+         glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+         glDisableClientState(GL_NORMAL_ARRAY);
+         glDisableClientState(GL_VERTEX_ARRAY);
+      }
+   }
+   if (m->list != 0) {
+      glCallList(m->list);
+   } else {
+      glInterleavedArrays(GL_T2F_N3F_V3F,0,m->vtx);
+      glDrawArrays(GL_QUADS,0,m->nvtx);
+      glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+      glDisableClientState(GL_NORMAL_ARRAY);
+      glDisableClientState(GL_VERTEX_ARRAY);
+   }
+   glPopMatrix();
+}
+
+/*
+   The cached cos/sin table of a full ring of m segments, stored in
+	the texture coordinate (i/m) and normal (cos,sin,0) slots
+*/
+static UNITMESH *UnitRing(int m)
+{
+   int i;
+   double theta;
+   UNITMESH *u;
+
+   for (i=0;i<UNITMESHCACHE;i++) {
+      if (unitring[i].n == m)
+         return(&(unitring[i]));
+   }
+   if ((u = UnitMeshSlot(unitring,&nextring,m,m+1)) == NULL)
+      return(NULL);
+   for (i=0;i<=m;i++) {
+      theta = i * TWOPI / m;
+      u->vtx[8*i]   = i / (double)m;
+      u->vtx[8*i+2] = cos(theta);
+      u->vtx[8*i+3] = sin(theta);
+   }
+   return(u);
+}
+
+/*
+   Fill and draw a quad strip between two rings of the cached table:
+	ring k is centred at c[k] with radius r[k] in the plane spanned by
+	perp and q.  If n is NULL the ring directions are the normals.
+*/
+static void DrawRingStrip(UNITMESH *u,XYZ *c,double *r,
+   XYZ perp,XYZ q,XYZ *n)
+{
+   static GLfloat *vtx = NULL;
+   static int nvtx = 0;
+   int i,k;
+   GLfloat *v,*t;
+   XYZ d;
+
+   if (nvtx < 2*u->nvtx) {
+      if ((v = (GLfloat *)realloc(vtx,2*u->nvtx*8*sizeof(GLfloat))) == NULL)
+         return;
+      vtx = v;
+      nvtx = 2*u->nvtx;
+   }
+
+   v = vtx;
+   for (i=0;i<u->nvtx;i++) {
+      t = u->vtx + 8*i;
+      d.x = t[2] * perp.x + t[3] * q.x;
+      d.y = t[2] * perp.y + t[3] * q.y;
+      d.z = t[2] * perp.z + t[3] * q.z;
+      if (n == NULL)
+         Normalise(&d);
+      for (k=0;k<2;k++) {
+         v[0] = t[0];
+         v[1] = k;
+         if (n == NULL) {
+            v[2] = d.x;
+            v[3] = d.y;
+            v[4] = d.z;
+         } else {
+            v[2] = n->x;
+            v[3] = n->y;
+            v[4] = n->z;
+         }
+         v[5] = c[k].x + r[k] * d.x;
+         v[6] = c[k].y + r[k] * d.y;
+         v[7] = c[k].z + r[k] * d.z;
+         v += 8;
+      }
+   }
+
+   glInterleavedArrays(GL_T2F_N3F_V3F,0,vtx);
+   glDrawArrays(GL_QUAD_STRIP,0,2*u->nvtx);
+   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+   glDisableClientState(GL_NORMAL_ARRAY);
+   glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+/*
+   Two unit vectors perp and q spanning the plane normal to n,
+	as chosen by CreateDisk and CreateCone
+*/
+static void RingBasis(XYZ n,XYZ *perp,XYZ *q)
+{
+   XYZ p,u;
+
+   p = n;
+   if (n.x == 0 && n.z == 0)
+      p.x += 1;
+   else
+      p.y += 1;
+   CROSSPROD(p,n,u);
+   CROSSPROD(n,u,p);
+   Normalise(&p);
+   Normalise(&u);
+   *perp = p;
+   *q = u;
+}
+
+/*
+   Draw a full disk centered at c, with normal n, inner radius r0
+	and outer radius r1, of m segments: CreateDisk(c,n,r0,r1,m,0,TWOPI)
+	from the cached ring table
+*/
+void DrawDiskInstance(XYZ c,XYZ n,double r0,double r1,int m)
+{
+   XYZ cc[2],perp,q;
+   double r[2];
+   UNITMESH *u;
+
+   if (m < 1 || (u = UnitRing(m)) == NULL) {
+      CreateDisk(c,n,r0,r1,m,0.0,TWOPI);
+      return;
+   }
+   Normalise(&n);
+   RingBasis(n,&perp,&q);
+   cc[0] = cc[1] = c;
+   r[0] = r0;
+   r[1] = r1;
+   DrawRingStrip(u,cc,r,perp,q,&n);
+}
+
+/*
+   Draw a full uncapped cone between p1 and p2 with radii r1 and r2,
+	of m segments: CreateCone(p1,p2,r1,r2,m,0,TWOPI) from the cached
+	ring table
+*/
+void DrawConeInstance(XYZ p1,XYZ p2,double r1,double r2,int m)
+{
+   XYZ cc[2],n,perp,q;
+   double r[2];
+   UNITMESH *u;
+
+   if (m < 1 || (u = UnitRing(m)) == NULL) {
+      CreateCone(p1,p2,r1,r2,m,0.0,TWOPI);
+      return;
+   }
+   n.x = p1.x - p2.x;
+   n.y = p1.y - p2.y;
+   n.z = p1.z - p2.z;
+   Normalise(&n);
+   RingBasis(n,&perp,&q);
+   cc[0] = p1;
+   cc[1] = p2;
+   r[0] = r1;
+   r[1] = r2;
+   DrawRingStrip(u,cc,r,perp,q,NULL);
+}
+
 /*
    Create a planet, which is a sphere, but with control over 
    placement of texture, and then rotation of sphere.
@@ -0,0 +1,651 @@
+/* s2batch.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Batched drawing of facets, dots, lines and labels.
+ *
+ * Rather than issuing glBegin/glVertex for every primitive, MakeGeometry
+ * packs these lists into an array of interleaved vertices plus a list
+ * of batches - runs of vertices that share the same GL state - and draws
+ * each batch with a single glDrawArrays.  Static geometry is packed
+ * into the panel's GL_static list, uploaded once to a GL vertex buffer,
+ * and only re-packed when the list is marked dirty (see
+ * _s2priv_listChanged and MakeGeometry(TRUE, ...)).  Dynamic geometry
+ * is packed into the panel's GL_dynamic list once each time the
+ * callback rebuilds it, and streamed into a ring of GL buffers.
+ *
+ * Screen geometry is packed alongside the world geometry, in screen
+ * coordinates and tagged with the screens it belongs on, and is drawn
+ * through a projection that maps it straight onto the viewport.  So
+ * nothing is re-packed per eye or per panel redraw: stereo and
+ * multi-panel frames replay the same batches with different matrices.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+#include <stddef.h>
+
+/* screen bits of a primitive: 0 for world geometry, else the screens
+ * its tag is drawn on */
+#if defined(BUILDING_S2PLOT)
+#define _S2BATCHBITS(x) ((x).whichscreen ? _s2_screentagbits[(x).whichscreen] : 0)
+#else
+#define _S2BATCHBITS(x) (0)
+#endif
+
+/* append in vertices to the list, returning a pointer to the first */
+static _S2BATCHVTX *_s2priv_batchVertices(_S2BATCHLIST *bl, int in) {
+  _S2BATCHVTX *base;
+  bl->vtx = (_S2BATCHVTX *)_s2priv_arenaReserve(bl->vtx, bl->nvtx, in,
+						 sizeof(_S2BATCHVTX));
+  if (!bl->vtx) {
+    bl->nvtx = 0;
+    _s2error("(internal)", "failed to allocate memory for vertex batch");
+  }
+  base = bl->vtx + bl->nvtx;
+  bl->nvtx += in;
+  return base;
+}
+
+/* start (or continue) a batch for vertices about to be appended */
+static void _s2priv_batchState(_S2BATCHLIST *bl, int mode, int lit, 
+			       unsigned char screen, char trans, float size,
+			       int sfac, unsigned short spat,
+			       unsigned int cell) {
+  _S2BATCH *b = bl->nbatch ? bl->batch + bl->nbatch - 1 : NULL;
+  if (b && (b->mode == mode) && (b->lit == lit) && (b->screen == screen) &&
+      (b->trans == trans) && (b->size == size) && (b->cell == cell) &&
+      (b->stipple_factor == sfac) && (b->stipple_pattern == spat) &&
+      (b->first + b->count == bl->nvtx)) {
+    return;
+  }
+  if (b && !b->count) {
+    /* previous batch is empty: re-use it */
+    bl->nbatch--;
+  }
+  bl->batch = (_S2BATCH *)_s2priv_arenaReserve(bl->batch, bl->nbatch, 1,
+					       sizeof(_S2BATCH));
+  if (!bl->batch) {
+    bl->nbatch = 0;
+    _s2error("(internal)", "failed to allocate memory for vertex batch");
+  }
+  b = bl->batch + bl->nbatch;
+  b->mode = mode;
+  b->lit = lit;
+  b->screen = screen;
+  b->trans = trans;
+  b->first = bl->nvtx;
+  b->count = 0;
+  b->size = size;
+  b->stipple_factor = sfac;
+  b->stipple_pattern = spat;
+  b->cell = cell;
+  b->lod = b->nlod = 0;
+  bl->nbatch++;
+}
+
+/* fill a vertex: position (world coordinates, or screen coordinates
+ * for screen geometry), normal and colour (desaturated on devices 
+ * without colour) */
+static void _s2priv_batchFill(_S2BATCHVTX *v, XYZ p, XYZ *n,
+			      COLOUR col, float alpha) {
+  v->p[0] = p.x;
+  v->p[1] = p.y;
+  v->p[2] = p.z;
+  if (n) {
+    v->n[0] = n->x;
+    v->n[1] = n->y;
+    v->n[2] = n->z;
+  } else {
+    v->n[0] = 0.;
+    v->n[1] = 0.;
+    v->n[2] = -1.;
+  }
+#if defined(BUILDING_S2PLOT)
+  if (_s2_devcap & _S2DEVCAP_NOCOLOR) {
+    v->c[0] = v->c[1] = v->c[2] = (col.r + col.g + col.b) * 0.33;
+  } else
+#endif
+    {
+      v->c[0] = col.r;
+      v->c[1] = col.g;
+      v->c[2] = col.b;
+    }
+  v->c[3] = alpha;
+}
+
+/* pack the current face3, face4, label, dot and line lists into bl.
+ * World and screen geometry are packed together; screen geometry is
+ * kept in screen coordinates, so the same batches serve every eye,
+ * screen and panel.  If spatial is set, the world geometry of each
+ * list is packed in order of its cell on a grid (see s2cull.c), so
+ * that the batches can be culled against the view. */
+void _s2priv_packBatches(_S2BATCHLIST *bl, int spatial) {
+  static XYZ linelist[300*MAXLABELLEN];
+  static _S2SORTKEYS order;
+  _S2CULLGRID grid;
+  int nlinelist = 0;
+  _S2BATCHVTX *v;
+  unsigned char bits;
+  unsigned int cell = 0;
+  int i, j, k;
+
+  bl->nvtx = 0;
+  bl->nbatch = 0;
+
+  grid.ncell = 1;
+  if (spatial) {
+    _s2priv_cullGrid(&grid);
+  }
+
+  /* order list items x[0..n-1] by the grid cell of their point pt
+   * (screen items first, in their own order); _S2PACKNEXT(k) then
+   * sets i to the k'th item to pack, and cell to its cell */
+#define _S2PACKORDER(x, n, pt)						\
+  if (grid.ncell > 1) {							\
+    _s2priv_sortReserve(&order, (n));					\
+    for (k = 0; k < (n); k++) {						\
+      order.key[k] = _S2BATCHBITS((x)[k]) ? 0 :				\
+	_s2priv_cullCell(&grid, (x)[k].pt) + 1;				\
+    }									\
+    _s2priv_sortKeys(&order);						\
+  }
+#define _S2PACKNEXT(k)							\
+  if (grid.ncell > 1) {							\
+    i = order.idx[(k)];							\
+    cell = order.key[(k)];						\
+  } else {								\
+    i = (k);								\
+  }
+
+  // 3 vertex faces
+  _S2PACKORDER(face3, nface3, p[0]);
+  for (k = 0; k < nface3; k++) {
+    _S2PACKNEXT(k);
+    bits = _S2BATCHBITS(face3[i]);
+#if defined(BUILDING_S2PLOT)
+    if (face3[i].whichscreen && !bits) {
+      continue;
+    }
+#endif
+    _s2priv_batchState(bl, GL_TRIANGLES, 1, bits, 0, 0, 0, 0, cell);
+    v = _s2priv_batchVertices(bl, 3);
+    for (j = 0; j < 3; j++) {
+      _s2priv_batchFill(v + j, face3[i].p[j], bits ? NULL : &(face3[i].n[j]),
+			face3[i].colour[j], transparency);
+    }
+    bl->batch[bl->nbatch-1].count += 3;
+  }
+
+  // 4 vertex faces
+  _S2PACKORDER(face4, nface4, p[0]);
+  for (k = 0; k < nface4; k++) {
+    _S2PACKNEXT(k);
+    bits = _S2BATCHBITS(face4[i]);
+#if defined(BUILDING_S2PLOT)
+    if (face4[i].whichscreen && !bits) {
+      continue;
+    }
+#endif
+    _s2priv_batchState(bl, GL_QUADS, 1, bits, 0, 0, 0, 0, cell);
+    v = _s2priv_batchVertices(bl, 4);
+    for (j = 0; j < 4; j++) {
+      _s2priv_batchFill(v + j, face4[i].p[j], bits ? NULL : &(face4[i].n[j]),
+			face4[i].colour[j], transparency);
+    }
+    bl->batch[bl->nbatch-1].count += 4;
+  }
+
+  // Labels: drawn as line segments at the default width
+  _S2PACKORDER(label, nlabel, p);
+  for (k = 0; k < nlabel; k++) {
+    _S2PACKNEXT(k);
+    bits = _S2BATCHBITS(label[i]);
+#if defined(BUILDING_S2PLOT)
+    if (label[i].whichscreen && !bits) {
+      continue;
+    }
+#endif
+    CreateLabelVector(label[i].s, label[i].p, label[i].right, label[i].up,
+		      linelist, &nlinelist);
+    nlinelist -= nlinelist % 2;
+    if (nlinelist < 2) {
+      continue;
+    }
+    _s2priv_batchState(bl, GL_LINES, 0, bits, 0, 1, 0, 0, cell);
+    v = _s2priv_batchVertices(bl, nlinelist);
+    for (j = 0; j < nlinelist; j++) {
+      _s2priv_batchFill(v + j, linelist[j], NULL, label[i].colour,
+			transparency);
+    }
+    bl->batch[bl->nbatch-1].count += nlinelist;
+  }
+
+  // Points: sizes are whole pixels, as they always have been
+  _S2PACKORDER(dot, ndot, p);
+  for (k = 0; k < ndot; k++) {
+    _S2PACKNEXT(k);
+    bits = _S2BATCHBITS(dot[i]);
+#if defined(BUILDING_S2PLOT)
+    if (dot[i].whichscreen && !bits) {
+      continue;
+    }
+#endif
+    _s2priv_batchState(bl, GL_POINTS, 0, bits, 0, (int)dot[i].size, 0, 0,
+		       cell);
+    v = _s2priv_batchVertices(bl, 1);
+    _s2priv_batchFill(v, dot[i].p, NULL, dot[i].colour, transparency);
+    bl->batch[bl->nbatch-1].count++;
+  }
+
+  // Lines
+  _S2PACKORDER(line, nline, p[0]);
+  for (k = 0; k < nline; k++) {
+    _S2PACKNEXT(k);
+    bits = _S2BATCHBITS(line[i]);
+#if defined(BUILDING_S2PLOT)
+    if (line[i].whichscreen && !bits) {
+      continue;
+    }
+    _s2priv_batchState(bl, GL_LINES, 0, bits, 0, (int)line[i].width,
+		       line[i].stipple_factor, line[i].stipple_pattern, cell);
+#else
+    _s2priv_batchState(bl, GL_LINES, 0, bits, 0, (int)line[i].width, 0, 0,
+		       cell);
+#endif
+    v = _s2priv_batchVertices(bl, 2);
+    for (j = 0; j < 2; j++) {
+#if defined(BUILDING_S2PLOT)
+      _s2priv_batchFill(v + j, line[i].p[j], NULL, line[i].colour[j],
+			line[i].alpha);
+#else
+      _s2priv_batchFill(v + j, line[i].p[j], NULL, line[i].colour[j],
+			transparency);
+#endif
+    }
+    bl->batch[bl->nbatch-1].count += 2;
+  }
+#undef _S2PACKORDER
+#undef _S2PACKNEXT
+
+  _s2priv_cullBounds(bl);
+  bl->nlod = 0;
+#if defined(BUILDING_S2PLOT)
+  if (spatial && _s2_lodpoints) {
+    _s2priv_lodBuild(bl);
+  }
+#endif
+  bl->dirty = 0;
+}
+
+#if defined(BUILDING_S2PLOT)
+/* Transparent facets and points.
+ *
+ * face3a and trdot primitives each carry a blending class: 'o' opaque,
+ * 's' alpha blended or 't' additive.  Their order depends on the
+ * camera, so they are packed afresh for each view into a list of
+ * their own.  Opaque primitives go first, then the blended ones, back
+ * to front, then the additive ones, which need no sort since addition
+ * does not depend on order.  Within a class, runs sharing the same
+ * state become single batches, whose blend state _s2priv_drawBatches
+ * sets once per run.
+ */
+
+/* is transparent primitive x part of this view? */
+#define _S2TRANSDRAWN(x, doscreen) ((doscreen) ? _S2ONSCREEN((x).whichscreen) : !(x).whichscreen)
+
+/* set the blending and depth writing for a transparency class */
+void _s2priv_transState(char trans) {
+  if (trans == 't') {
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+  } else if (trans == 's') {
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  } else {
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+  }
+}
+
+/* sort key for a transparent primitive: the class in the top two bits,
+ * and below that its depth for blended primitives (farthest first), or
+ * for the others a value to group them by, as their order is free */
+unsigned int _s2priv_transKey(int trans, float depth, float group) {
+  switch (trans) {
+  case 's':
+    return 0x40000000u | (_s2priv_depthKey(depth, 1) >> 2);
+  case 't':
+    return 0x80000000u | (_s2priv_depthKey(group, 0) >> 2);
+  default:
+    return _s2priv_depthKey(group, 0) >> 2;
+  }
+}
+
+/* depth of p for back to front ordering: squared distance from the
+ * camera for world geometry, window depth for screen geometry */
+float _s2priv_transDepth(XYZ p, int doscreen) {
+  if (doscreen) {
+    return p.z;
+  }
+  return (camera.vp.x - p.x) * (camera.vp.x - p.x) +
+    (camera.vp.y - p.y) * (camera.vp.y - p.y) +
+    (camera.vp.z - p.z) * (camera.vp.z - p.z);
+}
+
+/* pack the face3a and trdot lists into bl for this view: the world
+ * geometry, or with doscreen the screen geometry for
+ * _s2_doingScreenBit.  Facets are packed lit and points unlit, so
+ * each can be drawn at its place in MakeGeometry. */
+void _s2priv_packTransparent(_S2BATCHLIST *bl, int doscreen) {
+  static _S2SORTKEYS tsort;
+  static int *sel = NULL;
+  static int nsel = 0;
+  unsigned char bits = doscreen ? _s2_doingScreenBit : 0;
+  _S2BATCHVTX *v;
+  char trans;
+  XYZ c;
+  int i, j, k, n;
+
+  bl->nvtx = 0;
+  bl->nbatch = 0;
+
+  if (nface3a + ntrdot > nsel) {
+    nsel = nface3a + ntrdot;
+    sel = (int *)realloc(sel, nsel * sizeof(int));
+    if (!sel) {
+      nsel = 0;
+      _s2error("(internal)", "memory allocation failed for transparency sort");
+    }
+  }
+
+  // 3 vertex transparent faces
+  _s2priv_sortReserve(&tsort, nface3a);
+  for (i = 0, n = 0; i < nface3a; i++) {
+    if (!_S2TRANSDRAWN(face3a[i], doscreen)) {
+      continue;
+    }
+    if (face3a[i].trans == 's') {
+      c.x = (face3a[i].p[0].x + face3a[i].p[1].x + face3a[i].p[2].x) / 3.;
+      c.y = (face3a[i].p[0].y + face3a[i].p[1].y + face3a[i].p[2].y) / 3.;
+      c.z = (face3a[i].p[0].z + face3a[i].p[1].z + face3a[i].p[2].z) / 3.;
+      face3a[i].dist = _s2priv_transDepth(c, doscreen);
+    }
+    tsort.key[n] = _s2priv_transKey(face3a[i].trans, face3a[i].dist, 0.);
+    sel[n++] = i;
+  }
+  tsort.n = n;
+  _s2priv_sortKeys(&tsort);
+  for (k = 0; k < n; k++) {
+    i = sel[tsort.idx[k]];
+    trans = (face3a[i].trans == 's' || face3a[i].trans == 't') ? 
+      face3a[i].trans : 'o';
+    _s2priv_batchState(bl, GL_TRIANGLES, 1, bits, trans, 0, 0, 0, 0);
+    v = _s2priv_batchVertices(bl, 3);
+    for (j = 0; j < 3; j++) {
+      _s2priv_batchFill(v + j, face3a[i].p[j], doscreen ? NULL : &(face3a[i].n[j]),
+			face3a[i].colour[j], face3a[i].alpha[j]);
+    }
+    bl->batch[bl->nbatch-1].count += 3;
+  }
+
+  // transparent points, grouped by size where order does not matter
+  _s2priv_sortReserve(&tsort, ntrdot);
+  for (i = 0, n = 0; i < ntrdot; i++) {
+    if (!_S2TRANSDRAWN(trdot[i], doscreen)) {
+      continue;
+    }
+    tsort.key[n] = _s2priv_transKey(trdot[i].trans, 
+				    (trdot[i].trans == 's') ? 
+				    _s2priv_transDepth(trdot[i].p, doscreen) : 0.,
+				    trdot[i].size);
+    sel[n++] = i;
+  }
+  tsort.n = n;
+  _s2priv_sortKeys(&tsort);
+  for (k = 0; k < n; k++) {
+    i = sel[tsort.idx[k]];
+    trans = (trdot[i].trans == 's' || trdot[i].trans == 't') ? 
+      trdot[i].trans : 'o';
+    _s2priv_batchState(bl, GL_POINTS, 0, bits, trans, trdot[i].size, 0, 0,
+		       0);
+    v = _s2priv_batchVertices(bl, 1);
+    _s2priv_batchFill(v, trdot[i].p, NULL, trdot[i].colour, trdot[i].alpha);
+    bl->batch[bl->nbatch-1].count++;
+  }
+  _s2priv_cullBounds(bl);
+}
+#endif
+
+/* copy the packed vertices of bl to a GL vertex buffer, creating or
+ * growing the buffer as needed.  Lists with more than one buffer
+ * (dynamic geometry) write each upload into the next buffer of the
+ * ring, so the CPU never waits on a buffer from a frame still being
+ * drawn.  If no buffer can be made, bl is left to be drawn from client
+ * memory. */
+void _s2priv_uploadBatches(_S2BATCHLIST *bl) {
+  int k = (bl->nvbo > 1) ? (bl->curvbo + 1) % bl->nvbo : 0;
+  GLuint vbo = bl->vbo[k];
+  if (!vbo) {
+    glGenBuffers(1, &vbo);
+    if (!vbo) {
+      return;
+    }
+    bl->vbo[k] = vbo;
+    bl->vbocap[k] = 0;
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  if (bl->nvtx > bl->vbocap[k]) {
+    /* size to the store's capacity, so the buffer grows as rarely as
+     * the store does */
+    bl->vbocap[k] = _s2priv_arenaCapacity(bl->vtx);
+    glBufferData(GL_ARRAY_BUFFER, bl->vbocap[k] * sizeof(_S2BATCHVTX), NULL,
+		 (bl->nvbo > 1) ? GL_STREAM_DRAW : GL_STATIC_DRAW);
+  }
+  if (bl->nvtx) {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bl->nvtx * sizeof(_S2BATCHVTX),
+		    bl->vtx);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  bl->curvbo = k;
+}
+
+/* load a projection taking screen coordinates straight to the window:
+ * x and y in [0,1] across the (unclipped) viewport view, offset by off
+ * pixels, and z to window depth - exactly where the old per-vertex
+ * unprojection put screen geometry */
+static void _s2priv_screenProjection(GLint *view, float off) {
+  GLint vp[4];
+  GLdouble m[16];
+  glGetIntegerv(GL_VIEWPORT, vp);
+  memset(m, 0, 16 * sizeof(GLdouble));
+  m[0] = 2. * view[2] / vp[2];
+  m[5] = 2. * view[3] / vp[3];
+  m[10] = 2.;
+  m[12] = 2. * (view[0] + off - vp[0]) / vp[2] - 1.;
+  m[13] = 2. * (view[1] + off - vp[1]) / vp[3] - 1.;
+  m[14] = -1.;
+  m[15] = 1.;
+  glMatrixMode(GL_PROJECTION);
+  glLoadMatrixd(m);
+  glMatrixMode(GL_MODELVIEW);
+}
+
+/* draw the batches of bl that are lit (facets) or unlit (the rest).
+ * With view NULL the world geometry is drawn with the current 
+ * matrices; otherwise the screen geometry for _s2_doingScreenBit is 
+ * drawn across the viewport view. */
+void _s2priv_drawBatches(_S2BATCHLIST *bl, int lit, GLint *view) {
+  _S2BATCH *b;
+  char *base;
+  GLuint vbo;
+  int i;
+  float oldpointsize = -1., oldlinewidth = -1.;
+  char oldtrans = 0;
+  unsigned char want = 0;
+  float off, oldoff = -1.;
+  _S2FRUSTUM fr;
+  int first, count;
+#if defined(BUILDING_S2PLOT)
+  int lod = 0;
+  int oldsfac = -1;
+  unsigned short oldspat = 0;
+  if (view) {
+    want = _s2_doingScreenBit;
+  }
+#endif
+
+#define _S2BATCHDRAWN(b) ((b)->lit == lit && (b)->count && \
+			  (view ? ((b)->screen & want) : !(b)->screen))
+  for (i = 0; i < bl->nbatch && !_S2BATCHDRAWN(bl->batch + i); i++) ;
+  if (i == bl->nbatch) {
+    return;
+  }
+
+  vbo = bl->nvbo ? bl->vbo[bl->curvbo] : 0;
+  if (vbo) {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    base = NULL;
+  } else {
+    base = (char *)bl->vtx;
+  }
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(3, GL_FLOAT, sizeof(_S2BATCHVTX),
+		  base + offsetof(_S2BATCHVTX, p));
+  glColorPointer(4, GL_FLOAT, sizeof(_S2BATCHVTX),
+		 base + offsetof(_S2BATCHVTX, c));
+  if (lit) {
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glNormalPointer(GL_FLOAT, sizeof(_S2BATCHVTX),
+		    base + offsetof(_S2BATCHVTX, n));
+  }
+  if (view) {
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+  } else {
+    _s2priv_cullFrustum(&fr);
+#if defined(BUILDING_S2PLOT)
+    lod = bl->nlod && _s2_panels[_s2_activepanel].lodmoving;
+#endif
+  }
+
+  for (; i < bl->nbatch; i++) {
+    b = bl->batch + i;
+    if (!_S2BATCHDRAWN(b)) {
+      continue;
+    }
+    if (!view && !_s2priv_cullBox(&fr, b->lo, b->hi)) {
+      continue;
+    }
+    if (view) {
+      /* screen points and transparent facets have always been placed
+       * without the half pixel offset the other screen primitives get */
+      off = (b->mode == GL_POINTS || b->trans) ? 0. : 0.5;
+      if (off != oldoff) {
+	_s2priv_screenProjection(view, off);
+	oldoff = off;
+      }
+    }
+#if defined(BUILDING_S2PLOT)
+    if (b->trans != oldtrans) {
+      _s2priv_transState(b->trans);
+      oldtrans = b->trans;
+    }
+#endif
+    if (b->mode == GL_POINTS && b->size != oldpointsize) {
+#if defined(BUILDING_VIEWER)
+      if (options.stereo == INTERSTEREO) {
+	glPointSize(options.pointscale*b->size<2. ? 2. : options.pointscale*b->size);
+      } else {
+	glPointSize(options.pointscale*b->size);
+      }
+#else
+      glPointSize(options.pointscale*b->size);
+#endif
+      oldpointsize = b->size;
+    } else if (b->mode == GL_LINES) {
+      if (b->size != oldlinewidth) {
+	glLineWidth(options.linescale*b->size);
+	oldlinewidth = b->size;
+      }
+#if defined(BUILDING_S2PLOT)
+      if (b->stipple_factor != oldsfac || b->stipple_pattern != oldspat) {
+	oldsfac = b->stipple_factor;
+	oldspat = b->stipple_pattern;
+	if (oldsfac > 0) {
+	  glLineStipple(oldsfac, oldspat);
+	  glEnable(GL_LINE_STIPPLE);
+	} else {
+	  glDisable(GL_LINE_STIPPLE);
+	}
+      }
+#endif
+    }
+    first = b->first;
+    count = b->count;
+#if defined(BUILDING_S2PLOT)
+    if (lod) {
+      _s2priv_lodRange(&fr, bl, b, &first, &count);
+    }
+#endif
+    glDrawArrays(b->mode, first, count);
+  }
+#undef _S2BATCHDRAWN
+
+  if (view) {
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+  }
+  if (lit) {
+    glDisableClientState(GL_NORMAL_ARRAY);
+  }
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  if (vbo) {
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+  glPointSize(options.pointscale);
+  glLineWidth(options.linescale);
+#if defined(BUILDING_S2PLOT)
+  glDisable(GL_LINE_STIPPLE);
+  if (oldtrans) {
+    _s2priv_transState('o');
+  }
+#endif
+}
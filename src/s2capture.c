@@ -0,0 +1,494 @@
+/* s2capture.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Frame capture: the images of recorded frames (F6, F7) and of the
+ * /S2OFFSCR device.
+ *
+ * Frames are read back into pixel buffer objects, double-buffered so
+ * that each frame's pixels are collected a frame after they were
+ * asked for, once the transfer has finished, rather than stalling
+ * the pipeline with glFinish.  The pixels are handed to worker
+ * threads through a bounded queue to be encoded and written; the
+ * render loop only waits when the queue is full.  Unnamed frames
+ * are numbered from the start of the program (0000.tga, or
+ * L_0000.tga and R_0000.tga for active stereo) without looking for
+ * existing files.  See ss2scap for the output formats.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+#if defined(BUILDING_S2PLOT)
+
+#define _S2CAPSLOTS    2  /* frames in flight between GL and the CPU */
+#define _S2CAPQUEUE    8  /* frames waiting to be encoded */
+#define _S2CAPWORKERS  2  /* encoding threads */
+#define _S2CAPNAMELEN 280
+
+/* output formats */
+#define _S2CAP_TGA  0     /* run-length encoded TGA */
+#define _S2CAP_PPM  1
+#define _S2CAP_PNG  2
+#define _S2CAP_PIPE 3     /* raw RGBA frames written to a command */
+
+typedef struct {
+  char name[_S2CAPNAMELEN];     /* output file (unused for a pipe) */
+  int width, height;
+  unsigned char *pixels;        /* RGBA, bottom row first */
+} _S2CAPJOB;
+
+typedef struct {
+  int pending;                  /* read back but not yet collected */
+  int neye;
+  GLuint pbo[2];                /* left (or only) and right eye */
+  int size;                     /* bytes allocated to each pbo */
+  int width, height;
+  char name[2][_S2CAPNAMELEN];
+} _S2CAPSLOT;
+
+static int _s2x_capformat = _S2CAP_TGA;
+static char *_s2x_capcommand = NULL;
+static FILE *_s2x_cappipe = NULL;
+static int _s2x_capframe = 0;   /* next automatic frame number */
+
+static _S2CAPSLOT _s2x_capslot[_S2CAPSLOTS];
+static int _s2x_capnext = 0;    /* next (and oldest) slot */
+
+static _S2CAPJOB _s2x_capqueue[_S2CAPQUEUE];
+static int _s2x_caphead = 0, _s2x_capcount = 0;
+static int _s2x_capnworker = 0, _s2x_capquit = 0;
+static pthread_t _s2x_capworker[_S2CAPWORKERS];
+static pthread_mutex_t _s2x_capmutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _s2x_capnotempty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t _s2x_capnotfull = PTHREAD_COND_INITIALIZER;
+
+/* PNG, with its image data compressed by a single fixed-Huffman
+ * deflate block whose only matches are the previous pixel and the
+ * pixel above: enough for the large flat areas of most frames,
+ * without needing zlib. */
+typedef struct {
+  unsigned char *out;
+  long n;
+  unsigned long bits;
+  int nbits;
+} _S2CAPBITS;
+
+static void _s2x_capPutBits(_S2CAPBITS *bw, unsigned long v, int n) {
+  bw->bits |= v << bw->nbits;
+  bw->nbits += n;
+  while (bw->nbits >= 8) {
+    bw->out[bw->n++] = bw->bits & 0xff;
+    bw->bits >>= 8;
+    bw->nbits -= 8;
+  }
+}
+
+/* Huffman codes are sent most significant bit first */
+static void _s2x_capPutCode(_S2CAPBITS *bw, unsigned int code, int n) {
+  unsigned int rev = 0;
+  int i;
+  for (i = 0; i < n; i++) {
+    rev = (rev << 1) | ((code >> i) & 1);
+  }
+  _s2x_capPutBits(bw, rev, n);
+}
+
+static void _s2x_capPutLiteral(_S2CAPBITS *bw, int sym) {
+  if (sym < 144) {
+    _s2x_capPutCode(bw, 0x30 + sym, 8);
+  } else if (sym < 256) {
+    _s2x_capPutCode(bw, 0x190 + sym - 144, 9);
+  } else if (sym < 280) {
+    _s2x_capPutCode(bw, sym - 256, 7);
+  } else {
+    _s2x_capPutCode(bw, 0xc0 + sym - 280, 8);
+  }
+}
+
+static void _s2x_capPutMatch(_S2CAPBITS *bw, int len, int dist) {
+  static const short lbase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17,
+				  19, 23, 27, 31, 35, 43, 51, 59, 67, 83,
+				  99, 115, 131, 163, 195, 227, 258};
+  static const char lextra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 
+				  2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 
+				  5, 5, 5, 5, 0};
+  static const int dbase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49,
+				65, 97, 129, 193, 257, 385, 513, 769, 
+				1025, 1537, 2049, 3073, 4097, 6145, 8193,
+				12289, 16385, 24577};
+  int c = 28;
+  while (lbase[c] > len) {
+    c--;
+  }
+  _s2x_capPutLiteral(bw, 257 + c);
+  _s2x_capPutBits(bw, len - lbase[c], lextra[c]);
+  c = 29;
+  while (dbase[c] > dist) {
+    c--;
+  }
+  _s2x_capPutCode(bw, c, 5);
+  _s2x_capPutBits(bw, dist - dbase[c], c < 4 ? 0 : c / 2 - 1);
+}
+
+static unsigned long _s2x_capCRC(unsigned long crc, unsigned char *p, 
+				 long n) {
+  static unsigned long table[256];
+  static int ready = 0;
+  unsigned long c;
+  int i, k;
+  if (!ready) {
+    /* filled identically by any thread that gets here first */
+    for (i = 0; i < 256; i++) {
+      c = i;
+      for (k = 0; k < 8; k++) {
+	c = (c & 1) ? 0xedb88320UL ^ (c >> 1) : c >> 1;
+      }
+      table[i] = c;
+    }
+    ready = 1;
+  }
+  crc ^= 0xffffffffUL;
+  while (n--) {
+    crc = table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+  }
+  return crc ^ 0xffffffffUL;
+}
+
+static void _s2x_capChunk(FILE *fp, char *type, unsigned char *data, 
+			  long n) {
+  unsigned char b[4];
+  unsigned long crc;
+  b[0] = n >> 24; b[1] = n >> 16; b[2] = n >> 8; b[3] = n;
+  fwrite(b, 1, 4, fp);
+  fwrite(type, 1, 4, fp);
+  if (n > 0) {
+    fwrite(data, 1, n, fp);
+  }
+  crc = _s2x_capCRC(_s2x_capCRC(0, (unsigned char *)type, 4), data, n);
+  b[0] = crc >> 24; b[1] = crc >> 16; b[2] = crc >> 8; b[3] = crc;
+  fwrite(b, 1, 4, fp);
+}
+
+static void _s2x_capWritePNG(FILE *fp, _S2CAPJOB *job) {
+  int w = job->width, h = job->height;
+  long stride = 3 * (long)w + 1, nraw = stride * h;
+  unsigned char *raw = (unsigned char *)malloc(nraw);
+  _S2CAPBITS bw = {NULL, 0, 0, 0};
+  unsigned char hdr[13];
+  unsigned long a = 1, b = 0;
+  long i, d, len, best, bestd;
+  int x, y, k;
+
+  bw.out = (unsigned char *)malloc(nraw + nraw / 8 + 64);
+  if (!raw || !bw.out) {
+    _s2warn("(capture)", "no memory to encode %s", job->name);
+    free(raw);
+    free(bw.out);
+    return;
+  }
+
+  /* scanlines, top row first, each with filter type 0 */
+  for (y = 0; y < h; y++) {
+    unsigned char *src = job->pixels + 4 * (long)w * (h - 1 - y);
+    unsigned char *dst = raw + stride * y;
+    *dst++ = 0;
+    for (x = 0; x < w; x++, src += 4) {
+      *dst++ = src[0];
+      *dst++ = src[1];
+      *dst++ = src[2];
+    }
+  }
+
+  /* zlib header, then one final fixed-Huffman block */
+  bw.out[bw.n++] = 0x78;
+  bw.out[bw.n++] = 0x01;
+  _s2x_capPutBits(&bw, 1, 1);
+  _s2x_capPutBits(&bw, 1, 2);
+  for (i = 0; i < nraw; ) {
+    best = 0;
+    bestd = 0;
+    for (k = 0; k < 2; k++) {
+      d = k ? stride : 3;
+      if ((d > i) || (d > 32768)) {
+	continue;
+      }
+      len = 0;
+      while ((len < 258) && (i + len < nraw) && 
+	     (raw[i + len] == raw[i + len - d])) {
+	len++;
+      }
+      if (len > best) {
+	best = len;
+	bestd = d;
+      }
+    }
+    if (best >= 3) {
+      _s2x_capPutMatch(&bw, best, bestd);
+      i += best;
+    } else {
+      _s2x_capPutLiteral(&bw, raw[i]);
+      i++;
+    }
+  }
+  _s2x_capPutLiteral(&bw, 256);
+  _s2x_capPutBits(&bw, 0, 7);
+  bw.nbits = 0;
+  for (i = 0; i < nraw; i++) {
+    a = (a + raw[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  bw.out[bw.n++] = b >> 8;
+  bw.out[bw.n++] = b;
+  bw.out[bw.n++] = a >> 8;
+  bw.out[bw.n++] = a;
+
+  fwrite("\211PNG\r\n\032\n", 1, 8, fp);
+  hdr[0] = w >> 24; hdr[1] = w >> 16; hdr[2] = w >> 8; hdr[3] = w;
+  hdr[4] = h >> 24; hdr[5] = h >> 16; hdr[6] = h >> 8; hdr[7] = h;
+  hdr[8] = 8;     /* bit depth */
+  hdr[9] = 2;     /* RGB */
+  hdr[10] = hdr[11] = hdr[12] = 0;
+  _s2x_capChunk(fp, "IHDR", hdr, 13);
+  _s2x_capChunk(fp, "IDAT", bw.out, bw.n);
+  _s2x_capChunk(fp, "IEND", NULL, 0);
+
+  free(raw);
+  free(bw.out);
+}
+
+/* encode and write one frame: called on a worker thread */
+static void _s2x_capWrite(_S2CAPJOB *job) {
+  FILE *fp;
+  if (_s2x_capformat == _S2CAP_PIPE) {
+    if (_s2x_cappipe) {
+      fwrite(job->pixels, 4, (size_t)job->width * job->height, 
+	     _s2x_cappipe);
+    }
+    return;
+  }
+  if ((fp = fopen(job->name, "wb")) == NULL) {
+    _s2warn("(capture)", "cannot open %s for writing", job->name);
+    return;
+  }
+  if (_s2x_capformat == _S2CAP_PNG) {
+    _s2x_capWritePNG(fp, job);
+  } else {
+    Write_Bitmap(fp, (BITMAP4 *)job->pixels, job->width, job->height,
+		 (_s2x_capformat == _S2CAP_PPM) ? 2 : 12);
+  }
+  fclose(fp);
+}
+
+static void *_s2x_capThread(void *arg) {
+  _S2CAPJOB job;
+  for (;;) {
+    pthread_mutex_lock(&_s2x_capmutex);
+    while (!_s2x_capcount && !_s2x_capquit) {
+      pthread_cond_wait(&_s2x_capnotempty, &_s2x_capmutex);
+    }
+    if (!_s2x_capcount) {
+      pthread_mutex_unlock(&_s2x_capmutex);
+      break;
+    }
+    job = _s2x_capqueue[_s2x_caphead];
+    _s2x_caphead = (_s2x_caphead + 1) % _S2CAPQUEUE;
+    _s2x_capcount--;
+    pthread_cond_signal(&_s2x_capnotfull);
+    pthread_mutex_unlock(&_s2x_capmutex);
+
+    _s2x_capWrite(&job);
+    free(job.pixels);
+  }
+  return NULL;
+}
+
+/* queue a frame for the workers, waiting only if the queue is full */
+static void _s2x_capPush(_S2CAPJOB *job) {
+  int i;
+  if (!_s2x_capnworker) {
+    if ((_s2x_capformat == _S2CAP_PIPE) && !_s2x_cappipe) {
+      _s2x_cappipe = popen(_s2x_capcommand, "w");
+      if (!_s2x_cappipe) {
+	_s2warn("(capture)", "cannot run \"%s\"", _s2x_capcommand);
+      }
+    }
+    /* a pipe takes frames in order, so from a single worker */
+    _s2x_capnworker = (_s2x_capformat == _S2CAP_PIPE) ? 1 : _S2CAPWORKERS;
+    for (i = 0; i < _s2x_capnworker; i++) {
+      pthread_create(_s2x_capworker + i, NULL, _s2x_capThread, NULL);
+    }
+  }
+  pthread_mutex_lock(&_s2x_capmutex);
+  while (_s2x_capcount == _S2CAPQUEUE) {
+    pthread_cond_wait(&_s2x_capnotfull, &_s2x_capmutex);
+  }
+  _s2x_capqueue[(_s2x_caphead + _s2x_capcount) % _S2CAPQUEUE] = *job;
+  _s2x_capcount++;
+  pthread_cond_signal(&_s2x_capnotempty);
+  pthread_mutex_unlock(&_s2x_capmutex);
+}
+
+/* copy a slot's pixels out of its buffers and queue them */
+static void _s2x_capCollect(_S2CAPSLOT *sl) {
+  _S2CAPJOB job;
+  unsigned char *p;
+  int eye;
+  for (eye = 0; eye < sl->neye; eye++) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, sl->pbo[eye]);
+    p = (unsigned char *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    job.pixels = p ? (unsigned char *)malloc(sl->size) : NULL;
+    if (job.pixels) {
+      memcpy(job.pixels, p, sl->size);
+      strcpy(job.name, sl->name[eye]);
+      job.width = sl->width;
+      job.height = sl->height;
+      _s2x_capPush(&job);
+    } else {
+      _s2warn("(capture)", "lost frame %s", sl->name[eye]);
+    }
+    if (p) {
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  sl->pending = 0;
+}
+
+/* collect the frames read back earlier: called once per frame, by
+ * which time their transfers have finished */
+void _s2priv_capHarvest(void) {
+  int i;
+  for (i = 0; i < _S2CAPSLOTS; i++) {
+    _S2CAPSLOT *sl = _s2x_capslot + (_s2x_capnext + i) % _S2CAPSLOTS;
+    if (sl->pending) {
+      _s2x_capCollect(sl);
+    }
+  }
+}
+
+/* start reading back the current frame (both eyes if stereo) to be 
+ * written as name, or the next automatic name if name is empty */
+void _s2priv_capFrame(char *name, int width, int height, int stereo) {
+  static char *ext[] = {"tga", "ppm", "png", ""};
+  _S2CAPSLOT *sl = _s2x_capslot + _s2x_capnext;
+  char base[_S2CAPNAMELEN - 16];
+  int eye;
+
+  if (sl->pending) {
+    /* more than one frame asked for since the last harvest */
+    _s2x_capCollect(sl);
+  }
+  if (name && strlen(name)) {
+    snprintf(base, sizeof(base), "%s", name);
+  } else {
+    sprintf(base, "%04d", _s2x_capframe++);
+  }
+  sl->neye = stereo ? 2 : 1;
+  for (eye = 0; eye < sl->neye; eye++) {
+    sprintf(sl->name[eye], "%s%s.%s", stereo ? (eye ? "R_" : "L_") : "",
+	    base, ext[_s2x_capformat]);
+  }
+
+  sl->width = width;
+  sl->height = height;
+  if (!sl->pbo[0]) {
+    glGenBuffers(2, sl->pbo);
+    sl->size = 0;
+  }
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  for (eye = 0; eye < sl->neye; eye++) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, sl->pbo[eye]);
+    if (sl->size != 4 * width * height) {
+      glBufferData(GL_PIXEL_PACK_BUFFER, 4 * width * height, NULL, 
+		   GL_STREAM_READ);
+    }
+    glReadBuffer(eye ? GL_BACK_RIGHT : GL_BACK_LEFT);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  sl->size = 4 * width * height;
+  sl->pending = 1;
+  _s2x_capnext = (_s2x_capnext + 1) % _S2CAPSLOTS;
+}
+
+/* write everything outstanding, and stop the workers */
+void _s2priv_capFlush(void) {
+  int i;
+  _s2priv_capHarvest();
+  if (!_s2x_capnworker) {
+    return;
+  }
+  pthread_mutex_lock(&_s2x_capmutex);
+  _s2x_capquit = 1;
+  pthread_cond_broadcast(&_s2x_capnotempty);
+  pthread_mutex_unlock(&_s2x_capmutex);
+  for (i = 0; i < _s2x_capnworker; i++) {
+    pthread_join(_s2x_capworker[i], NULL);
+  }
+  _s2x_capnworker = 0;
+  _s2x_capquit = 0;
+  if (_s2x_cappipe) {
+    pclose(_s2x_cappipe);
+    _s2x_cappipe = NULL;
+  }
+}
+
+/* choose the output format: "tga", "ppm", "png", or "|command" to
+ * write raw frames to command's standard input */
+void _s2priv_capFormat(char *format) {
+  int fmt = -1;
+  if (!format || !strlen(format) || !strcasecmp(format, "tga")) {
+    fmt = _S2CAP_TGA;
+  } else if (!strcasecmp(format, "ppm")) {
+    fmt = _S2CAP_PPM;
+  } else if (!strcasecmp(format, "png")) {
+    fmt = _S2CAP_PNG;
+  } else if ((format[0] == '|') && strlen(format + 1)) {
+    fmt = _S2CAP_PIPE;
+  }
+  if (fmt < 0) {
+    _s2warn("ss2scap", "unknown capture format \"%s\"", format);
+    return;
+  }
+
+  /* finish with frames already captured in the old format */
+  _s2priv_capFlush();
+  _s2x_capformat = fmt;
+  if (_s2x_capcommand) {
+    free(_s2x_capcommand);
+    _s2x_capcommand = NULL;
+  }
+  if (fmt == _S2CAP_PIPE) {
+    _s2x_capcommand = strdup(format + 1);
+  }
+}
+
+#endif
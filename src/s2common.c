@@ -516,7 +516,7 @@ void CalcBounds(void) {
   
   for (i=0;i<ndot;i++) {
 #if defined(BUILDING_S2PLOT) 
-    if (!strlen(dot[i].whichscreen))
+    if (!dot[i].whichscreen)
 #endif
       UpdateBounds(dot[i].p);
   }
@@ -525,14 +525,14 @@ void CalcBounds(void) {
     p.y = ball[i].p.y + ball[i].r;
     p.z = ball[i].p.z + ball[i].r;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(ball[i].whichscreen))
+    if (!ball[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = ball[i].p.x - ball[i].r;
     p.y = ball[i].p.y - ball[i].r;
     p.z = ball[i].p.z - ball[i].r;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(ball[i].whichscreen))
+    if (!ball[i].whichscreen)
 #endif
       UpdateBounds(p);
   }
@@ -541,14 +541,14 @@ void CalcBounds(void) {
     p.y = ballt[i].p.y + ballt[i].r;
     p.z = ballt[i].p.z + ballt[i].r;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(ballt[i].whichscreen))
+    if (!ballt[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = ballt[i].p.x - ballt[i].r;
     p.y = ballt[i].p.y - ballt[i].r;
     p.z = ballt[i].p.z - ballt[i].r;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(ballt[i].whichscreen))
+    if (!ballt[i].whichscreen)
 #endif
       UpdateBounds(p);
   }
@@ -557,14 +557,14 @@ void CalcBounds(void) {
     p.y = disk[i].p.y + disk[i].r2;
     p.z = disk[i].p.z + disk[i].r2;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(disk[i].whichscreen))
+    if (!disk[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = disk[i].p.x - disk[i].r2;
     p.y = disk[i].p.y - disk[i].r2;
     p.z = disk[i].p.z - disk[i].r2;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(disk[i].whichscreen))
+    if (!disk[i].whichscreen)
 #endif
       UpdateBounds(p);
   }
@@ -573,14 +573,14 @@ void CalcBounds(void) {
     p.y = cone[i].p1.y + cone[i].r1;
     p.z = cone[i].p1.z + cone[i].r1;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(cone[i].whichscreen))
+    if (!cone[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = cone[i].p1.x - cone[i].r1;
     p.y = cone[i].p1.y - cone[i].r1;
     p.z = cone[i].p1.z - cone[i].r1;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(cone[i].whichscreen))
+    if (!cone[i].whichscreen)
 #endif
       UpdateBounds(p);
     
@@ -588,20 +588,20 @@ void CalcBounds(void) {
     p.y = cone[i].p2.y + cone[i].r2;
     p.z = cone[i].p2.z + cone[i].r2;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(cone[i].whichscreen))
+    if (!cone[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = cone[i].p2.x - cone[i].r2;
     p.y = cone[i].p2.y - cone[i].r2;
     p.z = cone[i].p2.z - cone[i].r2;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(cone[i].whichscreen))
+    if (!cone[i].whichscreen)
 #endif
       UpdateBounds(p);
   }
   for (i=0;i<nline;i++) {
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(line[i].whichscreen)) {
+    if (!line[i].whichscreen) {
 #endif
       UpdateBounds(line[i].p[0]);
       UpdateBounds(line[i].p[1]);
@@ -611,7 +611,7 @@ void CalcBounds(void) {
   }
   for (i=0;i<nface3;i++) {
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(face3[i].whichscreen)) {
+    if (!face3[i].whichscreen) {
 #endif
       UpdateBounds(face3[i].p[0]);
       UpdateBounds(face3[i].p[1]);
@@ -622,7 +622,7 @@ void CalcBounds(void) {
   }
 #if defined(BUILDING_S2PLOT)
   for (i=0;i<nface3a;i++) {
-    if (!strlen(face3a[i].whichscreen)) {
+    if (!face3a[i].whichscreen) {
       UpdateBounds(face3a[i].p[0]);
       UpdateBounds(face3a[i].p[1]);
       UpdateBounds(face3a[i].p[2]);
@@ -630,7 +630,7 @@ void CalcBounds(void) {
   }
 #if defined(S2_3D_TEXTURES)
   for (i=0;i<ntexpoly3d;i++) {
-    if (!strlen(texpoly3d[i].whichscreen)) {
+    if (!texpoly3d[i].whichscreen) {
       int j;
       for (j=0; j<texpoly3d[i].nverts;j++) {
 	UpdateBounds(texpoly3d[i].verts[j]);
@@ -639,7 +639,7 @@ void CalcBounds(void) {
   }
 #endif
   for (i = 0; i < ntexmesh; i++) {
-    if (!strlen(texmesh[i].whichscreen)) {
+    if (!texmesh[i].whichscreen) {
       int j;
       for (j = 0; j < texmesh[i].nverts; j++) {
 	UpdateBounds(texmesh[i].verts[j]);
@@ -649,7 +649,7 @@ void CalcBounds(void) {
 #endif
   for (i=0;i<nface4;i++) {
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(face4[i].whichscreen)) {
+    if (!face4[i].whichscreen) {
 #endif
       UpdateBounds(face4[i].p[0]);
       UpdateBounds(face4[i].p[1]);
@@ -661,7 +661,7 @@ void CalcBounds(void) {
   }
   for (i=0;i<nface4t;i++) {
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(face4t[i].whichscreen)) {
+    if (!face4t[i].whichscreen) {
 #endif
       UpdateBounds(face4t[i].p[0]);
       UpdateBounds(face4t[i].p[1]);
@@ -674,7 +674,7 @@ void CalcBounds(void) {
 
 #if defined(BUILDING_S2PLOT)
   for (i = 0; i < ntrdot; i++) {
-    if (!strlen(trdot[i].whichscreen)) {
+    if (!trdot[i].whichscreen) {
       UpdateBounds(trdot[i].p);
     }
   }
@@ -682,12 +682,12 @@ void CalcBounds(void) {
 
   for (i=0;i<nlabel;i++)
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(label[i].whichscreen)) 
+    if (!label[i].whichscreen) 
 #endif
       UpdateBounds(label[i].p);
 #if defined(BUILDING_S2PLOT)
   for (i = 0; i < nlabel; i++) {
-    if (!strlen(label[i].whichscreen)) {
+    if (!label[i].whichscreen) {
       UpdateBounds(VectorAdd(VectorAdd(label[i].p, label[i].up), 
 			     VectorMul(label[i].right, 
 				       (double)strlen(label[i].s))));
@@ -746,7 +746,7 @@ void UpdateBounds(XYZ p) {
 	Add a line segment to the line database
 */
 void AddLine2Database(XYZ p1,XYZ p2,COLOUR c1,COLOUR c2,double w) {
-  if ((line = (LINE *)realloc(line,(nline+1)*sizeof(LINE))) == NULL) {
+  if ((line = (LINE *)_s2priv_arenaReserve(line, nline, 1, sizeof(LINE))) == NULL) {
     _s2error("(internal)", "memory allocation for line failed");
   }
   w = ABS(w);
@@ -756,13 +756,15 @@ void AddLine2Database(XYZ p1,XYZ p2,COLOUR c1,COLOUR c2,double w) {
   line[nline].colour[0] = c1;
   line[nline].colour[1] = c2;
 #if defined(BUILDING_S2PLOT)
-  strcpy(line[nline].whichscreen, _s2_whichscreen);
-  strncpy(line[nline].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
-  line[nline].VRMLname[MAXVRMLLEN-1] = '\0';
+  line[nline].whichscreen = _s2_currscreentag;
+  line[nline].VRMLname = _s2_currVRMLidx;
   line[nline].stipple_factor = 0;
   line[nline].stipple_pattern = 0;
 #endif
   nline++;
+#if defined(BUILDING_S2PLOT)
+  _s2priv_listChanged();
+#endif
 }
 
 /*
@@ -773,7 +775,7 @@ void AddFace2Database(XYZ *p,int n,COLOUR c,double scale,XYZ shift) {
   int i;
   
   if (n == 3) {
-    if ((face3 = (FACE3 *)realloc(face3,(nface3+1)*sizeof(FACE3))) == NULL) {
+    if ((face3 = (FACE3 *)_s2priv_arenaReserve(face3, nface3, 1, sizeof(FACE3))) == NULL) {
       _s2error("(internal)", "memory allocation failed for face3");
     }
     for (i=0;i<3;i++) {
@@ -783,14 +785,13 @@ void AddFace2Database(XYZ *p,int n,COLOUR c,double scale,XYZ shift) {
       face3[nface3].n[i] = CalcNormal(p[0],p[1],p[2]);
       face3[nface3].colour[i] = c;
 #if defined(BUILDING_S2PLOT)
-      strcpy(face3[nface3].whichscreen, _s2_whichscreen);
-      strncpy(face3[nface3].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-      face3[nface3].VRMLname[MAXVRMLLEN-1] = '\0';
+      face3[nface3].whichscreen = _s2_currscreentag;
+      face3[nface3].VRMLname = _s2_currVRMLidx;
 #endif
     }
     nface3++;
   } else if (n == 4) {
-    if ((face4 = (FACE4 *)realloc(face4,(nface4+1)*sizeof(FACE4))) == NULL) {
+    if ((face4 = (FACE4 *)_s2priv_arenaReserve(face4, nface4, 1, sizeof(FACE4))) == NULL) {
       _s2error("(internal)", "memory allocation failed for face4");
     }
     for (i=0;i<4;i++) {
@@ -800,12 +801,13 @@ void AddFace2Database(XYZ *p,int n,COLOUR c,double scale,XYZ shift) {
       face4[nface4].n[i] = CalcNormal(p[(i-1+4)%4],p[i],p[(i+1)%4]);
       face4[nface4].colour[i] = c;
 #if defined(BUILDING_S2PLOT)
-      strcpy(face4[nface4].whichscreen, _s2_whichscreen);
-      strncpy(face4[nface4].VRMLname, _s2_VRMLnames[_s2_currVRMLidx],
-	      MAXVRMLLEN);
-      face4[nface4].VRMLname[MAXVRMLLEN-1] = '\0';
+      face4[nface4].whichscreen = _s2_currscreentag;
+      face4[nface4].VRMLname = _s2_currVRMLidx;
 #endif
     }
     nface4++;
   }
+#if defined(BUILDING_S2PLOT)
+  _s2priv_listChanged();
+#endif
 }
@@ -179,15 +179,27 @@
 #define _S2YAX 1
 #define _S2ZAX 2
 
-#define _S2WORLD2DEVICE(wv, axis) (strlen(_s2_whichscreen) ? (wv) : (_s2devicemin[(axis)] + (_s2devicemax[(axis)]-_s2devicemin[(axis)]) / (_s2axismax[(axis)]-_s2axismin[(axis)]) * ((wv) - _s2axismin[(axis)])))
+#define _S2WORLD2DEVICE(wv, axis) (_s2_currscreentag ? (wv) : (_s2devicemin[(axis)] + (_s2devicemax[(axis)]-_s2devicemin[(axis)]) / (_s2axismax[(axis)]-_s2axismin[(axis)]) * ((wv) - _s2axismin[(axis)])))
 
-#define _S2WORLD2DEVICE_SO(wv, axis) (strlen(_s2_whichscreen) ? (wv) : ((_s2devicemax[(axis)]-_s2devicemin[(axis)]) / (_s2axismax[(axis)]-_s2axismin[(axis)]) * ((wv))))
+#define _S2WORLD2DEVICE_SO(wv, axis) (_s2_currscreentag ? (wv) : ((_s2devicemax[(axis)]-_s2devicemin[(axis)]) / (_s2axismax[(axis)]-_s2axismin[(axis)]) * ((wv))))
 
-#define _S2DEVICE2WORLD(dv, axis) (strlen(_s2_whichscreen) ? (dv) : (_s2axismin[(axis)] + (_s2axismax[(axis)]-_s2axismin[(axis)]) / (_s2devicemax[(axis)]-_s2devicemin[(axis)]) * ((dv) - _s2devicemin[(axis)])))
+#define _S2DEVICE2WORLD(dv, axis) (_s2_currscreentag ? (dv) : (_s2axismin[(axis)] + (_s2axismax[(axis)]-_s2axismin[(axis)]) / (_s2devicemax[(axis)]-_s2devicemin[(axis)]) * ((dv) - _s2devicemin[(axis)])))
 
-#define _S2DEVICE2WORLD_SO(dv, axis) (strlen(_s2_whichscreen) ? (dv) : ((_s2axismax[(axis)]-_s2axismin[(axis)]) / (_s2devicemax[(axis)]-_s2devicemin[(axis)]) * ((dv))))
+#define _S2DEVICE2WORLD_SO(dv, axis) (_s2_currscreentag ? (dv) : ((_s2axismax[(axis)]-_s2axismin[(axis)]) / (_s2devicemax[(axis)]-_s2devicemin[(axis)]) * ((dv))))
 
-#define _S2W3RADIUS(val) (strlen(_s2_whichscreen) ? (val) : (sqrt(0.333333 * (powf(_S2WORLD2DEVICE_SO(val, _S2XAX), 2.0) + powf(_S2WORLD2DEVICE_SO(val, _S2YAX), 2.0) + powf(_S2WORLD2DEVICE_SO(val, _S2ZAX), 2.0)))))
+#define _S2W3RADIUS(val) (_s2_currscreentag ? (val) : (sqrt(0.333333 * (powf(_S2WORLD2DEVICE_SO(val, _S2XAX), 2.0) + powf(_S2WORLD2DEVICE_SO(val, _S2YAX), 2.0) + powf(_S2WORLD2DEVICE_SO(val, _S2ZAX), 2.0)))))
+
+/* screen geometry: each interned screen tag carries a bitmask of the
+ * screens it is drawn on, so the per-primitive filter is an integer test */
+#define _S2SCREEN_L 1
+#define _S2SCREEN_C 2
+#define _S2SCREEN_R 4
+#define _S2ONSCREEN(tag) (_s2_doingScreenBit && (_s2_screentagbits[(tag)] & _s2_doingScreenBit))
+
+/* number of GL buffers cycled through when streaming dynamic geometry,
+ * so a frame is never written into a buffer the GPU may still be
+ * drawing from */
+#define _S2BATCHRING 3
 
 /* handy utility macros */
 
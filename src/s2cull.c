@@ -0,0 +1,252 @@
+/* s2cull.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* View-frustum culling of world geometry.
+ *
+ * When static geometry is packed (see s2batch.c) each primitive list
+ * is ordered by the cell of a uniform grid over the geometry's
+ * bounding box that the primitive lies in, and a new batch is started
+ * at every change of cell.  Every batch then covers a small part of
+ * the scene, and its bounding box is kept with it.  _s2priv_drawBatches
+ * tests those boxes against the frustum of the current projection and
+ * modelview matrices, so each panel, eye, dome face or display tile
+ * draws only the batches it can see.  The grid is rebuilt only when
+ * the static lists are re-packed, i.e. when they change.  Billboards
+ * are tested one at a time, as spheres, before they are sorted.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+#include <float.h>
+
+/* aim for about this many primitives per grid cell */
+#define _S2CULLCELLPRIMS 512
+/* most cells along each axis of the grid */
+#define _S2CULLMAXCELLS 16
+
+/* is primitive x world geometry? */
+#if defined(BUILDING_S2PLOT)
+#define _S2CULLWORLD(x) (!(x).whichscreen)
+#else
+#define _S2CULLWORLD(x) (1)
+#endif
+
+/* grow the box lo, hi to hold p */
+static void _s2priv_cullExtend(float *lo, float *hi, XYZ p) {
+  if (p.x < lo[0]) lo[0] = p.x;
+  if (p.x > hi[0]) hi[0] = p.x;
+  if (p.y < lo[1]) lo[1] = p.y;
+  if (p.y > hi[1]) hi[1] = p.y;
+  if (p.z < lo[2]) lo[2] = p.z;
+  if (p.z > hi[2]) hi[2] = p.z;
+}
+
+/* set up grid over the world geometry in the face3, face4, label, dot 
+ * and line lists; a grid of a single cell means no binning */
+void _s2priv_cullGrid(_S2CULLGRID *grid) {
+  float lo[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+  float hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  int i, j, nprim = 0, ncell;
+
+  for (i = 0; i < nface3; i++) {
+    if (_S2CULLWORLD(face3[i])) {
+      for (j = 0; j < 3; j++) {
+	_s2priv_cullExtend(lo, hi, face3[i].p[j]);
+      }
+      nprim++;
+    }
+  }
+  for (i = 0; i < nface4; i++) {
+    if (_S2CULLWORLD(face4[i])) {
+      for (j = 0; j < 4; j++) {
+	_s2priv_cullExtend(lo, hi, face4[i].p[j]);
+      }
+      nprim++;
+    }
+  }
+  for (i = 0; i < nlabel; i++) {
+    if (_S2CULLWORLD(label[i])) {
+      _s2priv_cullExtend(lo, hi, label[i].p);
+      nprim++;
+    }
+  }
+  for (i = 0; i < ndot; i++) {
+    if (_S2CULLWORLD(dot[i])) {
+      _s2priv_cullExtend(lo, hi, dot[i].p);
+      nprim++;
+    }
+  }
+  for (i = 0; i < nline; i++) {
+    if (_S2CULLWORLD(line[i])) {
+      for (j = 0; j < 2; j++) {
+	_s2priv_cullExtend(lo, hi, line[i].p[j]);
+      }
+      nprim++;
+    }
+  }
+
+  ncell = (int)cbrt((double)nprim / _S2CULLCELLPRIMS);
+  if (ncell > _S2CULLMAXCELLS) {
+    ncell = _S2CULLMAXCELLS;
+  }
+  for (j = 0; j < 3; j++) {
+    grid->n[j] = (ncell > 1 && hi[j] > lo[j]) ? ncell : 1;
+    grid->lo[j] = lo[j];
+    grid->sca[j] = (grid->n[j] > 1) ? grid->n[j] / (hi[j] - lo[j]) : 0.;
+  }
+  grid->ncell = grid->n[0] * grid->n[1] * grid->n[2];
+}
+
+/* the grid cell holding p */
+unsigned int _s2priv_cullCell(_S2CULLGRID *grid, XYZ p) {
+  int c[3], j;
+  float v[3] = {p.x, p.y, p.z};
+  for (j = 0; j < 3; j++) {
+    c[j] = (int)((v[j] - grid->lo[j]) * grid->sca[j]);
+    c[j] = (c[j] < 0) ? 0 : ((c[j] >= grid->n[j]) ? grid->n[j] - 1 : c[j]);
+  }
+  return (unsigned int)((c[2] * grid->n[1] + c[1]) * grid->n[0] + c[0]);
+}
+
+/* the bounding box of each world batch of bl */
+void _s2priv_cullBounds(_S2BATCHLIST *bl) {
+  _S2BATCH *b;
+  _S2BATCHVTX *v;
+  int i, k, j;
+  for (i = 0; i < bl->nbatch; i++) {
+    b = bl->batch + i;
+    for (j = 0; j < 3; j++) {
+      b->lo[j] = FLT_MAX;
+      b->hi[j] = -FLT_MAX;
+    }
+    if (b->screen) {
+      continue;
+    }
+    for (k = 0, v = bl->vtx + b->first; k < b->count; k++, v++) {
+      for (j = 0; j < 3; j++) {
+	if (v->p[j] < b->lo[j]) b->lo[j] = v->p[j];
+	if (v->p[j] > b->hi[j]) b->hi[j] = v->p[j];
+      }
+    }
+  }
+}
+
+/* the planes of the frustum of the current projection and modelview
+ * matrices, in world coordinates.  Culling is off while a display
+ * list is being compiled, since the list may be replayed in any view. */
+void _s2priv_cullFrustum(_S2FRUSTUM *fr) {
+  GLdouble m[16], p[16], c[16];
+  GLint compiling, view[4];
+  int i, j, k;
+  double len;
+
+  glGetIntegerv(GL_LIST_INDEX, &compiling);
+  fr->on = !compiling;
+  if (!fr->on) {
+    return;
+  }
+  glGetDoublev(GL_MODELVIEW_MATRIX, m);
+  glGetDoublev(GL_PROJECTION_MATRIX, p);
+  for (i = 0; i < 4; i++) {
+    for (j = 0; j < 4; j++) {
+      c[j*4+i] = 0.;
+      for (k = 0; k < 4; k++) {
+	c[j*4+i] += p[k*4+i] * m[j*4+k];
+      }
+    }
+  }
+  /* rows 3 + and - rows 0, 1 and 2 of the clip matrix: left, right,
+   * bottom, top, near and far */
+  for (i = 0; i < 6; i++) {
+    double s = (i % 2) ? -1. : 1.;
+    for (j = 0; j < 4; j++) {
+      fr->p[i][j] = c[j*4+3] + s * c[j*4+i/2];
+    }
+    len = sqrt(fr->p[i][0]*fr->p[i][0] + fr->p[i][1]*fr->p[i][1] +
+	       fr->p[i][2]*fr->p[i][2]);
+    if (len > 0.) {
+      for (j = 0; j < 4; j++) {
+	fr->p[i][j] /= len;
+      }
+    }
+  }
+  /* for choosing point detail (s2lod.c): clip w, and the larger of
+   * the x and y pixel scales */
+  glGetIntegerv(GL_VIEWPORT, view);
+  fr->pix = 0.;
+  for (i = 0; i < 2; i++) {
+    len = 0.5 * view[2+i] * sqrt(c[i]*c[i] + c[4+i]*c[4+i] + c[8+i]*c[8+i]);
+    fr->pix = (len > fr->pix) ? len : fr->pix;
+  }
+  for (j = 0; j < 4; j++) {
+    fr->w[j] = c[j*4+3];
+  }
+}
+
+/* can any of the box lo, hi be inside the frustum? */
+int _s2priv_cullBox(_S2FRUSTUM *fr, float *lo, float *hi) {
+  int i;
+  float *q;
+  if (!fr->on) {
+    return 1;
+  }
+  if (lo[0] > hi[0]) {
+    /* empty (or screen) batch: nothing to test */
+    return 1;
+  }
+  for (i = 0; i < 6; i++) {
+    q = fr->p[i];
+    /* the corner farthest along the plane's inward normal */
+    if (q[0] * (q[0] > 0. ? hi[0] : lo[0]) +
+	q[1] * (q[1] > 0. ? hi[1] : lo[1]) +
+	q[2] * (q[2] > 0. ? hi[2] : lo[2]) + q[3] < 0.) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* can any of the sphere at c of radius r be inside the frustum? */
+int _s2priv_cullSphere(_S2FRUSTUM *fr, XYZ c, float r) {
+  int i;
+  float *q;
+  if (!fr->on) {
+    return 1;
+  }
+  for (i = 0; i < 6; i++) {
+    q = fr->p[i];
+    if (q[0] * c.x + q[1] * c.y + q[2] * c.z + q[3] < -r) {
+      return 0;
+    }
+  }
+  return 1;
+}
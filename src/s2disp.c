@@ -38,6 +38,7 @@
 #include <sys/time.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "s2win.h"
 
 void CameraHome(int);
 void MakeGeometry(int, int);
@@ -117,11 +118,13 @@ void s2disp(int idelay, int irestorecamera) {
   _s2_skip = 0;
   
   do {
+    if (!s2winSystem()) {
 #if defined(S2LINUX) 
-    glutMainLoopEvent();
+      glutMainLoopEvent();
 #elif defined(S2DARWIN)
-    glutCheckLoop();
+      glutCheckLoop();
 #endif
+    }
     HandleDisplay();
     usleep(20);
 
@@ -209,11 +212,13 @@ void s2disptk(float timeout, char key, int irestorecamera) {
   _s2_skip = 0;
   
   do {
+    if (!s2winSystem()) {
 #if defined(S2LINUX) 
-    glutMainLoopEvent();
+      glutMainLoopEvent();
 #elif defined(S2DARWIN)
-    glutCheckLoop();
+      glutCheckLoop();
 #endif
+    }
     HandleDisplay();
     usleep(20);
 
@@ -33,35 +33,213 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 #include "s2plot.h"
 
-/* Based on FreeType2 Tutorial code: 
+/* Glyphs are rasterised once per font file and pixel size into a
+ * glyph atlas: one or more textures of _S2FTATLAS x _S2FTATLAS
+ * texels, filled row by row ("shelf" packing) as new characters are
+ * met, with just the changed region sent to OpenGL (ss2ptr).  The
+ * FreeType face stays open so that kerning can be looked up, and the
+ * kerning of each pair of characters is cached on first use.
+ *
+ * ns2ftstr draws a string as textured facets taken from the atlas:
+ * one textured mesh per atlas texture used.  ss2ftt, which makes a
+ * texture holding a single string, now copies its glyphs out of the
+ * atlas too.
+ *
+ * Originally based on FreeType2 Tutorial code: 
  * http://www.freetype.org/freetype2/docs/tutorial/example1.c
  */
 
-void draw_bitmap( unsigned char **image,
-	     int imagewidth, int imageheight,
-	     FT_Bitmap*  bitmap,
-             FT_Int      x,
-             FT_Int      y) {
-  FT_Int  i, j, p, q;
-  FT_Int  x_max = x + bitmap->width;
-  FT_Int  y_max = y + bitmap->rows;
-  for ( i = x, p = 0; i < x_max; i++, p++ ) {
-    for ( j = y, q = 0; j < y_max; j++, q++ ) {
-      if ( i >= imagewidth || j >= imageheight )
-        continue;
-      image[j][i] |= bitmap->buffer[q * bitmap->width + p];
+#define _S2FTATLAS 512
+#define _S2FTPAD 1             /* empty texels around each glyph */
+#define _S2FTNOKERN SHRT_MIN   /* kerning pair not yet looked up */
+
+typedef struct {
+  int ready;                   /* looked up yet? */
+  int page;                    /* atlas texture, or -1 if no pixels */
+  int x, y, w, h;              /* position and size in the atlas */
+  int left, top;               /* offset of the bitmap from the pen */
+  long advance;                /* 26.6 pixels */
+  FT_UInt index;               /* glyph index, for kerning */
+} _S2FTGLYPH;
+
+typedef struct _s2ftfont {
+  char *path;
+  int sizepx;
+  FT_Face face;
+  _S2FTGLYPH glyph[256];
+  short *kern;                 /* 256 x 256 pairs, 26.6 pixels */
+  int npages;
+  unsigned int *pages;         /* atlas texture ids */
+  int shelfx, shelfy, shelfh;  /* free space on the last page */
+  struct _s2ftfont *next;
+} _S2FTFONT;
+
+static FT_Library _s2ft_library;
+static int _s2ft_libready = 0;
+static _S2FTFONT *_s2ft_fonts = NULL;
+
+/* the cached font for a file and size, opening it on first use;
+ * NULL if it cannot be opened */
+static _S2FTFONT *_s2priv_ftFont(char *fontfilename, int fontsizepx) {
+  _S2FTFONT *font;
+  for (font = _s2ft_fonts; font; font = font->next) {
+    if ((font->sizepx == fontsizepx) && !strcmp(font->path, fontfilename)) {
+      return font;
     }
   }
+
+  if (!_s2ft_libready) {
+    if (FT_Init_FreeType(&_s2ft_library)) {
+      fprintf(stderr, "Failed to initialise freetype library!\n");
+      return NULL;
+    }
+    _s2ft_libready = 1;
+  }
+  font = (_S2FTFONT *)calloc(1, sizeof(_S2FTFONT));
+  if (!font) {
+    return NULL;
+  }
+  if (FT_New_Face(_s2ft_library, fontfilename, 0, &(font->face))) {
+    fprintf(stderr, "Failed to load font \"%s\"\n", fontfilename);
+    free(font);
+    return NULL;
+  }
+  if (FT_Set_Pixel_Sizes(font->face, fontsizepx, fontsizepx)) {
+    fprintf(stderr, "Failed to set character size\n");
+    FT_Done_Face(font->face);
+    free(font);
+    return NULL;
+  }
+  font->path = strdup(fontfilename);
+  font->sizepx = fontsizepx;
+  font->next = _s2ft_fonts;
+  _s2ft_fonts = font;
+  return font;
 }
 
+/* start a new, empty atlas texture */
+static int _s2priv_ftAddPage(_S2FTFONT *font) {
+  unsigned int *pages = (unsigned int *)realloc(font->pages, 
+				 (font->npages + 1) * sizeof(unsigned int));
+  if (!pages) {
+    return 0;
+  }
+  font->pages = pages;
+  unsigned int texid = ss2ctt(_S2FTATLAS, _S2FTATLAS);
+  unsigned char *bits = ss2gt(texid, NULL, NULL);
+  memset(bits, 0, _S2FTATLAS * _S2FTATLAS * 4);
+  ss2ptt(texid);
+  font->pages[font->npages++] = texid;
+  font->shelfx = font->shelfy = font->shelfh = 0;
+  return 1;
+}
+
+/* the glyph for character c, rasterising it into the atlas on first
+ * use.  Returns NULL if the font has no such character.
+ */
+static _S2FTGLYPH *_s2priv_ftGlyph(_S2FTFONT *font, unsigned char c) {
+  _S2FTGLYPH *g = font->glyph + c;
+  if (g->ready) {
+    return (g->index || g->advance) ? g : NULL;
+  }
+  g->ready = 1;
+  g->page = -1;
+
+  FT_Set_Transform(font->face, NULL, NULL);
+  if (FT_Load_Char(font->face, c, FT_LOAD_RENDER)) {
+    return NULL;
+  }
+  FT_GlyphSlot slot = font->face->glyph;
+  FT_Bitmap *bm = &(slot->bitmap);
+  g->index = FT_Get_Char_Index(font->face, c);
+  g->left = slot->bitmap_left;
+  g->top = slot->bitmap_top;
+  g->advance = slot->advance.x;
+  g->w = bm->width;
+  g->h = bm->rows;
+  if (!g->w || !g->h) {
+    return g;
+  }
+  if ((g->w + 2 * _S2FTPAD > _S2FTATLAS) || 
+      (g->h + 2 * _S2FTPAD > _S2FTATLAS)) {
+    fprintf(stderr, "Glyph too large for font texture - skipped\n");
+    return g;
+  }
+
+  /* find room: along the current shelf, else on a new shelf, else on
+   * a new page */
+  if (font->npages && 
+      (font->shelfx + g->w + 2 * _S2FTPAD > _S2FTATLAS)) {
+    font->shelfy += font->shelfh;
+    font->shelfx = font->shelfh = 0;
+  }
+  if (!font->npages || 
+      (font->shelfy + g->h + 2 * _S2FTPAD > _S2FTATLAS)) {
+    if (!_s2priv_ftAddPage(font)) {
+      return g;
+    }
+  }
+  g->page = font->npages - 1;
+  g->x = font->shelfx + _S2FTPAD;
+  g->y = font->shelfy + _S2FTPAD;
+  font->shelfx += g->w + 2 * _S2FTPAD;
+  if (g->h + 2 * _S2FTPAD > font->shelfh) {
+    font->shelfh = g->h + 2 * _S2FTPAD;
+  }
+
+  /* copy in, flipped so the texture rows run bottom up */
+  unsigned int texid = font->pages[g->page];
+  unsigned char *bits = ss2gt(texid, NULL, NULL);
+  int pitch = (bm->pitch < 0) ? -bm->pitch : bm->pitch;
+  int p, q;
+  long idx;
+  for (q = 0; q < g->h; q++) {
+    idx = ((long)(g->y + g->h - 1 - q) * _S2FTATLAS + g->x) * 4;
+    for (p = 0; p < g->w; p++, idx += 4) {
+      bits[idx] = bits[idx+1] = bits[idx+2] = bits[idx+3] =
+	bm->buffer[q * pitch + p];
+    }
+  }
+  ss2ptr(texid, g->x, g->x + g->w - 1, g->y, g->y + g->h - 1);
+  return g;
+}
+
+/* kerning, in 26.6 pixels, between characters a and b */
+static long _s2priv_ftKern(_S2FTFONT *font, _S2FTGLYPH *a, _S2FTGLYPH *b) {
+  if (!FT_HAS_KERNING(font->face)) {
+    return 0;
+  }
+  if (!font->kern) {
+    int i;
+    font->kern = (short *)malloc(256 * 256 * sizeof(short));
+    if (!font->kern) {
+      return 0;
+    }
+    for (i = 0; i < 256 * 256; i++) {
+      font->kern[i] = _S2FTNOKERN;
+    }
+  }
+  short *k = font->kern + (a - font->glyph) * 256 + (b - font->glyph);
+  if (*k == _S2FTNOKERN) {
+    FT_Vector delta;
+    *k = 0;
+    if (!FT_Get_Kerning(font->face, a->index, b->index, FT_KERNING_DEFAULT,
+			&delta)) {
+      *k = (short)delta.x;
+    }
+  }
+  return *k;
+}
 
 /* fontfilename = eg "/System/Library/Arial"
  * text = eg. "Hello World!"
@@ -70,133 +248,157 @@ void draw_bitmap( unsigned char **image,
  */
 unsigned int ss2ftt(char *fontfilename, char *text, int fontsizepx,
 		    int border) {
-  FT_Library    library;
-  FT_Face       face;
-  FT_GlyphSlot  slot;
-  FT_Matrix     matrix;                 /* transformation matrix */
-  FT_Vector     pen;                    /* untransformed origin  */
-  FT_Error      error;
-
-  int i,j, n, loop;
-  int tmp;
+  _S2FTFONT *font = _s2priv_ftFont(fontfilename, fontsizepx);
+  _S2FTGLYPH *g;
+  int n, num_chars = strlen(text);
+  int i, j, p, q, x, y;
   int bbot = 0, btop = 0;
-  
-  int num_chars = strlen( text );
-  double angle = ( 0.0 / 360.0 ) * 3.14159 * 2.0;      /* use 0 degrees     */
+  long pen = 0;
 
-  unsigned char **image = NULL;
-  int WIDTH = 0, HEIGHT = 0;
-
-  error = FT_Init_FreeType( &library );              /* initialize library */
-  if (error) {
-    fprintf(stderr, "Failed to initialise freetype library!\n");
+  if (!font) {
     return ss2ct(16, 16);
   }
 
-  error = FT_New_Face( library, fontfilename, 0, &face ); /* create face object */
-  if (error) {
-    fprintf(stderr, "Failed to load font \"%s\"\n", fontfilename);
-    return ss2ct(16, 16);
-  }
-  
-  /* use characters that are 24 x 24 pixels */
-  error = FT_Set_Pixel_Sizes(face, fontsizepx, fontsizepx);
-  if (error) {
-    fprintf(stderr, "Failed to set character size\n");
-    return ss2ct(16, 16);
+  /* measure */
+  for (n = 0; n < num_chars; n++) {
+    if (!(g = _s2priv_ftGlyph(font, (unsigned char)text[n]))) {
+      continue;
+    }
+    if (-g->top < btop) {
+      btop = -g->top;
+    }
+    if (-g->top + g->h > bbot) {
+      bbot = -g->top + g->h;
+    }
+    pen += g->advance;
   }
+  int WIDTH = pen / 64 + 2 * border;
+  int HEIGHT = (bbot - btop) + 2 * border;
 
-  slot = face->glyph;
-
-  /* set up matrix */
-  matrix.xx = (FT_Fixed)( cos( angle ) * 0x10000L );
-  matrix.xy = (FT_Fixed)(-sin( angle ) * 0x10000L );
-  matrix.yx = (FT_Fixed)( sin( angle ) * 0x10000L );
-  matrix.yy = (FT_Fixed)( cos( angle ) * 0x10000L );
-
-  for (loop = 0; loop < 2; loop++) {
-    // first loop: figure out dimensions without drawing
-    // second loop: draw to bitmap
-    if (!loop) {
-      pen.x = 0;
-      pen.y = 0;
-      bbot = btop = 0;
-    } else {
-      // start at (border, fontsizepx + border) relative to TLC
-      pen.x = border * 64;
-      pen.y = (border + bbot) * 64;
-    }
-
-    for ( n = 0; n < num_chars; n++ ) {
-      /* set transformation */
-      FT_Set_Transform( face, &matrix, &pen );
-      
-      /* load glyph image into the slot (erase previous one) */
-      error = FT_Load_Char( face, text[n], FT_LOAD_RENDER );
-      if ( error )
-	continue;                 /* ignore errors */
-
-      if (!loop) {
-	/* see if we have a new max height... */
-	tmp = -slot->bitmap_top;
-	if (tmp < btop) {
-	  btop = tmp;
-	}
-	tmp = -slot->bitmap_top + slot->bitmap.rows;
-	if (tmp > bbot) {
-	  bbot = tmp;
-	}
-      } else {
-	/* draw to our target surface (convert position) */
-	draw_bitmap( image, WIDTH, HEIGHT, &slot->bitmap,
-		     slot->bitmap_left,
-		     HEIGHT - slot->bitmap_top );
-      }
-
-      /* increment pen position */
-      pen.x += slot->advance.x;
-      pen.y += slot->advance.y;
+  /* copy the glyphs from the atlas; the texture runs bottom up with
+   * the baseline bbot + border rows above the bottom edge */
+  unsigned int texid = ss2ct(WIDTH, HEIGHT);
+  unsigned char *bits = ss2gt(texid, NULL, NULL);
+  memset(bits, 0, (long)WIDTH * HEIGHT * 4);
+  pen = border * 64;
+  for (n = 0; n < num_chars; n++) {
+    if (!(g = _s2priv_ftGlyph(font, (unsigned char)text[n]))) {
+      continue;
     }
-
-    if (!loop) {
-      WIDTH = pen.x / 64 + 2 * border;
-      HEIGHT = (bbot - btop) + 2 * border;
-      image = (unsigned char **)malloc(HEIGHT * sizeof(unsigned char *));
-      for (j = 0; j < HEIGHT; j++) {
-	image[j] = (unsigned char *)malloc(WIDTH * sizeof(unsigned char));
-	for (i = 0; i < WIDTH; i++) {
-	  image[j][i] = 0;
+    if (g->page >= 0) {
+      unsigned char *atlas = ss2gt(font->pages[g->page], NULL, NULL);
+      for (q = 0; q < g->h; q++) {
+	y = bbot + border + g->top - 1 - q;
+	if ((y < 0) || (y >= HEIGHT)) {
+	  continue;
+	}
+	for (p = 0; p < g->w; p++) {
+	  x = pen / 64 + g->left + p;
+	  if ((x < 0) || (x >= WIDTH)) {
+	    continue;
+	  }
+	  i = (y * WIDTH + x) * 4;
+	  j = ((g->y + g->h - 1 - q) * _S2FTATLAS + g->x + p) * 4;
+	  bits[i] |= atlas[j];
+	  bits[i+1] |= atlas[j];
+	  bits[i+2] |= atlas[j];
+	  bits[i+3] |= atlas[j];
 	}
       }
     }
+    pen += g->advance;
   }
+  ss2pt(texid);
+
+  return texid;
+}
 
-  FT_Done_Face    ( face );
-  FT_Done_FreeType( library );
+/* draw a string as textured facets from the glyph atlas */
+void ns2ftstr(char *fontfilename, int fontsizepx, char *text,
+	      XYZ P, XYZ right, XYZ up, COLOUR col, char trans, float alpha) {
+  _S2FTFONT *font = _s2priv_ftFont(fontfilename, fontsizepx);
+  int n, num_chars = strlen(text);
+  if (!font || !num_chars) {
+    return;
+  }
 
-  /* ok at this point image contains our bitmap ... turn it into a 
-   * texture */
-  unsigned int texid = ss2ct(WIDTH, HEIGHT);
-  unsigned char *bits = ss2gt(texid, NULL, NULL);
-  int idx;
-  for (j = 0; j < HEIGHT; j++) {
-    for (i = 0; i < WIDTH; i++) {
-      // HEIGHT-1-j to flip texture vertically
-      idx = ((HEIGHT-1-j) * WIDTH + i) * 4;
-      bits[idx] = image[j][i];
-      bits[idx+1] = image[j][i];
-      bits[idx+2] = image[j][i];
-      bits[idx+3] = image[j][i]; /* half transparent */
+  /* lay out the string once, noting the glyph and pen position of
+   * every character that has pixels */
+  _S2FTGLYPH **gl = (_S2FTGLYPH **)malloc(num_chars * sizeof(_S2FTGLYPH *));
+  long *pens = (long *)malloc(num_chars * sizeof(long));
+  XYZ *verts = (XYZ *)malloc(4 * num_chars * sizeof(XYZ));
+  XYZ *norms = (XYZ *)malloc(4 * num_chars * sizeof(XYZ));
+  XYZ *tcs = (XYZ *)malloc(4 * num_chars * sizeof(XYZ));
+  int *facets = (int *)malloc(6 * num_chars * sizeof(int));
+  if (!gl || !pens || !verts || !norms || !tcs || !facets) {
+    fprintf(stderr, "Failed to allocate memory for string\n");
+    free(gl); free(pens); free(verts); free(norms); free(tcs); free(facets);
+    return;
+  }
+  _S2FTGLYPH *g, *prev = NULL;
+  long pen = 0;
+  for (n = 0; n < num_chars; n++) {
+    gl[n] = g = _s2priv_ftGlyph(font, (unsigned char)text[n]);
+    if (!g) {
+      continue;
     }
+    if (prev) {
+      pen += _s2priv_ftKern(font, prev, g);
+    }
+    pens[n] = pen;
+    pen += g->advance;
+    prev = g;
   }
-  ss2pt(texid);
 
-  for (j = 0; j < HEIGHT; j++) {
-    free(image[j]);
+  /* facing direction, for lighting */
+  XYZ nrm = {right.y * up.z - right.z * up.y,
+	     right.z * up.x - right.x * up.z,
+	     right.x * up.y - right.y * up.x};
+  float len = sqrt(nrm.x * nrm.x + nrm.y * nrm.y + nrm.z * nrm.z);
+  if (len > 0.) {
+    nrm.x /= len; nrm.y /= len; nrm.z /= len;
   }
-  free(image);
 
-  return texid;
+  /* one mesh per atlas texture */
+  int page, k, nq;
+  for (page = 0; page < font->npages; page++) {
+    nq = 0;
+    for (n = 0; n < num_chars; n++) {
+      g = gl[n];
+      if (!g || (g->page != page)) {
+	continue;
+      }
+      /* corners in pixels from the pen, then in ems */
+      float x0 = (pens[n] / 64. + g->left) / fontsizepx;
+      float x1 = x0 + (float)g->w / fontsizepx;
+      float y1 = (float)g->top / fontsizepx;
+      float y0 = y1 - (float)g->h / fontsizepx;
+      float u0 = (float)g->x / _S2FTATLAS, u1 = (float)(g->x + g->w) / _S2FTATLAS;
+      float v0 = (float)g->y / _S2FTATLAS, v1 = (float)(g->y + g->h) / _S2FTATLAS;
+      float cx[4] = {x0, x1, x1, x0}, cy[4] = {y0, y0, y1, y1};
+      float cu[4] = {u0, u1, u1, u0}, cv[4] = {v0, v0, v1, v1};
+      for (k = 0; k < 4; k++) {
+	XYZ *v = verts + 4 * nq + k;
+	v->x = P.x + cx[k] * right.x + cy[k] * up.x;
+	v->y = P.y + cx[k] * right.y + cy[k] * up.y;
+	v->z = P.z + cx[k] * right.z + cy[k] * up.z;
+	norms[4 * nq + k] = nrm;
+	tcs[4 * nq + k].x = cu[k];
+	tcs[4 * nq + k].y = cv[k];
+	tcs[4 * nq + k].z = 0.;
+      }
+      int *f = facets + 6 * nq;
+      f[0] = 4 * nq; f[1] = 4 * nq + 1; f[2] = 4 * nq + 2;
+      f[3] = 4 * nq; f[4] = 4 * nq + 2; f[5] = 4 * nq + 3;
+      nq++;
+    }
+    if (nq) {
+      ns2texmeshc(4 * nq, verts, 4 * nq, norms, 4 * nq, tcs,
+		  2 * nq, facets, facets, font->pages[page], col, trans, alpha);
+    }
+  }
+
+  free(gl); free(pens); free(verts); free(norms); free(tcs); free(facets);
 }
 
 /* Convert a FORTRAN string and length to a C string with null
@@ -224,4 +426,3 @@ unsigned int ss2ftt_(char *fontfilename, char *text, int *fontsizepx,
   free(font);
   return result;
 }
-
@@ -539,49 +539,19 @@ unsigned int ss2lt(char *itexturefn) {
 
   /* textures loaded this way are all called "<cached>" so that they
    * are not deleted when geometry is deleted.  Consequently, we do
-   * not look for an existing texture of same name!
+   * not look for an existing texture of same name!  Geometry given a
+   * texture file name shares its textures via _s2priv_texAcquire.
    */
-
-  // 1. if filename starts with "." or "/" then attempt to open
-  //    precisely this file.  No other attempts will be made.  
-#if !defined(S2SUNOS)
-  struct stat filestat;
-#else
-  int filestat;
-#endif
-  if (!strncmp(itexturefn, ".", 1) || !strncmp(itexturefn, "/", 1)) {
-    if (!stat(itexturefn, &filestat)) {
-      bitmap = ReadTGATexture(itexturefn, &width, &height);
+  if (_s2priv_isTexFile(itexturefn)) {
+    /* texture files go straight from the file to OpenGL */
+    char texname[400];
+    unsigned int id;
+    if (_s2priv_findTexture(itexturefn, texname) &&
+	_s2priv_loadTexFile(texname, &id)) {
+      return id;
     }
   } else {
-    // 2. in order, try to load texture from current dir, then from
-    //    S2PLOT_TEXPATH (if defined), then from S2PATH/textures
-    //    (if defined).
-    char cwd[200], texname[200];
-    if (getcwd(cwd, 200)) {
-      sprintf(texname, "%s/%s", cwd, itexturefn);
-      if (!stat(texname, &filestat)) {
-	bitmap = ReadTGATexture(texname, &width, &height);
-      }
-    }
-    if (!bitmap) {
-      char *s2texpath = getenv("S2PLOT_TEXPATH");
-      if (s2texpath) {
-	sprintf(texname, "%s/%s", s2texpath, itexturefn);
-	if (!stat(texname, &filestat)) {
-	  bitmap = ReadTGATexture(texname, &width, &height);
-	}
-      }
-    }
-    if (!bitmap) {
-      char *s2path = getenv("S2PATH");
-      if (s2path) {
-	sprintf(texname, "%s/textures/%s", s2path, itexturefn);
-	if (!stat(texname, &filestat)) {
-	  bitmap = ReadTGATexture(texname, &width, &height);
-	}
-      }
-    }
+    bitmap = _s2priv_readTexture(itexturefn, &width, &height);
   }
   if (!bitmap) {
     fprintf(stderr, "Advisory: unable to load texture %s, using 'red X'\n",
@@ -595,6 +565,68 @@ unsigned int ss2lt(char *itexturefn) {
 
 }
 
+/* find the file for a texture, writing its full name into found
+ * (which must have room for 400 characters).  Returns 0 if there is
+ * no such file.
+ */
+int _s2priv_findTexture(char *itexturefn, char *found) {
+#if !defined(S2SUNOS)
+  struct stat filestat;
+#else
+  int filestat;
+#endif
+
+  // 1. if filename starts with "." or "/" then attempt to open
+  //    precisely this file.  No other attempts will be made.  
+  if (!strncmp(itexturefn, ".", 1) || !strncmp(itexturefn, "/", 1)) {
+    snprintf(found, 400, "%s", itexturefn);
+    return !stat(found, &filestat);
+  }
+
+  // 2. in order, try to load texture from current dir, then from
+  //    S2PLOT_TEXPATH (if defined), then from S2PATH/textures
+  //    (if defined).
+  char cwd[200];
+  if (getcwd(cwd, 200)) {
+    snprintf(found, 400, "%s/%s", cwd, itexturefn);
+    if (!stat(found, &filestat)) {
+      return 1;
+    }
+  }
+  char *s2texpath = getenv("S2PLOT_TEXPATH");
+  if (s2texpath) {
+    snprintf(found, 400, "%s/%s", s2texpath, itexturefn);
+    if (!stat(found, &filestat)) {
+      return 1;
+    }
+  }
+  char *s2path = getenv("S2PATH");
+  if (s2path) {
+    snprintf(found, 400, "%s/textures/%s", s2path, itexturefn);
+    if (!stat(found, &filestat)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* find and read the file for a texture - TGA, or a texture file
+ * (s2texfile.c) decoded in full - returning NULL if it cannot be
+ * found or read.  This touches no OpenGL or S2PLOT state, so it is
+ * safe to call from the background loader (s2texload.c).
+ */
+BITMAP4 *_s2priv_readTexture(char *itexturefn, int *width, int *height) {
+  char texname[400];
+  if (!_s2priv_findTexture(itexturefn, texname)) {
+    return NULL;
+  }
+  if (_s2priv_isTexFile(texname)) {
+    return _s2priv_readTexFile(texname, width, height);
+  }
+  /* not ReadTGATexture, which calls rand() */
+  return ReadTGABitmap(texname, width, height);
+}
+
 
 /* reinstall a texture, eg. after modifying the map returned by 
  * s2ext_gettexture.
@@ -609,95 +641,242 @@ void ss2ptt(unsigned int itextureID) {
 }
 
 void _s2priv_ss2pt(unsigned int itextureID, int usemipmaps) {
-  int i;
-  for (i = 0; i < _s2_ctext_count; i++) {
-    if (_s2_ctext[i].id == itextureID) {
-      /* fetch known properties */
-      int width = _s2_ctext[i].width;
-      int height = _s2_ctext[i].height;
-      int depth = _s2_ctext[i].depth;
-      int doing3d = (depth > 0);
+  int i = _s2priv_texIndex(itextureID);
+  if (i < 0) {
+    return;
+  }
+  /* fetch known properties */
+  int width = _s2_ctext[i].width;
+  int height = _s2_ctext[i].height;
+  int depth = _s2_ctext[i].depth;
+  int doing3d = (depth > 0);
 #if !defined(S2_3D_TEXTURES)
-      if (doing3d) {
-	_s2error("ss2pt/ss2ptt", "Cannot use 3D texture on this platform");
-      }
+  if (doing3d) {
+    _s2error("ss2pt/ss2ptt", "Cannot use 3D texture on this platform");
+  }
 #endif
-      BITMAP4 *bitmap = _s2_ctext[i].bitmap;
-
-      if (_s2_devcap & _S2DEVCAP_NOCOLOR) {
-	// desaturate the bitmap data
-	int i, j, k;
-	long idx = 0;
-	float sum;
-	for (i = 0; i < width; i++) {
-	  for (j = 0; j < height; j++) {
-	    if (doing3d) {
-	      for (k = 0; k < depth; k++) {
-		sum = (bitmap[idx].r + bitmap[idx].g + bitmap[idx].b) * 0.33;
-		bitmap[idx].r = bitmap[idx].g = bitmap[idx].b = sum;
-		idx++;
-	      }
-	    } else {
-	      sum = (bitmap[idx].r + bitmap[idx].g + bitmap[idx].b) * 0.33;
-	      bitmap[idx].r = bitmap[idx].g = bitmap[idx].b = sum;
-	      idx++;
-	    }
+  BITMAP4 *bitmap = _s2priv_texBitmap(i);
+  if (!bitmap) {
+    return;
+  }
+
+  if (_s2_devcap & _S2DEVCAP_NOCOLOR) {
+    // desaturate the bitmap data
+    int i, j, k;
+    long idx = 0;
+    float sum;
+    for (i = 0; i < width; i++) {
+      for (j = 0; j < height; j++) {
+	if (doing3d) {
+	  for (k = 0; k < depth; k++) {
+	    sum = (bitmap[idx].r + bitmap[idx].g + bitmap[idx].b) * 0.33;
+	    bitmap[idx].r = bitmap[idx].g = bitmap[idx].b = sum;
+	    idx++;
 	  }
+	} else {
+	  sum = (bitmap[idx].r + bitmap[idx].g + bitmap[idx].b) * 0.33;
+	  bitmap[idx].r = bitmap[idx].g = bitmap[idx].b = sum;
+	  idx++;
 	}
       }
+    }
+  }
 
-      if(options.stereo < 0) {
-	return;
-      }
+  if(options.stereo < 0) {
+    return;
+  }
 #if defined(S2_3D_TEXTURES)
-      int gl_tex_mode = doing3d ? GL_TEXTURE_3D : GL_TEXTURE_2D;
+  int gl_tex_mode = doing3d ? GL_TEXTURE_3D : GL_TEXTURE_2D;
 #else
-      int gl_tex_mode = GL_TEXTURE_2D;
+  int gl_tex_mode = GL_TEXTURE_2D;
 #endif
 
-      /* and rebind */
-      glBindTexture(gl_tex_mode,itextureID);
-      glTexParameterf(gl_tex_mode,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
-      glTexParameterf(gl_tex_mode,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+  /* and rebind */
+  glBindTexture(gl_tex_mode,itextureID);
+  glTexParameterf(gl_tex_mode,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+  glTexParameterf(gl_tex_mode,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
 #if defined(S2_3D_TEXTURES)
-      if (doing3d) {
-	glTexParameterf(gl_tex_mode,GL_TEXTURE_WRAP_R,GL_CLAMP_TO_EDGE);
-      }
+  if (doing3d) {
+    glTexParameterf(gl_tex_mode,GL_TEXTURE_WRAP_R,GL_CLAMP_TO_EDGE);
+  }
 #endif
 
-      if (usemipmaps) {
-	glTexParameterf(gl_tex_mode,GL_TEXTURE_MIN_FILTER,
-			GL_LINEAR_MIPMAP_LINEAR);
-      } else {
-	glTexParameterf(gl_tex_mode, GL_TEXTURE_MIN_FILTER,
-			GL_LINEAR);
-      }
-      glTexParameterf(gl_tex_mode,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+  if (usemipmaps) {
+    glTexParameterf(gl_tex_mode,GL_TEXTURE_MIN_FILTER,
+		    GL_LINEAR_MIPMAP_LINEAR);
+  } else {
+    glTexParameterf(gl_tex_mode, GL_TEXTURE_MIN_FILTER,
+		    GL_LINEAR);
+  }
+  glTexParameterf(gl_tex_mode,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
 #if defined(S2_3D_TEXTURES)
-      if (doing3d) {
-	glTexImage3D(GL_TEXTURE_3D,0,4, width, height,depth,
-		     0,GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
-	if (usemipmaps) {
-	  gluBuild3DMipmaps(GL_TEXTURE_3D,4,
-			    width, height, depth,
-			    GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
-	}
-      } else
+  if (doing3d) {
+    glTexImage3D(GL_TEXTURE_3D,0,4, width, height,depth,
+		 0,GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
+  } else
 #endif
-	{
-	glTexImage2D(GL_TEXTURE_2D,0,4, width, height,
-		     0,GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
-	if (usemipmaps) {
-	  gluBuild2DMipmaps(GL_TEXTURE_2D,4,
-			    width, height,
-			    GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
+    {
+    glTexImage2D(GL_TEXTURE_2D,0,4, width, height,
+		 0,GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
+  }
+  if (usemipmaps) {
+    _s2priv_buildMipmaps(gl_tex_mode, width, height, depth, bitmap);
+  }
+  if (_s2_ctext[i].packed) {
+    /* the stored mipmap levels no longer match level 0 */
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+    _s2_ctext[i].packed = 0;
+  }
+  _s2_ctext[i].mipmaps = usemipmaps;
+  glTexEnvf(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_MODULATE);
+  return;
+}
+
+/* reinstall part of a texture: columns x0 to x1, rows y0 to y1 and,
+ * for 3d textures, slabs z0 to z1 (all inclusive).  Mipmaps are
+ * regenerated if the texture was last installed with them.
+ */
+void ss2ptr(unsigned int itextureID, int x0, int x1, int y0, int y1) {
+  _s2priv_ss2ptr(itextureID, x0, x1, y0, y1, 0, -1);
+}
+#if defined(S2_3D_TEXTURES)
+void ss2p3dtr(unsigned int itextureID, int x0, int x1, int y0, int y1,
+	      int z0, int z1) {
+  _s2priv_ss2ptr(itextureID, x0, x1, y0, y1, z0, z1);
+}
+#endif
+
+void _s2priv_ss2ptr(unsigned int itextureID, int x0, int x1, int y0, int y1,
+		    int z0, int z1) {
+  int i = _s2priv_texIndex(itextureID);
+  if (i < 0) {
+    return;
+  }
+  int width = _s2_ctext[i].width;
+  int height = _s2_ctext[i].height;
+  int depth = _s2_ctext[i].depth;
+  int doing3d = (depth > 0);
+#if !defined(S2_3D_TEXTURES)
+  if (doing3d) {
+    _s2error("ss2ptr", "Cannot use 3D texture on this platform");
+  }
+#endif
+  if (_s2_ctext[i].packed) {
+    /* still in the form stored in its texture file: reinstall whole */
+    _s2priv_ss2pt(itextureID, _s2_ctext[i].mipmaps);
+    return;
+  }
+  BITMAP4 *bitmap = _s2_ctext[i].bitmap;
+
+  /* clip the region to the texture; a 2d region of a 3d texture
+   * covers every slab */
+  if (!doing3d) {
+    z0 = z1 = 0;
+  } else if (z1 < z0) {
+    z0 = 0;
+    z1 = depth - 1;
+  }
+  x0 = MAX(x0, 0);
+  y0 = MAX(y0, 0);
+  z0 = MAX(z0, 0);
+  x1 = MIN(x1, width - 1);
+  y1 = MIN(y1, height - 1);
+  z1 = MIN(z1, (doing3d ? depth : 1) - 1);
+  if (x1 < x0 || y1 < y0 || z1 < z0) {
+    return;
+  }
+
+  if (_s2_devcap & _S2DEVCAP_NOCOLOR) {
+    // desaturate the bitmap data in the region
+    int ix, iy, iz;
+    long idx;
+    float sum;
+    for (iz = z0; iz <= z1; iz++) {
+      for (iy = y0; iy <= y1; iy++) {
+	idx = ((long)iz * height + iy) * width + x0;
+	for (ix = x0; ix <= x1; ix++, idx++) {
+	  sum = (bitmap[idx].r + bitmap[idx].g + bitmap[idx].b) * 0.33;
+	  bitmap[idx].r = bitmap[idx].g = bitmap[idx].b = sum;
 	}
       }
-      glTexEnvf(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_MODULATE);
-      return;
     }
   }
-  return;
+
+  if (options.stereo < 0) {
+    return;
+  }
+#if defined(S2_3D_TEXTURES)
+  int gl_tex_mode = doing3d ? GL_TEXTURE_3D : GL_TEXTURE_2D;
+#else
+  int gl_tex_mode = GL_TEXTURE_2D;
+#endif
+
+  /* upload just the region, read in place from the full bitmap; the
+   * pixel store settings are the application's, so put them back */
+  glBindTexture(gl_tex_mode, itextureID);
+  glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, x0);
+  glPixelStorei(GL_UNPACK_SKIP_ROWS, y0);
+#if defined(S2_3D_TEXTURES)
+  if (doing3d) {
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, height);
+    glPixelStorei(GL_UNPACK_SKIP_IMAGES, z0);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, x0, y0, z0,
+		    x1 - x0 + 1, y1 - y0 + 1, z1 - z0 + 1,
+		    GL_RGBA, GL_UNSIGNED_BYTE, bitmap);
+  } else
+#endif
+    {
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, x1 - x0 + 1, y1 - y0 + 1,
+		    GL_RGBA, GL_UNSIGNED_BYTE, bitmap);
+  }
+  glPopClientAttrib();
+
+  if (_s2_ctext[i].mipmaps) {
+    _s2priv_buildMipmaps(gl_tex_mode, width, height, depth, bitmap);
+  }
+}
+
+/* can mipmaps be generated by the GPU (OpenGL 3.0 or framebuffer
+ * objects)?  Checked once, in the first context we get. */
+static int _s2priv_gpuMipmaps(void) {
+  static int has = -1;
+  if (has < 0) {
+    const char *ver = (const char *)glGetString(GL_VERSION);
+    const char *ext = (const char *)glGetString(GL_EXTENSIONS);
+    has = (ver && atoi(ver) >= 3) ||
+      (ext && (strstr(ext, "GL_ARB_framebuffer_object") ||
+	       strstr(ext, "GL_EXT_framebuffer_object")));
+  }
+  return has;
+}
+
+/* (re)build the mipmaps of the bound texture from its level 0, on the
+ * GPU where possible; otherwise the whole pyramid is made on the CPU
+ * from the bitmap */
+void _s2priv_buildMipmaps(int gl_tex_mode, int width, int height, int depth,
+			  BITMAP4 *bitmap) {
+  if (_s2priv_gpuMipmaps()) {
+#if defined(S2DARWIN)
+    glGenerateMipmapEXT(gl_tex_mode);
+#else
+    glGenerateMipmap(gl_tex_mode);
+#endif
+    return;
+  }
+#if defined(S2_3D_TEXTURES)
+  if (gl_tex_mode == GL_TEXTURE_3D) {
+    gluBuild3DMipmaps(GL_TEXTURE_3D,4,
+		      width, height, depth,
+		      GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
+    return;
+  }
+#endif
+  gluBuild2DMipmaps(GL_TEXTURE_2D,4,
+		    width, height,
+		    GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
 }
 
 int __texid = 0;
@@ -737,9 +916,7 @@ unsigned int _s2priv_setupTexture(int width, int height,
     glTexImage2D(GL_TEXTURE_2D,0,4, width, height,
 		 0,GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
     if (usemipmaps) {
-      gluBuild2DMipmaps(GL_TEXTURE_2D,4,
-			width, height,
-			GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
+      _s2priv_buildMipmaps(GL_TEXTURE_2D, width, height, 0, bitmap);
     }
     glTexEnvf(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_MODULATE);
     assign_id = id;
@@ -748,15 +925,7 @@ unsigned int _s2priv_setupTexture(int width, int height,
     __texid++;
   }
   /* assume all went well - possibly a bad assumption */
-  _s2_ctext = (_S2CACHEDTEXTURE *)realloc(_s2_ctext, (_s2_ctext_count+1) *
-					   sizeof(_S2CACHEDTEXTURE));
-  _s2_ctext[_s2_ctext_count].width = width;
-  _s2_ctext[_s2_ctext_count].height = height;
-  _s2_ctext[_s2_ctext_count].depth = 0;
-  _s2_ctext[_s2_ctext_count].bitmap = bitmap;
-  _s2_ctext[_s2_ctext_count].id = assign_id;
-
-  _s2_ctext_count++;
+  _s2priv_texRegister(assign_id, width, height, 0, bitmap, usemipmaps);
   return (unsigned int)assign_id;
 }
 
@@ -800,9 +969,7 @@ unsigned int _s2priv_setupTexture3d(int width, int height, int depth,
     glTexImage3D(GL_TEXTURE_3D,0,4, width, height,depth,
 		 0,GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
     if (usemipmaps) {
-      gluBuild3DMipmaps(GL_TEXTURE_3D,4,
-			width, height, depth,
-			GL_RGBA,GL_UNSIGNED_BYTE,bitmap);
+      _s2priv_buildMipmaps(GL_TEXTURE_3D, width, height, depth, bitmap);
     }
     glTexEnvf(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_MODULATE);
     assign_id = id;
@@ -811,26 +978,16 @@ unsigned int _s2priv_setupTexture3d(int width, int height, int depth,
     __texid++;
   }
   /* assume all went well - possibly a bad assumption */
-  _s2_ctext = (_S2CACHEDTEXTURE *)realloc(_s2_ctext, (_s2_ctext_count+1) *
-					   sizeof(_S2CACHEDTEXTURE));
-  _s2_ctext[_s2_ctext_count].width = width;
-  _s2_ctext[_s2_ctext_count].height = height;
-  _s2_ctext[_s2_ctext_count].depth = depth;
-  _s2_ctext[_s2_ctext_count].bitmap = bitmap;
-  _s2_ctext[_s2_ctext_count].id = assign_id;
-
-  _s2_ctext_count++;
+  _s2priv_texRegister(assign_id, width, height, depth, bitmap,
+		      usemipmaps);
   return (unsigned int)assign_id;
 }
 #endif
 
 
 void _s2priv_dropTexture(unsigned int texid) {
-  int i = 0, j;
-  while (i < _s2_ctext_count && _s2_ctext[i].id != texid) {
-    i++;
-  }
-  if (i >= _s2_ctext_count) {
+  int i = _s2priv_texIndex(texid);
+  if (i < 0) {
     return;
   }
 
@@ -840,14 +997,6 @@ void _s2priv_dropTexture(unsigned int texid) {
   }
 
   free(_s2_ctext[i].bitmap);
-
-  /* this loop could be removed and replaced with one calculated
-   * call to bcopy ... */
-  for (j = i; j < (_s2_ctext_count-1); j++) {
-    bcopy(_s2_ctext + j + 1, _s2_ctext + j, sizeof(_S2CACHEDTEXTURE));
-  }
-  _s2_ctext = (_S2CACHEDTEXTURE *)realloc(_s2_ctext, (_s2_ctext_count - 1) *
-					   sizeof(_S2CACHEDTEXTURE));
-  _s2_ctext_count--;
+  _s2priv_texUnregister(i);
 }
 
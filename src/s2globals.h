@@ -321,6 +321,19 @@ extern int _s2_nvol;
 extern int _s2_vralphascaling;
 extern float _s2_evas_x, _s2_evas_y, _s2_evas_z;
 
+/* billboards are expanded to quads in a vertex shader (ss2tbbx) */
+extern int _s2_bbshader;
+
+/* static dot clouds are drawn at reduced detail while the view
+ * moves (ss2tlod) */
+extern int _s2_lodpoints;
+
+/* frame-time governor (ss2sfb) */
+extern _S2GOVERNOR _s2_governor;
+
+/* frame profile (ss2tprof) */
+extern _S2PROFILE _s2_profile;
+
 
 extern double _s2_fadetime;
 extern int _s2_fadestatus; /* 0 = start fade-in, 1 = fade-in, 2 = normal running, */
@@ -366,6 +379,12 @@ extern int _s2_nVRMLnames;
 extern char **_s2_VRMLnames;
 extern int _s2_currVRMLidx;
 
+extern int _s2_nscreentags;
+extern char **_s2_screentags;
+extern unsigned char *_s2_screentagbits;
+extern unsigned short _s2_currscreentag;
+extern unsigned char _s2_doingScreenBit;
+
 /* are we using an ati card? (requires no multisampling) */
 extern int _s2x_ati;
 
@@ -375,6 +394,12 @@ extern int _s2x_ywinpos;
 /* cache of textures (generally used in callbacks) */
 extern int _s2_ctext_count;
 extern _S2CACHEDTEXTURE *_s2_ctext;
+extern int _s2_ctext_alloc;
+extern long _s2_ctext_bytes;
+
+/* hash tables indexing the texture cache by id and by file name */
+extern int *_s2_texreg_byid, *_s2_texreg_byname;
+extern int _s2_texreg_nslot;
 
 /* global store for MPI state and world display position */
 #if defined(S2MPICH)
@@ -0,0 +1,145 @@
+/* s2govern.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Frame-time governor (ss2sfb).
+ *
+ * The stages of each frame (callbacks, packing geometry, depth sorts
+ * and drawing) are timed by the frame profile's timers (s2prof.c).
+ * While the view of any panel is moving (see _s2priv_lodMotion) and
+ * frames take longer than the budget, the governor raises its level,
+ * and each cost knob is coarsened by one step per level: volume
+ * rendering slice stride, sphere resolution, isosurface resolution
+ * and the depth of point detail (ss2tlod).  It lowers the level again
+ * when frames come in well under budget, and returns to full quality
+ * as soon as the view settles.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+#if defined(BUILDING_S2PLOT)
+
+/* levels of coarsening the governor can apply */
+#define _S2GOVMAXLEVEL 3
+/* coarsen above this fraction of the budget, refine below the next */
+#define _S2GOVOVER 1.1
+#define _S2GOVUNDER 0.4
+
+static char *_s2x_govstagenames[_S2GOV_NSTAGES] = {
+  "callbacks", "geometry", "sort", "draw"};
+
+/* the value of a cost knob at the current level, given its value at
+ * full quality */
+int _s2priv_govern(int knob, int full) {
+  int level = _s2_governor.level;
+  if (!level) {
+    return full;
+  }
+  switch (knob) {
+  case _S2GOV_SPHERE:
+    /* halve the resolution per level, but keep spheres round-ish */
+    for (; level && (full / 2 >= 6); level--) {
+      full /= 2;
+    }
+    return full;
+  case _S2GOV_SLICES:
+    /* full is the slice stride */
+    return full << level;
+  case _S2GOV_ISORES:
+    /* full is the grid resolution: double the cell size per level */
+    return full << level;
+  case _S2GOV_POINTS:
+    /* full is the coarsest point level wanted: go that many more up */
+    return full + level;
+  }
+  return full;
+}
+
+/* a frame was completed at time tm: record its stage times and 
+ * choose the level for the next frame */
+void _s2priv_govFrame(double tm) {
+  static double tlast = -1.;
+  int i, moving, level;
+  double tframe, tdraw;
+
+  tframe = (tlast > 0.) ? tm - tlast : 0.;
+  tlast = tm;
+  if (_s2_governor.budget <= 0.) {
+    _s2_governor.level = 0;
+    memset(_s2_governor.t, 0, _S2GOV_NSTAGES * sizeof(double));
+    return;
+  }
+
+  /* the draw stage is timed around the whole of drawing: take out
+   * the packing and sorting done within it */
+  tdraw = _s2_governor.t[_S2GOV_DRAW];
+  for (i = _S2GOV_GEOMETRY; i < _S2GOV_DRAW; i++) {
+    tdraw -= _s2_governor.t[i];
+  }
+  _s2_governor.t[_S2GOV_DRAW] = (tdraw > 0.) ? tdraw : 0.;
+  memcpy(_s2_governor.last, _s2_governor.t, _S2GOV_NSTAGES * sizeof(double));
+  memset(_s2_governor.t, 0, _S2GOV_NSTAGES * sizeof(double));
+
+  for (i = 0, moving = 0; i < _s2_npanels; i++) {
+    moving |= _s2_panels[i].active && (_s2_panels[i].lodmoving > 0);
+  }
+
+  /* the frame time includes any wait for targetfps, so never ask for
+   * more than that allows */
+  level = _s2_governor.level;
+  if (!moving) {
+    level = 0;
+  } else if ((tframe > _s2_governor.budget * _S2GOVOVER) &&
+	     (tframe > 1.0 / options.targetfps * _S2GOVOVER)) {
+    level = (level < _S2GOVMAXLEVEL) ? level + 1 : level;
+  } else if (tframe < _s2_governor.budget * _S2GOVUNDER) {
+    level = (level > 0) ? level - 1 : level;
+  }
+
+  if (level != _s2_governor.level) {
+    if (options.debug) {
+      char stages[256];
+      int n = 0;
+      for (i = 0; i < _S2GOV_NSTAGES; i++) {
+	n += snprintf(stages + n, sizeof(stages) - n, "%s%s %.1f", 
+		      i ? ", " : "", _s2x_govstagenames[i], 
+		      _s2_governor.last[i] * 1000.);
+      }
+      _s2debug("(governor)", "frame %.1f ms (%s), budget %.1f ms, %s: "
+	       "level %d -> %d", tframe * 1000., stages,
+	       _s2_governor.budget * 1000., moving ? "moving" : "still",
+	       _s2_governor.level, level);
+    }
+    _s2_governor.level = level;
+  }
+}
+
+#endif
@@ -41,6 +41,8 @@
 #if defined(S2DARWIN)
 #include <OpenGL/gl.h>
 #else
+/* as per geomviewer.h: must be set before gl.h includes glext.h */
+#define GL_GLEXT_PROTOTYPES
 #include <GL/gl.h>
 #endif
 
@@ -425,6 +427,10 @@ void inits2plot(void) {
     /* no pre-loaded cached textures */
     _s2_ctext_count = 0;
     _s2_ctext = NULL;
+    _s2_ctext_alloc = 0;
+    _s2_ctext_bytes = 0;
+    _s2_texreg_byid = _s2_texreg_byname = NULL;
+    _s2_texreg_nslot = 0;
     
     /* default state is to not record geom, view or image */
     _s2_recstate = 0;
@@ -506,6 +512,18 @@ void inits2plot(void) {
     _s2_volumes = NULL;
     _s2_vralphascaling = 0;  // no scaling by default
     _s2_evas_x = _s2_evas_y = _s2_evas_z = -1.0;
+
+    /* billboards are expanded on the CPU by default */
+    _s2_bbshader = 0;
+
+    /* static dot clouds are always drawn in full by default */
+    _s2_lodpoints = 0;
+
+    /* no frame budget: always draw at full quality */
+    memset(&_s2_governor, 0, sizeof(_S2GOVERNOR));
+
+    /* no frame profile */
+    memset(&_s2_profile, 0, sizeof(_S2PROFILE));
     
     /* isosurfaces */
     _s2_nisosurf = 0;
@@ -536,8 +554,10 @@ void inits2plot(void) {
     /* normal (3d) coordinates */
     //_s2_screenco = 0;
     strcpy(_s2_whichscreen, "");
+    _s2_currscreentag = _s2priv_screenTag(_s2_whichscreen);
     _s2_screenEnabled = 0;
     strcpy(_s2_doingScreen, "");
+    _s2_doingScreenBit = 0;
     
     /* command prompt */
     _s2prompt_length = -1; // not prompting
@@ -1268,6 +1288,7 @@ void drawView(char *projinfo, double camsca) {
         
         // draw the screen geometry
         strcpy(_s2_doingScreen, projinfo);
+        _s2_doingScreenBit = _s2priv_screenBits(_s2_doingScreen);
         glDisable(GL_LIGHTING);
         int tmp = options.rendermode;
         options.rendermode = SHADE_FLAT;
@@ -1275,6 +1296,7 @@ void drawView(char *projinfo, double camsca) {
         glEnable(GL_LIGHTING);
         options.rendermode = tmp;
         strcpy(_s2_doingScreen, "");
+        _s2_doingScreenBit = 0;
         
         // draw the panel surround
         if (_s2_npanels > 1) { 	
@@ -1555,7 +1577,11 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
     if (transparency < 1)
         glDepthMask(GL_FALSE);
     
-    // Balls 
+    // Balls: instances of the cached unit sphere, scaled by their
+    // radius, so their normals need renormalising
+    if (nball) {
+        glEnable(GL_NORMALIZE);
+    }
     for (i=0;i<nball;i++) {
 #if !defined(BUILDING_S2PLOT)
         glLoadName(objectid++);
@@ -1564,18 +1590,20 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
         
 #if defined(BUILDING_S2PLOT) && defined(FIXME)
         if (doscreen) {
-            if (strlen(_s2_doingScreen) && 
-                strstr(ball[i].whichscreen, _s2_doingScreen)) {
+            if (_S2ONSCREEN(ball[i].whichscreen)) {
                 // screen geometry
                 s2UnProject(view[0] + view[2] * ball[i].p.x + 0.5, 
                             view[1] + view[3] * ball[i].p.y + 0.5, 
                             ball[i].p.z, 
                             model, proj, view, &vt.x, &vt.y, &vt.z);
-                CreateASphere(vt, ball[i].r, options.sphereresolution, 1,1);
+                DrawSphereInstance(vt, ball[i].r, options.sphereresolution);
             }
-        } else if (!strlen(ball[i].whichscreen))
+        } else if (!ball[i].whichscreen)
 #endif
-            CreateASphere(ball[i].p,ball[i].r,options.sphereresolution,1,1);
+            DrawSphereInstance(ball[i].p,ball[i].r,options.sphereresolution);
+    }
+    if (nball) {
+        glDisable(GL_NORMALIZE);
     }
     
     // Disks 
@@ -1587,8 +1615,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
         
 #if defined(BUILDING_S2PLOT) && defined(FIXME)
         if (doscreen) {
-            if (strlen(_s2_doingScreen) &&
-                strstr(disk[i].whichscreen, _s2_doingScreen)) {
+            if (_S2ONSCREEN(disk[i].whichscreen)) {
                 // screen geometry
                 s2UnProject(view[0] + view[2] * disk[i].p.x + 0.5, 
                             view[1] + view[3] * disk[i].p.y + 0.5, 
@@ -1616,11 +1643,11 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                 dor2 = sqrt((vtmp.x - vt.x)*(vtmp.x - vt.x) +
                             (vtmp.y - vt.y)*(vtmp.y - vt.y));
                 
-                CreateDisk(vt, vtn, dor2, dor1, 32, 0.0, TWOPI);
+                DrawDiskInstance(vt, vtn, dor2, dor1, 32);
             }
-        } else if (!strlen(disk[i].whichscreen))
+        } else if (!disk[i].whichscreen)
 #endif
-            CreateDisk(disk[i].p,disk[i].n,disk[i].r2,disk[i].r1,32,0.0,TWOPI);
+            DrawDiskInstance(disk[i].p,disk[i].n,disk[i].r2,disk[i].r1,32);
     }
     
     
@@ -1633,8 +1660,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
         
 #if defined(BUILDING_S2PLOT) && defined(FIXME)
         if (doscreen) {
-            if (strlen(_s2_doingScreen) && 
-                strstr(cone[i].whichscreen, _s2_doingScreen)) {
+            if (_S2ONSCREEN(cone[i].whichscreen)) {
                 // screen geometry
                 s2UnProject(view[0] + view[2] * cone[i].p2.x + 0.5, 
                             view[1] + view[3] * cone[i].p2.y + 0.5, 
@@ -1644,11 +1670,11 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                             view[1] + view[3] * cone[i].p1.y + 0.5, 
                             cone[i].p1.z, 
                             model, proj, view, &vtn.x, &vtn.y, &vtn.z);
-                CreateCone(vt, vtn, cone[i].r2, cone[i].r1, 32, 0.0, TWOPI);
+                DrawConeInstance(vt, vtn, cone[i].r2, cone[i].r1, 32);
             }
-        } else if (!strlen(cone[i].whichscreen))
+        } else if (!cone[i].whichscreen)
 #endif
-            CreateCone(cone[i].p2,cone[i].p1,cone[i].r2,cone[i].r1,32,0.0,TWOPI);
+            DrawConeInstance(cone[i].p2,cone[i].p1,cone[i].r2,cone[i].r1,32);
     }
     
     // 3 vertex faces 
@@ -1664,8 +1690,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
         for (i=0;i<nface3;i++) {
 #if defined(BUILDING_S2PLOT)
             if (doscreen) {
-                if (strlen(_s2_doingScreen) &&
-                    strstr(face3[i].whichscreen, _s2_doingScreen)) {
+                if (_S2ONSCREEN(face3[i].whichscreen)) {
                     // screen geometry
                     for (j = 0; j < 3; j++) {
                         s2UnProject(view[0] + view[2] * face3[i].p[j].x + 0.5, 
@@ -1685,7 +1710,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                     }
                     nf3++;
                 }
-            } else if (!strlen(face3[i].whichscreen)) 
+            } else if (!face3[i].whichscreen) 
 #endif
             {
                 for (j=0;j<3;j++) {
@@ -1725,8 +1750,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
         for (i=0;i<nface3;i++) {
 #if defined(BUILDING_S2PLOT)
             if (doscreen) {
-                if (strlen(_s2_doingScreen) &&
-                    strstr(face3[i].whichscreen, _s2_doingScreen)) {
+                if (_S2ONSCREEN(face3[i].whichscreen)) {
                     // screen geometry
                     for (j = 0; j < 3; j++) {
                         s2UnProject(view[0] + view[2] * face3[i].p[j].x + 0.5, 
@@ -1739,7 +1763,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                         glVertex3f(vtx, vty, vtz);
                     }
                 }
-            } else if (!strlen(face3[i].whichscreen)) 
+            } else if (!face3[i].whichscreen) 
 #endif
             {
                 for (j=0;j<3;j++) {
@@ -1761,8 +1785,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
         for (i=0;i<nface4;i++) {
 #if defined(BUILDING_S2PLOT)
             if (doscreen) {
-                if (strlen(_s2_doingScreen) && 
-                    strstr(face4[i].whichscreen, _s2_doingScreen)) {
+                if (_S2ONSCREEN(face4[i].whichscreen)) {
                     // screen geometry
                     for (j = 0; j < 4; j++) {
                         s2UnProject(view[0] + view[2] * face4[i].p[j].x + 0.5, 
@@ -1775,7 +1798,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                         glVertex3f(vtx, vty, vtz);
                     }
                 }
-            } else if (!strlen(face4[i].whichscreen))
+            } else if (!face4[i].whichscreen)
 #endif
             {
                 // normal 3d geometry
@@ -1801,8 +1824,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
         
 #if defined(BUILDING_S2PLOT)
         if (doscreen) {
-            if (strlen(_s2_doingScreen) && 
-                strstr(label[i].whichscreen, _s2_doingScreen)) {
+            if (_S2ONSCREEN(label[i].whichscreen)) {
                 for (j = 0; j < nlinelist; j += 2) {
                     glBegin(GL_LINES);
                     s2UnProject(view[0] + view[2] * linelist[j].x + 0.5, 
@@ -1818,7 +1840,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                     glEnd();
                 }
             }
-        } else if (!strlen(label[i].whichscreen)) {
+        } else if (!label[i].whichscreen) {
 #endif 
             for (j=0;j<nlinelist;j+=2) {
                 glBegin(GL_LINES);
@@ -1864,16 +1886,15 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
             
 #if defined(BUILDING_S2PLOT)
             if (doscreen) {
-                if (strlen(_s2_doingScreen) && 
-                    strstr(dot[i].whichscreen, _s2_doingScreen)) {
-		  fprintf(stderr, "dot[%d].whichscreen = %s\n", i, dot[i].whichscreen);
+                if (_S2ONSCREEN(dot[i].whichscreen)) {
+		  fprintf(stderr, "dot[%d].whichscreen = %s\n", i, _s2_screentags[dot[i].whichscreen]);
                     s2UnProject(view[0] + view[2] * dot[i].p.x, 
                                 view[1] + view[3] * dot[i].p.y, 
                                 dot[i].p.z, 
                                 model, proj, view, &vtx, &vty, &vtz);
                     glVertex3f(vtx, vty, vtz);
                 }
-            } else if (!strlen(dot[i].whichscreen))
+            } else if (!dot[i].whichscreen)
 #endif
             {
                 glVertex3f(dot[i].p.x,dot[i].p.y,dot[i].p.z);
@@ -1914,8 +1935,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                 }
 #if defined(BUILDING_S2PLOT)
                 if (doscreen) {
-                    if (strlen(_s2_doingScreen) && 
-                        strstr(line[i].whichscreen, _s2_doingScreen)) {
+                    if (_S2ONSCREEN(line[i].whichscreen)) {
                         for (j = 0; j < 2; j++) {
                             s2UnProject(view[0] + view[2] * line[i].p[j].x + 0.5, 
                                         view[1] + view[3] * line[i].p[j].y + 0.5, 
@@ -1927,7 +1947,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                             glVertex3f(vtx, vty, vtz);
                         }		
                     } 
-                } else if (!strlen(line[i].whichscreen)) 
+                } else if (!line[i].whichscreen) 
 #endif
                 {
                     for (j=0;j<2;j++) {
@@ -1966,8 +1986,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
             
 #if defined(BUILDING_S2PLOT) && defined(FIXME)
             if (doscreen) {
-                if (strlen(_s2_doingScreen) && 
-                    strstr(ballt[i].whichscreen, _s2_doingScreen)) {
+                if (_S2ONSCREEN(ballt[i].whichscreen)) {
                     // screen geometry
                     s2UnProject(view[0] + view[2] * ballt[i].p.x + 0.5,
                                 view[1] + view[3] * ballt[i].p.y + 0.5, 
@@ -1977,7 +1996,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                                   ballt[i].texture_phase, ballt[i].axis,
                                   ballt[i].rotation);
                 }
-            } else if (!strlen(ballt[i].whichscreen))
+            } else if (!ballt[i].whichscreen)
 #endif
 #if defined(BUILDING_S2PLOT)
                 CreateAPlanet(ballt[i].p,ballt[i].r,options.sphereresolution,1,1,
@@ -2045,8 +2064,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                 glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
             }      
             if (doscreen) {
-                if (strlen(_s2_doingScreen) && 
-                    strstr(face4t[i].whichscreen, _s2_doingScreen)) {
+                if (_S2ONSCREEN(face4t[i].whichscreen)) {
                     
                     glBegin(GL_QUADS);
                     _glColor4f(face4t[i].colour.r,face4t[i].colour.g,
@@ -2076,7 +2094,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                     
                 }
                 
-            } else if (!strlen(face4t[i].whichscreen))
+            } else if (!face4t[i].whichscreen)
                 
 #endif
             {
@@ -2123,8 +2141,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                     glDisable(GL_BLEND);
                 }
                 if (doscreen) {
-                    if (strlen(_s2_doingScreen) && 
-                        strstr(face3a[i].whichscreen, _s2_doingScreen)) {
+                    if (_S2ONSCREEN(face3a[i].whichscreen)) {
                         glBegin(GL_TRIANGLES);
                         for (j = 0; j < 3; j++) {
                             /* screen z coord in glUnProject: 0.0 = near plane,
@@ -2142,7 +2159,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                         glEnd();
                         
                     }
-                } else if (!strlen(face3a[i].whichscreen)) {
+                } else if (!face3a[i].whichscreen) {
                     glBegin(GL_TRIANGLES);
                     for (j=0;j<3;j++) {
                         glNormal3f(face3a[i].n[j].x,face3a[i].n[j].y,face3a[i].n[j].z);
@@ -2180,11 +2197,10 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                 glTexParameterf(GL_TEXTURE_3D,GL_TEXTURE_WRAP_R,GL_CLAMP_TO_EDGE);
                 
                 if (doscreen) {
-                    if (strlen(_s2_doingScreen) &&
-                        strstr(texpoly3d[i].whichscreen, _s2_doingScreen)) {
+                    if (_S2ONSCREEN(texpoly3d[i].whichscreen)) {
                         _s2warn("MakeGeometry", "screen-meshed textures not supported");
                     }
-                } else if (!strlen(texpoly3d[i].whichscreen)) {
+                } else if (!texpoly3d[i].whichscreen) {
                     
                     glBegin(GL_POLYGON);
                     glColor4f(1., 1., 1., texpoly3d[i].alpha);
@@ -2240,8 +2256,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                 glBegin(GL_POINTS);
                 _glColor4f(trdot[i].colour.r,trdot[i].colour.g,trdot[i].colour.b,trdot[i].alpha);
                 if (doscreen) {
-                    if (strlen(_s2_doingScreen) && 
-                        strstr(trdot[i].whichscreen, _s2_doingScreen)) {
+                    if (_S2ONSCREEN(trdot[i].whichscreen)) {
                         s2UnProject(view[0] + view[2] * trdot[i].p.x, 
                                     view[1] + view[3] * trdot[i].p.y, 
                                     trdot[i].p.z, 
@@ -2249,7 +2264,7 @@ void MakeGeometry(int doupdate, int doscreen, int eye) {
                         glVertex3f(vtx, vty, vtz);
                         
                     }
-                } else if (!strlen(trdot[i].whichscreen)) {
+                } else if (!trdot[i].whichscreen) {
                     glVertex3f(trdot[i].p.x,trdot[i].p.y,trdot[i].p.z);
                 }
                 glEnd();
@@ -0,0 +1,209 @@
+/* s2lod.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Level of detail for static point clouds (ss2tlod).
+ *
+ * When static geometry is packed, each large batch of world points
+ * (see s2cull.c for how batches are laid out by place) gets a
+ * hierarchy of representative points: the batch's bounding box is
+ * divided as an octree, and each occupied node at each depth becomes
+ * one point at the centroid, with the mean colour, of the points in
+ * it.  The levels are appended to the list's vertices, coarsest
+ * first.  While the camera is moving, _s2priv_drawBatches draws for
+ * each batch the coarsest level whose nodes project to no more than
+ * a point's width on screen, so the cost follows the number of
+ * pixels covered rather than the number of points.  Once the camera
+ * stops, full detail is drawn again.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+/* batches with fewer points than this are always drawn in full */
+#define _S2LODMINPOINTS 1024
+/* deepest octree level: 8 bits per axis of a 24-bit node key */
+#define _S2LODDEPTH 8
+/* frames the view must be still for before full detail is drawn */
+#define _S2LODHOLD 4
+
+/* spread the low 8 bits of v to every third bit */
+static unsigned int _s2priv_lodSpread(unsigned int v) {
+  v &= 0xff;
+  v = (v | (v << 8)) & 0x00f00f;
+  v = (v | (v << 4)) & 0x0c30c3;
+  v = (v | (v << 2)) & 0x249249;
+  return v;
+}
+
+/* build the representative point levels of the point batches of bl */
+void _s2priv_lodBuild(_S2BATCHLIST *bl) {
+  static _S2SORTKEYS order;
+  _S2BATCH *b;
+  _S2BATCHVTX *v, *out;
+  float sca[3];
+  unsigned int c[3];
+  int i, j, k, l, ng, shift, npt;
+  double sum[7];
+
+  bl->nlod = 0;
+  for (i = 0; i < bl->nbatch; i++) {
+    b = bl->batch + i;
+    b->nlod = 0;
+    if (b->mode != GL_POINTS || b->screen || b->trans || 
+	b->count < _S2LODMINPOINTS) {
+      continue;
+    }
+
+    // order the points by their deepest octree node: the nodes at
+    // each shallower level are then runs of a shared key prefix
+    for (j = 0; j < 3; j++) {
+      sca[j] = (b->hi[j] > b->lo[j]) ? 
+	(1 << _S2LODDEPTH) / (b->hi[j] - b->lo[j]) : 0.;
+    }
+    _s2priv_sortReserve(&order, b->count);
+    for (k = 0; k < b->count; k++) {
+      v = bl->vtx + b->first + k;
+      for (j = 0; j < 3; j++) {
+	c[j] = (unsigned int)((v->p[j] - b->lo[j]) * sca[j]);
+	c[j] = (c[j] >= (1 << _S2LODDEPTH)) ? (1 << _S2LODDEPTH) - 1 : c[j];
+      }
+      order.key[k] = _s2priv_lodSpread(c[0]) | 
+	(_s2priv_lodSpread(c[1]) << 1) | (_s2priv_lodSpread(c[2]) << 2);
+    }
+    _s2priv_sortKeys(&order);
+
+    // one level per depth, until a level would hold more than half as
+    // many points as the batch itself
+    b->lod = bl->nlod;
+    for (l = 0; l <= _S2LODDEPTH; l++) {
+      shift = 3 * (_S2LODDEPTH - l);
+      for (k = 1, ng = 1; k < b->count; k++) {
+	ng += ((order.key[k] >> shift) != (order.key[k-1] >> shift));
+      }
+      if (ng > b->count / 2) {
+	break;
+      }
+
+      bl->lod = (_S2BATCHLOD *)_s2priv_arenaReserve(bl->lod, bl->nlod, 1,
+						    sizeof(_S2BATCHLOD));
+      if (!bl->lod) {
+	bl->nlod = 0;
+	_s2error("(internal)", "failed to allocate memory for point levels");
+      }
+      bl->lod[bl->nlod].first = bl->nvtx;
+      bl->lod[bl->nlod].count = ng;
+      bl->nlod++;
+      b->nlod++;
+
+      out = _s2priv_batchVertices(bl, ng);
+      for (k = 0; k < b->count; k = npt) {
+	*out = bl->vtx[b->first + order.idx[k]];
+	memset(sum, 0, 7 * sizeof(double));
+	for (npt = k; (npt < b->count) && 
+	       ((order.key[npt] >> shift) == (order.key[k] >> shift)); npt++) {
+	  v = bl->vtx + b->first + order.idx[npt];
+	  for (j = 0; j < 3; j++) {
+	    sum[j] += v->p[j];
+	  }
+	  for (j = 0; j < 4; j++) {
+	    sum[3+j] += v->c[j];
+	  }
+	}
+	for (j = 0; j < 3; j++) {
+	  out->p[j] = sum[j] / (npt - k);
+	}
+	for (j = 0; j < 4; j++) {
+	  out->c[j] = sum[3+j] / (npt - k);
+	}
+	out++;
+      }
+    }
+  }
+}
+
+/* if batch b of bl can be drawn at a reduced level of detail in the
+ * view fr, set first and count to the vertices of that level and
+ * return 1; otherwise return 0 */
+int _s2priv_lodRange(_S2FRUSTUM *fr, _S2BATCHLIST *bl, _S2BATCH *b,
+		     int *first, int *count) {
+  float w, e, px, limit;
+  int j, l;
+
+  if (!fr->on || !b->nlod) {
+    return 0;
+  }
+
+  // nearest clip w of the box, and its largest extent in pixels there
+  w = fr->w[3];
+  e = 0.;
+  for (j = 0; j < 3; j++) {
+    w += fr->w[j] * ((fr->w[j] > 0.) ? b->lo[j] : b->hi[j]);
+    e = (b->hi[j] - b->lo[j] > e) ? b->hi[j] - b->lo[j] : e;
+  }
+  if (w <= 0.) {
+    // the camera is within or behind the box
+    return 0;
+  }
+  px = e * fr->pix / w;
+
+  limit = b->size * options.pointscale;
+  limit = (limit < 1.) ? 1. : limit;
+  for (l = 0; (l < b->nlod) && (px > limit); l++, px *= 0.5) ;
+#if defined(BUILDING_S2PLOT)
+  /* the frame-time governor may ask for coarser levels still */
+  l -= _s2priv_govern(_S2GOV_POINTS, 0);
+  l = (l < 0) ? 0 : l;
+#endif
+  if (l == b->nlod) {
+    return 0;
+  }
+  *first = bl->lod[b->lod + l].first;
+  *count = bl->lod[b->lod + l].count;
+  return 1;
+}
+
+#if defined(BUILDING_S2PLOT)
+/* note whether the camera of panel p has moved since the last frame.
+ * Mouse and key events need not arrive every frame, so the view is
+ * taken to be moving until it has been still for a few frames. */
+void _s2priv_lodMotion(S2PLOT_PANEL *p) {
+  if (memcmp(&(p->lodcamera), &camera, sizeof(CAMERA)) ||
+      memcmp(&(p->lodtrans), &_s2_object_trans, sizeof(XYZ)) ||
+      memcmp(p->lodrot, _s2_object_rot, 16 * sizeof(double))) {
+    p->lodmoving = _S2LODHOLD;
+  } else if (p->lodmoving > 0) {
+    p->lodmoving--;
+  }
+  p->lodcamera = camera;
+  p->lodtrans = _s2_object_trans;
+  memcpy(p->lodrot, _s2_object_rot, 16 * sizeof(double));
+}
+#endif
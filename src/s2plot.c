@@ -40,6 +40,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
 
 /* GLOBAL DECLARATIONS AND DEFINITIONS
  * 
@@ -238,7 +239,7 @@ void _s2priv_setBounds() {
 	Add a line segment to the line database
 */
 void AddLine2Database(XYZ p1,XYZ p2,COLOUR c1,COLOUR c2,double w) {
-  if ((line = (LINE *)realloc(line,(nline+1)*sizeof(LINE))) == NULL) {
+  if ((line = (LINE *)_s2priv_arenaReserve(line, nline, 1, sizeof(LINE))) == NULL) {
     _s2error("(internal)", "memory allocation for line failed");
   }
   w = ABS(w);
@@ -248,9 +249,8 @@ void AddLine2Database(XYZ p1,XYZ p2,COLOUR c1,COLOUR c2,double w) {
   line[nline].colour[0] = c1;
   line[nline].colour[1] = c2;
 #if defined(BUILDING_S2PLOT)
-  strcpy(line[nline].whichscreen, _s2_whichscreen);
-  strncpy(line[nline].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN-1);
-  line[nline].VRMLname[MAXVRMLLEN-1] = '\0';
+  line[nline].whichscreen = _s2_currscreentag;
+  line[nline].VRMLname = _s2_currVRMLidx;
   line[nline].stipple_factor = 0;
   line[nline].stipple_pattern = 0;
 #endif
@@ -265,7 +265,7 @@ void AddFace2Database(XYZ *p,int n,COLOUR c,double scale,XYZ shift) {
   int i;
   
   if (n == 3) {
-    if ((face3 = (FACE3 *)realloc(face3,(nface3+1)*sizeof(FACE3))) == NULL) {
+    if ((face3 = (FACE3 *)_s2priv_arenaReserve(face3, nface3, 1, sizeof(FACE3))) == NULL) {
       _s2error("(internal)", "memory allocation failed for face3");
     }
     for (i=0;i<3;i++) {
@@ -275,14 +275,13 @@ void AddFace2Database(XYZ *p,int n,COLOUR c,double scale,XYZ shift) {
       face3[nface3].n[i] = CalcNormal(p[0],p[1],p[2]);
       face3[nface3].colour[i] = c;
 #if defined(BUILDING_S2PLOT)
-      strcpy(face3[nface3].whichscreen, _s2_whichscreen);
-      strncpy(face3[nface3].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-      face3[nface3].VRMLname[MAXVRMLLEN-1] = '\0';
+      face3[nface3].whichscreen = _s2_currscreentag;
+      face3[nface3].VRMLname = _s2_currVRMLidx;
 #endif
     }
     nface3++;
   } else if (n == 4) {
-    if ((face4 = (FACE4 *)realloc(face4,(nface4+1)*sizeof(FACE4))) == NULL) {
+    if ((face4 = (FACE4 *)_s2priv_arenaReserve(face4, nface4, 1, sizeof(FACE4))) == NULL) {
       _s2error("(internal)", "memory allocation failed for face4");
     }
     for (i=0;i<4;i++) {
@@ -292,10 +291,8 @@ void AddFace2Database(XYZ *p,int n,COLOUR c,double scale,XYZ shift) {
       face4[nface4].n[i] = CalcNormal(p[(i-1+4)%4],p[i],p[(i+1)%4]);
       face4[nface4].colour[i] = c;
 #if defined(BUILDING_S2PLOT)
-      strcpy(face4[nface4].whichscreen, _s2_whichscreen);
-      strncpy(face4[nface4].VRMLname, _s2_VRMLnames[_s2_currVRMLidx],
-	      MAXVRMLLEN);
-      face4[nface4].VRMLname[MAXVRMLLEN-1] = '\0';
+      face4[nface4].whichscreen = _s2_currscreentag;
+      face4[nface4].VRMLname = _s2_currVRMLidx;
 #endif
     }
     nface4++;
@@ -372,242 +369,311 @@ void AddMarker2Database(int type,double size,XYZ p,COLOUR c)
    }
 }
 
+/* The primitive stores behind the _s2priv_add* functions grow
+ * geometrically, so that long runs of single-primitive calls cost
+ * amortised O(1) each instead of copying the whole list every time.
+ * The capacity of a store is kept in a small header immediately before
+ * its first element: it therefore travels with the pointer through the
+ * static/dynamic list swaps and the per-panel copies.  Stores MUST only
+ * be grown with _s2priv_arenaReserve and released with _s2priv_arenaFree.
+ */
+#define _S2ARENA_MINCAP 16
+typedef union {
+  size_t capacity;
+  long double align; /* keep elements maximally aligned */
+} _S2ARENAHDR;
+
+/* ensure room for in more elements after the n already in base; returns
+ * the (possibly moved) store, or NULL (and base released) on failure */
+void *_s2priv_arenaReserve(void *base, int n, int in, size_t size) {
+  _S2ARENAHDR *hdr = NULL, *newhdr;
+  size_t need = (size_t)n + (size_t)in;
+  size_t cap = 0, newcap;
+  if (base) {
+    hdr = (_S2ARENAHDR *)base - 1;
+    cap = hdr->capacity;
+    if (need <= cap) {
+      return base;
+    }
+  }
+  newcap = cap ? cap : _S2ARENA_MINCAP;
+  while (newcap < need) {
+    newcap *= 2;
+  }
+  newhdr = (_S2ARENAHDR *)realloc(hdr, sizeof(_S2ARENAHDR) + newcap * size);
+  if (!newhdr) {
+    if (hdr) {
+      free(hdr);
+    }
+    return NULL;
+  }
+  newhdr->capacity = newcap;
+  return (void *)(newhdr + 1);
+}
+
+void _s2priv_arenaFree(void *base) {
+  if (base) {
+    free((_S2ARENAHDR *)base - 1);
+  }
+}
+
+/* number of elements base can hold without being reallocated */
+int _s2priv_arenaCapacity(void *base) {
+  if (!base) {
+    return 0;
+  }
+  return (int)(((_S2ARENAHDR *)base - 1)->capacity);
+}
+
+/* evaluate the constant parts of _S2WORLD2DEVICE once, so that batches
+ * of vertices can be transformed without re-testing the screen tag:
+ * device = devmin[i] + scale[i] * (world - axmin[i]) */
+void _s2priv_w2dcoeffs(float *devmin, float *scale, float *axmin) {
+  int i;
+  for (i = 0; i < 3; i++) {
+    if (_s2_currscreentag) {
+      devmin[i] = 0.;
+      scale[i] = 1.;
+      axmin[i] = 0.;
+    } else {
+      devmin[i] = _s2devicemin[i];
+      scale[i] = (_s2devicemax[i] - _s2devicemin[i]) / 
+	(_s2axismax[i] - _s2axismin[i]);
+      axmin[i] = _s2axismin[i];
+    }
+  }
+}
+
+/* _S2SCREEN_* bits of a whichscreen string, eg. "lr" */
+unsigned char _s2priv_screenBits(char *ws) {
+  unsigned char bits = 0;
+  if (strchr(ws, 'l')) {
+    bits |= _S2SCREEN_L;
+  }
+  if (strchr(ws, 'c')) {
+    bits |= _S2SCREEN_C;
+  }
+  if (strchr(ws, 'r')) {
+    bits |= _S2SCREEN_R;
+  }
+  return bits;
+}
+
+/* return the id of screen tag ws, adding it to the table if it is new.
+ * Tag 0 is always the empty string, ie. world geometry. */
+unsigned short _s2priv_screenTag(char *ws) {
+  int i;
+  if (!_s2_nscreentags) {
+    _s2_screentags = (char **)malloc(sizeof(char *));
+    _s2_screentagbits = (unsigned char *)malloc(sizeof(unsigned char));
+    _s2_screentags[0] = strdup("");
+    _s2_screentagbits[0] = 0;
+    _s2_nscreentags = 1;
+  }
+  for (i = 0; i < _s2_nscreentags; i++) {
+    if (!strcmp(_s2_screentags[i], ws)) {
+      return (unsigned short)i;
+    }
+  }
+  if (_s2_nscreentags >= USHRT_MAX) {
+    _s2warn("_s2priv_screenTag", "too many distinct screen tags");
+    return 0;
+  }
+  _s2_screentags = (char **)realloc(_s2_screentags, (_s2_nscreentags+1) *
+				    sizeof(char *));
+  _s2_screentagbits = (unsigned char *)realloc(_s2_screentagbits,
+					       (_s2_nscreentags+1) *
+					       sizeof(unsigned char));
+  _s2_screentags[_s2_nscreentags] = strdup(ws);
+  _s2_screentagbits[_s2_nscreentags] = _s2priv_screenBits(ws);
+  return (unsigned short)(_s2_nscreentags++);
+}
+
+/* a list drawn through the batched path (dots, lines, facets, labels)
+ * of the active panel has changed: re-pack its static or dynamic vertex
+ * buffer before it is next drawn */
+void _s2priv_listChanged(void) {
+  if (_s2_panels && 
+      (_s2_activepanel >= 0) && (_s2_activepanel < _s2_npanels)) {
+    if (_s2_dynamicEnabled) {
+      _s2_panels[_s2_activepanel].GL_dynamic.dirty = 1;
+    } else {
+      _s2_panels[_s2_activepanel].GL_static.dirty = 1;
+    }
+  }
+}
+
 DISK *_s2priv_adddisks(int in) {
   DISK *disk_base;
-  if (!disk) {
-    disk = (DISK *)calloc(in, sizeof(DISK));
-    disk_base = disk;
-    ndisk = in;
-  } else {
-    disk = (DISK *)realloc(disk, (ndisk + in) * sizeof(DISK));
-    disk_base = disk + ndisk;
-    ndisk += in;
-  }
+  disk = (DISK *)_s2priv_arenaReserve(disk, ndisk, in, sizeof(DISK));
   if (!disk) {
     ndisk = 0;
     return NULL;
   }
+  disk_base = disk + ndisk;
+  memset(disk_base, 0, in * sizeof(DISK));
+  ndisk += in;
   return disk_base;
 }
 
 BALL *_s2priv_addballs(int in) {
   BALL *ball_base;
-  if (!ball) {
-    ball = (BALL *)calloc(in, sizeof(BALL));
-    ball_base = ball;
-    nball = in;
-  } else {
-    ball = (BALL *)realloc(ball, (nball + in) * sizeof(BALL));
-    ball_base = ball + nball;
-    nball += in;
-  }
+  ball = (BALL *)_s2priv_arenaReserve(ball, nball, in, sizeof(BALL));
   if (!ball) {
     nball = 0;
     return NULL;
   }
+  ball_base = ball + nball;
+  memset(ball_base, 0, in * sizeof(BALL));
+  nball += in;
   return ball_base;
 }
 
 LABEL *_s2priv_addlabels(int in) {
   LABEL *label_base;
-  if (!label) {
-    label = (LABEL *)calloc(in, sizeof(LABEL));
-    label_base = label;
-    nlabel = in;
-  } else {
-    label = (LABEL *)realloc(label, (nlabel + in) * sizeof(LABEL));
-    label_base = label + nlabel;
-    nlabel += in;
-  }
+  label = (LABEL *)_s2priv_arenaReserve(label, nlabel, in, sizeof(LABEL));
   if (!label) {
     nlabel = 0;
     return NULL;
   }
+  label_base = label + nlabel;
+  memset(label_base, 0, in * sizeof(LABEL));
+  nlabel += in;
+  _s2priv_listChanged();
   return label_base;
 }
 
 _S2HANDLE *_s2priv_addhandles(int in) {
   _S2HANDLE *handle_base;
-  if (!handle) {
-    handle = (_S2HANDLE *)calloc(in, sizeof(_S2HANDLE));
-    handle_base = handle;
-    nhandle = in;
-  } else {
-    handle = (_S2HANDLE *)realloc(handle, (nhandle + in) * sizeof(_S2HANDLE));
-    handle_base = handle + nhandle;
-    nhandle += in;
-  }
+  handle = (_S2HANDLE *)_s2priv_arenaReserve(handle, nhandle, in, sizeof(_S2HANDLE));
   if (!handle) {
     nhandle = 0;
     return NULL;
   }
+  handle_base = handle + nhandle;
+  memset(handle_base, 0, in * sizeof(_S2HANDLE));
+  nhandle += in;
   return handle_base;
 }
 
 _S2BBOARD *_s2priv_addbboards(int in) {
   _S2BBOARD *bboard_base;
-  if (!bboard) {
-    bboard = (_S2BBOARD *)calloc(in, sizeof(_S2BBOARD));
-    bboard_base = bboard;
-    nbboard = in;
-  } else {
-    bboard = (_S2BBOARD *)realloc(bboard, (nbboard + in) * sizeof(_S2BBOARD));
-    bboard_base = bboard + nbboard;
-    nbboard += in;
-  }
+  bboard = (_S2BBOARD *)_s2priv_arenaReserve(bboard, nbboard, in, sizeof(_S2BBOARD));
   if (!bboard) {
     nbboard = 0;
     return NULL;
   }
+  bboard_base = bboard + nbboard;
+  memset(bboard_base, 0, in * sizeof(_S2BBOARD));
+  nbboard += in;
   return bboard_base;
 }
-  
+
 _S2BBSET *_s2priv_addbbset(int in) {
   _S2BBSET *bbset_base;
-  if (!bbset) {
-    bbset = (_S2BBSET *)calloc(in, sizeof(_S2BBSET));
-    bbset_base = bbset;
-    nbbset = in;
-  } else {
-    bbset = (_S2BBSET *)realloc(bbset, (nbbset + in) * sizeof(_S2BBSET));
-    bbset_base = bbset + nbbset;
-    nbbset += in;
-  }
+  bbset = (_S2BBSET *)_s2priv_arenaReserve(bbset, nbbset, in, sizeof(_S2BBSET));
   if (!bbset) {
     nbbset = 0;
     return NULL;
   }
+  bbset_base = bbset + nbbset;
+  memset(bbset_base, 0, in * sizeof(_S2BBSET));
+  nbbset += in;
   return bbset_base;
 }
 
 CONE *_s2priv_addcones(int in) {
   CONE *cone_base;
-  if (!cone) {
-    cone = (CONE *)calloc(in, sizeof(CONE));
-    cone_base = cone;
-    ncone = in;
-  } else {
-    cone = (CONE *)realloc(cone, (ncone + in) * sizeof(CONE));
-    cone_base = cone + ncone;
-    ncone += in;
-  }
+  cone = (CONE *)_s2priv_arenaReserve(cone, ncone, in, sizeof(CONE));
   if (!cone) {
     ncone = 0;
     return NULL;
   }
+  cone_base = cone + ncone;
+  memset(cone_base, 0, in * sizeof(CONE));
+  ncone += in;
   return cone_base;
 }
 
-#if (1)
 DOT *_s2priv_adddots(int in) {
   DOT *dot_base;
-  if (!dot) {
-    dot = (DOT *)calloc(in, sizeof(DOT));
-    dot_base = dot;
-    ndot = in;
-  } else {
-    dot = (DOT *)realloc(dot, (ndot + in) * sizeof(DOT));
-    dot_base = dot + ndot;
-    ndot += in;
-  }
+  dot = (DOT *)_s2priv_arenaReserve(dot, ndot, in, sizeof(DOT));
   if (!dot) {
     ndot = 0;
     return NULL;
   }
+  dot_base = dot + ndot;
+  memset(dot_base, 0, in * sizeof(DOT));
+  ndot += in;
+  _s2priv_listChanged();
   return dot_base;
 }
-#endif
 
 TRDOT *_s2priv_addtrdots(int in) {
   TRDOT *trdot_base;
-  if (!trdot) {
-    trdot = (TRDOT *)calloc(in, sizeof(TRDOT));
-    trdot_base = trdot;
-    ntrdot = in;
-  } else {
-    trdot = (TRDOT *)realloc(trdot, (ntrdot + in) * sizeof(TRDOT));
-    trdot_base = trdot + ntrdot;
-    ntrdot += in;
-  }
+  trdot = (TRDOT *)_s2priv_arenaReserve(trdot, ntrdot, in, sizeof(TRDOT));
   if (!trdot) {
     ntrdot = 0;
     return NULL;
   }
+  trdot_base = trdot + ntrdot;
+  memset(trdot_base, 0, in * sizeof(TRDOT));
+  ntrdot += in;
   return trdot_base;
 }
 
-#if (1)
 LINE *_s2priv_addlines(int in) {
   LINE *line_base;
-  if (!line) {
-    line = (LINE *)malloc(in * sizeof(LINE));
-    line_base = line;
-    nline = in;
-  } else {
-    line = (LINE *)realloc(line, (nline + in) * sizeof(LINE));
-    line_base = line + nline;
-    nline += in;
-  }
+  line = (LINE *)_s2priv_arenaReserve(line, nline, in, sizeof(LINE));
   if (!line) {
     nline = 0;
     return NULL;
   }
+  line_base = line + nline;
+  memset(line_base, 0, in * sizeof(LINE));
+  nline += in;
+  _s2priv_listChanged();
   return line_base;
 }
-#endif
 
 FACE3 *_s2priv_addface3s(int in) {
   FACE3 *face3_base;
-  if (!face3) {
-    face3 = (FACE3 *)calloc(in, sizeof(FACE3));
-    face3_base = face3;
-    nface3 = in;
-  } else {
-    face3 = (FACE3 *)realloc(face3, (nface3 + in) * sizeof(FACE3));
-    face3_base = face3 + nface3;
-    nface3 += in;
-  }
+  face3 = (FACE3 *)_s2priv_arenaReserve(face3, nface3, in, sizeof(FACE3));
   if (!face3) {
     nface3 = 0;
     return NULL;
   }
+  face3_base = face3 + nface3;
+  memset(face3_base, 0, in * sizeof(FACE3));
+  nface3 += in;
+  _s2priv_listChanged();
   return face3_base;
 }
 
 _S2FACE3A *_s2priv_addface3as(int in) {
   _S2FACE3A *face3a_base;
-  if (!face3a) {
-    face3a = (_S2FACE3A *)calloc(in, sizeof(_S2FACE3A));
-    face3a_base = face3a;
-    nface3a = in;
-  } else {
-    face3a = (_S2FACE3A *)realloc(face3a, (nface3a + in) * sizeof(_S2FACE3A));
-    face3a_base = face3a + nface3a;
-    nface3a += in;
-  }
+  face3a = (_S2FACE3A *)_s2priv_arenaReserve(face3a, nface3a, in, sizeof(_S2FACE3A));
   if (!face3a) {
     nface3a = 0;
     return NULL;
   }
+  face3a_base = face3a + nface3a;
+  memset(face3a_base, 0, in * sizeof(_S2FACE3A));
+  nface3a += in;
   return face3a_base;
 }
 
 #if defined(S2_3D_TEXTURES)
 _S2TEXPOLY3D *_s2priv_addtexpoly3ds(int in) {
   _S2TEXPOLY3D *texpoly3d_base;
-  if (!texpoly3d) {
-    texpoly3d = (_S2TEXPOLY3D *)calloc(in, sizeof(_S2TEXPOLY3D));
-    texpoly3d_base = texpoly3d;
-    ntexpoly3d = in;
-  } else {
-    texpoly3d = (_S2TEXPOLY3D *)realloc(texpoly3d, (ntexpoly3d + in) * sizeof(_S2TEXPOLY3D));
-    texpoly3d_base = texpoly3d + ntexpoly3d;
-    ntexpoly3d += in;
-  }
+  texpoly3d = (_S2TEXPOLY3D *)_s2priv_arenaReserve(texpoly3d, ntexpoly3d, in, sizeof(_S2TEXPOLY3D));
   if (!texpoly3d) {
     ntexpoly3d = 0;
     return NULL;
   }
+  texpoly3d_base = texpoly3d + ntexpoly3d;
+  memset(texpoly3d_base, 0, in * sizeof(_S2TEXPOLY3D));
+  ntexpoly3d += in;
   int i;
   for (i = 0; i < in; i++) {
     texpoly3d_base[i].nverts = 0;
@@ -620,22 +686,14 @@ _S2TEXPOLY3D *_s2priv_addtexpoly3ds(int in) {
 
 _S2TEXTUREDMESH *_s2priv_addtexturedmesh(int in) {
   _S2TEXTUREDMESH *texmesh_base;
-  if (!texmesh) {
-    texmesh = (_S2TEXTUREDMESH *)calloc(in, sizeof(_S2TEXTUREDMESH));
-    texmesh_base = texmesh;
-    ntexmesh = in;
-  } else {
-    texmesh = (_S2TEXTUREDMESH *)realloc(texmesh, (ntexmesh + in) * 
-					 sizeof(_S2TEXTUREDMESH));
-    texmesh_base = texmesh + ntexmesh;
-    ntexmesh += in;
-    //fprintf(stderr, "ntexmesh = %d\n", ntexmesh);
-  }
+  texmesh = (_S2TEXTUREDMESH *)_s2priv_arenaReserve(texmesh, ntexmesh, in, sizeof(_S2TEXTUREDMESH));
   if (!texmesh) {
     ntexmesh = 0;
     return NULL;
   }
-  //fprintf(stderr, "pppp\n");
+  texmesh_base = texmesh + ntexmesh;
+  memset(texmesh_base, 0, in * sizeof(_S2TEXTUREDMESH));
+  ntexmesh += in;
   int i;
   for (i = 0; i < in; i++) {
     texmesh_base[i].nverts = 0;
@@ -648,47 +706,39 @@ _S2TEXTUREDMESH *_s2priv_addtexturedmesh(int in) {
     texmesh_base[i].facets = NULL;
     texmesh_base[i].facets_vtcs = NULL;
     texmesh_base[i].texid = 0;
+    texmesh_base[i].col.r = texmesh_base[i].col.g = texmesh_base[i].col.b = 1.;
     texmesh_base[i].trans = 'o';
     texmesh_base[i].alpha = 1.0;
-    strcpy(texmesh_base[i].whichscreen, "");
-    strcpy(texmesh_base[i].VRMLname, "");
+    texmesh_base[i].whichscreen = 0;
+    texmesh_base[i].VRMLname = 0;
   }
   return texmesh_base;
 }
 
 FACE4 *_s2priv_addface4s(int in) {
   FACE4 *face4_base;
-  if (!face4) {
-    face4 = (FACE4 *)calloc(in, sizeof(FACE4));
-    face4_base = face4;
-    nface4 = in;
-  } else {
-    face4 = (FACE4 *)realloc(face4, (nface4 + in) * sizeof(FACE4));
-    face4_base = face4 + nface4;
-    nface4 += in;
-  }
+  face4 = (FACE4 *)_s2priv_arenaReserve(face4, nface4, in, sizeof(FACE4));
   if (!face4) {
     nface4 = 0;
     return NULL;
   }
+  face4_base = face4 + nface4;
+  memset(face4_base, 0, in * sizeof(FACE4));
+  nface4 += in;
+  _s2priv_listChanged();
   return face4_base;
 }
 
 FACE4T *_s2priv_addface4ts(int in) {
   FACE4T *face4t_base;
-  if (!face4t) {
-    face4t = (FACE4T *)calloc(in, sizeof(FACE4T));
-    face4t_base = face4t;
-    nface4t = in;
-  } else {
-    face4t = (FACE4T *)realloc(face4t, (nface4t + in) * sizeof(FACE4T));
-    face4t_base = face4t + nface4t;
-    nface4t += in;
-  }
+  face4t = (FACE4T *)_s2priv_arenaReserve(face4t, nface4t, in, sizeof(FACE4T));
   if (!face4t) {
     nface4t = 0;
     return NULL;
   }
+  face4t_base = face4t + nface4t;
+  memset(face4t_base, 0, in * sizeof(FACE4T));
+  nface4t += in;
   return face4t_base;
 }
 
@@ -716,10 +766,8 @@ void _s2priv_quad(float *xpts, float *ypts, float *zpts, float *normal) {
     face4_base[0].colour[i].r = _S2PENRED;
     face4_base[0].colour[i].g = _S2PENGRN;
     face4_base[0].colour[i].b = _S2PENBLU;
-    strcpy(face4_base[0].whichscreen, _s2_whichscreen);
-    strncpy(face4_base[0].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], 
-	    MAXVRMLLEN);
-    face4_base[0].VRMLname[MAXVRMLLEN-1] = '\0';
+    face4_base[0].whichscreen = _s2_currscreentag;
+    face4_base[0].VRMLname = _s2_currVRMLidx;
   }
 }
 
@@ -752,9 +800,8 @@ void _s2priv_text(float *labelp, float *labelr, float *labelu, char *text) {
   strncpy(label_base[0].s, text, MAXLABELLEN-1);
   label_base[0].s[MAXLABELLEN-1] = '\0';
 
-  strcpy(label_base[0].whichscreen, _s2_whichscreen);
-  strncpy(label_base[0].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  label_base[0].VRMLname[MAXVRMLLEN-1] = '\0';
+  label_base[0].whichscreen = _s2_currscreentag;
+  label_base[0].VRMLname = _s2_currVRMLidx;
 
 }
 
@@ -924,9 +971,8 @@ void _s2priv_coneline(float *xpts, float *ypts, float *zpts) {
   cone_base->p2.z = _S2WORLD2DEVICE(zpts[1], _S2ZAX);
   cone_base->r2 = ticklen;
   cone_base->colour = _s2_colormap[_s2_colidx];
-  strcpy(cone_base->whichscreen, _s2_whichscreen);
-  strncpy(cone_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  cone_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  cone_base->whichscreen = _s2_currscreentag;
+  cone_base->VRMLname = _s2_currVRMLidx;
   return;
 }
 
@@ -1005,12 +1051,16 @@ int _s2priv_ns2cvr(float ***grid,
    will be loaded up with the vertices at most 5 triangular facets.
    0 will be returned if the grid cell is either totally above
    of totally below the isolevel.
+
+   PolygoniseEdges does the work: it fills vertlist with the vertices
+   on the intersected cube edges, and returns each facet as the
+   numbers (0-11) of the three edges its vertices lie on, so that 
+   neighbouring cells can share vertices.
 */
-int Polygonise(GRIDCELL g,double iso,TRIANGLE *tri)
+int PolygoniseEdges(GRIDCELL g,double iso,XYZ *vertlist,int *edges)
 {
    int i,ntri = 0;
    int cubeindex;
-   XYZ vertlist[12];
 /*
    int edgeTable[256].  It corresponds to the 2^8 possible combinations of
    of the eight (n) vertices either existing inside or outside (2^n) of the
@@ -1404,69 +1454,66 @@ static int triTable[256][16] =
    if (edgeTable[cubeindex] & 2048)
       vertlist[11] = VertexInterp(iso,g.p[3],g.p[7],g.val[3],g.val[7]);
 
-   /* Create the triangles */
+   /* Create the triangles, as the cube edges their vertices lie on */
    for (i=0;triTable[cubeindex][i]!=-1;i+=3) {
-      tri[ntri].p[0] = vertlist[triTable[cubeindex][i  ]];
-      tri[ntri].p[1] = vertlist[triTable[cubeindex][i+1]];
-      tri[ntri].p[2] = vertlist[triTable[cubeindex][i+2]];
+      edges[3*ntri  ] = triTable[cubeindex][i  ];
+      edges[3*ntri+1] = triTable[cubeindex][i+1];
+      edges[3*ntri+2] = triTable[cubeindex][i+2];
       ntri++;
    }
 
    return(ntri);
 }
 
-void _s2priv_drawTriangleCache(_S2TRIANGLE_CACHE *cache) {
-  int i;
-  for (i = 0; i < cache->ntri; i++) {
-    //ns2vf3a(cache->trivert + 3 * i, cache->col[i], cache->descr.trans,
-    //	    cache->descr.alpha);
-    ns2vf3na(cache->trivert + 3 * i, cache->normals + 3 * i,
-	     cache->col[i], cache->descr.trans,
-	     cache->descr.alpha);
-  }
+int Polygonise(GRIDCELL g,double iso,TRIANGLE *tri)
+{
+   XYZ vertlist[12];
+   int edges[15];
+   int i, ntri = PolygoniseEdges(g, iso, vertlist, edges);
+   for (i=0;i<ntri;i++) {
+      tri[i].p[0] = vertlist[edges[3*i  ]];
+      tri[i].p[1] = vertlist[edges[3*i+1]];
+      tri[i].p[2] = vertlist[edges[3*i+2]];
+   }
+   return(ntri);
 }
 
-void _s2priv_addToTriangleCache(_S2TRIANGLE_CACHE *cache, XYZ *trivert, 
-				float *tr, COLOUR col) {
-//void _s2priv_addToTriangleCache(_S2TRIANGLE_CACHE *cache, XYZ *trivert,
-//				XYZ cellnormal,
-//				float *tr, COLOUR col) {
-  int n = cache->ntri, i;
-  cache->trivert = (XYZ *)realloc(cache->trivert, (n + 1) * 3 * sizeof(XYZ));
-  //cache->normals = (XYZ *)realloc(cache->normals, (n + 1) * 3 * sizeof(XYZ));
-  cache->col = (COLOUR *)realloc(cache->col, (n + 1) * sizeof(COLOUR));
-
-  for (i = 0; i < 3; i++) {
-    cache->trivert[n * 3 + i].x = 
-      tr[0] + tr[1]*trivert[i].x + tr[2]*trivert[i].y + tr[3]*trivert[i].z;
-    cache->trivert[n * 3 + i].y = 
-      tr[4] + tr[5]*trivert[i].x + tr[6]*trivert[i].y + tr[7]*trivert[i].z;
-    cache->trivert[n * 3 + i].z = 
-      tr[8] + tr[9]*trivert[i].x + tr[10]*trivert[i].y + tr[11]*trivert[i].z;
-
+void _s2priv_drawTriangleCache(_S2TRIANGLE_CACHE *cache) {
+  int i, j;
+  XYZ P[3], N[3];
+  for (i = 0; i < cache->ntri; i++) {
+    for (j = 0; j < 3; j++) {
+      P[j] = cache->verts[cache->tris[3*i+j]];
+    }
+    if (!cache->normals) {
+      ns2vf3a(P, cache->col[i], cache->descr.trans, cache->descr.alpha);
+      continue;
+    }
+    for (j = 0; j < 3; j++) {
+      N[j] = cache->normals[cache->tris[3*i+j]];
+    }
+    ns2vf3na(P, N, cache->col[i], cache->descr.trans, cache->descr.alpha);
   }
-  cache->col[n] = col;
-  cache->ntri++;
 }
 
+/* smooth vertex normals for the (indexed) isosurface mesh: each vertex
+ * gets the sum of the normals of the facets that share it, weighted by
+ * facet area.  Fast (low quality) surfaces have no vertex normals and
+ * are drawn with facet normals. */
 void _s2priv_calcNormalsForTriangleCache(_S2TRIANGLE_CACHE *cache) {
 
   if (cache->normals) {
     free(cache->normals);
+    cache->normals = NULL;
   }
-  cache->normals = (XYZ *)malloc(cache->ntri * 3 * sizeof(XYZ));
-
-  if (_s2_fastsurfaces) {
-    int i;
-    for (i = 0; i < cache->ntri; i++) {
-      cache->normals[3*i] = cache->normals[3*i+1] =
-	cache->normals[3*i+2] = CalcNormal(cache->trivert[i*3],
-					   cache->trivert[i*3+1],
-					   cache->trivert[i*3+2]);
-    }
+  if (_s2_fastsurfaces || !cache->nvert) {
+    return;
+  }
+  cache->normals = (XYZ *)calloc(cache->nvert, sizeof(XYZ));
+  if (!cache->normals) {
+    _s2warn("(internal)", "failed to allocate memory for normals");
     return;
   }
-
 
   // scaling for normals when axes are not cubic
   float sx, sy, sz;
@@ -1483,112 +1530,35 @@ void _s2priv_calcNormalsForTriangleCache(_S2TRIANGLE_CACHE *cache) {
     sz = 1. / (_s2devicemax[_S2ZAX] - _s2devicemin[_S2ZAX]);
   }
 
-  // store whether this vertex has had a normal assigned already
-  // also store weights (area) of triangles...
-  unsigned char *vdone = (unsigned char *)malloc(cache->ntri * 3); 
-  float *pweight;
-  pweight = (float *)malloc(cache->ntri * sizeof(float));
-  XYZ vec1, vec2;
-  int i,j,k,m;
-  for (i = 0; i < cache->ntri; i++) {
-    vdone[i*3] = vdone[i*3+1] = vdone[i*3+2] = 0;
-    
-    vec1 = VectorSub(cache->trivert[i*3], cache->trivert[i*3+1]);
+  XYZ vec1, vec2, partial_normal, *v;
+  int *t;
+  float weight;
+  int i, j;
+  for (i = 0, t = cache->tris; i < cache->ntri; i++, t += 3) {
+    v = cache->verts;
+    vec1 = VectorSub(v[t[0]], v[t[1]]);
     vec1.x *= sx;
     vec1.y *= sy;
     vec1.z *= sz;
-    vec2 = VectorSub(cache->trivert[i*3], cache->trivert[i*3+2]);
+    vec2 = VectorSub(v[t[0]], v[t[2]]);
     vec2.x *= sx;
     vec2.y *= sy;
     vec2.z *= sz;
-    pweight[i] = 0.5 * Modulus(CrossProduct(vec1, vec2));    
-  }
-
-#define MAX_MATCHING_VERTS 30
-  int matching_verts[MAX_MATCHING_VERTS];
-  int nmatching_verts = 0;
+    weight = 0.5 * Modulus(CrossProduct(vec1, vec2));
 
-  // loop over all triangles
-  for (i = 0; i < cache->ntri; i++) {
-    
-    // loop over the vertices in this triangle
+    partial_normal = CalcNormal(v[t[0]], v[t[1]], v[t[2]]);
+    partial_normal.x *= sx * weight;
+    partial_normal.y *= sy * weight;
+    partial_normal.z *= sz * weight;
     for (j = 0; j < 3; j++) {
-
-      // have we got a normal for this vertex already?
-      if (vdone[i*3+j]) {
-	continue;
-      }
-
-      // go through THIS and remaining triangles in list, find any with 
-      // a vertex that matches this one, and create a weighted 
-      // normal, weighted by inverse triangle area... (smaller
-      // triangles are associated with higher curvature).  Then
-      // apply this normal to the matching triangles and set
-      // vdone appropriately.
-
-      XYZ targ_vertex = cache->trivert[i*3+j];
-      XYZ summed_normal = {0., 0., 0.};
-      XYZ partial_normal;
-      //XYZ vec1, vec2;
-      float partial_weight;
-      
-      nmatching_verts = 0;
-
-      for (k = i; k < cache->ntri && nmatching_verts < MAX_MATCHING_VERTS; k++) {
-	for (m = 0; m < 3 && nmatching_verts < MAX_MATCHING_VERTS; m++) {
-	  if (vdone[k*3+m]) {
-	    continue;
-	  }
-	  if (S2_XYZWITHIN(targ_vertex, cache->trivert[k*3+m], 0.00001)) {
-	    partial_normal = CalcNormal(cache->trivert[k*3], 
-					cache->trivert[k*3+1],
-					cache->trivert[k*3+2]);
-
-	    matching_verts[nmatching_verts] = k*3+m;
-	    nmatching_verts++;
-#if (1)
-	    static int showmesg = 0;
-	    if (!showmesg) {
-	      //fprintf(stderr, "EXAGGERATING NORMALS!!!\n");
-	      showmesg = 1;
-	    }
-#endif
-	    partial_normal.x *= sx;
-	    partial_normal.y *= sy;
-	    partial_normal.z *= sz;
-	    partial_weight = pweight[k];
-
-	    summed_normal.x += partial_normal.x * partial_weight;
-	    summed_normal.y += partial_normal.y * partial_weight;
-	    summed_normal.z += partial_normal.z * partial_weight;
-	  }
-	}
-      }
-
-      Normalise(&summed_normal);
-
-      for (k = 0; k < nmatching_verts; k++) {
-	cache->normals[matching_verts[k]] = summed_normal;
-	vdone[matching_verts[k]] = 1;
-      }
-      /*
-      for (k = i; k < cache->ntri; k++) {
-	for (m = 0; m < 3; m++) {
-	  if (vdone[k*3+m]) {
-	    continue;
-	  }
-	  if (S2_XYZWITHIN(targ_vertex, cache->trivert[k*3+m], 0.001)) {
-	    cache->normals[k*3+m] = summed_normal;
-	    vdone[k*3+m] = 1;
-	  }
-	}
-      }
-      */
-      
+      cache->normals[t[j]].x += partial_normal.x;
+      cache->normals[t[j]].y += partial_normal.y;
+      cache->normals[t[j]].z += partial_normal.z;
     }
   }
-
-  free(pweight);
+  for (i = 0; i < cache->nvert; i++) {
+    Normalise(cache->normals + i);
+  }
 }
 				     
 
@@ -1606,6 +1576,221 @@ void _s2priv_colrfn(float *ix, float *iy, float *iz,
 }
 
 
+/* the facets one slab of an isosurface (the cells with a given first
+ * index) produces: for each facet vertex, its position in grid 
+ * coordinates and the key of the grid edge it lies on */
+typedef struct {
+  int ntri;
+  XYZ *trivert;     /* ntri * 3 in length */
+  long long *keys;  /* ntri * 3 in length */
+} _S2ISOSLAB;
+
+/* the cube edges of PolygoniseEdges, as the offset (in cells) of their
+ * lower grid point from the cell origin, and their axis */
+static const int _s2x_isoedge[12][4] = {
+  {0,0,0, 0}, {1,0,0, 2}, {0,0,1, 0}, {0,0,0, 2},
+  {0,1,0, 0}, {1,1,0, 2}, {0,1,1, 0}, {0,1,0, 2},
+  {0,0,0, 1}, {1,0,0, 1}, {1,0,1, 1}, {0,0,1, 1}};
+
+/* The optional min/max block tree of an isosurface: the cells (at the
+ * surface resolution) are grouped into blocks of _S2ISOBLOCK cells
+ * along each axis, and the range of grid values in each block is kept,
+ * as well as the range over each slab of blocks.  A cell can only
+ * contain the level if some value is below it and some is not, so
+ * blocks and slabs whose range does not bracket the level are skipped.
+ */
+#define _S2ISOBLOCK 8
+#define _S2ISOBRACKETS(mn, mx, level) (((mn) < (level)) && ((mx) >= (level)))
+
+/* number of cells along an axis from index n1 to n2 */
+#define _S2ISOCELLS(n1, n2, res) (((n2) - (n1) < (res)) ? 0 : ((n2) - (n1)) / (res))
+
+static void _s2priv_freeIsosurfaceTree(_S2ISOSURFACE *it) {
+  free(it->bmin);
+  free(it->bmax);
+  free(it->rmin);
+  free(it->rmax);
+  it->bmin = it->bmax = it->rmin = it->rmax = NULL;
+  it->nbx = it->nby = it->nbz = 0;
+}
+
+static void _s2priv_buildIsosurfaceTree(_S2ISOSURFACE *it) {
+  int res = it->descr.resolution;
+  int a1 = it->descr.a1, b1 = it->descr.b1, c1 = it->descr.c1;
+  int ncx = _S2ISOCELLS(a1, it->descr.a2, res);
+  int ncy = _S2ISOCELLS(b1, it->descr.b2, res);
+  int ncz = _S2ISOCELLS(c1, it->descr.c2, res);
+  float ***grid = it->grptr;
+  int bx;
+
+  _s2priv_freeIsosurfaceTree(it);
+  if (!ncx || !ncy || !ncz) {
+    return;
+  }
+  int nbx = (ncx + _S2ISOBLOCK - 1) / _S2ISOBLOCK;
+  int nby = (ncy + _S2ISOBLOCK - 1) / _S2ISOBLOCK;
+  int nbz = (ncz + _S2ISOBLOCK - 1) / _S2ISOBLOCK;
+  it->bmin = (float *)malloc(nbx * nby * nbz * sizeof(float));
+  it->bmax = (float *)malloc(nbx * nby * nbz * sizeof(float));
+  it->rmin = (float *)malloc(nbx * sizeof(float));
+  it->rmax = (float *)malloc(nbx * sizeof(float));
+  if (!it->bmin || !it->bmax || !it->rmin || !it->rmax) {
+    _s2warn("(internal)", "failed to allocate memory for isosurface tree");
+    _s2priv_freeIsosurfaceTree(it);
+    return;
+  }
+
+#if defined(S2OPENMP)
+#pragma omp parallel for schedule(dynamic,1)
+#endif
+  for (bx = 0; bx < nbx; bx++) {
+    int by, bz, pi, pj, pk, pi2, pj2, pk2;
+    float v, mn, mx, rmn = HUGE_VAL, rmx = -HUGE_VAL;
+    pi2 = (bx + 1) * _S2ISOBLOCK;
+    pi2 = (pi2 > ncx) ? ncx : pi2;
+    for (by = 0; by < nby; by++) {
+      pj2 = (by + 1) * _S2ISOBLOCK;
+      pj2 = (pj2 > ncy) ? ncy : pj2;
+      for (bz = 0; bz < nbz; bz++) {
+	pk2 = (bz + 1) * _S2ISOBLOCK;
+	pk2 = (pk2 > ncz) ? ncz : pk2;
+	mn = HUGE_VAL;
+	mx = -HUGE_VAL;
+	/* every grid point the block's cells use, its far faces included */
+	for (pi = bx * _S2ISOBLOCK; pi <= pi2; pi++) {
+	  for (pj = by * _S2ISOBLOCK; pj <= pj2; pj++) {
+	    for (pk = bz * _S2ISOBLOCK; pk <= pk2; pk++) {
+	      v = grid[a1 + pi * res][b1 + pj * res][c1 + pk * res];
+	      if (v < mn) {
+		mn = v;
+	      }
+	      if (v > mx) {
+		mx = v;
+	      } else if (v != v) {
+		/* NaN is never below the level */
+		mx = HUGE_VAL;
+	      }
+	    }
+	  }
+	}
+	it->bmin[(bx * nby + by) * nbz + bz] = mn;
+	it->bmax[(bx * nby + by) * nbz + bz] = mx;
+	rmn = (mn < rmn) ? mn : rmn;
+	rmx = (mx > rmx) ? mx : rmx;
+      }
+    }
+    it->rmin[bx] = rmn;
+    it->rmax[bx] = rmx;
+  }
+  it->nbx = nbx;
+  it->nby = nby;
+  it->nbz = nbz;
+}
+
+/* march the cells of the slab starting at first index i */
+static void _s2priv_isosurfaceSlab(_S2ISOSURFACE *it, int i, 
+				   _S2ISOSLAB *slab) {
+  int j, k, n, l, m;
+  const int *e;
+  float *bmin = NULL, *bmax = NULL;
+  int bz, nbz = 0;
+  GRIDCELL cell;
+  XYZ vertlist[12];
+  int edges[15];
+  int resolution = it->descr.resolution;
+  float ***grid = it->grptr;
+  long long bdim = it->descr.bdim, cdim = it->descr.cdim;
+
+  slab->ntri = 0;
+  slab->trivert = NULL;
+  slab->keys = NULL;
+  if (it->nbx) {
+    int bx = (i - it->descr.a1) / resolution / _S2ISOBLOCK;
+    if (!_S2ISOBRACKETS(it->rmin[bx], it->rmax[bx], it->descr.level)) {
+      return;
+    }
+    nbz = it->nbz;
+    bmin = it->bmin + bx * it->nby * nbz;
+    bmax = it->bmax + bx * it->nby * nbz;
+  }
+  for (j=it->descr.b1;j<=it->descr.b2-resolution;j+=resolution) {
+    for (k=it->descr.c1;k<=it->descr.c2-resolution;k+=resolution) {
+      if (nbz) {
+	bz = (j - it->descr.b1) / resolution / _S2ISOBLOCK * nbz +
+	  (k - it->descr.c1) / resolution / _S2ISOBLOCK;
+	if (!_S2ISOBRACKETS(bmin[bz], bmax[bz], it->descr.level)) {
+	  /* on to the last cell of this block */
+	  k = it->descr.c1 + ((bz % nbz + 1) * _S2ISOBLOCK - 1) * resolution;
+	  continue;
+	}
+      }
+      cell.p[0].x = i;
+      cell.p[0].y = j;
+      cell.p[0].z = k;
+      cell.val[0] = grid[i][j][k];
+      cell.p[1].x = i + resolution;
+      cell.p[1].y = j;
+      cell.p[1].z = k;
+      cell.val[1] = grid[i+resolution][j][k];
+      cell.p[2].x = i + resolution;
+      cell.p[2].y = j;
+      cell.p[2].z = k + resolution;
+      cell.val[2] = grid[i+resolution][j][k+resolution];
+      cell.p[3].x = i;
+      cell.p[3].y = j;
+      cell.p[3].z = k + resolution;
+      cell.val[3] = grid[i][j][k+resolution];
+      cell.p[4].x = i;
+      cell.p[4].y = j + resolution;
+      cell.p[4].z = k;
+      cell.val[4] = grid[i][j+resolution][k];
+      cell.p[5].x = i + resolution;
+      cell.p[5].y = j + resolution;
+      cell.p[5].z = k;
+      cell.val[5] = grid[i+resolution][j+resolution][k];
+      cell.p[6].x = i + resolution;
+      cell.p[6].y = j + resolution;
+      cell.p[6].z = k + resolution;
+      cell.val[6] = grid[i+resolution][j+resolution][k+resolution];
+      cell.p[7].x = i;
+      cell.p[7].y = j + resolution;
+      cell.p[7].z = k + resolution;
+      cell.val[7] = grid[i][j+resolution][k+resolution];
+	
+      n = PolygoniseEdges(cell,it->descr.level,vertlist,edges);
+      if (!n) {
+	continue;
+      }
+
+      slab->trivert = (XYZ *)_s2priv_arenaReserve(slab->trivert, 
+						  slab->ntri * 3, n * 3,
+						  sizeof(XYZ));
+      slab->keys = (long long *)_s2priv_arenaReserve(slab->keys, 
+						     slab->ntri * 3, n * 3,
+						     sizeof(long long));
+      if (!slab->trivert || !slab->keys) {
+	/* reported once the slabs are merged */
+	_s2priv_arenaFree(slab->trivert);
+	_s2priv_arenaFree(slab->keys);
+	slab->trivert = NULL;
+	slab->keys = NULL;
+	slab->ntri = -1;
+	return;
+      }
+      for (l=0;l<n;l++) {
+	for (m=0;m<3;m++) {
+	  e = _s2x_isoedge[edges[3*l+m]];
+	  slab->trivert[3*slab->ntri+m] = vertlist[edges[3*l+m]];
+	  slab->keys[3*slab->ntri+m] = 
+	    (((i + e[0]*resolution) * bdim + (j + e[1]*resolution)) * cdim +
+	     (k + e[2]*resolution)) * 3 + e[3];
+	}
+	slab->ntri++;
+      }
+    }
+  }
+}
+
 void _s2priv_generate_isosurface(int isid, int force) {
   _S2ISOSURFACE *it = _s2_isosurfs + isid;
 
@@ -1623,9 +1808,14 @@ void _s2priv_generate_isosurface(int isid, int force) {
 
   /* zap the current cache */
   it->ntri = 0;
-  if (it->trivert) {
-    free(it->trivert);
-    it->trivert = NULL;
+  it->nvert = 0;
+  if (it->tris) {
+    free(it->tris);
+    it->tris = NULL;
+  }
+  if (it->verts) {
+    free(it->verts);
+    it->verts = NULL;
   }
   if (it->normals) {
     free(it->normals);
@@ -1644,15 +1834,10 @@ void _s2priv_generate_isosurface(int isid, int force) {
   invbcopy(&_s2priv_colrfn_g, &it->descr.green, sizeof(float));
   invbcopy(&_s2priv_colrfn_b, &it->descr.blue, sizeof(float));
 
-  int i,j,k,n,l;
-  float x2, y2, z2;
-  GRIDCELL cell;
-  TRIANGLE triangles[10];
+  int i, s, l;
   
   _s2debug("(internal)", "forming isosurface");
   
-  x2 = y2 = z2 = 0.;
-  
   COLOUR col;
   col.r = _s2priv_colrfn_r;
   col.g = _s2priv_colrfn_g;
@@ -1661,7 +1846,6 @@ void _s2priv_generate_isosurface(int isid, int force) {
   float fr, fg, fb;
 
   int resolution = it->descr.resolution;
-  float ***grid = it->grptr;
 
   // XXX pre-mult it->descr.tr by it->descr.local_tr ...
   float newtr[12];
@@ -1682,62 +1866,141 @@ void _s2priv_generate_isosurface(int isid, int force) {
   newtr[10]=          ltr[9] * tr[2] + ltr[10]* tr[6] + ltr[11]* tr[10];
   newtr[11]=          ltr[9] * tr[3] + ltr[10]* tr[7] + ltr[11]* tr[11];
 
+  /* 1. march the slabs of cells, each into its own triangle list; with
+   * S2OPENMP the slabs are shared out between threads */
+  int nslab = 0;
   for (i=it->descr.a1;i<=it->descr.a2-resolution;i+=resolution) {
-    for (j=it->descr.b1;j<=it->descr.b2-resolution;j+=resolution) {
-      for (k=it->descr.c1;k<=it->descr.c2-resolution;k+=resolution) {
-	cell.p[0].x = i - x2;
-	cell.p[0].y = j - y2;
-	cell.p[0].z = k - z2;
-	cell.val[0] = grid[i][j][k];
-	cell.p[1].x = i + resolution - x2;
-	cell.p[1].y = j     - y2;
-	cell.p[1].z = k     - z2;
-	cell.val[1] = grid[i+resolution][j][k];
-	cell.p[2].x = i + resolution - x2;
-	cell.p[2].y = j     - y2;
-	cell.p[2].z = k + resolution - z2;
-	cell.val[2] = grid[i+resolution][j][k+resolution];
-	cell.p[3].x = i     - x2;
-	cell.p[3].y = j     - y2;
-	cell.p[3].z = k + resolution - z2;
-	cell.val[3] = grid[i][j][k+resolution];
-	cell.p[4].x = i     - x2;
-	cell.p[4].y = j + resolution - y2;
-	cell.p[4].z = k     - z2;
-	cell.val[4] = grid[i][j+resolution][k];
-	cell.p[5].x = i + resolution - x2;
-	cell.p[5].y = j + resolution - y2;
-	cell.p[5].z = k     - z2;
-	cell.val[5] = grid[i+resolution][j+resolution][k];
-	cell.p[6].x = i + resolution - x2;
-	cell.p[6].y = j + resolution - y2;
-	cell.p[6].z = k + resolution - z2;
-	cell.val[6] = grid[i+resolution][j+resolution][k+resolution];
-	cell.p[7].x = i     - x2;
-	cell.p[7].y = j + resolution - y2;
-	cell.p[7].z = k + resolution - z2;
-	cell.val[7] = grid[i][j+resolution][k+resolution];
-	
-	n = Polygonise(cell,it->descr.level,triangles);
-
-	for (l=0;l<n;l++) {
-	  if (it->descr.fcol != _s2priv_colrfn) {
-	    ixf = 0.3333333333333 * (triangles[l].p[0].x + triangles[l].p[1].x + triangles[l].p[2].x);
-	    iyf = 0.3333333333333 * (triangles[l].p[0].y + triangles[l].p[1].y + triangles[l].p[2].y);
-	    izf = 0.3333333333333 * (triangles[l].p[0].z + triangles[l].p[1].z + triangles[l].p[2].z);
-	    it->descr.fcol(&ixf, &iyf, &izf, &fr, &fg, &fb);
-	    col.r = fr;
-	    col.g = fg;
-	    col.b = fb;
-	  }
+    nslab++;
+  }
+  if (nslab < 1) {
+    _s2priv_calcNormalsForTriangleCache(it);
+    return;
+  }
+  _S2ISOSLAB *slabs = (_S2ISOSLAB *)malloc(nslab * sizeof(_S2ISOSLAB));
+  int *first = (int *)malloc(nslab * sizeof(int));
+  if (!slabs || !first) {
+    _s2warn("(internal)", "failed to allocate memory for isosurface");
+    free(slabs);
+    free(first);
+    return;
+  }
+#if defined(S2OPENMP)
+#pragma omp parallel for schedule(dynamic,1)
+#endif
+  for (s = 0; s < nslab; s++) {
+    _s2priv_isosurfaceSlab(it, it->descr.a1 + s * resolution, slabs + s);
+  }
+
+  /* 2. merge the slabs into an indexed mesh.  Each vertex is stored
+   * once, found by hashing the grid edge it lies on, and shared by
+   * all the facets around it; the mesh arrays are allocated once, at
+   * their final (or, for vertices, largest possible) size. */
+  int ntri = 0, failed = 0;
+  for (s = 0; s < nslab; s++) {
+    if (slabs[s].ntri < 0) {
+      failed = 1;
+      slabs[s].ntri = 0;
+    }
+    first[s] = ntri;
+    ntri += slabs[s].ntri;
+  }
+  int hsize = 16;
+  while (hsize < 4 * ntri) {
+    hsize *= 2;
+  }
+  long long *hkey = NULL;
+  int *hvert = NULL;
+  if (ntri > 0) {
+    it->tris = (int *)malloc(ntri * 3 * sizeof(int));
+    it->verts = (XYZ *)malloc(ntri * 3 * sizeof(XYZ));
+    it->col = (COLOUR *)malloc(ntri * sizeof(COLOUR));
+    hkey = (long long *)malloc(hsize * sizeof(long long));
+    hvert = (int *)malloc(hsize * sizeof(int));
+    if (!it->tris || !it->verts || !it->col || !hkey || !hvert) {
+      failed = 1;
+      free(it->tris);
+      free(it->verts);
+      free(it->col);
+      it->tris = NULL;
+      it->verts = NULL;
+      it->col = NULL;
+      ntri = 0;
+    }
+  }
+  if (failed) {
+    _s2warn("(internal)", "failed to allocate memory for isosurface");
+  }
 
+  int nvert = 0;
+  if (ntri > 0) {
+    unsigned long long h;
+    long long key;
+    for (l = 0; l < hsize; l++) {
+      hvert[l] = -1;
+    }
+    for (s = 0; s < nslab; s++) {
+      for (l = 0; l < 3 * slabs[s].ntri; l++) {
+	key = slabs[s].keys[l];
+	h = ((unsigned long long)key * 0x9E3779B97F4A7C15ULL) & (hsize - 1);
+	while (hvert[h] >= 0 && hkey[h] != key) {
+	  h = (h + 1) & (hsize - 1);
+	}
+	if (hvert[h] < 0) {
+	  hkey[h] = key;
+	  hvert[h] = nvert;
+	  it->verts[nvert++] = slabs[s].trivert[l];
+	}
+	it->tris[3 * first[s] + l] = hvert[h];
+      }
+    }
+    it->verts = (XYZ *)realloc(it->verts, nvert * sizeof(XYZ));
+  }
+  free(hkey);
+  free(hvert);
+
+  /* 3. transform the vertices into place.  The colour callback is user
+   * code, so it is called from this thread only, in grid order. */
+  if (ntri > 0) {
+    XYZ in;
+#if defined(S2OPENMP)
+#pragma omp parallel for private(in)
+#endif
+    for (l = 0; l < nvert; l++) {
+      in = it->verts[l];
+      it->verts[l].x = newtr[0] + newtr[1]*in.x + newtr[2]*in.y + 
+	newtr[3]*in.z;
+      it->verts[l].y = newtr[4] + newtr[5]*in.x + newtr[6]*in.y + 
+	newtr[7]*in.z;
+      it->verts[l].z = newtr[8] + newtr[9]*in.x + newtr[10]*in.y + 
+	newtr[11]*in.z;
+    }
 
-	  //_s2priv_addToTriangleCache(it, triangles[l].p, it->descr.tr, col);
-	  _s2priv_addToTriangleCache(it, triangles[l].p, newtr, col);
+    for (s = 0; s < nslab; s++) {
+      XYZ *in = slabs[s].trivert;
+      for (l = 0; l < slabs[s].ntri; l++, in += 3) {
+	if (it->descr.fcol != _s2priv_colrfn) {
+	  ixf = 0.3333333333333 * (in[0].x + in[1].x + in[2].x);
+	  iyf = 0.3333333333333 * (in[0].y + in[1].y + in[2].y);
+	  izf = 0.3333333333333 * (in[0].z + in[1].z + in[2].z);
+	  it->descr.fcol(&ixf, &iyf, &izf, &fr, &fg, &fb);
+	  col.r = fr;
+	  col.g = fg;
+	  col.b = fb;
 	}
+	it->col[first[s] + l] = col;
       }
     }
   }
+  it->ntri = ntri;
+  it->nvert = nvert;
+
+  for (s = 0; s < nslab; s++) {
+    _s2priv_arenaFree(slabs[s].trivert);
+    _s2priv_arenaFree(slabs[s].keys);
+  }
+  free(slabs);
+  free(first);
+
   _s2priv_calcNormalsForTriangleCache(it);
   return;
 }
@@ -1770,13 +2033,12 @@ void _s2priv_bb(XYZ iP, XYZ iStretch, XYZ ioffset,
   bboard_base[0].texid = iid;
   bboard_base[0].alpha = ialpha;
   bboard_base[0].trans = itrans;
-  strcpy(bboard_base[0].whichscreen, _s2_whichscreen);
-  bboard_base[0].whichscreen[strlen(_s2_whichscreen)] = '\0';
-  if (strlen(bboard_base[0].whichscreen)) {
-    fprintf(stderr, "adding billboard with screen: %s\n", bboard_base[0].whichscreen);
+  bboard_base[0].whichscreen = _s2_currscreentag;
+  if (bboard_base[0].whichscreen) {
+    fprintf(stderr, "adding billboard with screen: %s\n", 
+	    _s2_screentags[bboard_base[0].whichscreen]);
   }
-  strncpy(bboard_base[0].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  bboard_base[0].VRMLname[MAXVRMLLEN-1] = '\0';
+  bboard_base[0].VRMLname = _s2_currVRMLidx;
 
   return;
 }
@@ -1834,6 +2096,81 @@ void _s2priv_choose_vr_axis(int vrid, int *axis, int *reverse) {
   return;
 }
 
+/* Fill the texture for slice tid of a volume along the given axis.
+ * Each texture row is first gathered into contiguous storage and
+ * quantised to an offset into the colour lookup table lut (nidx + 1
+ * RGB entries); these inner loops carry no calls or cross-iteration
+ * state so the compiler can vectorise them. */
+static void _s2priv_vr_slice(_S2VRVOLUME *it, int axis, int tid,
+			     int width, int height, unsigned char *tptr,
+			     unsigned char *lut, int nidx, 
+			     float sca, float xsca) {
+  float *row = (float *)malloc(width * sizeof(float));
+  int *q = (int *)malloc(width * sizeof(int));
+  float *val = row;
+  float *vox;
+  float valsca;
+  unsigned char *tbit;
+  int c, rw;
+
+  for (rw = 0; rw < height; rw++) {
+    switch (axis) {
+    case 1:
+      val = it->grid[it->a1 + tid][it->b1 + rw] + it->c1;
+      break;
+    case 2:
+      for (c = 0; c < width; c++) {
+	row[c] = it->grid[it->a1 + c][it->b1 + tid][it->c1 + rw];
+      }
+      break;
+    case 3:
+      for (c = 0; c < width; c++) {
+	row[c] = it->grid[it->a1 + c][it->b1 + rw][it->c1 + tid];
+      }
+      break;
+    }
+
+    for (c = 0; c < width; c++) {
+      valsca = (val[c] - it->datamin) * sca;
+      valsca = (valsca < 0.) ? 0. : ((valsca > 1.) ? 1. : valsca);
+      q[c] = (int)(valsca * (float)nidx);
+      q[c] = (q[c] < 0) ? 0 : ((q[c] > nidx) ? nidx : q[c]);
+    }
+
+    tbit = tptr + 4 * width * rw;
+    for (c = 0; c < width; c++, tbit += 4) {
+      tbit[0] = lut[3 * q[c]];     // red
+      tbit[1] = lut[3 * q[c] + 1]; // green
+      tbit[2] = lut[3 * q[c] + 2]; // blue
+      if (it->alphafn) {
+	// the user function is handed the voxel itself, not a copy
+	switch (axis) {
+	case 1:
+	  vox = val + c;
+	  break;
+	case 2:
+	  vox = &it->grid[it->a1 + c][it->b1 + tid][it->c1 + rw];
+	  break;
+	default:
+	  vox = &it->grid[it->a1 + c][it->b1 + rw][it->c1 + tid];
+	  break;
+	}
+	tbit[3] = 255. * xsca * it->alphafn(vox);
+      } else if (val[c] - it->datamin < 0) {
+	// added db 20120131 to clip data < dmin
+	tbit[3] = 0;
+      } else {
+	valsca = (val[c] - it->datamin) * sca;
+	valsca = (valsca < 0.) ? 0. : ((valsca > 1.) ? 1. : valsca);
+	tbit[3] = 255. * xsca * (it->alphamin + valsca * (it->alphamax - it->alphamin));
+      }
+    }
+  }
+
+  free(q);
+  free(row);
+}
+
 // call with iaxis == 0 to request autoselect of axis
 // otherwise axis = abs(axis) and reverse = (axis < 0)
 void _s2priv_load_vr_textures(int vrid, int force, int iaxis) {
@@ -1841,7 +2178,7 @@ void _s2priv_load_vr_textures(int vrid, int force, int iaxis) {
   int axis = 0;
   int reverse = 0;
 
-  int i, j, k;
+  int i;
   _S2VRVOLUME *it = _s2_volumes + vrid;
 
   if (iaxis != 0) {
@@ -1914,6 +2251,7 @@ void _s2priv_load_vr_textures(int vrid, int force, int iaxis) {
 
   // if we are here, then the axis has changed, so we need to zap
   // all the textures and recreate new ones.
+  double tprof = _s2priv_profStart();
   
   // delete textures
   for (i = 0; i < it->ntexts; i++) {
@@ -1921,16 +2259,14 @@ void _s2priv_load_vr_textures(int vrid, int force, int iaxis) {
   }
   
   // make new textures
-  unsigned char *tptr = NULL;
-  unsigned char *tbit = NULL;
-  int nt, width, height, wq, hq;
+  unsigned char **tptrs = NULL;
+  unsigned char *lut = NULL;
+  int nt = 0, width = 0, height = 0, wq, hq;
   int tid;
   float sca = 1. / (it->datamax - it->datamin);
-  float valsca;
 
   int idx1 = _s2_colr1;
   int idx2 = _s2_colr2;
-  int idx;
   float r, g, b;
 
 #define MAXOPACFRAC 0.7
@@ -1963,179 +2299,86 @@ void _s2priv_load_vr_textures(int vrid, int force, int iaxis) {
   case 1:
     _s2debug("(internal)", "creating volume rendering textures for X-view");
     // textures are zy planes 
-    nt = it->ntexts = it->a2 - it->a1 + 1;
-
+    nt = it->a2 - it->a1 + 1;
+    width = it->c2 - it->c1 + 1;
+    height = it->b2 - it->b1 + 1;
     // alpha scaling for non-cubic volumes: 1.0 for x views
     if (_s2_evas_x > 0.0) {
       xsca = _s2_evas_x;
     } else {
       xsca = basess / sx;
     }
-    //fprintf(stderr, "X-view xsca = %f; sca = %f\n", xsca, sca);
-    //fprintf(stderr, "X-view amin = %f; amax = %f\n", it->alphamin, it->alphamax);
-
-    //float minaf = 9e30, maxaf = -9e30;
-    width = it->c2 - it->c1 + 1;
-    height = it->b2 - it->b1 + 1;
-    it->textureids = (unsigned int *)realloc(it->textureids, 
-					     nt * sizeof(unsigned int));
-    for (tid = 0; tid < nt; tid++) {
-      it->textureids[tid] = ss2ct(width, height);
-      tptr = ss2gt(it->textureids[tid], &wq, &hq);
-      // (ignore wq, hq, as they should be idential to width, height)
-      i = it->a1 + tid;
-      for (k = 0; k < width; k++) {
-	for (j = 0; j < height; j++) {
-	  tbit = tptr + 4 * (k + width * j);
-	  valsca = (it->grid[i][j + it->b1][k + it->c1] - it->datamin) * sca;
-	  valsca = (valsca < 0.) ? 0. : ((valsca > 1.) ? 1. : valsca);
-	  idx = idx1 + (int)(valsca * (float)(idx2 - idx1));
-	  idx = (idx < idx1) ? idx1 : ((idx > idx2) ? idx2 : idx);
-	  s2qcr(idx, &r, &g, &b);
-	  //if (tid == 15) {
-	  //  fprintf(stderr, "%5d %5d %7.3f %3d %7.4f %7.4f %7.4f\n", 
-	  //	    idx1, idx2, valsca, idx, r, g, b);
-	  //}
-	  tbit[0] = r * 255.; // red
-	  //if (tid == 15) {
-	  //  fprintf(stderr, "%3d ", tbit[0]);
-	  //}
-	  tbit[1] = g * 255.; // green
-	  tbit[2] = b * 255.; // blue
-	  //tbit[3] = 255. * valsca * MAXOPACFRAC;
-	  if (it->alphafn) {
-	    tbit[3] = 255. * xsca * it->alphafn(&it->grid[i][j + it->b1][k + it->c1]);
-	  } else {
-	    // added db 20120131 to clip data < dmin
-	    if (it->grid[i][j + it->b1][k + it->c1] - it->datamin < 0) {
-	      tbit[3] = 0;
-	    } else {
-	      tbit[3] = 255. * xsca * (it->alphamin + valsca * (it->alphamax - it->alphamin));
-	    }
-	  }
-	  //if (tbit[3] < minaf) {
-	  //  minaf = tbit[3];
-	  //}
-	  //if (tbit[3] > maxaf) {
-	  //  maxaf = tbit[3];
-	  //}
-	}
-      }
-      ss2pt(it->textureids[tid]);
-      //fprintf(stderr, "minaf = %f, maxaf = %f\n", minaf, maxaf);
-    }
     break;
 
   case 2:
     _s2debug("(internal)", "creating volume rendering textures for Y-view");
-    // textures are zy planes 
-    nt = it->ntexts = it->b2 - it->b1 + 1;
-
-    // alpha scaling for non-cubic volumes: 1.0 for x views
+    // textures are zx planes 
+    nt = it->b2 - it->b1 + 1;
+    width = it->a2 - it->a1 + 1;
+    height = it->c2 - it->c1 + 1;
     if (_s2_evas_y > 0.0) {
       xsca = _s2_evas_y;
     } else {
       xsca = basess / sy;
     }
-    //fprintf(stderr, "Y-view xsca = %f\n", xsca);
-
-    width = it->a2 - it->a1 + 1;
-    height = it->c2 - it->c1 + 1;
-    it->textureids = (unsigned int *)realloc(it->textureids, 
-					     nt * sizeof(unsigned int));
-    for (tid = 0; tid < nt; tid++) {
-      it->textureids[tid] = ss2ct(width, height);
-      tptr = ss2gt(it->textureids[tid], &wq, &hq);
-      // (ignore wq, hq, as they should be idential to width, height)
-      j = it->b1 + tid;
-      for (i = 0; i < width; i++) {
-	for (k = 0; k < height; k++) {
-	  tbit = tptr + 4 * (i + width * k);
-	  valsca = (it->grid[i + it->a1][j][k + it->c1] - it->datamin) * sca;
-	  valsca = (valsca < 0.) ? 0. : ((valsca > 1.) ? 1. : valsca);
-	  idx = idx1 + valsca * (idx2 - idx1);
-	  idx = (idx < idx1) ? idx1 : ((idx > idx2) ? idx2 : idx);
-	  s2qcr(idx, &r, &g, &b);
-	  tbit[0] = r * 255.; // red
-	  tbit[1] = g * 255.; // green
-	  tbit[2] = b * 255.; // blue
-	  //tbit[3] = 255. * valsca * MAXOPACFRAC;
-	  if (it->alphafn) {
-	    tbit[3] = 255. * xsca * it->alphafn(&it->grid[i + it->a1][j][k + it->c1]);
-	  } else {
-	    // added db 20120131 to clip data < dmin
-	    if (it->grid[i + it->a1][j][k + it->c1] - it->datamin < 0) {
-	      tbit[3] = 0;
-	    } else {
-	    tbit[3] = 255. * xsca * (it->alphamin + valsca * (it->alphamax - it->alphamin));
-	    }
-	  }
-	}
-      }
-      ss2pt(it->textureids[tid]);
-    }
     break;
 
   case 3:
     _s2debug("(internal)", "creating volume rendering textures for Z-view");
     // textures are xy planes 
-    nt = it->ntexts = it->c2 - it->c1 + 1;
-
-    // alpha scaling for non-cubic volumes: 1.0 for x views
+    nt = it->c2 - it->c1 + 1;
+    width = it->a2 - it->a1 + 1;
+    height = it->b2 - it->b1 + 1;
     if (_s2_evas_z > 0.0) {
       xsca = _s2_evas_z;
     } else {
       xsca = basess / sz;
     }
-    //fprintf(stderr, "Z-view xsca = %f\n", xsca);
-
-    width = it->a2 - it->a1 + 1;
-    height = it->b2 - it->b1 + 1;
-    it->textureids = (unsigned int *)realloc(it->textureids, 
-					     nt * sizeof(unsigned int));
-    for (tid = 0; tid < nt; tid++) {
-      it->textureids[tid] = ss2ct(width, height);
-      tptr = ss2gt(it->textureids[tid], &wq, &hq);
-      // (ignore wq, hq, as they should be idential to width, height)
-      k = it->c1 + tid;
-      for (i = 0; i < width; i++) {
-	for (j = 0; j < height; j++) {
-	  tbit = tptr + 4 * (i + width * j);
-	  valsca = (it->grid[it->a1 + i][it->b1 + j][k] - it->datamin) * sca;
-	  valsca = (valsca < 0.) ? 0. : ((valsca > 1.) ? 1. : valsca);
-	  idx = idx1 + valsca * (idx2 - idx1);
-	  idx = (idx < idx1) ? idx1 : ((idx > idx2) ? idx2 : idx);
-	  s2qcr(idx, &r, &g, &b);
-	  tbit[0] = r * 255.; // red
-	  tbit[1] = g * 255.; // green
-	  tbit[2] = b * 255.; // blue
-	  //tbit[3] = 255. * valsca * MAXOPACFRAC;
-	  if (it->alphafn) {
-	    tbit[3] = 255. * xsca * it->alphafn(&it->grid[i + it->a1][j + it->b1][k]);
-	  } else {
-	    // added db 20120131 to clip data < dmin
-	    if (it->grid[it->a1 + i][it->b1 + j][k] - it->datamin < 0) {
-	      tbit[3] = 0;
-	    } else {
-	      tbit[3] = 255. * xsca * (it->alphamin + valsca * (it->alphamax - it->alphamin));
-	    }
-	  }
-	  /*
-	  if (i == 0  || j == 0 || i == width-1 || j == height-1) {
-	    tbit[0] = 0;
-	    tbit[1] = 255;
-	    tbit[2] = 128;
-	    tbit[3] = 255;
-	  }
-	  */
-	}
-      }
-      ss2pt(it->textureids[tid]);
-    }
     break;
 
   } // case (axis) 
 
+  // the transfer function's colour ramp: one RGB entry per colour
+  // index, so the voxel loop is a table lookup rather than a call to
+  // s2qcr per voxel
+  if (idx2 < idx1) {
+    idx1 = idx2;
+  }
+  lut = (unsigned char *)malloc(3 * (idx2 - idx1 + 1) * sizeof(unsigned char));
+  for (i = 0; i <= idx2 - idx1; i++) {
+    s2qcr(idx1 + i, &r, &g, &b);
+    lut[3 * i] = r * 255.;
+    lut[3 * i + 1] = g * 255.;
+    lut[3 * i + 2] = b * 255.;
+  }
+
+  // textures are created serially, as that touches the texture list,
+  // then the slices - which are independent - are filled, in parallel
+  // under S2OPENMP unless a user alpha function must be called
+  it->ntexts = nt;
+  it->textureids = (unsigned int *)realloc(it->textureids, 
+					   nt * sizeof(unsigned int));
+  tptrs = (unsigned char **)malloc(nt * sizeof(unsigned char *));
+  for (tid = 0; tid < nt; tid++) {
+    it->textureids[tid] = ss2ct(width, height);
+    tptrs[tid] = ss2gt(it->textureids[tid], &wq, &hq);
+    // (ignore wq, hq, as they should be idential to width, height)
+  }
+#if defined(S2OPENMP)
+#pragma omp parallel for schedule(dynamic,1) if(!it->alphafn)
+#endif
+  for (tid = 0; tid < nt; tid++) {
+    _s2priv_vr_slice(it, axis, tid, width, height, tptrs[tid], 
+		     lut, idx2 - idx1, sca, xsca);
+  }
+  for (tid = 0; tid < nt; tid++) {
+    ss2pt(it->textureids[tid]);
+  }
+  free(tptrs);
+  free(lut);
+
+  _s2priv_profStop(_S2PROF_VRTEX, tprof, nt, nt * width * height * 4);
+
 }
 
 /* Draw the surface described by the provided function "fab(a, b)".
@@ -2928,7 +3171,7 @@ void CalcBounds(void) {
   
   for (i=0;i<ndot;i++) {
 #if defined(BUILDING_S2PLOT) 
-    if (!strlen(dot[i].whichscreen))
+    if (!dot[i].whichscreen)
 #endif
       UpdateBounds(dot[i].p);
   }
@@ -2937,14 +3180,14 @@ void CalcBounds(void) {
     p.y = ball[i].p.y + ball[i].r;
     p.z = ball[i].p.z + ball[i].r;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(ball[i].whichscreen))
+    if (!ball[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = ball[i].p.x - ball[i].r;
     p.y = ball[i].p.y - ball[i].r;
     p.z = ball[i].p.z - ball[i].r;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(ball[i].whichscreen))
+    if (!ball[i].whichscreen)
 #endif
       UpdateBounds(p);
   }
@@ -2953,14 +3196,14 @@ void CalcBounds(void) {
     p.y = ballt[i].p.y + ballt[i].r;
     p.z = ballt[i].p.z + ballt[i].r;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(ballt[i].whichscreen))
+    if (!ballt[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = ballt[i].p.x - ballt[i].r;
     p.y = ballt[i].p.y - ballt[i].r;
     p.z = ballt[i].p.z - ballt[i].r;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(ballt[i].whichscreen))
+    if (!ballt[i].whichscreen)
 #endif
       UpdateBounds(p);
   }
@@ -2969,14 +3212,14 @@ void CalcBounds(void) {
     p.y = disk[i].p.y + disk[i].r2;
     p.z = disk[i].p.z + disk[i].r2;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(disk[i].whichscreen))
+    if (!disk[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = disk[i].p.x - disk[i].r2;
     p.y = disk[i].p.y - disk[i].r2;
     p.z = disk[i].p.z - disk[i].r2;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(disk[i].whichscreen))
+    if (!disk[i].whichscreen)
 #endif
       UpdateBounds(p);
   }
@@ -2985,14 +3228,14 @@ void CalcBounds(void) {
     p.y = cone[i].p1.y + cone[i].r1;
     p.z = cone[i].p1.z + cone[i].r1;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(cone[i].whichscreen))
+    if (!cone[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = cone[i].p1.x - cone[i].r1;
     p.y = cone[i].p1.y - cone[i].r1;
     p.z = cone[i].p1.z - cone[i].r1;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(cone[i].whichscreen))
+    if (!cone[i].whichscreen)
 #endif
       UpdateBounds(p);
     
@@ -3000,20 +3243,20 @@ void CalcBounds(void) {
     p.y = cone[i].p2.y + cone[i].r2;
     p.z = cone[i].p2.z + cone[i].r2;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(cone[i].whichscreen))
+    if (!cone[i].whichscreen)
 #endif
       UpdateBounds(p);
     p.x = cone[i].p2.x - cone[i].r2;
     p.y = cone[i].p2.y - cone[i].r2;
     p.z = cone[i].p2.z - cone[i].r2;
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(cone[i].whichscreen))
+    if (!cone[i].whichscreen)
 #endif
       UpdateBounds(p);
   }
   for (i=0;i<nline;i++) {
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(line[i].whichscreen)) {
+    if (!line[i].whichscreen) {
 #endif
       UpdateBounds(line[i].p[0]);
       UpdateBounds(line[i].p[1]);
@@ -3023,7 +3266,7 @@ void CalcBounds(void) {
   }
   for (i=0;i<nface3;i++) {
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(face3[i].whichscreen)) {
+    if (!face3[i].whichscreen) {
 #endif
       UpdateBounds(face3[i].p[0]);
       UpdateBounds(face3[i].p[1]);
@@ -3034,7 +3277,7 @@ void CalcBounds(void) {
   }
 #if defined(BUILDING_S2PLOT)
   for (i=0;i<nface3a;i++) {
-    if (!strlen(face3a[i].whichscreen)) {
+    if (!face3a[i].whichscreen) {
       UpdateBounds(face3a[i].p[0]);
       UpdateBounds(face3a[i].p[1]);
       UpdateBounds(face3a[i].p[2]);
@@ -3042,7 +3285,7 @@ void CalcBounds(void) {
   }
 #if defined(S2_3D_TEXTURES)
   for (i=0;i<ntexpoly3d;i++) {
-    if (!strlen(texpoly3d[i].whichscreen)) {
+    if (!texpoly3d[i].whichscreen) {
       int j;
       for (j=0; j<texpoly3d[i].nverts;j++) {
 	UpdateBounds(texpoly3d[i].verts[j]);
@@ -3051,7 +3294,7 @@ void CalcBounds(void) {
   }
 #endif
   for (i = 0; i < ntexmesh; i++) {
-    if (!strlen(texmesh[i].whichscreen)) {
+    if (!texmesh[i].whichscreen) {
       int j;
       for (j = 0; j < texmesh[i].nverts; j++) {
 	UpdateBounds(texmesh[i].verts[j]);
@@ -3061,7 +3304,7 @@ void CalcBounds(void) {
 #endif
   for (i=0;i<nface4;i++) {
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(face4[i].whichscreen)) {
+    if (!face4[i].whichscreen) {
 #endif
       UpdateBounds(face4[i].p[0]);
       UpdateBounds(face4[i].p[1]);
@@ -3073,7 +3316,7 @@ void CalcBounds(void) {
   }
   for (i=0;i<nface4t;i++) {
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(face4t[i].whichscreen)) {
+    if (!face4t[i].whichscreen) {
 #endif
       UpdateBounds(face4t[i].p[0]);
       UpdateBounds(face4t[i].p[1]);
@@ -3086,7 +3329,7 @@ void CalcBounds(void) {
 
 #if defined(BUILDING_S2PLOT)
   for (i = 0; i < ntrdot; i++) {
-    if (!strlen(trdot[i].whichscreen)) {
+    if (!trdot[i].whichscreen) {
       UpdateBounds(trdot[i].p);
     }
   }
@@ -3094,12 +3337,12 @@ void CalcBounds(void) {
 
   for (i=0;i<nlabel;i++)
 #if defined(BUILDING_S2PLOT)
-    if (!strlen(label[i].whichscreen)) 
+    if (!label[i].whichscreen) 
 #endif
       UpdateBounds(label[i].p);
 #if defined(BUILDING_S2PLOT)
   for (i = 0; i < nlabel; i++) {
-    if (!strlen(label[i].whichscreen)) {
+    if (!label[i].whichscreen) {
       UpdateBounds(VectorAdd(VectorAdd(label[i].p, label[i].up), 
 			     VectorMul(label[i].right, 
 				       (double)strlen(label[i].s))));
@@ -3169,66 +3412,34 @@ void _s2_endScreenGeometry() {
 }
 
 
+/* empty the current geometry lists; the stores themselves are retained
+ * so that per-frame dynamic geometry re-uses the same memory */
 void _s2_clearGeometryList() {
   int i;
-  if (nball) {
-    free(ball);
-    ball = NULL;
-    nball = 0;
-  }
+
+  nball = 0;
 
   if (nballt) {	
     for (i = 0; i < nballt; i++) {
-      /* only delete the texture if it is not called "<cached>" */
+      /* only release the texture if it is not called "<cached>";
+       * it is deleted once nothing else uses it */
       if (strcmp(ballt[i].texturename, "<cached>")) {
-	//glDeleteTextures(1,&(ballt[i].textureid));
-		  _s2priv_dropTexture(ballt[i].textureid); //wasGL
+	_s2priv_texRelease(ballt[i].textureid);
 	if (ballt[i].rgba != NULL) {
 	  free(ballt[i].rgba);
 	  ballt[i].rgba = NULL;
 	}
       }
     }
-    free(ballt);
-    ballt = NULL;
     nballt = 0;
   }
 
-  if (ndisk) {
-    free(disk);
-    disk = NULL;
-    ndisk = 0;
-  }
-
-  if (ncone) {
-    free(cone);
-    cone = NULL;
-    ncone = 0;
-  }
-
-  if (ndot) {
-    free(dot);
-    dot = NULL;
-    ndot = 0;
-  }
-
-  if (nline) {
-    free(line);
-    line = NULL;
-    nline = 0;
-  }
-
-  if (nface3) {
-    free(face3);
-    face3 = NULL;
-    nface3 = 0;
-  }
-
-  if (nface3a) {
-    free(face3a);
-    face3a = NULL;
-    nface3a = 0;
-  }
+  ndisk = 0;
+  ncone = 0;
+  ndot = 0;
+  nline = 0;
+  nface3 = 0;
+  nface3a = 0;
 
 #if defined(S2_3D_TEXTURES)
   if (ntexpoly3d) {
@@ -3240,8 +3451,6 @@ void _s2_clearGeometryList() {
 	free(texpoly3d[i].texcoords);
       }
     }
-    free(texpoly3d);
-    texpoly3d = NULL;
     ntexpoly3d = 0;
   }
 #endif
@@ -3275,69 +3484,38 @@ void _s2_clearGeometryList() {
 	texmesh[i].facets_vtcs = NULL;
       }
     }
-    free(texmesh);
-    texmesh = NULL;
     ntexmesh = 0;
   }
 
-  if (nface4) {
-    free(face4);
-    face4 = NULL;
-    nface4 = 0;
-  }
+  nface4 = 0;
 
   if (nface4t) {
     for (i = 0; i < nface4t; i++) {
-      /* only delete the texture if it is not called "<cached>" */
+      /* only release the texture if it is not called "<cached>";
+       * it is deleted once nothing else uses it */
       if (strcmp(face4t[i].texturename, "<cached>")) {
-	//glDeleteTextures(1,&(face4t[i].textureid));
-		  _s2priv_dropTexture(face4t[i].textureid); // wasGL
+	_s2priv_texRelease(face4t[i].textureid);
 	if (face4t[i].rgba != NULL) {
 	  free(face4t[i].rgba);
 	  face4t[i].rgba = NULL;
 	}
       }
     }
-    free(face4t);
-    face4t = NULL;
     nface4t = 0;
   }
 
-  if (nlabel) {
-    free(label);
-    label = NULL;
-    nlabel = 0;
-  }
-
-  if (nhandle) {
-    free(handle);
-    handle = NULL;
-    nhandle = 0;
-  }
-
-  if (nbboard) {
-    free(bboard);
-    bboard = NULL;
-    nbboard = 0;
-  }
-
-  if (nbbset) {
-    free(bbset);
-    bbset = NULL;
-    nbbset = 0;
-  }
-
-  if (ntrdot) {
-    free(trdot);
-    trdot = NULL;
-    ntrdot = 0;
-  }
-
+  nlabel = 0;
+  nhandle = 0;
+  nbboard = 0;
+  nbbset = 0;
+  ntrdot = 0;
 }
 
 /* enable dynamic lists */
 void _s2_startDynamicGeometry(int erase) {
 
+  double tprof = _s2priv_profStart();
+
   if (_s2_dynamicEnabled) {
     fprintf(stderr, "_s2_startDynamicGeometry INVALID * * * * * SHOULD NEVER HAPPEN! ARGH !!! * * * *\n");
   }
@@ -3439,6 +3617,12 @@ void _s2_startDynamicGeometry(int erase) {
   }
 
   _s2_dynamicEnabled = 1;
+
+  if (erase) {
+    _s2priv_listChanged();
+  }
+
+  _s2priv_profStop(_S2PROF_DYNAMIC, tprof, 1, 0);
 }
 
 /* enable static lists */
@@ -3583,7 +3767,8 @@ void _s2priv_pushGlobalsToPanel(int panelid) {
   bcopy(_s2_dragproj, it->dragproj, 16 * sizeof(double)); // wasGL
   bcopy(_s2_dragview, it->dragview, 4 * sizeof(int)); // wasGL
 
-  // GL_listindex is not done - it is handled by direct access
+  // GL_listindex, GL_static and GL_dynamic are not done - they are
+  // handled by direct access
 
   /* "current" geometry */
   bcopy(&nball, &(it->nball), sizeof(int));
@@ -4329,10 +4514,8 @@ void s2pt(int inp, float *ixpts, float *iypts, float *izpts, int isymbol) {
 	ball_base[0].colour.r = _S2PENRED;
 	ball_base[0].colour.g = _S2PENGRN;
 	ball_base[0].colour.b = _S2PENBLU;
-	strcpy(ball_base[0].whichscreen, _s2_whichscreen);
-	strncpy(ball_base[0].VRMLname, _s2_VRMLnames[_s2_currVRMLidx],
-		MAXVRMLLEN);
-	ball_base[0].VRMLname[MAXVRMLLEN-1] = '\0';
+	ball_base[0].whichscreen = _s2_currscreentag;
+	ball_base[0].VRMLname = _s2_currVRMLidx;
       }
       break;
     }
@@ -4367,10 +4550,8 @@ void s2pt(int inp, float *ixpts, float *iypts, float *izpts, int isymbol) {
 	dot_base[0].p.y = _S2WORLD2DEVICE(iypts[i], _S2YAX);
 	dot_base[0].p.z = _S2WORLD2DEVICE(izpts[i], _S2ZAX);
 	dot_base[0].size = (float)_s2_linewidth;
-	strcpy(dot_base[0].whichscreen, _s2_whichscreen);
-	strncpy(dot_base[0].VRMLname, _s2_VRMLnames[_s2_currVRMLidx],
-		MAXVRMLLEN);
-	dot_base[0].VRMLname[MAXVRMLLEN-1] = '\0';
+	dot_base[0].whichscreen = _s2_currscreentag;
+	dot_base[0].VRMLname = _s2_currVRMLidx;
       }
       break;
     }
@@ -4422,10 +4603,8 @@ void s2linea(int in, float *ixpts, float *iypts, float *izpts, float ialpha) {
 	line_base[i].p[1].y = _S2WORLD2DEVICE(iypts[i+1], _S2YAX);
 	line_base[i].p[1].z = _S2WORLD2DEVICE(izpts[i+1], _S2ZAX);
 	line_base[i].width = _s2_linewidth;
-	strcpy(line_base[i].whichscreen, _s2_whichscreen);
-	strncpy(line_base[i].VRMLname, _s2_VRMLnames[_s2_currVRMLidx],
-		MAXVRMLLEN);
-	line_base[i].VRMLname[MAXVRMLLEN-1] = '\0';
+	line_base[i].whichscreen = _s2_currscreentag;
+	line_base[i].VRMLname = _s2_currVRMLidx;
 	switch (_s2_linestyle) {
 	case 2:
 	  line_base[i].stipple_factor = 3;
@@ -4472,7 +4651,7 @@ void s2diskxy(float ipx, float ipy, float ipz, float ir1, float ir2) {
   disk_base->n.x = 0.0;
   disk_base->n.y = 0.0;
   disk_base->n.z = 1.0;
-  strcpy(disk_base->whichscreen, _s2_whichscreen);
+  disk_base->whichscreen = _s2_currscreentag;
   return;
 }
 void s2diskxz(float ipx, float ipy, float ipz, float ir1, float ir2) {
@@ -4491,7 +4670,7 @@ void s2diskxz(float ipx, float ipy, float ipz, float ir1, float ir2) {
   disk_base->n.x = 0.0;
   disk_base->n.y = 1.0;
   disk_base->n.z = 0.0;
-  strcpy(disk_base->whichscreen, _s2_whichscreen);
+  disk_base->whichscreen = _s2_currscreentag;
   return;
 }
 void s2diskyz(float ipx, float ipy, float ipz, float ir1, float ir2) {
@@ -4510,7 +4689,7 @@ void s2diskyz(float ipx, float ipy, float ipz, float ir1, float ir2) {
   disk_base->n.x = 1.0;
   disk_base->n.y = 0.0;
   disk_base->n.z = 0.0;
-  strcpy(disk_base->whichscreen, _s2_whichscreen);
+  disk_base->whichscreen = _s2_currscreentag;
   return;
 }
 
@@ -4624,9 +4803,8 @@ void s2arro(float ix1, float iy1, float iz1,
   cone_base->p2.z = zpts[1] + (zpts[0] - zpts[1]) * ticklen / linelength;
   cone_base->r2 = ticklen * tan(0.5 * _s2_arrow_angle / 180.0 * PI);
   cone_base->colour = _s2_colormap[_s2_colidx];
-  strcpy(cone_base->whichscreen, _s2_whichscreen);
-  strncpy(cone_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  cone_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  cone_base->whichscreen = _s2_currscreentag;
+  cone_base->VRMLname = _s2_currVRMLidx;
 
   /* inside cone */
   cone_base++;
@@ -4643,9 +4821,8 @@ void s2arro(float ix1, float iy1, float iz1,
   cone_base->p2 = (cone_base-1)->p2;
   cone_base->r2 = (cone_base-1)->r2;
   cone_base->colour = _s2_colormap[_s2_colidx];
-  strcpy(cone_base->whichscreen, _s2_whichscreen);
-  strncpy(cone_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  cone_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  cone_base->whichscreen = _s2_currscreentag;
+  cone_base->VRMLname = _s2_currVRMLidx;
   return;
 }
 
@@ -4663,7 +4840,7 @@ void s2box(char *ixopt, float ixtick, int inxsub,
 	   char *iyopt, float iytick, int inysub,
 	   char *izopt, float iztick, int inzsub) {
 
-  if (strlen(_s2_whichscreen)) {
+  if (_s2_currscreentag) {
     _s2warn("s2box", "function does not support screen coordinates");
     return;
   }
@@ -5027,7 +5204,7 @@ void s2box(char *ixopt, float ixtick, int inxsub,
 
 /* draw x, y, z and plot titles */
 void s2lab(char *ixlab, char *iylab, char *izlab, char *ititle) {
-  if (strlen(_s2_whichscreen)) {
+  if (_s2_currscreentag) {
     _s2warn("s2lab", "function does not support screen coordinates");
     return;
   }
@@ -5623,39 +5800,36 @@ void ss2dt(unsigned int texid) {
 }
 /* fetch pointer to a texture */
 unsigned char *ss2gt(unsigned int itextureID, int *width, int *height) {
-  int i;
-  for (i = 0; i < _s2_ctext_count; i++) {
-    if (_s2_ctext[i].id == itextureID) {
-      if (width) {
-	*width = _s2_ctext[i].width;
-      }
-      if (height) {
-	*height = _s2_ctext[i].height;
-      }
-      return (unsigned char *)(_s2_ctext[i].bitmap);
-    }
+  int i = _s2priv_texIndex(itextureID);
+  if (i < 0) {
+    return NULL;
+  }
+  if (width) {
+    *width = _s2_ctext[i].width;
   }
-  return NULL;
+  if (height) {
+    *height = _s2_ctext[i].height;
+  }
+  /* textures loaded from texture files get their host copy now */
+  return (unsigned char *)_s2priv_texBitmap(i);
 }
 #if defined(S2_3D_TEXTURES)
 /* 3d texture version */
 unsigned char *ss2g3dt(unsigned int itextureID, int *width, int *height, int *depth) {
-  int i;
-  for (i = 0; i < _s2_ctext_count; i++) {
-    if (_s2_ctext[i].id == itextureID) {
-      if (width) {
-	*width = _s2_ctext[i].width;
-      }
-      if (height) {
-	*height = _s2_ctext[i].height;
-      }
-      if (depth) {
-	*depth = _s2_ctext[i].depth;
-      }
-      return (unsigned char *)(_s2_ctext[i].bitmap);
-    }
+  int i = _s2priv_texIndex(itextureID);
+  if (i < 0) {
+    return NULL;
+  }
+  if (width) {
+    *width = _s2_ctext[i].width;
+  }
+  if (height) {
+    *height = _s2_ctext[i].height;
   }
-  return NULL;
+  if (depth) {
+    *depth = _s2_ctext[i].depth;
+  }
+  return (unsigned char *)(_s2_ctext[i].bitmap);
 }
 #endif
 
@@ -5692,9 +5866,8 @@ void ns2vsphere(XYZ iP, float ir, COLOUR icol) {
   ball_base->p.z = _S2WORLD2DEVICE(iP.z, _S2ZAX);
   ball_base->r = _S2W3RADIUS(ir);
   ball_base->colour = icol;
-  strcpy(ball_base->whichscreen, _s2_whichscreen);
-  strncpy(ball_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  ball_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  ball_base->whichscreen = _s2_currscreentag;
+  ball_base->VRMLname = _s2_currVRMLidx;
   return;
 }
 
@@ -5721,7 +5894,7 @@ void ns2vspheret(XYZ iP, float ir, COLOUR icol, char *itexturefn) {
 void ns2vplanett(XYZ iP, float ir, COLOUR icol, char *itexturefn,
 		 float texture_phase, XYZ axis, float rotation) {
   
-  if ((ballt = (BALLT *)realloc(ballt, (nballt + 1)*sizeof(BALLT))) == NULL) {
+  if ((ballt = (BALLT *)_s2priv_arenaReserve(ballt, nballt, 1, sizeof(BALLT))) == NULL) {
     _s2error("ns2*spheret/ns2*planett", 
 	     "failed to allocate memory for textured ball");
   }
@@ -5730,25 +5903,12 @@ void ns2vplanett(XYZ iP, float ir, COLOUR icol, char *itexturefn,
   ballt[nballt].p.z = _S2WORLD2DEVICE(iP.z, _S2ZAX);
   ballt[nballt].r = _S2W3RADIUS(ir);
   ballt[nballt].colour = icol;
-  strcpy(ballt[nballt].whichscreen, _s2_whichscreen);
+  ballt[nballt].whichscreen = _s2_currscreentag;
   strcpy(ballt[nballt].texturename, itexturefn);
   
-  /* Check to see if the texture already exists */
-  int gotitalready = FALSE;
-  int i;
-  for (i=0;i<nballt;i++) {
-    if (strcmp(ballt[i].texturename,itexturefn) == 0) {
-      gotitalready = TRUE;
-      break;
-    }
-  }
-  if (gotitalready) {
-    ballt[nballt].rgba = NULL;
-    ballt[nballt].textureid = ballt[i].textureid;
-  } else {
-    ballt[nballt].rgba = NULL;
-    ballt[nballt].textureid = s2loadtexture(itexturefn);
-  }
+  /* share the texture with anything else using this file */
+  ballt[nballt].rgba = NULL;
+  ballt[nballt].textureid = _s2priv_texAcquire(itexturefn);
 
   ballt[nballt].texture_phase = texture_phase;
   ballt[nballt].axis.x = _S2WORLD2DEVICE_SO(axis.x, _S2XAX);
@@ -5786,7 +5946,7 @@ void ns2vplanetx(XYZ iP, float ir, COLOUR icol,
 		 unsigned int itextureid,
 		 float texture_phase, XYZ axis, float rotation) {
   
-  if ((ballt = (BALLT *)realloc(ballt, (nballt + 1)*sizeof(BALLT))) == NULL) {
+  if ((ballt = (BALLT *)_s2priv_arenaReserve(ballt, nballt, 1, sizeof(BALLT))) == NULL) {
     _s2error("ns2*spherex/ns2*planetx", 
 	     "failed to allocate memory for textured ball");
   }
@@ -5795,7 +5955,7 @@ void ns2vplanetx(XYZ iP, float ir, COLOUR icol,
   ballt[nballt].p.z = _S2WORLD2DEVICE(iP.z, _S2ZAX);
   ballt[nballt].r = _S2W3RADIUS(ir);
   ballt[nballt].colour = icol;
-  strcpy(ballt[nballt].whichscreen, _s2_whichscreen);
+  ballt[nballt].whichscreen = _s2_currscreentag;
   strcpy(ballt[nballt].texturename, "<cached>");
   
   ballt[nballt].rgba = NULL;
@@ -5841,7 +6001,7 @@ void ns2vdisk(XYZ iP, XYZ iN, float ir1, float ir2, COLOUR icol) {
   disk_base->n.x = iN.x;
   disk_base->n.y = iN.y;
   disk_base->n.z = iN.z;
-  strcpy(disk_base->whichscreen, _s2_whichscreen);
+  disk_base->whichscreen = _s2_currscreentag;
   return;
 }
 
@@ -5943,9 +6103,8 @@ void ns2vtext(XYZ iP, XYZ iR, XYZ iU, COLOUR icol, char *itext) {
   label_base[0].colour = icol;
   strncpy(label_base[0].s, itext, MAXLABELLEN);
   label_base[0].s[MAXLABELLEN-1] = '\0';
-  strcpy(label_base[0].whichscreen, _s2_whichscreen);
-  strncpy(label_base[0].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  label_base[0].VRMLname[MAXVRMLLEN-1] = '\0';
+  label_base[0].whichscreen = _s2_currscreentag;
+  label_base[0].VRMLname = _s2_currVRMLidx;
   return;
 }
 
@@ -5961,11 +6120,69 @@ void ns2vpoint(XYZ iP, COLOUR icol) {
 }
 void ns2vnpoint(XYZ *iP, COLOUR icol, int in) {
   int i;
+  if (in > 0) {
+    dot = (DOT *)_s2priv_arenaReserve(dot, ndot, in, sizeof(DOT));
+    if (!dot) {
+      ndot = 0;
+      _s2error("ns2vnpoint", "failed to allocate memory for dots");
+    }
+  }
   for (i = 0; i < in; i++) {
     ns2vpoint(iP[i], icol);
   }
   return;
 }
+void ns2vnpoints(int in, float *ix, float *iy, float *iz,
+		 float *ired, float *igreen, float *iblue, COLOUR icol,
+		 float *isize, float idefsize) {
+  if (in < 1 || !ix || !iy || !iz) {
+    return;
+  }
+  int percol = (ired && igreen && iblue);
+  float dmin[3], sc[3], amin[3];
+  _s2priv_w2dcoeffs(dmin, sc, amin);
+
+  /* reserve once for the whole batch; ndot is advanced by the number
+   * of points actually kept after clipping */
+  dot = (DOT *)_s2priv_arenaReserve(dot, ndot, in, sizeof(DOT));
+  if (!dot) {
+    ndot = 0;
+    _s2error("ns2vnpoints", "failed to allocate memory for dots");
+  }
+
+  DOT tmpl;
+  tmpl.whichscreen = _s2_currscreentag;
+  tmpl.VRMLname = _s2_currVRMLidx;
+
+  DOT *it = dot + ndot;
+  int i;
+  for (i = 0; i < in; i++) {
+    if (_s2_clipping && 
+	!(_S2MONOTONIC(_s2axismin[_S2XAX], ix[i], _s2axismax[_S2XAX]) &&
+	  _S2MONOTONIC(_s2axismin[_S2YAX], iy[i], _s2axismax[_S2YAX]) &&
+	  _S2MONOTONIC(_s2axismin[_S2ZAX], iz[i], _s2axismax[_S2ZAX]))) {
+      continue;
+    }
+    it->p.x = dmin[0] + sc[0] * (ix[i] - amin[0]);
+    it->p.y = dmin[1] + sc[1] * (iy[i] - amin[1]);
+    it->p.z = dmin[2] + sc[2] * (iz[i] - amin[2]);
+    if (percol) {
+      it->colour = icol;
+      it->colour.r = ired[i];
+      it->colour.g = igreen[i];
+      it->colour.b = iblue[i];
+    } else {
+      it->colour = icol;
+    }
+    it->size = isize ? isize[i] : idefsize;
+    it->whichscreen = tmpl.whichscreen;
+    it->VRMLname = tmpl.VRMLname;
+    it++;
+  }
+  ndot = it - dot;
+  _s2priv_listChanged();
+  return;
+}
 void ns2thpoint(float ix, float iy, float iz,
 		float ired, float igreen, float iblue,
 		float isize) {
@@ -5992,9 +6209,8 @@ void ns2vthpoint(XYZ iP, COLOUR icol, float isize) {
   dot_base->p.z = _S2WORLD2DEVICE(iP.z, _S2ZAX);
   dot_base->colour = icol;
   dot_base->size = isize;
-  strcpy(dot_base->whichscreen, _s2_whichscreen);
-  strncpy(dot_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  dot_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  dot_base->whichscreen = _s2_currscreentag;
+  dot_base->VRMLname = _s2_currVRMLidx;
   return;
 }
 
@@ -6013,7 +6229,7 @@ void ns2vpa(XYZ iP, COLOUR icol, float isize, char itrans, float ialpha) {
   trdot_base->size = isize;
   trdot_base->trans = itrans;
   trdot_base->alpha = ialpha;
-  strcpy(trdot_base->whichscreen, _s2_whichscreen);
+  trdot_base->whichscreen = _s2_currscreentag;
   return;
 }
 
@@ -6092,9 +6308,8 @@ void ns2vthline(XYZ iP1, XYZ iP2, COLOUR icol, float iwid) {
   line_base->colour[0] = icol;
   line_base->colour[1] = icol;
   line_base->width = iwid;
-  strcpy(line_base->whichscreen, _s2_whichscreen);
-  strncpy(line_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  line_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  line_base->whichscreen = _s2_currscreentag;
+  line_base->VRMLname = _s2_currVRMLidx;
   line_base->stipple_factor = 0;
   line_base->stipple_pattern = 0;
   line_base->alpha = 1.0;
@@ -6182,15 +6397,61 @@ void ns2vthcline(XYZ iP1, XYZ iP2, COLOUR icol1, COLOUR icol2,
   line_base->colour[0] = icol1;
   line_base->colour[1] = icol2;
   line_base->width = iwid;
-  strcpy(line_base->whichscreen, _s2_whichscreen);
-  strncpy(line_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  line_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  line_base->whichscreen = _s2_currscreentag;
+  line_base->VRMLname = _s2_currVRMLidx;
   line_base->stipple_factor = 0;
   line_base->stipple_pattern = 0;
   line_base->alpha = 1.0;
   return;
 }
 
+void ns2vnlines(int in, float *ix, float *iy, float *iz,
+		float *ired, float *igreen, float *iblue, COLOUR icol,
+		float iwid) {
+  if (in < 1 || !ix || !iy || !iz) {
+    return;
+  }
+  int percol = (ired && igreen && iblue);
+  float dmin[3], sc[3], amin[3];
+  _s2priv_w2dcoeffs(dmin, sc, amin);
+
+  line = (LINE *)_s2priv_arenaReserve(line, nline, in, sizeof(LINE));
+  if (!line) {
+    nline = 0;
+    _s2error("ns2vnlines", "failed to allocate memory for lines");
+  }
+
+  LINE tmpl;
+  tmpl.whichscreen = _s2_currscreentag;
+  tmpl.VRMLname = _s2_currVRMLidx;
+
+  LINE *it = line + nline;
+  int i, j, k;
+  for (i = 0; i < in; i++, it++) {
+    for (j = 0; j < 2; j++) {
+      k = 2 * i + j;
+      it->p[j].x = dmin[0] + sc[0] * (ix[k] - amin[0]);
+      it->p[j].y = dmin[1] + sc[1] * (iy[k] - amin[1]);
+      it->p[j].z = dmin[2] + sc[2] * (iz[k] - amin[2]);
+      it->colour[j] = icol;
+      if (percol) {
+	it->colour[j].r = ired[k];
+	it->colour[j].g = igreen[k];
+	it->colour[j].b = iblue[k];
+      }
+    }
+    it->width = iwid;
+    it->whichscreen = tmpl.whichscreen;
+    it->VRMLname = tmpl.VRMLname;
+    it->stipple_factor = 0;
+    it->stipple_pattern = 0;
+    it->alpha = 1.0;
+  }
+  nline += in;
+  _s2priv_listChanged();
+  return;
+}
+
 
 
 /* a 3-vertex facet with auto-normal and only one colour */
@@ -6244,10 +6505,79 @@ void ns2vf3nc(XYZ *iP, XYZ *iN, COLOUR *icol) {
     Normalise(&(face3_base->n[i]));
 
     face3_base->colour[i] = icol[i];
-    strcpy(face3_base->whichscreen, _s2_whichscreen);
-    strncpy(face3_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-    face3_base->VRMLname[MAXVRMLLEN-1] = '\0';
+    face3_base->whichscreen = _s2_currscreentag;
+    face3_base->VRMLname = _s2_currVRMLidx;
+  }
+  return;
+}
+
+/* many 3-vertex facets with auto-normals: 3 * in vertices are given in
+ * ix, iy, iz; per-vertex colours are used if ired, igreen and iblue are
+ * all given, otherwise every facet is drawn in icol */
+void _s2priv_vnf3(int in, float *ix, float *iy, float *iz, 
+		  float *ired, float *igreen, float *iblue, COLOUR icol) {
+  if (in < 1 || !ix || !iy || !iz) {
+    return;
   }
+  int percol = (ired && igreen && iblue);
+  float dmin[3], sc[3], amin[3];
+  _s2priv_w2dcoeffs(dmin, sc, amin);
+
+  face3 = (FACE3 *)_s2priv_arenaReserve(face3, nface3, in, sizeof(FACE3));
+  if (!face3) {
+    nface3 = 0;
+    _s2error("ns2vnf3*", "failed to allocate memory for facets");
+  }
+
+  FACE3 tmpl;
+  tmpl.whichscreen = _s2_currscreentag;
+  tmpl.VRMLname = _s2_currVRMLidx;
+
+  FACE3 *it = face3 + nface3;
+  XYZ wP[3], N;
+  int i, j, k;
+  for (i = 0; i < in; i++, it++) {
+    for (j = 0; j < 3; j++) {
+      k = 3 * i + j;
+      wP[j].x = ix[k];
+      wP[j].y = iy[k];
+      wP[j].z = iz[k];
+      it->p[j].x = dmin[0] + sc[0] * (ix[k] - amin[0]);
+      it->p[j].y = dmin[1] + sc[1] * (iy[k] - amin[1]);
+      it->p[j].z = dmin[2] + sc[2] * (iz[k] - amin[2]);
+      it->colour[j] = icol;
+      if (percol) {
+	it->colour[j].r = ired[k];
+	it->colour[j].g = igreen[k];
+	it->colour[j].b = iblue[k];
+      }
+    }
+    /* world normal, scaled to device units as per ns2vf3nc */
+    N = CalcNormal(wP[0], wP[1], wP[2]);
+    N.x *= sc[0];
+    N.y *= sc[1];
+    N.z *= sc[2];
+    Normalise(&N);
+    it->n[0] = it->n[1] = it->n[2] = N;
+    it->whichscreen = tmpl.whichscreen;
+    it->VRMLname = tmpl.VRMLname;
+  }
+  nface3 += in;
+  _s2priv_listChanged();
+  return;
+}
+void ns2vnf3(int in, float *ix, float *iy, float *iz, COLOUR icol) {
+  _s2priv_vnf3(in, ix, iy, iz, NULL, NULL, NULL, icol);
+  return;
+}
+void ns2vnf3c(int in, float *ix, float *iy, float *iz,
+	      float *ired, float *igreen, float *iblue) {
+#if defined(S2TRIPLEFLOAT)
+  COLOUR C = {1., 1., 1., 1.};
+#else
+  COLOUR C = {1., 1., 1.};
+#endif
+  _s2priv_vnf3(in, ix, iy, iz, ired, igreen, iblue, C);
   return;
 }
 
@@ -6301,9 +6631,8 @@ void ns2vf4nc(XYZ *iP, XYZ *iN, COLOUR *icol) {
     Normalise(&(face4_base->n[i]));
 
     face4_base->colour[i] = icol[i];
-    strcpy(face4_base->whichscreen, _s2_whichscreen);
-    strncpy(face4_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-    face4_base->VRMLname[MAXVRMLLEN-1] = '\0';
+    face4_base->whichscreen = _s2_currscreentag;
+    face4_base->VRMLname = _s2_currVRMLidx;
   }
   return;
 }
@@ -6326,25 +6655,13 @@ void ns2vf4t(XYZ *iP, COLOUR icol, char *itexturefn, float iscale,
   face4t_base->trans = itrans;
   face4t_base->scale = iscale;
   face4t_base->alpha = 1.0;
-  strcpy(face4t_base->whichscreen, _s2_whichscreen);
-  strncpy(face4t_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  face4t_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  face4t_base->whichscreen = _s2_currscreentag;
+  face4t_base->VRMLname = _s2_currVRMLidx;
   strcpy(face4t_base->texturename, itexturefn);
   
-  int gotitalready = FALSE;
-  for (i = 0; i < nface4t-1; i++) {
-    if (strcmp(face4t[i].texturename, itexturefn)) {
-      gotitalready = TRUE;
-      break;
-    }
-  }
-  if (gotitalready) {
-    face4t_base->rgba = NULL;
-    face4t_base->textureid = face4t[i].textureid;
-  } else {
-    face4t_base->rgba = NULL;
-    face4t_base->textureid = s2loadtexture(itexturefn);
-  }
+  /* share the texture with anything else using this file */
+  face4t_base->rgba = NULL;
+  face4t_base->textureid = _s2priv_texAcquire(itexturefn);
   return;
 }
 
@@ -6371,14 +6688,13 @@ void ns2vf4xt(XYZ *iP, COLOUR icol, unsigned int itextureid, float iscale,
   face4t_base->trans = itrans;
   face4t_base->scale = iscale;
   face4t_base->alpha = ialpha;
-  strcpy(face4t_base->whichscreen, _s2_whichscreen);
+  face4t_base->whichscreen = _s2_currscreentag;
   strcpy(face4t_base->texturename, "<cached>");
   
   face4t_base->rgba = NULL;
   face4t_base->textureid = itextureid;
-  strcpy(face4t_base->whichscreen, _s2_whichscreen);
-  strncpy(face4t_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  face4t_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  face4t_base->whichscreen = _s2_currscreentag;
+  face4t_base->VRMLname = _s2_currVRMLidx;
   return;
 }
 
@@ -6498,9 +6814,8 @@ void ns2texpoly3d(XYZ *iP, XYZ *iTC, float in,
   texpoly3d_base->texid = itexid;
   texpoly3d_base->trans = itrans;
   texpoly3d_base->alpha = ialpha;
-  strcpy(texpoly3d_base->whichscreen, _s2_whichscreen);
-  strncpy(texpoly3d_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  texpoly3d_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  texpoly3d_base->whichscreen = _s2_currscreentag;
+  texpoly3d_base->VRMLname = _s2_currVRMLidx;
   return;
 }
 #endif
@@ -6513,6 +6828,20 @@ int ns2texmesh(int inverts, XYZ *iverts,
 		unsigned int itexid,
 		char itrans,
 		float ialpha) {
+  COLOUR white = {1., 1., 1.};
+  return ns2texmeshc(inverts, iverts, innorms, inorms, invtcs, ivtcs,
+		     infacets, ifacets, ifacets_tcs, itexid, white,
+		     itrans, ialpha);
+}
+
+int ns2texmeshc(int inverts, XYZ *iverts,
+		int innorms, XYZ *inorms,
+		int invtcs, XYZ *ivtcs,
+		int infacets, int *ifacets, int *ifacets_tcs,
+		unsigned int itexid,
+		COLOUR icol,
+		char itrans,
+		float ialpha) {
   _S2TEXTUREDMESH *texmesh_base = _s2priv_addtexturedmesh(1);
   if (!texmesh_base) {
     _s2warn("ns2texmesh", "could not allocate memory for meshed texture");
@@ -6564,11 +6893,11 @@ int ns2texmesh(int inverts, XYZ *iverts,
   bcopy(ifacets_tcs, texmesh_base->facets_vtcs, 3 * infacets * sizeof(int));
   
   texmesh_base->texid = itexid;
+  texmesh_base->col = icol;
   texmesh_base->trans = itrans;
   texmesh_base->alpha = ialpha;
-  strcpy(texmesh_base->whichscreen, _s2_whichscreen);
-  strncpy(texmesh_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  texmesh_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  texmesh_base->whichscreen = _s2_currscreentag;
+  texmesh_base->VRMLname = _s2_currVRMLidx;
 
   return (texmesh_base - texmesh);
 }
@@ -6612,9 +6941,8 @@ void ns2texmesh_ref(int refmesh, int infacets, int *ifacets, int *ifacets_tcs,
   texmesh_base->texid = itexid;
   texmesh_base->trans = itrans;
   texmesh_base->alpha = ialpha;
-  strcpy(texmesh_base->whichscreen, _s2_whichscreen);
-  strncpy(texmesh_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  texmesh_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  texmesh_base->whichscreen = _s2_currscreentag;
+  texmesh_base->VRMLname = _s2_currVRMLidx;
   
   //fprintf(stderr, "uuuu\n");
 
@@ -6652,9 +6980,8 @@ void ns2vf3na(XYZ *iP, XYZ *iN, COLOUR icol, char itrans, float ialpha) {
     face3a_base->alpha[i] = ialpha;    
   }
   face3a_base->trans = itrans;
-  strcpy(face3a_base->whichscreen, _s2_whichscreen);
-  strncpy(face3a_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  face3a_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  face3a_base->whichscreen = _s2_currscreentag;
+  face3a_base->VRMLname = _s2_currVRMLidx;
   return;
 }
 
@@ -6677,9 +7004,8 @@ void ns2vf3nca(XYZ *iP, XYZ *iN, COLOUR *icol, char itrans, float *ialpha) {
     face3a_base->alpha[i] = ialpha[i];    
   }
   face3a_base->trans = itrans;
-  strcpy(face3a_base->whichscreen, _s2_whichscreen);
-  strncpy(face3a_base->VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  face3a_base->VRMLname[MAXVRMLLEN-1] = '\0';
+  face3a_base->whichscreen = _s2_currscreentag;
+  face3a_base->VRMLname = _s2_currVRMLidx;
   return;
 }
 
@@ -6743,8 +7069,12 @@ int ns2cisc(float ***grid,
 
   it->grptr = grid;
   it->ntri = 0;
-  it->trivert = NULL;
+  it->tris = NULL;
+  it->nvert = 0;
+  it->verts = NULL;
   it->normals = NULL;
+  it->nbx = it->nby = it->nbz = 0;
+  it->bmin = it->bmax = it->rmin = it->rmax = NULL;
   it->col = NULL;
 
   _s2_nisosurf++;
@@ -6759,11 +7089,26 @@ void ns2dis(int isid, int force) {
     return;
   }
   
-  // 1. regenerate surface (if nec.) 
+  // 1. regenerate surface (if nec.), at a coarser resolution while
+  // the frame-time governor asks for it; the block tree (ns2sist) is
+  // only valid at the resolution it was built for
+  _S2ISOSURFACE *it = _s2_isosurfs + isid;
+  int res = it->descr.resolution;
+  if (!it->nbx) {
+    it->descr.resolution = _s2priv_govern(_S2GOV_ISORES, res);
+  }
+  double tprof = 0.;
+  if (force || memcmp(&(it->descr), &(it->cached_descr),
+		      sizeof(_S2TRIANGLE_CACHE_DESCR))) {
+    tprof = _s2priv_profStart();
+  }
   _s2priv_generate_isosurface(isid, force);
+  _s2priv_profStop(_S2PROF_ISOSURF, tprof, it->ntri,
+		   it->ntri * (3 * sizeof(int) + sizeof(COLOUR)) +
+		   it->nvert * sizeof(XYZ));
+  it->descr.resolution = res;
 
   // 2. draw the surface
-  _S2ISOSURFACE *it = _s2_isosurfs + isid;
   _s2priv_drawTriangleCache(it);
 }
 
@@ -6776,6 +7121,19 @@ void ns2sisl(int isid, float level) {
   _S2ISOSURFACE *it = _s2_isosurfs + isid;
   it->descr.level = level;
 }
+/* use (or rebuild) or drop the min/max block tree of an isosurface */
+void ns2sist(int isid, int use) {
+  if (isid >= _s2_nisosurf) {
+    _s2warn("ns2sist", "invalid isosurface object (isid)");
+    return;
+  }
+  _S2ISOSURFACE *it = _s2_isosurfs + isid;
+  if (use) {
+    _s2priv_buildIsosurfaceTree(it);
+  } else {
+    _s2priv_freeIsosurfaceTree(it);
+  }
+}
 /* change isosurface alpha  & transparency */
 void ns2sisa(int isid, float alpha, char trans) {
   if (isid >= _s2_nisosurf) {
@@ -6996,8 +7354,6 @@ int CamChange(CAMERA c1, CAMERA c2) {
   return 0;
 }
 
-//#define PROGRESSIVERENDER 1
-#define MAXSTEPS 3
 /* draw vol ren "object" */
 void ds2dvr(int vrid, int force) {
   if (!_s2_dynamicEnabled) {
@@ -7008,45 +7364,15 @@ void ds2dvr(int vrid, int force) {
     _s2warn("ds2dvr", "invalid volume rendering object (vrid)");
     return;
   }
-#if defined(PROGRESSIVERENDER)
-#define SLICE_TRANS 0.4
-#else
-#define SLICE_TRANS 0.9
-#endif
-  float strans = SLICE_TRANS;
-
-  int sstep = 1; // slice step (1 = skip no slices)
-
-#if defined(PROGRESSIVERENDER)
-  static int beenhere = 0;
-  static int slicestep;
-  static int stillframes;
-  static CAMERA previous_camera;
-  if (!beenhere || force) {
-    // first time, or forced redraw: reset
-    slicestep = 1 << (MAXSTEPS-1);
-    previous_camera = camera;
-    beenhere = 1;
-    stillframes = 0;
-  } else if (CamChange(previous_camera, camera)) {
-    // camera has moved: increase step
-    slicestep *= 2;
-    slicestep = slicestep > (1 << (MAXSTEPS-1)) ? (1 << (MAXSTEPS-1)) : slicestep;
-    stillframes = 0;
-  } else {
-    stillframes++;
-    if (stillframes > 10) {
-      // camera has not moved: decrease step
-      slicestep /= 2;
-      slicestep = slicestep < 1 ? 1 : slicestep;
-      stillframes = 0;
-    }
-  }
-  sstep = slicestep;
-  strans = SLICE_TRANS + (float)(sstep-1) / (float)(1 << (MAXSTEPS-1)) * (1. - SLICE_TRANS);
+  float strans = 0.9;
 
-  previous_camera = camera;
-#endif
+  /* slice step (1 = skip no slices): the frame-time governor skips
+   * slices while the view moves, and the ones drawn are made more
+   * opaque to keep about the same total opacity */
+  int sstep = _s2priv_govern(_S2GOV_SLICES, 1);
+  if (sstep > 1) {
+    strans = (strans * sstep > 1.) ? 1. : strans * sstep;
+  }
 
   // 1. load textures (if nec.) (0 means auto-select axis)
   _s2priv_load_vr_textures(vrid, force, 0);
@@ -7074,19 +7400,6 @@ void ds2dvr(int vrid, int force) {
   case 1:
     _s2debug("ds2dvr", "drawing textures for X-view");
 
-#if defined(PROGRESSIVERENDER)
-    // solve strans for 't' mode:
-    float q_N = it->a2 - it->a1 + 1;
-    float q_a = ((q_N / (float)sstep) - 1.0) * 0.5;
-    float q_b = -1.0;
-    float q_c = SLICE_TRANS * (1. - (q_N - 1.0) * 0.5 * SLICE_TRANS);
-    float q_sqred = q_b * q_b - 4. * q_a * q_c;
-    if (q_sqred > 0.0) {
-      strans = (-1.0 * q_b + sqrt(q_sqred)) / (2. * q_a);
-      //fprintf(stderr, "strans modified to %f\n", strans);
-    }
-#endif
-
 
 
     for (pl2 = 0; pl2 < (it->a2 - it->a1 + 1); pl2 += sstep) {
@@ -7151,19 +7464,6 @@ void ds2dvr(int vrid, int force) {
   case 2:
     _s2debug("ds2dvr", "drawing textures for Y-view");
 
-#if defined(PROGRESSIVERENDER)
-    // solve strans for 't' mode:
-    float q_N = it->b2 - it->b1 + 1;
-    float q_a = ((q_N / (float)sstep) - 1.0) * 0.5;
-    float q_b = -1.0;
-    float q_c = SLICE_TRANS * (1. - (q_N - 1.0) * 0.5 * SLICE_TRANS);
-    float q_sqred = q_b * q_b - 4. * q_a * q_c;
-    if (q_sqred > 0.0) {
-      strans = (-1.0 * q_b + sqrt(q_sqred)) / (2. * q_a);
-      //fprintf(stderr, "strans modified to %f\n", strans);
-    }
-#endif
-
     for (pl2 = 0; pl2 < (it->b2 - it->b1 + 1); pl2 += sstep) {
       if (it->reverse) {
 	plt = it->b2 - pl2;
@@ -7226,19 +7526,6 @@ void ds2dvr(int vrid, int force) {
   case 3:
     _s2debug("ds2dvr", "drawing textures for Z-view");
 
-#if defined(PROGRESSIVERENDER)
-    // solve strans for 't' mode:
-    float q_N = it->c2 - it->c1 + 1;
-    float q_a = ((q_N / (float)sstep) - 1.0) * 0.5;
-    float q_b = -1.0;
-    float q_c = SLICE_TRANS * (1. - (q_N - 1.0) * 0.5 * SLICE_TRANS);
-    float q_sqred = q_b * q_b - 4. * q_a * q_c;
-    if (q_sqred > 0.0) {
-      strans = (-1.0 * q_b + sqrt(q_sqred)) / (2. * q_a);
-      //fprintf(stderr, "strans modified to %f\n", strans);
-    }
-#endif
-
     for (pl2 = 0; pl2 < (it->c2 - it->c1 + 1); pl2 += sstep) {
       if (it->reverse) {
 	plt = it->c2 - pl2;
@@ -7338,6 +7625,13 @@ void ds2dvrx(int vrid, int force_reload, int axis, int force_draw) {
     //float pl;
     XYZ p[4];
     COLOUR col = {1., 1., 1.};
+
+    /* fewer, more opaque slices while the frame-time governor asks */
+    float strans = 0.6;
+    int sstep = _s2priv_govern(_S2GOV_SLICES, 1);
+    if (sstep > 1) {
+      strans = (strans * sstep > 1.) ? 1. : strans * sstep;
+    }
     
     int idx;
     float ic_a, ic_b, ic_c;
@@ -7350,7 +7644,7 @@ void ds2dvrx(int vrid, int force_reload, int axis, int force_draw) {
     case 1:
       _s2debug("ds2dvrx", "drawing textures for X-view, reverse=%d", it->reverse);
       
-      for (pl2 = 0; pl2 < (it->a2 - it->a1 + 1); pl2++) {
+      for (pl2 = 0; pl2 < (it->a2 - it->a1 + 1); pl2 += sstep) {
 	if (it->reverse) {
 	  plt = it->a2 - pl2;
 	  //pl = it->a2 - 0.5 - 
@@ -7405,14 +7699,14 @@ void ds2dvrx(int vrid, int force_reload, int axis, int force_draw) {
 	p[idx].z = it->tr[8] + it->tr[9] * ic_a + it->tr[10] * ic_b +
 	  it->tr[11] * ic_c;
 	
-	ns2vf4xt(p, col, it->textureids[plt - it->a1], 1., it->trans, 0.6);
+	ns2vf4xt(p, col, it->textureids[plt - it->a1], 1., it->trans, strans);
       }
       break;
       
     case 2:
       _s2debug("ds2dvrx", "drawing textures for Y-view, reverse=%d", it->reverse);
       
-      for (pl2 = 0; pl2 < (it->b2 - it->b1 + 1); pl2++) {
+      for (pl2 = 0; pl2 < (it->b2 - it->b1 + 1); pl2 += sstep) {
 	if (it->reverse) {
 	  plt = it->b2 - pl2;
 	  //pl = it->b2 - 0.5 - 
@@ -7467,7 +7761,7 @@ void ds2dvrx(int vrid, int force_reload, int axis, int force_draw) {
 	p[idx].z = it->tr[8] + it->tr[9] * ic_a + it->tr[10] * ic_b +
 	  it->tr[11] * ic_c;
 	
-	ns2vf4xt(p, col, it->textureids[plt - it->b1], 1., it->trans, 0.6);
+	ns2vf4xt(p, col, it->textureids[plt - it->b1], 1., it->trans, strans);
       }
       break;
       
@@ -7475,7 +7769,7 @@ void ds2dvrx(int vrid, int force_reload, int axis, int force_draw) {
       _s2debug("ds2dvrx", "drawing textures for Z-view, reverse=%d", it->reverse);
 
       
-      for (pl2 = 0; pl2 < (it->c2 - it->c1 + 1); pl2++) {
+      for (pl2 = 0; pl2 < (it->c2 - it->c1 + 1); pl2 += sstep) {
 	if (it->reverse) {
 	  plt = it->c2 - pl2;
 	  //pl = it->c2 - 0.5 - 
@@ -7530,7 +7824,7 @@ void ds2dvrx(int vrid, int force_reload, int axis, int force_draw) {
 	p[idx].z = it->tr[8] + it->tr[9] * ic_a + it->tr[10] * ic_b +
 	  it->tr[11] * ic_c;
 	
-	ns2vf4xt(p, col, it->textureids[plt - it->c1], 1., it->trans, 0.6);
+	ns2vf4xt(p, col, it->textureids[plt - it->c1], 1., it->trans, strans);
       }
       break;
       
@@ -7573,9 +7867,8 @@ void ds2ahx(XYZ iP, float size, int itex, int ihitex,
 		    powf(_S2WORLD2DEVICE_SO(size, _S2ZAX),2.)));
   handle_base[0].texid = itex;
   handle_base[0].hitexid = ihitex;
-  strcpy(handle_base[0].whichscreen, _s2_whichscreen);
-  strncpy(handle_base[0].VRMLname, _s2_VRMLnames[_s2_currVRMLidx], MAXVRMLLEN);
-  handle_base[0].VRMLname[MAXVRMLLEN-1] = '\0';
+  handle_base[0].whichscreen = _s2_currscreentag;
+  handle_base[0].VRMLname = _s2_currVRMLidx;
   return;
 }
 
@@ -7621,6 +7914,78 @@ int ss2qrm() {
   return options.rendermode;
 }
 
+/* toggle billboard expansion in a vertex shader */
+void ss2tbbx(int enabledisable) {
+  _s2_bbshader = enabledisable ? 1 : 0;
+}
+int ss2qbbx(void) {
+  return _s2_bbshader;
+}
+
+/* toggle reduced detail for static dot clouds while the view moves */
+void ss2tlod(int enabledisable) {
+  int i;
+  _s2_lodpoints = enabledisable ? 1 : 0;
+  /* the detail levels are built when static geometry is packed */
+  for (i = 0; i < _s2_npanels; i++) {
+    _s2_panels[i].GL_static.dirty = 1;
+  }
+}
+int ss2qlod(void) {
+  return _s2_lodpoints;
+}
+
+/* set/query the frame-time budget while the view moves */
+void ss2sfb(float budget) {
+  _s2_governor.budget = (budget > 0.) ? budget : 0.;
+  if (_s2_governor.budget <= 0.) {
+    _s2_governor.level = 0;
+  }
+}
+float ss2qfb(void) {
+  return _s2_governor.budget;
+}
+
+/* toggle/query the frame profile */
+void ss2tprof(int enabledisable) {
+  if (enabledisable && !_s2_profile.on) {
+    /* start afresh */
+    _s2_profile.nframe = 0;
+  }
+  _s2_profile.on = enabledisable ? 1 : 0;
+}
+int ss2qprof(void) {
+  return _s2_profile.on;
+}
+
+/* query a stage of a recent frame in the profile */
+float ss2qprs(char *stage, int ago, int *count, int *bytes) {
+  int st = _s2priv_profStage(stage);
+  if (st < 0) {
+    _s2warn("ss2qprs", "unknown profile stage \"%s\"", stage ? stage : "");
+    return -1.;
+  }
+  _S2PROFSAMPLE *s = _s2priv_profSample(st, ago);
+  if (!s) {
+    return -1.;
+  }
+  if (count) {
+    *count = s->count;
+  }
+  if (bytes) {
+    *bytes = s->bytes;
+  }
+  return s->t;
+}
+int ss2qprn(void) {
+  return _s2priv_profFrames();
+}
+
+/* write the frame profile */
+void ss2wprof(char *filename) {
+  _s2priv_profWrite(filename);
+}
+
 /* set the entire lighting environment */
 void ss2sl(COLOUR ambient, int nlights, XYZ *lightpos,
 	   COLOUR *lightcol, int worldcoords) {
@@ -7999,6 +8364,16 @@ int xs2ap(float x1, float y1, float x2, float y2) {
   it->promptcb_data = NULL;
 
   it->GL_listindex = -1;
+  memset(&(it->GL_static), 0, sizeof(_S2BATCHLIST));
+  it->GL_static.nvbo = 1;
+  it->GL_static.dirty = 1;
+  memset(&(it->GL_dynamic), 0, sizeof(_S2BATCHLIST));
+  it->GL_dynamic.nvbo = _S2BATCHRING;
+  it->GL_dynamic.dirty = 1;
+  memset(&(it->lodcamera), 0, sizeof(CAMERA));
+  memset(&(it->lodtrans), 0, sizeof(XYZ));
+  memset(it->lodrot, 0, 16 * sizeof(double));
+  it->lodmoving = 0;
 
   /* "current" geometry */
   it->nball = 0; it->ball = NULL;
@@ -8103,6 +8478,7 @@ void xs2mp(int panelid, float x1, float y1, float x2, float y2) {
 void ss2tsc(char *whichscreen) {
   //strncpy(_s2_whichscreen, whichscreen, 9);
   strcpy(_s2_whichscreen, whichscreen);
+  _s2_currscreentag = _s2priv_screenTag(_s2_whichscreen);
   if (strlen(_s2_whichscreen)) {
     _s2_startScreenGeometry(FALSE);
   } else {
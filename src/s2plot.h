@@ -708,6 +708,15 @@ void ns2dis(int isid, int force);
 /* change an isosurface level */
 void ns2sisl(int isid, float level);
 
+/* Use (use = 1) or stop using (use = 0) a min/max block tree for an
+ * isosurface.  The tree records the range of the grid values in small
+ * blocks of the grid, so that when the level is changed with ns2sisl
+ * only the blocks that can contain the new level are searched.  The
+ * tree is built from the grid when this function is called: if the
+ * grid is subsequently changed in place, call ns2sist(isid, 1) again
+ * to rebuild it, and then ns2dis(isid, 1) to redraw the surface. */
+void ns2sist(int isid, int use);
+
 /* set isosurface alpha and transparency */
 void ns2sisa(int isid, float alpha, char trans);
 
@@ -892,6 +901,16 @@ void ns2point(float x, float y, float z,
 void ns2vpoint(XYZ P, COLOUR col);
 /* Draw multiple points in one colour */
 void ns2vnpoint(XYZ *P, COLOUR col, int n);
+/* Draw n points whose coordinates are given in separate arrays x, y
+ * and z.  If red, green and blue are all non-NULL they give the colour
+ * of each point, otherwise every point is drawn in col.  If size is
+ * non-NULL it gives the size of each point in pixels, otherwise
+ * defsize is used.  Space is reserved once for the whole batch, so
+ * this is much faster than calling ns2vthpoint n times.
+ */
+void ns2vnpoints(int n, float *x, float *y, float *z,
+		 float *red, float *green, float *blue, COLOUR col,
+		 float *size, float defsize);
 
 /* Draw a thick point at given position, in colour and thickness in
  * pixels (not world coords).
@@ -948,6 +967,14 @@ void ns2thcline(float x1, float y1, float z1,
 		float red2, float green2, float blue2, 
 		float width);
 void ns2vthcline(XYZ P1, XYZ P2, COLOUR col1, COLOUR col2, float width);
+/* Draw n line segments of the given width.  The 2*n end points are
+ * given in the arrays x, y and z, with segment i running from vertex
+ * 2*i to vertex 2*i+1.  If red, green and blue are all non-NULL they
+ * give the colour at each vertex, otherwise all segments are drawn in
+ * col. */
+void ns2vnlines(int n, float *x, float *y, float *z,
+		float *red, float *green, float *blue, COLOUR col,
+		float width);
 
 
 /* 3-vertex facets of various specifications.
@@ -971,6 +998,14 @@ void ns2vf3nc(XYZ *P, XYZ *N, COLOUR *col);
 void ns2vf3na(XYZ *P, XYZ *N, COLOUR col, char trans, float alpha);
 /* and completely general + alpha per vertex */
 void ns2vf3nca(XYZ *P, XYZ *N, COLOUR *col, char trans, float *alf);
+/* Many 3-vertex facets at once, with auto-normals.  The 3*n vertices
+ * are given in the arrays x, y and z, with facet i using vertices 3*i,
+ * 3*i+1 and 3*i+2.
+ * 1. single colour */
+void ns2vnf3(int n, float *x, float *y, float *z, COLOUR col);
+/* 2. coloured vertices, given in the arrays red, green and blue */
+void ns2vnf3c(int n, float *x, float *y, float *z,
+	      float *red, float *green, float *blue);
 
 
 /* 4-vertex facets of various specifications.  The vertices need not
@@ -1237,7 +1272,13 @@ void ss2qsd(int *x, int *y);
  ***********************************************************************
  */
 
-/* Load a texture for future (generally repeated) use */
+/* Load a texture for future (generally repeated) use.  The file is
+ * a TGA image, or an S2PLOT texture file (name ending ".s2t", made
+ * with scripts/texpack.csh) holding ready-made mipmaps and optionally
+ * compressed pixels, which is uploaded straight from the file; no
+ * copy of its pixels is kept in memory until one is asked for with
+ * ss2gt.
+ */
 unsigned int ss2lt(char *itexturefn);
 
 /* get a pointer to an identified texture.  The return value of
@@ -1270,6 +1311,15 @@ void ss2pt(unsigned int itextureID);
  */
 void ss2ptt(unsigned int itextureID);
 
+/* reinstall part of a texture after modifying it: only columns x0 to
+ * x1 and rows y0 to y1 (inclusive, counting from 0) of the map
+ * returned by ss2gt are sent to the graphics card, which is much
+ * faster than ss2pt or ss2ptt when only a little of the texture has
+ * changed.  Multiresolution versions are rebuilt if the texture was
+ * created or last reinstalled with them (ie. not by ss2ctt or ss2ptt).
+ */
+void ss2ptr(unsigned int itextureID, int x0, int x1, int y0, int y1);
+
 /* load a colourmap into mem, starting at index startidx, read maximum
  * of maxn colours.  Return num read and stored.  Map file format is
  * per line:
@@ -1290,15 +1340,56 @@ int ss2lcm(char *imapfile, int startidx, int maxn);
  */
 unsigned int ss2ltt(char *latexcmd, float *aspect);
 
+/* load a texture from file (as per ss2lt), or create one with LaTeX
+ * commands (as per ss2ltt), in the background.  The texture handle is
+ * returned immediately and can be used at once: it shows a plain grey
+ * image until the file has been read, after which the texture is
+ * replaced between frames.  Use ss2qtl to find out when it is ready.
+ */
+unsigned int ss2lta(char *itexturefn);
+unsigned int ss2ltta(char *latexcmd);
+
+/* query whether a texture is ready: returns 1 if so, 0 if it is still
+ * being loaded in the background, or -1 if there is no such texture.
+ * When ready, the x:y aspect ratio of the image is returned in
+ * "aspect" (if not NULL).
+ */
+int ss2qtl(unsigned int texid, float *aspect);
+
+/* set the time, in milliseconds, spent installing background-loaded
+ * textures each frame (default 4).  At least one texture is installed
+ * per frame; 0 installs all that are ready.
+ */
+void ss2stlb(float ms);
+
 #if defined(S2FREETYPE)
 /* create a texture using the freetype font engine */
 unsigned int ss2ftt(char *fontfilename, char *text, int fontsizepx,
 		    int border);
+
+/* draw text using the freetype font engine.  Glyphs are drawn as
+ * textured facets taken from a texture of glyphs kept for each font
+ * file and size, so drawing many strings - or the same strings each
+ * frame - costs no new textures.  The baseline starts at P; right
+ * and up are the world-coordinate vectors spanning one em (fontsizepx
+ * pixels) along and up from the baseline.  trans and alpha are as
+ * for ns2vf4xt.
+ */
+void ns2ftstr(char *fontfilename, int fontsizepx, char *text,
+	      XYZ P, XYZ right, XYZ up, COLOUR col, char trans, float alpha);
 #endif
 
 /* delete a texture */
 void ss2dt(unsigned int texid);
 
+/* query texture memory: returns the number of bytes of bitmap data
+ * held for all textures currently loaded, and the number of textures
+ * in ntex (if not NULL).  Textures named by file in eg. ns2vspheret
+ * and ns2vf4t are loaded once per file and shared, and are freed when
+ * the last geometry using them is deleted.
+ */
+long ss2qtm(int *ntex);
+
 /***********************************************************************
  *
  * ENVIRONMENT / RENDERING ATTRIBUTES
@@ -1321,6 +1412,77 @@ int ss2qsr(void);
 void ss2srm(int mode);
 int ss2qrm();
 
+/* Enable/disable/query expansion of billboards (ds2vbb, ds2vbbr,
+ * ds2vbbp etc.) to quads in a vertex shader, rather than on the CPU.
+ * This makes large numbers of billboards much cheaper to draw.  It
+ * needs OpenGL 2.0; without it billboards are expanded on the CPU as
+ * usual.  Disabled by default.
+ */
+void ss2tbbx(int enabledisable);
+int ss2qbbx(void);
+
+/* Enable/disable/query reduced detail for large static dot clouds
+ * (s2pt, ns2vpoint, ns2vthpoint etc.).  When enabled, representative
+ * points (averaged in position and colour) are built for the static
+ * dots, and while the camera is moving distant parts of the cloud
+ * are drawn with about one point per pixel.  Full detail is drawn
+ * once the camera stops.  Disabled by default.
+ */
+void ss2tlod(int enabledisable);
+int ss2qlod(void);
+
+/* Set/query the frame-time budget, in seconds, for interactive
+ * rendering.  While the camera is moving and frames take longer than
+ * this, cost is reduced step by step: volume renderings skip slices,
+ * spheres and isosurfaces are drawn at lower resolution, and dot
+ * clouds with reduced detail enabled (ss2tlod) are drawn coarser.
+ * Full quality is restored once the camera stops.  The decisions and
+ * the time spent in each stage of the frame are reported in debug
+ * output (zs2debug).  A budget of 0 (the default) turns this off.
+ */
+void ss2sfb(float budget);
+float ss2qfb(void);
+
+/* Enable/disable/query the frame profile.  While enabled, the time
+ * spent in each stage of drawing a frame is recorded for the last 256
+ * frames, along with a count of calls or primitives and of bytes
+ * built, for these stages:
+ *   callback   - the animation callback
+ *   dynamic    - clearing dynamic geometry for the callback
+ *   pack       - packing dots, lines, facets and labels for drawing
+ *   ball, disk, cone, batch (dots, lines, facets and labels), ballt,
+ *   face4t, texmesh, bboard, bbset - drawing each kind of geometry
+ *   trans      - packing and sorting transparent facets and dots
+ *   bbsort     - sorting billboards
+ *   vrtexture  - rebuilding volume rendering textures
+ *   isosurface - regenerating isosurfaces
+ *   swap       - the buffer swap
+ *   capture    - reading back recorded frames (see ss2scap)
+ *   draw       - all drawing, including the stages within it
+ * Stages may run more than once per frame (eg. once per eye, panel
+ * and screen), and are summed.  Setting the environment variable
+ * S2PLOT_PROFILE to a file name enables the profile at startup; it is
+ * written to that file when the program exits and when 'T' is
+ * pressed.  Disabled by default.
+ */
+void ss2tprof(int enabledisable);
+int ss2qprof(void);
+
+/* Query the profile: the time in seconds spent in the named stage
+ * during the frame ago frames before the last complete one (0 = the
+ * last complete frame), with its count of calls or primitives and of
+ * bytes (either may be NULL).  Returns -1 if there is no such stage
+ * or frame.  ss2qprn returns the number of complete frames held.
+ */
+float ss2qprs(char *stage, int ago, int *count, int *bytes);
+int ss2qprn(void);
+
+/* Write the complete frames of the profile, oldest first, to the
+ * named file: as JSON if the name ends in ".json", otherwise as CSV
+ * with one line per stage per frame.
+ */
+void ss2wprof(char *filename);
+
 /* Set the entire lighting environment.  You can place a total of 8 lights
  * in the environment, at given positions and colours.  Set the ambient
  * light colour as you like, but if this is set to white light (1,1,1)
@@ -1476,6 +1638,24 @@ void ss2sess(float ieyesep);
  * is added for you. */
 void ss2wtga(char *fname);
 
+/* Set the format of frames recorded while the program runs (F6
+ * records one frame, F7 toggles continuous recording, and the
+ * /S2OFFSCR device records every frame): "tga" (run-length
+ * encoded, the default), "ppm" or "png"; or "|command" to write the
+ * frames, as raw RGBA bytes with the bottom row first, to the
+ * standard input of command, eg.
+ *   "|ffmpeg -f rawvideo -pix_fmt rgba -s 800x600 -i - -vf vflip x.mp4"
+ * On /S2OFFSCR files are numbered from 0000 at the start of the
+ * program; F6 and F7 frames share the number of the geometry and
+ * view files saved with them.  For active stereo each frame is
+ * written as L_ and R_ files.  Frames are
+ * read back without stalling the display and are encoded on separate
+ * threads, so they may be written a little after they are drawn; all
+ * are written by the time the program exits.  The environment 
+ * variable S2PLOT_CAPTURE sets the format at startup.
+ */
+void ss2scap(char *format);
+
 /* Fetch the current frame image to an RGB buffer.  The buffer is of
  * length height * width * 3 bytes, with each pixel a R,G,B triplet.
  * Pixels are returned in row order from the lowest to the highest
@@ -1608,6 +1788,11 @@ void pushVRMLname(char *iname);
 
   /* fetch pointer to 3d texture */
   unsigned char *ss2g3dt(unsigned int itextureID, int *width, int *height, int *depth);
+
+  /* reinstall part of a 3d texture, as per ss2ptr: slabs z0 to z1 of
+   * the region are sent */
+  void ss2p3dtr(unsigned int itextureID, int x0, int x1, int y0, int y1,
+		int z0, int z1);
 #endif
 
   int ns2texmesh(int inverts, XYZ *iverts,
@@ -1617,6 +1802,15 @@ void pushVRMLname(char *iname);
 		  unsigned int itexid,
 		  char itrans,
 		  float ialpha);
+  /* as ns2texmesh, with the texture modulated by colour icol */
+  int ns2texmeshc(int inverts, XYZ *iverts,
+		  int innorms, XYZ *inorms,
+		  int invtcs, XYZ *ivtcs,
+		  int infacets, int *ifacets, int *ifacets_tcs,
+		  unsigned int itexid,
+		  COLOUR icol,
+		  char itrans,
+		  float ialpha);
   void ns2texmesh_ref(int refmesh, int infacets, int *ifacets, int *ifacets_tcs,
 		      unsigned int texid,
 		      char itrans,
@@ -599,6 +599,9 @@ void ns2dis_(int *isid, int *force) {
 void ns2sisl_(int *isid, float *level) {
   ns2sisl(*isid, *level);
 }
+void ns2sist_(int *isid, int *use) {
+  ns2sist(*isid, *use);
+}
 void ns2sisa_(int *isid, float *alpha, char *trans) {/*NEW*/
   ns2sisa(*isid, *alpha, *trans); /*Not sure if this is correct */
 }
@@ -796,6 +799,11 @@ void ns2vpoint_(XYZ *P, COLOUR *col) {
 void ns2vnpoint_(XYZ *P, COLOUR *col, int *n) {
   ns2VNpoint(P, *col, *n);
 }
+void ns2vnpoints_(int *n, float *x, float *y, float *z,
+		  float *red, float *green, float *blue, COLOUR *col,
+		  float *size, float *defsize) {
+  ns2vnpoints(*n, x, y, z, red, green, blue, *col, size, *defsize);
+}
 
 void ns2thpoint_(float *x, float *y, float *z,
 		float *red, float *green, float *blue, float *size) {
@@ -867,6 +875,11 @@ void ns2thcline_(float *x1, float *y1, float *z1,
 void ns2vthcline_(XYZ *P1, XYZ *P2, COLOUR *col1, COLOUR *col2, float *width) {
   ns2vthcline(*P1, *P2, *col1, *col2, *width);
 }
+void ns2vnlines_(int *n, float *x, float *y, float *z,
+		 float *red, float *green, float *blue, COLOUR *col,
+		 float *width) {
+  ns2vnlines(*n, x, y, z, red, green, blue, *col, *width);
+}
 
 void ns2vf3_(XYZ *P, COLOUR *col) {
   ns2vf3(P, *col);
@@ -890,6 +903,13 @@ void ns2vf3na_(XYZ *P, XYZ *N, COLOUR *col, char *trans, float *alpha) {
 void ns2vf3nca_(XYZ *P, XYZ *N, COLOUR *col, char *trans, float *alpha) {
   ns2vf3nca(P, N, col, *trans, alpha);
 }
+void ns2vnf3_(int *n, float *x, float *y, float *z, COLOUR *col) {
+  ns2vnf3(*n, x, y, z, *col);
+}
+void ns2vnf3c_(int *n, float *x, float *y, float *z,
+	       float *red, float *green, float *blue) {
+  ns2vnf3c(*n, x, y, z, red, green, blue);
+}
 
 void ns2vf4_(XYZ *P, COLOUR *col) {
   ns2vf4(P, *col);
@@ -1174,6 +1194,10 @@ void ss2ptt_(unsigned int *iid) {
   _s2warn("ss2ptt", "function not available from FORTRAN");
   return;
 }
+void ss2ptr_(unsigned int *iid, int *x0, int *x1, int *y0, int *y1) {
+  _s2warn("ss2ptr", "function not available from FORTRAN");
+  return;
+}
 
 int ss2lcm_(char *imapfile, int *startidx, int *maxn,
 	       long int textlen) {
@@ -1197,6 +1221,28 @@ unsigned int ss2ltt_(char *cmd, float *aspect, long int textlen) {
   return result;
 }
 
+unsigned int ss2lta_(char *itexturefn, long int textlen) {
+  char *ttex = _s2_f2cstr(itexturefn, textlen);
+  unsigned int result = ss2lta(ttex);
+  free(ttex);
+  return result;
+}
+
+unsigned int ss2ltta_(char *cmd, long int textlen) {
+  char *ttex = _s2_f2cstr(cmd, textlen);
+  unsigned int result = ss2ltta(ttex);
+  free(ttex);
+  return result;
+}
+
+int ss2qtl_(unsigned int *texid, float *aspect) {
+  return ss2qtl(*texid, aspect);
+}
+
+void ss2stlb_(float *ms) {
+  ss2stlb(*ms);
+}
+
 #if defined(S2FREETYPE)
 /* create a texture using the freetype font engine */
 unsigned int ss2ftt_(char *fontfilename, char *text, int *fontsizepx,
@@ -1207,6 +1253,17 @@ unsigned int ss2ftt_(char *fontfilename, char *text, int *fontsizepx,
   free(ttext);
   free(tfont);
 }
+
+/* draw text using the freetype font engine */
+void ns2ftstr_(char *fontfilename, int *fontsizepx, char *text,
+	       XYZ *P, XYZ *right, XYZ *up, COLOUR *col, char *trans,
+	       float *alpha, long int fnlen, long int textlen) {
+  char *tfont = _s2_f2cstr(fontfilename, fnlen);
+  char *ttext = _s2_f2cstr(text, textlen);
+  ns2ftstr(tfont, *fontsizepx, ttext, *P, *right, *up, *col, *trans, *alpha);
+  free(ttext);
+  free(tfont);
+}
 #endif
 
 
@@ -1222,6 +1279,10 @@ void ss2dt_(unsigned int *texid) {/*NEW*/
   ss2dt(*texid);
 }
 
+long ss2qtm_(int *ntex) {
+  return ss2qtm(ntex);
+}
+
 /***********************************************************************
  *
  * ENVIRONMENT / RENDERING ATTRIBUTES
@@ -1243,6 +1304,46 @@ int ss2qrm_() {
   return ss2qrm();
 }
 
+void ss2tbbx_(int *enabledisable) {
+  ss2tbbx(*enabledisable);
+}
+int ss2qbbx_() {
+  return ss2qbbx();
+}
+void ss2tlod_(int *enabledisable) {
+  ss2tlod(*enabledisable);
+}
+int ss2qlod_() {
+  return ss2qlod();
+}
+void ss2sfb_(float *budget) {
+  ss2sfb(*budget);
+}
+float ss2qfb_() {
+  return ss2qfb();
+}
+void ss2tprof_(int *enabledisable) {
+  ss2tprof(*enabledisable);
+}
+int ss2qprof_() {
+  return ss2qprof();
+}
+float ss2qprs_(char *stage, int *ago, int *count, int *bytes, 
+	       long int stagelen) {
+  char *t1 = _s2_f2cstr(stage, stagelen);
+  float retval = ss2qprs(t1, *ago, count, bytes);
+  free(t1);
+  return retval;
+}
+int ss2qprn_() {
+  return ss2qprn();
+}
+void ss2wprof_(char *filename, long int filenamelen) {
+  char *t1 = _s2_f2cstr(filename, filenamelen);
+  ss2wprof(t1);
+  free(t1);
+}
+
 void ss2sl_(COLOUR *ambient, int *nlights, XYZ *lightpos,
 	    COLOUR *lightcol, int *worldcoords) {
   ss2sl(*ambient, *nlights, lightpos, lightcol, *worldcoords);
@@ -1379,6 +1480,12 @@ void ss2wtga_(char *fname, long int textlen) {/*NEW*/
   free(string);
 }
 
+void ss2scap_(char *format, long int textlen) {
+  char *string = _s2_f2cstr(format, textlen);
+  ss2scap(string);
+  free(string);
+}
+
 unsigned char *ss2gpix_(unsigned int *width, unsigned int *height) {
   return ss2gpix(width, height);
 }
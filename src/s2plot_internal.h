@@ -149,8 +149,9 @@ extern "C" {
 #if defined(S2MPICH)
      {"/S2MULTI",  0, 63, 0, "Multihead"},
 #endif
+     {"/S2OFFSCR", 0, -2, 1, "Offscreen rendering (no window system)"},
      {"/S2NULL",   0, -1, 1, "Null device (no display)"}};
-  int _s2_ndevices = 24;
+  int _s2_ndevices = 25;
   
   /* pointer to callback function */
   void (*_s2_callback)(double*, int *);
@@ -280,6 +281,19 @@ extern "C" {
   
   float _s2_evas_x, _s2_evas_y, _s2_evas_z;
   
+  /* billboards are expanded to quads in a vertex shader (ss2tbbx) */
+  int _s2_bbshader;
+
+  /* static dot clouds are drawn at reduced detail while the view
+   * moves (ss2tlod) */
+  int _s2_lodpoints;
+
+  /* frame-time governor (ss2sfb) */
+  _S2GOVERNOR _s2_governor;
+
+  /* frame profile (ss2tprof) */
+  _S2PROFILE _s2_profile;
+  
   /* s2plot fade in/out routine */
   double _s2_fadetime;
   int _s2_fadestatus; /* 0 = start fade-in, 1 = fade-in, 2 = normal running, 
@@ -327,6 +341,15 @@ extern "C" {
   char **_s2_VRMLnames;
   int _s2_currVRMLidx;
 
+  /* interned screen tags: primitives store an index into this table
+   * instead of a copy of _s2_whichscreen.  Tag 0 is always "" (world
+   * geometry); _s2_screentagbits holds the _S2SCREEN_* bits of each tag */
+  int _s2_nscreentags;
+  char **_s2_screentags;
+  unsigned char *_s2_screentagbits;
+  unsigned short _s2_currscreentag; /* tag of _s2_whichscreen */
+  unsigned char _s2_doingScreenBit; /* _S2SCREEN_* bit of _s2_doingScreen */
+
 #endif
 
   /* are we using an ati card? (requires no multisampling) */
@@ -338,6 +361,12 @@ extern "C" {
   /* cache of textures (generally used in callbacks) */
   int _s2_ctext_count;
   _S2CACHEDTEXTURE *_s2_ctext;
+  int _s2_ctext_alloc;
+  long _s2_ctext_bytes;
+
+  /* hash tables indexing the texture cache by id and by file name */
+  int *_s2_texreg_byid, *_s2_texreg_byname;
+  int _s2_texreg_nslot;
 
   /* global store for MPI state and world display position */
 #if defined(S2MPICH)
@@ -54,6 +54,48 @@ extern "C" {
   void AddLine2Database(XYZ p1,XYZ p2,COLOUR c1,COLOUR c2,double w);
   void AddFace2Database(XYZ *p,int n,COLOUR c,double scale,XYZ shift);
   void AddMarker2Database(int type,double size,XYZ p,COLOUR c);
+  void *_s2priv_arenaReserve(void *base, int n, int in, size_t size);
+  void _s2priv_arenaFree(void *base);
+  int _s2priv_arenaCapacity(void *base);
+  void _s2priv_w2dcoeffs(float *devmin, float *scale, float *axmin);
+  unsigned char _s2priv_screenBits(char *ws);
+  unsigned short _s2priv_screenTag(char *ws);
+  void _s2priv_listChanged(void);
+  void _s2priv_packBatches(_S2BATCHLIST *bl, int spatial);
+  void _s2priv_uploadBatches(_S2BATCHLIST *bl);
+  void _s2priv_drawBatches(_S2BATCHLIST *bl, int lit, int *view); // wasGL
+  unsigned int _s2priv_depthKey(float d, int farfirst);
+  void _s2priv_sortReserve(_S2SORTKEYS *sk, int n);
+  void _s2priv_sortKeys(_S2SORTKEYS *sk);
+  void _s2priv_cullGrid(_S2CULLGRID *grid);
+  unsigned int _s2priv_cullCell(_S2CULLGRID *grid, XYZ p);
+  void _s2priv_cullBounds(_S2BATCHLIST *bl);
+  void _s2priv_cullFrustum(_S2FRUSTUM *fr);
+  int _s2priv_cullBox(_S2FRUSTUM *fr, float *lo, float *hi);
+  int _s2priv_cullSphere(_S2FRUSTUM *fr, XYZ c, float r);
+  void _s2priv_lodBuild(_S2BATCHLIST *bl);
+  int _s2priv_lodRange(_S2FRUSTUM *fr, _S2BATCHLIST *bl, _S2BATCH *b,
+		       int *first, int *count);
+  void _s2priv_lodMotion(S2PLOT_PANEL *p);
+  int _s2priv_govern(int knob, int full);
+  void _s2priv_govFrame(double tm);
+  double _s2priv_profStart(void);
+  void _s2priv_profStop(int stage, double t0, int count, int bytes);
+  void _s2priv_profFrame(double tm);
+  int _s2priv_profStage(char *name);
+  int _s2priv_profFrames(void);
+  _S2PROFSAMPLE *_s2priv_profSample(int stage, int ago);
+  void _s2priv_profWrite(char *filename);
+  void _s2priv_capFrame(char *name, int width, int height, int stereo);
+  void _s2priv_capHarvest(void);
+  void _s2priv_capFlush(void);
+  void _s2priv_capFormat(char *format);
+  void _s2priv_transState(char trans); // wasGL
+  unsigned int _s2priv_transKey(int trans, float depth, float group);
+  float _s2priv_transDepth(XYZ p, int doscreen);
+  void _s2priv_packTransparent(_S2BATCHLIST *bl, int doscreen);
+  void _s2priv_vnf3(int in, float *ix, float *iy, float *iz, 
+		    float *ired, float *igreen, float *iblue, COLOUR icol);
   DISK *_s2priv_adddisks(int in);
   BALL *_s2priv_addballs(int in);
   LABEL *_s2priv_addlabels(int in);
@@ -129,9 +171,40 @@ extern "C" {
 				      int usemipmaps);
   
   void _s2priv_ss2pt(unsigned int itextureID, int usemipmaps);
+  void _s2priv_ss2ptr(unsigned int itextureID, int x0, int x1, int y0, int y1,
+		      int z0, int z1);
+
+  /* build mipmaps for the bound texture, on the GPU if possible */
+  void _s2priv_buildMipmaps(int gl_tex_mode, int width, int height,
+			    int depth, BITMAP4 *bitmap);
   
   /* drop a texture from memory */
   void _s2priv_dropTexture(unsigned int texid);
+
+  /* find and read a texture file, or run LaTeX, without creating
+   * a texture */
+  int _s2priv_findTexture(char *itexturefn, char *found);
+  BITMAP4 *_s2priv_readTexture(char *itexturefn, int *width, int *height);
+  BITMAP4 *_s2priv_latexBitmap(char *latexcmd, float *aspect,
+			       int *width, int *height);
+
+  /* texture files (s2texfile.c) */
+  int _s2priv_isTexFile(char *name);
+  BITMAP4 *_s2priv_readTexFile(char *fname, int *width, int *height);
+  int _s2priv_loadTexFile(char *fname, unsigned int *id);
+  BITMAP4 *_s2priv_texBitmap(int idx);
+
+  /* install textures finished by the background loader (s2texload.c) */
+  void _s2priv_texLoadApply(void);
+
+  /* texture registry (s2texreg.c) */
+  int _s2priv_texIndex(unsigned int id);
+  int _s2priv_texNameIndex(char *name);
+  void _s2priv_texRegister(unsigned int id, int width, int height, int depth,
+			   BITMAP4 *bitmap, int usemipmaps);
+  void _s2priv_texUnregister(int idx);
+  unsigned int _s2priv_texAcquire(char *name);
+  void _s2priv_texRelease(unsigned int id);
   
   /* switch the geometry lists so new geometry is added to / drawn from 
    * the dynamic lists.  A global flag is set so we know in MakeGeometry
@@ -173,10 +246,8 @@ extern "C" {
 
   /* routines and structure/s for isosurfaces */
   int Polygonise(GRIDCELL g,double iso,TRIANGLE *tri);
+  int PolygoniseEdges(GRIDCELL g,double iso,XYZ *vertlist,int *edges);
   void _s2priv_drawTriangleCache(_S2TRIANGLE_CACHE *cache);
-  void _s2priv_addToTriangleCache(_S2TRIANGLE_CACHE *cache, XYZ *trivert, 
-				  //				XYZ cellnormal,
-				  float *tr, COLOUR col);
   void _s2priv_colrfn(float *ix, float *iy, float *iz, 
 		      float *r, float *g, float *b);
   void _s2priv_generate_isosurface(int isid, int force);
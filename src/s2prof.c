@@ -0,0 +1,185 @@
+/* s2prof.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Frame profile (ss2tprof).
+ *
+ * Named stages of each frame - callbacks, clearing dynamic geometry,
+ * each class of primitive in MakeGeometry, sorts, volume texture and
+ * isosurface rebuilds and the buffer swap - are timed and counted
+ * into a ring buffer of the last _S2PROFFRAMES frames.  The same
+ * timers feed the frame-time governor (see s2govern.c).  When neither
+ * is on, a stage costs one test of a flag.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+#if defined(BUILDING_S2PLOT)
+
+static char *_s2x_profnames[_S2PROF_NSTAGES] = {
+  "callback", "dynamic", "pack", "ball", "disk", "cone", "batch",
+  "ballt", "face4t", "trans", "texmesh", "bbsort", "bboard", "bbset",
+  "vrtexture", "isosurface", "swap", "capture", "draw"};
+
+/* the governor stage each profile stage counts towards, or -1 */
+static int _s2x_profgov[_S2PROF_NSTAGES] = {
+  _S2GOV_CALLBACK, -1, _S2GOV_GEOMETRY, -1, -1, -1, -1, 
+  -1, -1, _S2GOV_SORT, -1, _S2GOV_SORT, -1, -1, 
+  -1, -1, -1, -1, _S2GOV_DRAW};
+
+/* start timing a stage: returns the start time, or 0 when neither
+ * the profile nor the governor is on */
+double _s2priv_profStart(void) {
+  if (!_s2_profile.on && (_s2_governor.budget <= 0.)) {
+    return 0.;
+  }
+  return GetRunTime();
+}
+
+/* add the time since t0 (from _s2priv_profStart), and count
+ * primitives and bytes, to stage of the current frame */
+void _s2priv_profStop(int stage, double t0, int count, int bytes) {
+  double dt;
+  _S2PROFSAMPLE *s;
+  if (t0 <= 0.) {
+    return;
+  }
+  dt = GetRunTime() - t0;
+  if ((_s2x_profgov[stage] >= 0) && (_s2_governor.budget > 0.)) {
+    _s2_governor.t[_s2x_profgov[stage]] += dt;
+  }
+  if (_s2_profile.on && (_s2_profile.nframe > 0)) {
+    s = _s2_profile.s[(_s2_profile.nframe - 1) % _S2PROFFRAMES] + stage;
+    s->t += dt;
+    s->count += count;
+    s->bytes += bytes;
+  }
+}
+
+/* start a new frame in the profile, at time tm */
+void _s2priv_profFrame(double tm) {
+  int f;
+  if (!_s2_profile.on) {
+    return;
+  }
+  f = _s2_profile.nframe % _S2PROFFRAMES;
+  _s2_profile.tstart[f] = tm;
+  memset(_s2_profile.s[f], 0, _S2PROF_NSTAGES * sizeof(_S2PROFSAMPLE));
+  _s2_profile.nframe++;
+}
+
+/* the index of the named stage, or -1 */
+int _s2priv_profStage(char *name) {
+  int i;
+  for (i = 0; i < _S2PROF_NSTAGES; i++) {
+    if (name && !strcasecmp(name, _s2x_profnames[i])) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* the number of complete frames held in the profile */
+int _s2priv_profFrames(void) {
+  int n = _s2_profile.nframe - 1;
+  if (n < 0) {
+    return 0;
+  }
+  return (n > _S2PROFFRAMES - 1) ? _S2PROFFRAMES - 1 : n;
+}
+
+/* the sample of stage from the frame ago frames before the last
+ * complete one */
+_S2PROFSAMPLE *_s2priv_profSample(int stage, int ago) {
+  if ((stage < 0) || (stage >= _S2PROF_NSTAGES) ||
+      (ago < 0) || (ago >= _s2priv_profFrames())) {
+    return NULL;
+  }
+  return _s2_profile.s[(_s2_profile.nframe - 2 - ago) % _S2PROFFRAMES] + 
+    stage;
+}
+
+/* write the complete frames of the profile, oldest first, as JSON if
+ * the file name ends in ".json" and CSV otherwise */
+void _s2priv_profWrite(char *filename) {
+  FILE *fp;
+  int i, ago, nf, json, f;
+  _S2PROFSAMPLE *s;
+  
+  nf = _s2priv_profFrames();
+  json = filename && (strlen(filename) > 5) &&
+    !strcasecmp(filename + strlen(filename) - 5, ".json");
+  fp = filename ? fopen(filename, "w") : NULL;
+  if (!fp) {
+    _s2warn("(internal)", "unable to write frame profile to %s",
+	    filename ? filename : "(null)");
+    return;
+  }
+
+  if (json) {
+    fprintf(fp, "{\"stages\": [");
+    for (i = 0; i < _S2PROF_NSTAGES; i++) {
+      fprintf(fp, "%s\"%s\"", i ? ", " : "", _s2x_profnames[i]);
+    }
+    fprintf(fp, "],\n \"frames\": [");
+  } else {
+    fprintf(fp, "frame,time,stage,seconds,count,bytes\n");
+  }
+  for (ago = nf - 1; ago >= 0; ago--) {
+    f = _s2_profile.nframe - 2 - ago;
+    if (json) {
+      fprintf(fp, "%s\n  {\"frame\": %d, \"time\": %.6f, \"samples\": [", 
+	      (ago < nf - 1) ? "," : "", f, 
+	      _s2_profile.tstart[f % _S2PROFFRAMES]);
+    }
+    for (i = 0; i < _S2PROF_NSTAGES; i++) {
+      s = _s2_profile.s[f % _S2PROFFRAMES] + i;
+      if (json) {
+	fprintf(fp, "%s[%.9f, %d, %d]", i ? ", " : "", s->t, s->count,
+		s->bytes);
+      } else {
+	fprintf(fp, "%d,%.6f,%s,%.9f,%d,%d\n", f, 
+		_s2_profile.tstart[f % _S2PROFFRAMES], _s2x_profnames[i], 
+		s->t, s->count, s->bytes);
+      }
+    }
+    if (json) {
+      fprintf(fp, "]}");
+    }
+  }
+  if (json) {
+    fprintf(fp, "\n ]}\n");
+  }
+  fclose(fp);
+  _s2debug("(internal)", "wrote %d frames of profile to %s", nf, filename);
+}
+
+#endif
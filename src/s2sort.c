@@ -0,0 +1,171 @@
+/* s2sort.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Depth ordering of billboards and handles.
+ *
+ * Rather than sorting the primitive structs themselves, the caller
+ * fills an _S2SORTKEYS with one 32-bit key per primitive - its camera
+ * distance, mapped by _s2priv_depthKey to an unsigned integer that
+ * orders the same way - and _s2priv_sortKeys leaves the draw order in
+ * idx.  The sort is a stable least-significant-digit radix sort; under
+ * S2OPENMP each pass histograms and scatters contiguous chunks of the
+ * keys in parallel.  The key and index arrays are kept from frame to
+ * frame and only ever grow.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+#include <string.h>
+#if defined(S2OPENMP)
+#include <omp.h>
+#endif
+
+/* radix digit width: four passes over 32-bit keys */
+#define _S2SORTBITS 8
+#define _S2SORTBINS (1 << _S2SORTBITS)
+/* fewer keys than this are not worth sharing between threads */
+#define _S2SORTPARALLEL 65536
+
+/* a key that sorts after that of any distance d >= 0 drawn far first,
+ * for items that are not to be drawn at all */
+#define _S2SORTLAST 0xffffffffu
+
+/* map a distance to an unsigned key with the same ordering, or the
+ * reverse ordering if farfirst is set */
+unsigned int _s2priv_depthKey(float d, int farfirst) {
+  union {
+    float f;
+    unsigned int u;
+  } v;
+  v.f = d;
+  v.u ^= (v.u & 0x80000000u) ? 0xffffffffu : 0x80000000u;
+  return farfirst ? ~v.u : v.u;
+}
+
+/* make room for n keys */
+void _s2priv_sortReserve(_S2SORTKEYS *sk, int n) {
+  if (n > sk->cap) {
+    sk->cap = n + n / 2;
+    sk->key = (unsigned int *)realloc(sk->key, sk->cap * sizeof(unsigned int));
+    sk->tkey = (unsigned int *)realloc(sk->tkey, sk->cap * sizeof(unsigned int));
+    sk->idx = (int *)realloc(sk->idx, sk->cap * sizeof(int));
+    sk->tidx = (int *)realloc(sk->tidx, sk->cap * sizeof(int));
+    if (!sk->key || !sk->tkey || !sk->idx || !sk->tidx) {
+      _s2error("(internal)", "memory allocation failed for depth sort");
+    }
+  }
+  sk->n = n;
+}
+
+/* sort key[0..n-1] ascending, leaving the permutation in idx */
+void _s2priv_sortKeys(_S2SORTKEYS *sk) {
+  int n = sk->n;
+  int nchunk = 1;
+  int shift, c, d, i;
+
+#if defined(S2OPENMP)
+  if (n >= _S2SORTPARALLEL) {
+    nchunk = omp_get_max_threads();
+  }
+#endif
+  if (nchunk > sk->nhist) {
+    sk->hist = (int *)realloc(sk->hist, nchunk * _S2SORTBINS * sizeof(int));
+    sk->nhist = nchunk;
+  }
+
+  for (i = 0; i < n; i++) {
+    sk->idx[i] = i;
+  }
+
+  for (shift = 0; shift < 32; shift += _S2SORTBITS) {
+
+    // count the digits in each chunk
+#if defined(S2OPENMP)
+#pragma omp parallel for if(nchunk > 1)
+#endif
+    for (c = 0; c < nchunk; c++) {
+      int *h = sk->hist + c * _S2SORTBINS;
+      int lo = (int)((long long)n * c / nchunk);
+      int hi = (int)((long long)n * (c + 1) / nchunk);
+      int k;
+      memset(h, 0, _S2SORTBINS * sizeof(int));
+      for (k = lo; k < hi; k++) {
+	h[(sk->key[k] >> shift) & (_S2SORTBINS - 1)]++;
+      }
+    }
+
+    // a digit shared by every key leaves the order as it is
+    if (n > 0) {
+      int same = 0;
+      d = (sk->key[0] >> shift) & (_S2SORTBINS - 1);
+      for (c = 0; c < nchunk; c++) {
+	same += sk->hist[c * _S2SORTBINS + d];
+      }
+      if (same == n) {
+	continue;
+      }
+    }
+
+    // turn the counts into scatter offsets, digit-major so each chunk
+    // writes after every lower digit and after earlier chunks
+    int sum = 0, t;
+    for (d = 0; d < _S2SORTBINS; d++) {
+      for (c = 0; c < nchunk; c++) {
+	t = sk->hist[c * _S2SORTBINS + d];
+	sk->hist[c * _S2SORTBINS + d] = sum;
+	sum += t;
+      }
+    }
+
+#if defined(S2OPENMP)
+#pragma omp parallel for if(nchunk > 1)
+#endif
+    for (c = 0; c < nchunk; c++) {
+      int *h = sk->hist + c * _S2SORTBINS;
+      int lo = (int)((long long)n * c / nchunk);
+      int hi = (int)((long long)n * (c + 1) / nchunk);
+      int k, o;
+      for (k = lo; k < hi; k++) {
+	o = h[(sk->key[k] >> shift) & (_S2SORTBINS - 1)]++;
+	sk->tkey[o] = sk->key[k];
+	sk->tidx[o] = sk->idx[k];
+      }
+    }
+
+    unsigned int *ukeep = sk->key;
+    sk->key = sk->tkey;
+    sk->tkey = ukeep;
+    int *ikeep = sk->idx;
+    sk->idx = sk->tidx;
+    sk->tidx = ikeep;
+  }
+}
@@ -0,0 +1,373 @@
+/* s2texfile.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Reading S2PLOT texture files (".s2t", see s2texfile.h).
+ *
+ * ss2lt maps the file into memory and hands each stored mipmap level
+ * to OpenGL as it stands: block compressed levels with
+ * glCompressedTexImage2D where the card understands S3TC, one and
+ * two channel levels as luminance textures.  No host copy of the
+ * image is kept; if one is asked for by ss2gt, or needed by ss2pt,
+ * it is read back from OpenGL at that point.  Where OpenGL cannot
+ * be used (no display, or a device without colour) the file is
+ * decoded to an ordinary bitmap instead.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+#if defined(BUILDING_S2PLOT)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "s2texfile.h"
+
+typedef struct {
+  unsigned char *map;
+  size_t mapsize;
+  int format, width, height, nlevels;
+  unsigned int lw[S2TF_MAXLEVELS], lh[S2TF_MAXLEVELS];
+  unsigned int loff[S2TF_MAXLEVELS], lsize[S2TF_MAXLEVELS];
+} _S2TEXFILE;
+
+/* is this the name of a texture file? */
+int _s2priv_isTexFile(char *name) {
+  size_t n = strlen(name);
+  return (n > 4) && !strcasecmp(name + n - 4, ".s2t");
+}
+
+static unsigned int _s2priv_tfU32(unsigned char *p) {
+  return (unsigned int)p[0] | ((unsigned int)p[1] << 8) |
+    ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static void _s2priv_tfClose(_S2TEXFILE *tf) {
+  if (tf->map) {
+    munmap(tf->map, tf->mapsize);
+    tf->map = NULL;
+  }
+}
+
+/* map a texture file and check its header; returns 0 on failure */
+static int _s2priv_tfOpen(char *fname, _S2TEXFILE *tf) {
+  struct stat st;
+  int fd, i;
+  unsigned char *p;
+
+  memset(tf, 0, sizeof(_S2TEXFILE));
+  if ((fd = open(fname, O_RDONLY)) < 0) {
+    return 0;
+  }
+  if (fstat(fd, &st) || (st.st_size < S2TF_HEADER)) {
+    close(fd);
+    return 0;
+  }
+  tf->mapsize = st.st_size;
+  tf->map = (unsigned char *)mmap(NULL, tf->mapsize, PROT_READ, MAP_PRIVATE,
+				  fd, 0);
+  close(fd);
+  if (tf->map == (unsigned char *)MAP_FAILED) {
+    tf->map = NULL;
+    return 0;
+  }
+
+  p = tf->map;
+  tf->format = _s2priv_tfU32(p + 8);
+  tf->width = _s2priv_tfU32(p + 12);
+  tf->height = _s2priv_tfU32(p + 16);
+  tf->nlevels = _s2priv_tfU32(p + 20);
+  if (memcmp(p, S2TF_MAGIC, 8) || (tf->format >= S2TF_NFORMATS) ||
+      (tf->width < 1) || (tf->height < 1) || 
+      (tf->width > S2TF_MAXSIZE) || (tf->height > S2TF_MAXSIZE) ||
+      (tf->nlevels < 1) || (tf->nlevels > S2TF_MAXLEVELS) ||
+      (S2TF_HEADER + tf->nlevels * S2TF_LEVEL > tf->mapsize)) {
+    _s2warn("ss2lt", "%s is not a valid texture file", fname);
+    _s2priv_tfClose(tf);
+    return 0;
+  }
+  for (i = 0; i < tf->nlevels; i++) {
+    p = tf->map + S2TF_HEADER + i * S2TF_LEVEL;
+    tf->lw[i] = _s2priv_tfU32(p);
+    tf->lh[i] = _s2priv_tfU32(p + 4);
+    tf->loff[i] = _s2priv_tfU32(p + 8);
+    tf->lsize[i] = _s2priv_tfU32(p + 12);
+    if ((tf->lw[i] != MAX(1, tf->width >> i)) ||
+	(tf->lh[i] != MAX(1, tf->height >> i)) ||
+	(tf->lsize[i] != S2TF_LEVELSIZE(tf->format, tf->lw[i], tf->lh[i])) ||
+	((size_t)tf->loff[i] + tf->lsize[i] > tf->mapsize)) {
+      _s2warn("ss2lt", "%s has a bad mipmap level", fname);
+      _s2priv_tfClose(tf);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* the four colours of a BC1/BC3 block */
+static void _s2priv_tfColours(unsigned char *b, BITMAP4 *c, int bc1) {
+  unsigned int c0 = b[0] | (b[1] << 8), c1 = b[2] | (b[3] << 8);
+  int k;
+  c[0].r = ((c0 >> 11) & 31) * 255 / 31;
+  c[0].g = ((c0 >> 5) & 63) * 255 / 63;
+  c[0].b = (c0 & 31) * 255 / 31;
+  c[1].r = ((c1 >> 11) & 31) * 255 / 31;
+  c[1].g = ((c1 >> 5) & 63) * 255 / 63;
+  c[1].b = (c1 & 31) * 255 / 31;
+  c[0].a = c[1].a = c[2].a = c[3].a = 255;
+  if (bc1 && (c0 <= c1)) {
+    c[2].r = (c[0].r + c[1].r) / 2;
+    c[2].g = (c[0].g + c[1].g) / 2;
+    c[2].b = (c[0].b + c[1].b) / 2;
+    c[3].r = c[3].g = c[3].b = c[3].a = 0;
+  } else {
+    for (k = 0; k < 2; k++) {
+      c[2+k].r = ((2 - k) * c[0].r + (1 + k) * c[1].r) / 3;
+      c[2+k].g = ((2 - k) * c[0].g + (1 + k) * c[1].g) / 3;
+      c[2+k].b = ((2 - k) * c[0].b + (1 + k) * c[1].b) / 3;
+    }
+  }
+}
+
+/* the eight alpha values of a BC3 block */
+static void _s2priv_tfAlphas(unsigned char *b, int *a) {
+  int k;
+  a[0] = b[0];
+  a[1] = b[1];
+  if (a[0] > a[1]) {
+    for (k = 1; k < 7; k++) {
+      a[k+1] = ((7 - k) * a[0] + k * a[1]) / 7;
+    }
+  } else {
+    for (k = 1; k < 5; k++) {
+      a[k+1] = ((5 - k) * a[0] + k * a[1]) / 5;
+    }
+    a[6] = 0;
+    a[7] = 255;
+  }
+}
+
+/* expand one level of a texture file to RGBA */
+static void _s2priv_tfDecode(_S2TEXFILE *tf, int level, BITMAP4 *out) {
+  int w = tf->lw[level], h = tf->lh[level];
+  unsigned char *p = tf->map + tf->loff[level];
+  long i, n = (long)w * h;
+  int bx, by, x, y, k;
+
+  switch (tf->format) {
+  case S2TF_RGBA:
+    memcpy(out, p, n * sizeof(BITMAP4));
+    break;
+  case S2TF_LUM:
+  case S2TF_LUMA:
+    k = (tf->format == S2TF_LUM) ? 1 : 2;
+    for (i = 0; i < n; i++, p += k) {
+      out[i].r = out[i].g = out[i].b = p[0];
+      out[i].a = (k == 1) ? 255 : p[1];
+    }
+    break;
+  case S2TF_BC1:
+  case S2TF_BC3:
+    for (by = 0; by < (h + 3) / 4; by++) {
+      for (bx = 0; bx < (w + 3) / 4; bx++) {
+	BITMAP4 c[4];
+	int a[8];
+	unsigned char *cb = p;
+	unsigned long long abits = 0;
+	if (tf->format == S2TF_BC3) {
+	  _s2priv_tfAlphas(p, a);
+	  for (k = 0; k < 6; k++) {
+	    abits |= (unsigned long long)p[2+k] << (8 * k);
+	  }
+	  cb = p + 8;
+	}
+	_s2priv_tfColours(cb, c, tf->format == S2TF_BC1);
+	unsigned int bits = _s2priv_tfU32(cb + 4);
+	for (k = 0; k < 16; k++) {
+	  x = bx * 4 + (k & 3);
+	  y = by * 4 + (k >> 2);
+	  if ((x < w) && (y < h)) {
+	    out[y * w + x] = c[(bits >> (2 * k)) & 3];
+	    if (tf->format == S2TF_BC3) {
+	      out[y * w + x].a = a[(abits >> (3 * k)) & 7];
+	    }
+	  }
+	}
+	p += (tf->format == S2TF_BC1) ? 8 : 16;
+      }
+    }
+    break;
+  }
+}
+
+/* read the full size image of a texture file into a new bitmap;
+ * returns NULL on failure.  Safe to call from the background loader.
+ */
+BITMAP4 *_s2priv_readTexFile(char *fname, int *width, int *height) {
+  _S2TEXFILE tf;
+  BITMAP4 *bitmap;
+  if (!_s2priv_tfOpen(fname, &tf)) {
+    return NULL;
+  }
+  bitmap = (BITMAP4 *)malloc((long)tf.width * tf.height * sizeof(BITMAP4));
+  if (bitmap) {
+    _s2priv_tfDecode(&tf, 0, bitmap);
+    *width = tf.width;
+    *height = tf.height;
+  }
+  _s2priv_tfClose(&tf);
+  return bitmap;
+}
+
+/* can we upload S3TC compressed levels? */
+static int _s2priv_tfS3TC(void) {
+  static int has = -1;
+  if (has < 0) {
+    const char *ext = (const char *)glGetString(GL_EXTENSIONS);
+    has = (ext && strstr(ext, "GL_EXT_texture_compression_s3tc")) ? 1 : 0;
+  }
+  return has;
+}
+
+/* create a texture from a texture file; returns 0 on failure */
+int _s2priv_loadTexFile(char *fname, unsigned int *id) {
+  _S2TEXFILE tf;
+  BITMAP4 *tmp = NULL;
+  GLuint texid;
+  int i, w, h;
+
+  if ((options.stereo < 0) || (_s2_devcap & _S2DEVCAP_NOCOLOR)) {
+    /* no OpenGL, or the image must be desaturated: plain bitmap */
+    tmp = _s2priv_readTexFile(fname, &w, &h);
+    if (!tmp) {
+      return 0;
+    }
+    *id = _s2priv_setupTexture(w, h, tmp, 1);
+    return 1;
+  }
+
+  if (!_s2priv_tfOpen(fname, &tf)) {
+    return 0;
+  }
+  glGenTextures(1, &texid);
+  glBindTexture(GL_TEXTURE_2D, texid);
+  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+		  (tf.nlevels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, tf.nlevels - 1);
+  glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  for (i = 0; i < tf.nlevels; i++) {
+    unsigned char *data = tf.map + tf.loff[i];
+    switch (tf.format) {
+    case S2TF_LUM:
+      glTexImage2D(GL_TEXTURE_2D, i, GL_LUMINANCE8, tf.lw[i], tf.lh[i], 0,
+		   GL_LUMINANCE, GL_UNSIGNED_BYTE, data);
+      break;
+    case S2TF_LUMA:
+      glTexImage2D(GL_TEXTURE_2D, i, GL_LUMINANCE8_ALPHA8, tf.lw[i], tf.lh[i],
+		   0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, data);
+      break;
+    case S2TF_BC1:
+    case S2TF_BC3:
+      if (_s2priv_tfS3TC()) {
+	glCompressedTexImage2D(GL_TEXTURE_2D, i, (tf.format == S2TF_BC1) ?
+			       GL_COMPRESSED_RGBA_S3TC_DXT1_EXT :
+			       GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+			       tf.lw[i], tf.lh[i], 0, tf.lsize[i], data);
+	break;
+      }
+      /* no S3TC: expand the level here */
+      if (!tmp) {
+	tmp = (BITMAP4 *)malloc((long)tf.width * tf.height * sizeof(BITMAP4));
+	if (!tmp) {
+	  _s2error("ss2lt", "failed to allocate memory for texture");
+	}
+      }
+      _s2priv_tfDecode(&tf, i, tmp);
+      data = (unsigned char *)tmp;
+      /* fall through */
+    default:
+      glTexImage2D(GL_TEXTURE_2D, i, 4, tf.lw[i], tf.lh[i], 0,
+		   GL_RGBA, GL_UNSIGNED_BYTE, data);
+      break;
+    }
+  }
+  glPopClientAttrib();
+  glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+  if (tmp) {
+    free(tmp);
+  }
+
+  /* cached with no host copy */
+  _s2priv_texRegister(texid, tf.width, tf.height, 0, NULL, tf.nlevels > 1);
+  _s2_ctext[_s2_ctext_count - 1].packed = 1 + tf.format;
+  _s2priv_tfClose(&tf);
+  *id = texid;
+  return 1;
+}
+
+/* the host copy of cached texture idx, reading it back from OpenGL
+ * for textures loaded from a texture file */
+BITMAP4 *_s2priv_texBitmap(int idx) {
+  _S2CACHEDTEXTURE *t = _s2_ctext + idx;
+  if (t->bitmap || !t->packed) {
+    return t->bitmap;
+  }
+  t->bitmap = (BITMAP4 *)malloc((long)t->width * t->height * sizeof(BITMAP4));
+  if (!t->bitmap) {
+    _s2warn("ss2gt", "failed to allocate memory for texture");
+    return NULL;
+  }
+  glBindTexture(GL_TEXTURE_2D, t->id);
+  glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  if ((t->packed - 1 == S2TF_LUM) || (t->packed - 1 == S2TF_LUMA)) {
+    /* luminance reads back as red only in RGBA, so read grey and
+     * alpha into the front of the bitmap and spread it from the end */
+    unsigned char *la = (unsigned char *)t->bitmap;
+    long i = (long)t->width * t->height;
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, la);
+    while (i--) {
+      t->bitmap[i].a = la[2 * i + 1];
+      t->bitmap[i].r = t->bitmap[i].g = t->bitmap[i].b = la[2 * i];
+    }
+  } else {
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, t->bitmap);
+  }
+  glPopClientAttrib();
+  t->bytes = (long)t->width * t->height * sizeof(BITMAP4);
+  _s2_ctext_bytes += t->bytes;
+  return t->bitmap;
+}
+
+#endif
@@ -0,0 +1,74 @@
+/* s2texfile.h
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* The S2PLOT texture file (".s2t"): an image with its mipmaps built
+ * ahead of time, stored in the form it is sent to OpenGL so it can
+ * be uploaded straight from a memory mapping of the file.  Written by
+ * the s2texpack tool (see scripts/texpack.csh) and read by ss2lt.
+ *
+ * All numbers are 32-bit unsigned little-endian.  The file is:
+ *
+ *   magic "S2PLTEX1" (8 bytes)
+ *   format, width, height, nlevels, flags (0)
+ *   for each level, largest first: width, height, offset, size
+ *   level data, each level starting on a 16-byte boundary
+ *
+ * Level n is max(1, width >> n) by max(1, height >> n).  Rows run
+ * from the bottom of the image up, as in the bitmaps of ss2gt.  Block
+ * compressed levels are stored as 4x4 pixel blocks, rows of blocks
+ * again from the bottom up, with partial blocks padded.
+ */
+
+#ifndef S2TEXFILE_H
+#define S2TEXFILE_H
+
+#define S2TF_MAGIC "S2PLTEX1"
+#define S2TF_HEADER 28      /* bytes before the level table */
+#define S2TF_LEVEL  16      /* bytes per level table entry */
+#define S2TF_MAXLEVELS 32
+#define S2TF_MAXSIZE 16384  /* largest width or height accepted */
+
+/* formats */
+#define S2TF_RGBA 0         /* 4 bytes per pixel */
+#define S2TF_LUM  1         /* 1 byte per pixel: grey, opaque */
+#define S2TF_LUMA 2         /* 2 bytes per pixel: grey and alpha */
+#define S2TF_BC1  3         /* 8 bytes per block: DXT1, 1-bit alpha */
+#define S2TF_BC3  4         /* 16 bytes per block: DXT5 */
+#define S2TF_NFORMATS 5
+
+/* bytes of one level of the given format and size */
+#define S2TF_LEVELSIZE(f, w, h) \
+  (((f) == S2TF_BC1) ? (((size_t)(w) + 3) / 4) * (((size_t)(h) + 3) / 4) * 8 : \
+   ((f) == S2TF_BC3) ? (((size_t)(w) + 3) / 4) * (((size_t)(h) + 3) / 4) * 16 : \
+   (size_t)(w) * (size_t)(h) * (((f) == S2TF_LUM) ? 1 : ((f) == S2TF_LUMA) ? 2 : 4))
+
+#endif
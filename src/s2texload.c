@@ -0,0 +1,252 @@
+/* s2texload.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Background texture loading (ss2lta, ss2ltta).
+ *
+ * A texture asked for this way is created at once with a small grey
+ * placeholder image, so its id can be used straight away.  The file
+ * is found and decoded, or the LaTeX run, by worker threads, which
+ * touch no OpenGL or S2PLOT state; finished images wait in a queue
+ * until the display loop installs them, under the texture's original
+ * id, at the start of a frame.  Installing stops for the frame once
+ * the time budget set by ss2stlb has been used, so a large batch of
+ * textures arrives over several frames rather than stalling one.
+ *
+ * Each request carries a sequence number that is also kept in the
+ * texture's cache entry until it is installed.  A finished image is
+ * thrown away if the texture has been deleted meanwhile, even if
+ * OpenGL has since given the same id to a new texture.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+#if defined(BUILDING_S2PLOT)
+
+#define _S2TLWORKERS 2    /* decoding threads */
+#define _S2TLBUDGET  4.0  /* default installing time per frame (ms) */
+#define _S2TLSIZE    16   /* width and height of the placeholder */
+
+typedef struct _S2TLJOB {
+  unsigned int id;  /* texture to fill */
+  int seq;          /* must match the texture's loadseq */
+  int latex;        /* src is LaTeX, not a file name */
+  char *src;
+  BITMAP4 *bitmap;  /* result, filled in by a worker */
+  int width, height;
+  float aspect;
+  struct _S2TLJOB *next;
+} _S2TLJOB;
+
+static pthread_mutex_t _s2x_tlmutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _s2x_tlcond = PTHREAD_COND_INITIALIZER;
+static _S2TLJOB *_s2x_tltodo = NULL, *_s2x_tltodotail = NULL;
+static _S2TLJOB *_s2x_tldone = NULL, *_s2x_tldonetail = NULL;
+static int _s2x_tlnworker = 0;
+static int _s2x_tlseq = 0;
+static float _s2x_tlbudget = _S2TLBUDGET;
+
+static void _s2priv_tlAppend(_S2TLJOB **head, _S2TLJOB **tail, 
+			     _S2TLJOB *job) {
+  job->next = NULL;
+  if (*tail) {
+    (*tail)->next = job;
+  } else {
+    *head = job;
+  }
+  *tail = job;
+}
+
+static _S2TLJOB *_s2priv_tlPop(_S2TLJOB **head, _S2TLJOB **tail) {
+  _S2TLJOB *job = *head;
+  if (job) {
+    *head = job->next;
+    if (!*head) {
+      *tail = NULL;
+    }
+  }
+  return job;
+}
+
+static void *_s2priv_tlWorker(void *data) {
+  _S2TLJOB *job;
+  for (;;) {
+    pthread_mutex_lock(&_s2x_tlmutex);
+    while (!_s2x_tltodo) {
+      pthread_cond_wait(&_s2x_tlcond, &_s2x_tlmutex);
+    }
+    job = _s2priv_tlPop(&_s2x_tltodo, &_s2x_tltodotail);
+    pthread_mutex_unlock(&_s2x_tlmutex);
+
+    job->aspect = 0.;
+    if (job->latex) {
+      job->bitmap = _s2priv_latexBitmap(job->src, &(job->aspect),
+					&(job->width), &(job->height));
+    } else {
+      job->bitmap = _s2priv_readTexture(job->src, &(job->width),
+					&(job->height));
+      if (!job->bitmap) {
+	fprintf(stderr, "Advisory: unable to load texture %s, using 'red X'\n",
+		job->src);
+      }
+    }
+    if (!job->bitmap) {
+      job->width = job->height = 16;
+      job->bitmap = _s2priv_redXtexture(job->width, job->height);
+    }
+
+    pthread_mutex_lock(&_s2x_tlmutex);
+    _s2priv_tlAppend(&_s2x_tldone, &_s2x_tldonetail, job);
+    pthread_mutex_unlock(&_s2x_tlmutex);
+  }
+  return NULL;
+}
+
+/* create a placeholder texture and queue the real one to be made */
+static unsigned int _s2priv_tlRequest(char *src, int latex) {
+  int i;
+  BITMAP4 *bitmap = (BITMAP4 *)malloc(_S2TLSIZE * _S2TLSIZE * 
+				      sizeof(BITMAP4));
+  if (!bitmap) {
+    _s2error("ss2lta/ss2ltta", "failed to allocate placeholder texture");
+  }
+  for (i = 0; i < _S2TLSIZE * _S2TLSIZE; i++) {
+    bitmap[i].r = bitmap[i].g = bitmap[i].b = 128;
+    bitmap[i].a = 255;
+  }
+  unsigned int id = _s2priv_setupTexture(_S2TLSIZE, _S2TLSIZE, bitmap, 1);
+
+  _S2TLJOB *job = (_S2TLJOB *)calloc(1, sizeof(_S2TLJOB));
+  if (!job || !(job->src = strdup(src))) {
+    _s2error("ss2lta/ss2ltta", "failed to allocate texture request");
+  }
+  job->id = id;
+  job->seq = ++_s2x_tlseq;
+  job->latex = latex;
+  _s2_ctext[_s2priv_texIndex(id)].loadseq = job->seq;
+
+  pthread_mutex_lock(&_s2x_tlmutex);
+  while (_s2x_tlnworker < _S2TLWORKERS) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, _s2priv_tlWorker, NULL)) {
+      break;
+    }
+    pthread_detach(thread);
+    _s2x_tlnworker++;
+  }
+  if (!_s2x_tlnworker) {
+    pthread_mutex_unlock(&_s2x_tlmutex);
+    _s2error("ss2lta/ss2ltta", "failed to start texture loader");
+  }
+  _s2priv_tlAppend(&_s2x_tltodo, &_s2x_tltodotail, job);
+  pthread_cond_signal(&_s2x_tlcond);
+  pthread_mutex_unlock(&_s2x_tlmutex);
+  return id;
+}
+
+/* install finished textures, until this frame's budget is used */
+void _s2priv_texLoadApply(void) {
+  _S2TLJOB *job;
+  int idx;
+  double t0 = 0.;
+  if (!_s2x_tlnworker) {
+    return;
+  }
+  for (;;) {
+    pthread_mutex_lock(&_s2x_tlmutex);
+    job = _s2priv_tlPop(&_s2x_tldone, &_s2x_tldonetail);
+    pthread_mutex_unlock(&_s2x_tlmutex);
+    if (!job) {
+      break;
+    }
+    if (t0 <= 0.) {
+      t0 = GetRunTime();
+    }
+
+    idx = _s2priv_texIndex(job->id);
+    if ((idx >= 0) && (_s2_ctext[idx].loadseq == job->seq)) {
+      _S2CACHEDTEXTURE *t = _s2_ctext + idx;
+      free(t->bitmap);
+      t->bitmap = job->bitmap;
+      t->width = job->width;
+      t->height = job->height;
+      t->aspect = job->aspect;
+      t->loadseq = 0;
+      _s2_ctext_bytes -= t->bytes;
+      t->bytes = (long)t->width * t->height * sizeof(BITMAP4);
+      _s2_ctext_bytes += t->bytes;
+      _s2priv_ss2pt(job->id, t->mipmaps);
+    } else {
+      /* deleted while loading */
+      free(job->bitmap);
+    }
+    free(job->src);
+    free(job);
+
+    if ((_s2x_tlbudget > 0.) && 
+	((GetRunTime() - t0) * 1000. >= _s2x_tlbudget)) {
+      break;
+    }
+  }
+}
+
+/* load a texture in the background */
+unsigned int ss2lta(char *itexturefn) {
+  return _s2priv_tlRequest(itexturefn, 0);
+}
+
+/* create a texture with LaTeX commands in the background */
+unsigned int ss2ltta(char *latexcmd) {
+  return _s2priv_tlRequest(latexcmd, 1);
+}
+
+/* is a texture ready? */
+int ss2qtl(unsigned int texid, float *aspect) {
+  int idx = _s2priv_texIndex(texid);
+  if (idx < 0) {
+    return -1;
+  }
+  if (_s2_ctext[idx].loadseq) {
+    return 0;
+  }
+  if (aspect) {
+    *aspect = (_s2_ctext[idx].aspect > 0.) ? _s2_ctext[idx].aspect :
+      (float)_s2_ctext[idx].width / (float)_s2_ctext[idx].height;
+  }
+  return 1;
+}
+
+/* set the time spent installing background-loaded textures per frame */
+void ss2stlb(float ms) {
+  _s2x_tlbudget = ms;
+}
+
+#endif
@@ -0,0 +1,277 @@
+/* s2texreg.c
+ *
+ * Copyright 2006-2012 David G. Barnes, Paul Bourke, Christopher Fluke
+ *
+ * This file is part of S2PLOT.
+ *
+ * S2PLOT is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * S2PLOT is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with S2PLOT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * We would appreciate it if research outcomes using S2PLOT would
+ * provide the following acknowledgement:
+ *
+ * "Three-dimensional visualisation was conducted with the S2PLOT
+ * progamming library"
+ *
+ * and a reference to
+ *
+ * D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+ * of the Astronomical Society of Australia, 23(2), 82-93.
+ *
+ */
+
+/* Texture registry: the cache of textures in _s2_ctext, indexed.
+ *
+ * Each cached texture is found by its id through an open-addressed
+ * hash table, and textures loaded on behalf of named-texture geometry
+ * (ns2vplanett, ns2vf4t and friends) are also found by file name
+ * through a second table, so that every sphere or facet naming the
+ * same file shares one texture.  Both tables hold an index into
+ * _s2_ctext (plus one; zero marks an empty slot).  Entries are
+ * removed by moving the last entry into the hole, so _s2_ctext stays
+ * dense and the tables only need the moved entry re-pointed.
+ *
+ * Named textures are reference counted: each piece of geometry that
+ * names a file holds one reference, and _s2_clearGeometryList
+ * releases them, deleting the texture when the last user goes.
+ * Textures returned by ss2lt and friends belong to the caller and
+ * live until ss2dt.  The memory held by the cache is kept in
+ * _s2_ctext_bytes and can be read with ss2qtm.
+ *
+ * This file is included by geomviewer.c.
+ */
+
+/* smallest table size; tables are kept at most half full */
+#define _S2TEXREGMIN 64
+
+static unsigned int _s2priv_texHashId(unsigned int id) {
+  return id * 2654435761u;
+}
+
+/* FNV-1a */
+static unsigned int _s2priv_texHashName(char *name) {
+  unsigned int h = 2166136261u;
+  while (*name) {
+    h ^= (unsigned char)*name++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+/* hash of the key of entry idx in the id (byname = 0) or name table */
+static unsigned int _s2priv_texKey(int idx, int byname) {
+  return byname ? _s2priv_texHashName(_s2_ctext[idx].path) :
+    _s2priv_texHashId(_s2_ctext[idx].id);
+}
+
+/* slot in a table holding entry idx, or -1 */
+static int _s2priv_texSlot(int idx, int byname) {
+  int *tab = byname ? _s2_texreg_byname : _s2_texreg_byid;
+  unsigned int mask = _s2_texreg_nslot - 1;
+  unsigned int s = _s2priv_texKey(idx, byname) & mask;
+  while (tab[s]) {
+    if (tab[s] == idx + 1) {
+      return (int)s;
+    }
+    s = (s + 1) & mask;
+  }
+  return -1;
+}
+
+static void _s2priv_texSlotInsert(int idx, int byname) {
+  int *tab = byname ? _s2_texreg_byname : _s2_texreg_byid;
+  unsigned int mask = _s2_texreg_nslot - 1;
+  unsigned int s = _s2priv_texKey(idx, byname) & mask;
+  while (tab[s]) {
+    s = (s + 1) & mask;
+  }
+  tab[s] = idx + 1;
+}
+
+/* empty slot s, shuffling back any later entries of the same probe
+ * run that would otherwise become unreachable */
+static void _s2priv_texSlotDelete(int s, int byname) {
+  int *tab = byname ? _s2_texreg_byname : _s2_texreg_byid;
+  unsigned int mask = _s2_texreg_nslot - 1;
+  unsigned int hole = s, j = s, home;
+  for (;;) {
+    j = (j + 1) & mask;
+    if (!tab[j]) {
+      break;
+    }
+    home = _s2priv_texKey(tab[j] - 1, byname) & mask;
+    /* move entry j into the hole unless its home lies cyclically
+     * in (hole, j] */
+    if ((j > hole) ? (home <= hole || home > j) :
+	(home <= hole && home > j)) {
+      tab[hole] = tab[j];
+      hole = j;
+    }
+  }
+  tab[hole] = 0;
+}
+
+/* rebuild both tables, large enough for n entries */
+static void _s2priv_texRehash(int n) {
+  int nslot = _S2TEXREGMIN, i;
+  while (nslot < 2 * n) {
+    nslot *= 2;
+  }
+  if (nslot == _s2_texreg_nslot) {
+    return;
+  }
+  free(_s2_texreg_byid);
+  free(_s2_texreg_byname);
+  _s2_texreg_byid = (int *)calloc(nslot, sizeof(int));
+  _s2_texreg_byname = (int *)calloc(nslot, sizeof(int));
+  if (!_s2_texreg_byid || !_s2_texreg_byname) {
+    _s2error("(internal)", "failed to allocate texture registry");
+  }
+  _s2_texreg_nslot = nslot;
+  for (i = 0; i < _s2_ctext_count; i++) {
+    _s2priv_texSlotInsert(i, 0);
+    if (_s2_ctext[i].path) {
+      _s2priv_texSlotInsert(i, 1);
+    }
+  }
+}
+
+/* index into _s2_ctext of texture id, or -1 */
+int _s2priv_texIndex(unsigned int id) {
+  if (!_s2_texreg_nslot) {
+    return -1;
+  }
+  unsigned int mask = _s2_texreg_nslot - 1;
+  unsigned int s = _s2priv_texHashId(id) & mask;
+  while (_s2_texreg_byid[s]) {
+    if (_s2_ctext[_s2_texreg_byid[s] - 1].id == id) {
+      return _s2_texreg_byid[s] - 1;
+    }
+    s = (s + 1) & mask;
+  }
+  return -1;
+}
+
+/* index into _s2_ctext of the shared texture loaded from file name,
+ * or -1 */
+int _s2priv_texNameIndex(char *name) {
+  if (!_s2_texreg_nslot) {
+    return -1;
+  }
+  unsigned int mask = _s2_texreg_nslot - 1;
+  unsigned int s = _s2priv_texHashName(name) & mask;
+  int idx;
+  while (_s2_texreg_byname[s]) {
+    idx = _s2_texreg_byname[s] - 1;
+    if (!strcmp(_s2_ctext[idx].path, name)) {
+      return idx;
+    }
+    s = (s + 1) & mask;
+  }
+  return -1;
+}
+
+/* add a newly created texture to the cache, with one reference held
+ * by the caller */
+void _s2priv_texRegister(unsigned int id, int width, int height, int depth,
+			 BITMAP4 *bitmap, int usemipmaps) {
+  if (_s2_ctext_count >= _s2_ctext_alloc) {
+    int nalloc = _s2_ctext_alloc ? 2 * _s2_ctext_alloc : 16;
+    _S2CACHEDTEXTURE *tmp = (_S2CACHEDTEXTURE *)
+      realloc(_s2_ctext, nalloc * sizeof(_S2CACHEDTEXTURE));
+    if (!tmp) {
+      _s2error("(internal)", "failed to allocate texture cache");
+    }
+    _s2_ctext = tmp;
+    _s2_ctext_alloc = nalloc;
+  }
+  if (2 * (_s2_ctext_count + 1) > _s2_texreg_nslot) {
+    _s2priv_texRehash(_s2_ctext_count + 1);
+  }
+
+  _S2CACHEDTEXTURE *t = _s2_ctext + _s2_ctext_count;
+  memset(t, 0, sizeof(_S2CACHEDTEXTURE));
+  t->width = width;
+  t->height = height;
+  t->depth = depth;
+  t->bitmap = bitmap;
+  t->id = id;
+  t->mipmaps = usemipmaps;
+  t->refs = 1;
+  t->bytes = bitmap ? 
+    (long)width * height * (depth > 0 ? depth : 1) * sizeof(BITMAP4) : 0;
+  _s2_ctext_bytes += t->bytes;
+  _s2priv_texSlotInsert(_s2_ctext_count, 0);
+  _s2_ctext_count++;
+}
+
+/* remove entry idx from the cache; the caller has already released
+ * the bitmap and the OpenGL texture */
+void _s2priv_texUnregister(int idx) {
+  int last = _s2_ctext_count - 1;
+  _s2priv_texSlotDelete(_s2priv_texSlot(idx, 0), 0);
+  if (_s2_ctext[idx].path) {
+    _s2priv_texSlotDelete(_s2priv_texSlot(idx, 1), 1);
+    free(_s2_ctext[idx].path);
+  }
+  _s2_ctext_bytes -= _s2_ctext[idx].bytes;
+  if (idx != last) {
+    int s = _s2priv_texSlot(last, 0);
+    _s2_texreg_byid[s] = idx + 1;
+    if (_s2_ctext[last].path) {
+      s = _s2priv_texSlot(last, 1);
+      _s2_texreg_byname[s] = idx + 1;
+    }
+    _s2_ctext[idx] = _s2_ctext[last];
+  }
+  _s2_ctext_count--;
+}
+
+/* fetch the shared texture for file name, loading it on first use,
+ * and take a reference to it */
+unsigned int _s2priv_texAcquire(char *name) {
+  int idx = _s2priv_texNameIndex(name);
+  if (idx >= 0) {
+    _s2_ctext[idx].refs++;
+    return _s2_ctext[idx].id;
+  }
+  unsigned int id = ss2lt(name);
+  idx = _s2priv_texIndex(id);
+  if (idx >= 0) {
+    /* the name table never holds more entries than the id table,
+     * so it needs no growing here */
+    _s2_ctext[idx].path = strdup(name);
+    _s2priv_texSlotInsert(idx, 1);
+  }
+  return id;
+}
+
+/* drop a reference to a texture, deleting it if it was the last */
+void _s2priv_texRelease(unsigned int id) {
+  int idx = _s2priv_texIndex(id);
+  if (idx < 0) {
+    return;
+  }
+  if (--_s2_ctext[idx].refs > 0) {
+    return;
+  }
+  _s2priv_dropTexture(id);
+}
+
+/* bytes of texture memory held by the cache */
+long ss2qtm(int *ntex) {
+  if (ntex) {
+    *ntex = _s2_ctext_count;
+  }
+  return _s2_ctext_bytes;
+}
@@ -115,8 +115,8 @@ typedef struct {
   COLOUR colour;
   float size;
 #if defined(BUILDING_S2PLOT)
-  char whichscreen[10];
-  char VRMLname[MAXVRMLLEN];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 #endif
 } DOT;
 
@@ -126,7 +126,7 @@ typedef struct {
   double size;
   int trans;
   double alpha;
-  char whichscreen[10];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
 } TRDOT; /* transparent dot */
 
 typedef struct {
@@ -134,8 +134,8 @@ typedef struct {
   COLOUR colour[2];
   double width;
 #if defined(BUILDING_S2PLOT)
-  char whichscreen[10];
-  char VRMLname[MAXVRMLLEN];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
   int stipple_factor; // 0 means no stipple
   unsigned short stipple_pattern;
   float alpha;
@@ -147,8 +147,8 @@ typedef struct {
   XYZ n[3];
   COLOUR colour[3];
 #if defined(BUILDING_S2PLOT)
-  char whichscreen[10];
-  char VRMLname[MAXVRMLLEN];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 #endif
 } FACE3;
 
@@ -157,8 +157,8 @@ typedef struct {
   XYZ n[4];
   COLOUR colour[4];
 #if defined(BUILDING_S2PLOT)
-  char whichscreen[10];
-  char VRMLname[MAXVRMLLEN];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 #endif
 } FACE4;
 
@@ -173,8 +173,8 @@ typedef struct {
   unsigned int textureid; // wasGL
 #if defined(BUILDING_S2PLOT)
   double alpha; /* transparency: 1.0 = default = opaque */
-  char whichscreen[10]; 
-  char VRMLname[MAXVRMLLEN];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 #endif
 } FACE4T;
 
@@ -184,7 +184,7 @@ typedef struct {
   double r1,r2;
   COLOUR colour;
 #if defined(BUILDING_S2PLOT)
-  char whichscreen[10];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
 #endif
 } DISK;
 
@@ -193,8 +193,8 @@ typedef struct {
   double r1,r2;
   COLOUR colour;
 #if defined(BUILDING_S2PLOT)
-  char whichscreen[10];
-  char VRMLname[MAXVRMLLEN];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 #endif
 } CONE;
 
@@ -209,8 +209,8 @@ typedef struct {
   COLOUR colour;
   char s[MAXLABELLEN];
 #if defined(BUILDING_S2PLOT)
-  char whichscreen[10];
-  char VRMLname[MAXVRMLLEN];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 #endif
 } LABEL;
 
@@ -225,8 +225,8 @@ typedef struct {
   double r;
   COLOUR colour;
 #if defined(BUILDING_S2PLOT)
-  char whichscreen[10];
-  char VRMLname[MAXVRMLLEN];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 #endif
 } BALL;
 
@@ -242,7 +242,7 @@ typedef struct {
   float texture_phase; // phase of texture [longitude in 0->1]
   XYZ axis; // axis of rotation
   float rotation; // angle of rotation in degrees
-  char whichscreen[10];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
 #endif
 } BALLT;
 
@@ -258,8 +258,8 @@ typedef struct {
   float size;    /* size of handle: approx. the diameter of billboard */
   int texid;     /* texture for unselected draw, -1 for default */
   int hitexid;   /* texture for selected draw, -1 for default */
-  char whichscreen[10];
-  char VRMLname[32];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 } _S2HANDLE;
 
 #if !defined(_S2BBOARD_STRUCT_DEFINED)
@@ -275,8 +275,8 @@ typedef struct {
   float alpha;   /* transparency */
   double dist;   /* distance to camera - used internally */
   char trans;    /* 'o', 's', 't' */
-  char whichscreen[10];
-  char VRMLname[32];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 } _S2BBOARD;
 #define _S2BBOARD_STRUCT_DEFINED 1
 #endif
@@ -288,8 +288,8 @@ typedef struct {
   unsigned int texid;
   char trans;
   int n;
-  char whichscreen[10];
-  char VRMLname[32];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 } _S2BBSET;
 
 /* transparent 3-vertex facet */
@@ -301,8 +301,8 @@ typedef struct {
   COLOUR colour[3];
   int trans; /* 'o' = opaque, 't'/'s' = transparent */
   double alpha[3]; /* transparency: 1.0 = default = opaque */
-  char whichscreen[10]; 
-  char VRMLname[32];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 } _S2FACE3A;
 #define _S2FACE3A_STRUCT_DEFINED 1
 #endif
@@ -316,8 +316,8 @@ typedef struct {
   unsigned int texid;
   int trans; /* 'o' = opaque, 't'/'s' = transparent */
   double alpha; /* 1.0 = opaque, 0.0 = totally transparent */
-  char whichscreen[10];
-  char VRMLname[32];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 } _S2TEXPOLY3D;
 #endif
 
@@ -335,10 +335,11 @@ typedef struct {
   int *facets; // 3 * int per facet = 3 * vertex INDICES (look-up)
   int *facets_vtcs; // 3 * int per facet = 3 * texture coordinate INDICES
   unsigned int texid;
+  COLOUR col; /* modulates the texture; white unless set by ns2texmeshc */
   int trans; /* 'o' = opaque, 't'/'s' = transparent */
   double alpha; /* 1.0 = opaque, 0.0 = totally transparent */
-  char whichscreen[10];
-  char VRMLname[32];
+  unsigned short whichscreen; /* screen tag id, 0 = world geometry */
+  unsigned short VRMLname;   /* index into _s2_VRMLnames */
 } _S2TEXTUREDMESH;
 #define _S2TEXTUREDMESH_STRUCT_DEFINED
 #endif
@@ -362,11 +363,17 @@ typedef struct {
   float ***grptr;
   _S2TRIANGLE_CACHE_DESCR descr;
   _S2TRIANGLE_CACHE_DESCR cached_descr;
-  /* the triangle list */
+  /* the triangle list, as an indexed mesh */
   int ntri;
-  XYZ *trivert; /* ntri * 3 in length */
-  XYZ *normals; /* ntri * 3 in length */
+  int *tris;    /* ntri * 3 in length: indices into verts */
+  int nvert;
+  XYZ *verts;   /* nvert in length */
+  XYZ *normals; /* nvert in length, NULL for facet normals */
   COLOUR *col;  /* ntri in length */
+  /* optional min/max block tree over the grid, see ns2sist */
+  int nbx, nby, nbz;    /* blocks along each axis, 0 = no tree */
+  float *bmin, *bmax;   /* nbx * nby * nbz in length */
+  float *rmin, *rmax;   /* per slab of blocks, nbx in length */
 } _S2TRIANGLE_CACHE;
 
 /* volume rendering types, settings */
@@ -392,6 +399,129 @@ typedef struct {
   int consumed; // has event been used?
 } _S2EVENT;
 
+/* interleaved vertex used for batched drawing of facets, dots, lines
+ * and labels */
+typedef struct {
+  float p[3];
+  float n[3];
+  float c[4];
+} _S2BATCHVTX;
+
+/* a run of batched vertices drawn with the same GL state */
+typedef struct {
+  int mode;            /* GL_TRIANGLES, GL_QUADS, GL_POINTS or GL_LINES */
+  int lit;             /* drawn with lighting on (facets) or off */
+  unsigned char screen; /* screen bits (_S2SCREEN_*), 0 = world geometry */
+  char trans;          /* blending class 'o', 's' or 't' of transparent
+			* geometry, 0 = drawn in the current state */
+  int first, count;    /* range of vertices */
+  float size;          /* point size or line width, before global scaling */
+  int stipple_factor;  /* 0 means no stipple */
+  unsigned short stipple_pattern;
+  unsigned int cell;   /* grid cell of the batch's primitives */
+  float lo[3], hi[3];  /* bounding box of world batches, for culling */
+  int lod, nlod;       /* reduced detail levels of point batches, in the
+			* list's lod array (see s2lod.c) */
+} _S2BATCH;
+
+/* a level of representative points for a batch, coarsest first */
+typedef struct {
+  int first, count;    /* range of vertices */
+} _S2BATCHLOD;
+
+typedef struct {
+  int nvtx; _S2BATCHVTX *vtx;
+  int nbatch; _S2BATCH *batch;
+  int nvbo;            /* 1 for static, _S2BATCHRING for streamed lists */
+  int curvbo;          /* buffer holding the most recent upload */
+  unsigned int vbo[_S2BATCHRING]; /* 0 = draw from vtx */ // wasGL
+  int vbocap[_S2BATCHRING]; /* number of vertices each vbo can hold */
+  int dirty;           /* lists changed since vtx was packed */
+  int nlod; _S2BATCHLOD *lod; /* detail levels of all batches */
+} _S2BATCHLIST;
+
+/* distance keys and the resulting draw order for depth sorting (see
+ * s2sort.c); kept between frames */
+typedef struct {
+  int n, cap;
+  unsigned int *key, *tkey; /* sort keys, and scratch */
+  int *idx, *tidx;          /* idx[k] is the k'th item in sorted order */
+  int *hist;                /* per-chunk digit counts */
+  int nhist;
+} _S2SORTKEYS;
+
+/* uniform grid over world geometry, used to pack it into batches by
+ * place (see s2cull.c) */
+typedef struct {
+  int n[3];            /* cells along each axis */
+  int ncell;           /* n[0] * n[1] * n[2], 1 = no binning */
+  float lo[3];         /* grid origin */
+  float sca[3];        /* cells per unit length */
+} _S2CULLGRID;
+
+/* planes of a view frustum: a x + b y + c z + d >= 0 inside */
+typedef struct {
+  float p[6][4];
+  float w[4];          /* clip w of a point: w[0] x + ... + w[3] */
+  float pix;           /* pixels spanned by unit length at clip w = 1 */
+  int on;              /* 0 = cull nothing */
+} _S2FRUSTUM;
+
+/* stages of a frame timed by the frame-time governor, and the cost
+ * knobs it turns (see s2govern.c) */
+#define _S2GOV_CALLBACK 0
+#define _S2GOV_GEOMETRY 1
+#define _S2GOV_SORT     2
+#define _S2GOV_DRAW     3
+#define _S2GOV_NSTAGES  4
+#define _S2GOV_SPHERE   0
+#define _S2GOV_SLICES   1
+#define _S2GOV_ISORES   2
+#define _S2GOV_POINTS   3
+typedef struct {
+  float budget;        /* seconds per frame while moving, 0 = off */
+  int level;           /* coarsening applied, 0 = full quality */
+  double t[_S2GOV_NSTAGES];    /* stage times of the frame being drawn */
+  double last[_S2GOV_NSTAGES]; /* stage times of the last frame */
+} _S2GOVERNOR;
+
+/* stages of a frame in the frame profile (see s2prof.c) */
+#define _S2PROF_CALLBACK  0  /* user callbacks */
+#define _S2PROF_DYNAMIC   1  /* _s2_startDynamicGeometry */
+#define _S2PROF_PACK      2  /* packing and uploading vertex batches */
+#define _S2PROF_BALL      3  /* MakeGeometry, by class of primitive */
+#define _S2PROF_DISK      4
+#define _S2PROF_CONE      5
+#define _S2PROF_BATCH     6  /* facets, dots, lines and labels */
+#define _S2PROF_BALLT     7
+#define _S2PROF_FACE4T    8
+#define _S2PROF_TRANS     9  /* packing and sorting transparent geometry */
+#define _S2PROF_TEXMESH  10
+#define _S2PROF_BBSORT   11
+#define _S2PROF_BBOARD   12
+#define _S2PROF_BBSET    13
+#define _S2PROF_VRTEX    14  /* volume rendering texture rebuilds */
+#define _S2PROF_ISOSURF  15  /* isosurface regeneration */
+#define _S2PROF_SWAP     16
+#define _S2PROF_CAPTURE  17  /* reading back recorded frames */
+#define _S2PROF_DRAW     18  /* all drawing, including the stages within */
+#define _S2PROF_NSTAGES  19
+/* frames kept by the frame profile */
+#define _S2PROFFRAMES   256
+typedef struct {
+  float t;             /* seconds */
+  int count;           /* calls or primitives */
+  int bytes;           /* data built or uploaded */
+} _S2PROFSAMPLE;
+typedef struct {
+  int on;
+  int nframe;          /* frames begun: the current one is in slot
+			* (nframe - 1) % _S2PROFFRAMES */
+  double tstart[_S2PROFFRAMES];
+  _S2PROFSAMPLE s[_S2PROFFRAMES][_S2PROF_NSTAGES];
+  char *filename;      /* written on 'T' and at exit, if set */
+} _S2PROFILE;
+
 /* multi-panel capability */
 typedef struct {
   
@@ -445,6 +575,12 @@ typedef struct {
   int dragview[4]; // wasGL
   
   int GL_listindex; /* for GL list of static geom */
+  _S2BATCHLIST GL_static; /* packed vertex buffer of static geom */
+  _S2BATCHLIST GL_dynamic; /* streamed vertex buffers of dynamic geom */
+  CAMERA lodcamera; /* view at the last frame, to detect motion */
+  XYZ lodtrans;
+  double lodrot[16];
+  int lodmoving; /* > 0 while the view is moving (see s2lod.c) */
   
   /* "current" geometry */
   int nball    ; BALL    *ball;
@@ -520,6 +656,14 @@ typedef struct {
   BITMAP4 *bitmap;
   unsigned int id; // wasGL
   int depth, depth2; // "user" and "internal" depth for 3d textures
+  int mipmaps; // installed with mipmaps?
+  int refs; // users of the texture (see s2texreg.c)
+  long bytes; // size of bitmap (0 until there is one)
+  char *path; // file name for textures shared by name, else NULL
+  int loadseq; // non-zero while being loaded in the background
+  float aspect; // aspect ratio of the source image if not width/height
+  int packed; // 1 + format if loaded from a texture file (s2texfile.c)
+              // and not yet reinstalled from a host copy
 } _S2CACHEDTEXTURE;
 #define _S2CACHEDTEXTURE_STRUCT_DEFINED 1
 #endif
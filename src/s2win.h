@@ -64,5 +64,23 @@ void s2winInitDisplayMode(int stereotype, int aticard);
 void s2winDestroyWindow(void);
 void s2winBitmapCharacter(char *);
 
+/* A window system supplied by a device driver (eg. for offscreen
+ * rendering) in place of glut.  Once installed, every s2win call is
+ * routed to it; calls with no member here (reshape, idle and input
+ * handlers, cursors, bitmap characters) do nothing.
+ */
+typedef struct {
+  void (*init)(int *argc, char **argv);
+  void (*mainloop)(void);
+  void (*createwindow)(char *title, int w, int h);
+  void (*displayfunc)(void (*func)(void));
+  int (*get)(int which);
+  void (*swapbuffers)(void);
+  void (*destroywindow)(void);
+} S2WINSYS;
+
+void s2winSetSystem(S2WINSYS *winsys);
+S2WINSYS *s2winSystem(void);
+
 
 #endif
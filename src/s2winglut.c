@@ -48,76 +48,156 @@
 #include <mpi.h>
 #endif
 
+/* window system installed by a device driver, or NULL for glut */
+static S2WINSYS *_s2win_sys = NULL;
+static int _s2win_w = 0, _s2win_h = 0;
+
+void s2winSetSystem(S2WINSYS *winsys) {
+  _s2win_sys = winsys;
+}
+
+S2WINSYS *s2winSystem(void) {
+  return _s2win_sys;
+}
+
 void s2winInit(int *argc, char **argv) {
+  if (_s2win_sys) {
+    if (_s2win_sys->init) {
+      _s2win_sys->init(argc, argv);
+    }
+    return;
+  }
   glutInit(argc, argv);
 glutInitWindowPosition(0, 0);
 }
 
 void s2winMainLoop(void) {
+  if (_s2win_sys) {
+    if (_s2win_sys->mainloop) {
+      _s2win_sys->mainloop();
+    }
+    return;
+  }
   glutMainLoop();
 }
 
 void s2winInitWindowSize(int w, int h) {
+  _s2win_w = w;
+  _s2win_h = h;
+  if (_s2win_sys) {
+    return;
+  }
   glutInitWindowSize(w, h);
 }
 
 void s2winCreateWindow(char *title) {
+  if (_s2win_sys) {
+    if (_s2win_sys->createwindow) {
+      _s2win_sys->createwindow(title, _s2win_w, _s2win_h);
+    }
+    return;
+  }
   glutCreateWindow(title);
 }
 
 void s2winFullScreen(void) {
+  if (_s2win_sys) {
+    return;
+  }
   glutFullScreen();
 }
 
 void s2winReshapeFunc(void (*func)(int width, int height)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutReshapeFunc(func);
 }
 
 void s2winDisplayFunc(void (*func)(void)) {
+  if (_s2win_sys) {
+    if (_s2win_sys->displayfunc) {
+      _s2win_sys->displayfunc(func);
+    }
+    return;
+  }
   glutDisplayFunc(func);
 }
 
 void s2winVisibilityFunc(void (*func)(int state)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutVisibilityFunc(func);
 }
 
 void s2winKeyboardFunc(void (*func)(unsigned char key, 
 				    int x, int y)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutKeyboardFunc(func);
 }
 
 void s2winIdleFunc(void (*func)(void)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutIdleFunc(func);
 }
 
 void s2winSpecialFunc(void (*func)(int key, int x, int y)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutSpecialFunc(func);
 }
 
 void s2winMouseFunc(void (*func)(int button, int state, 
 				 int x, int y)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutMouseFunc(func);
 }
 
 void s2winMotionFunc(void (*func)(int x, int y)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutMotionFunc(func);
 }
 
 void s2winPassiveMotionFunc(void (*func)(int x, int y)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutPassiveMotionFunc(func);
 }
 
 void s2winSpaceballButtonFunc(void (*func)(int button, int state)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutSpaceballButtonFunc(func);
 }
 void s2winSpaceballMotionFunc(void (*func)(int x, int y, int z)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutSpaceballMotionFunc(func);
 }
 void s2winSpaceballRotateFunc(void (*func)(int x, int y, int z)) {
+  if (_s2win_sys) {
+    return;
+  }
   glutSpaceballRotateFunc(func);
 }
 
 void s2winSetCursor(int cursor) {
+  if (_s2win_sys) {
+    return;
+  }
   switch(cursor) {
   case S2_CURSOR_CROSSHAIR:
     glutSetCursor(GLUT_CURSOR_CROSSHAIR);
@@ -132,6 +212,9 @@ void s2winSetCursor(int cursor) {
 }
 
 int s2winGet(int which) {
+  if (_s2win_sys) {
+    return _s2win_sys->get ? _s2win_sys->get(which) : 0;
+  }
   switch(which) {
   case S2_SCREEN_WIDTH:
     return glutGet(GLUT_SCREEN_WIDTH);
@@ -158,20 +241,35 @@ void s2winSwapBuffers(void) {
 #if defined(S2MPICH)
   MPI_Barrier(MPI_COMM_WORLD);
 #endif
+  if (_s2win_sys) {
+    if (_s2win_sys->swapbuffers) {
+      _s2win_sys->swapbuffers();
+    }
+    return;
+  }
   glutSwapBuffers();
 }
 
 void s2winPostRedisplay(void) {
+  if (_s2win_sys) {
+    return;
+  }
   glutPostRedisplay();
 }
 
 int s2winGetModifiers(void) {
   // this ASSUMES GLUT_ACTIVE_* == S2_ACTIVE_* ... should fix with 
   // some mapping code in the future.
+  if (_s2win_sys) {
+    return 0;
+  }
   return glutGetModifiers();
 }
 
 void s2winInitDisplayMode(int stereotype, int aticard) {
+  if (_s2win_sys) {
+    return;
+  }
 
   if (stereotype == ACTIVESTEREO) {
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH | 
@@ -198,10 +296,19 @@ void s2winInitDisplayMode(int stereotype, int aticard) {
 }
 
 void s2winDestroyWindow(void) {
+  if (_s2win_sys) {
+    if (_s2win_sys->destroywindow) {
+      _s2win_sys->destroywindow();
+    }
+    return;
+  }
   glutDestroyWindow(glutGetWindow());
 }
 
 void s2winBitmapCharacter(char *p) {
+  if (_s2win_sys) {
+    return;
+  }
   glutBitmapCharacter(GLUT_BITMAP_8_BY_13, *p);
 }
 